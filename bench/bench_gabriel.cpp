@@ -0,0 +1,99 @@
+#include "bench_support.hpp"
+#include "programs.hpp"
+
+#include <sstream>
+#include <vector>
+
+using namespace shaka;
+
+namespace {
+
+void gabriel_fib(benchmark::State& state) {
+  bench::Program program(bench::fib_program, "(fib 20)");
+  bench::run_program(state, program, "6765");
+}
+
+void gabriel_tak(benchmark::State& state) {
+  bench::Program program(bench::tak_program, "(tak 18 12 6)");
+  bench::run_program(state, program, "7");
+}
+
+void gabriel_ack(benchmark::State& state) {
+  bench::Program program(bench::ack_program, "(ack 2 9)");
+  bench::run_program(state, program, "21");
+}
+
+void gabriel_nqueens(benchmark::State& state) {
+  bench::Program program(bench::nqueens_program, "(queens 8)");
+  bench::run_program(state, program, "92");
+}
+
+void gabriel_deriv(benchmark::State& state) {
+  bench::Program program(bench::deriv_program,
+                         "(deriv '(+ (* 3 x x) (* a x x) (* b x) 5))");
+  bench::run_program(state, program,
+      "(+ (* (* 3 x x) (+ (/ 0 3) (/ 1 x) (/ 1 x))) "
+      "(* (* a x x) (+ (/ 0 a) (/ 1 x) (/ 1 x))) "
+      "(* (* b x) (+ (/ 0 b) (/ 1 x))) 0)");
+}
+
+void gabriel_destruct(benchmark::State& state) {
+  bench::Program program(bench::destruct_program,
+                         "(list-lengths (destructive 60 50))");
+  bench::run_program(state, program, "(6 6 7 8 8 8 8 8 8 31)");
+}
+
+void gabriel_nboyer(benchmark::State& state) {
+  bench::Program program(bench::nboyer_program, "(nboyer 1 #f)");
+  bench::run_program(state, program, "#t");
+}
+
+void r7rs_string_append(benchmark::State& state) {
+  bench::Program program(bench::string_append_program,
+                         "(string-length (string-append-loop 500 \"\"))");
+  bench::run_program(state, program, "1500");
+}
+
+/**
+ * @brief Computes n! in base 10000 limbs, least significant first, the way
+ * bignum-factorial does, and prints them as a list.
+ */
+std::string factorial_limbs(int n) {
+  std::vector<int> limbs = {1};
+  for (int i = 2; i <= n; ++i) {
+    int carry = 0;
+    for (int& limb : limbs) {
+      int product = limb * i + carry;
+      limb = product % 10000;
+      carry = product / 10000;
+    }
+    for (; carry != 0; carry /= 10000) {
+      limbs.push_back(carry % 10000);
+    }
+  }
+  std::ostringstream out;
+  out << "(";
+  for (std::size_t i = 0; i < limbs.size(); ++i) {
+    out << (i == 0 ? "" : " ") << limbs[i];
+  }
+  out << ")";
+  return out.str();
+}
+
+void r7rs_bignum_factorial(benchmark::State& state) {
+  bench::Program program(bench::bignum_factorial_program,
+                         "(bignum-factorial 100)");
+  bench::run_program(state, program, factorial_limbs(100));
+}
+
+} // namespace
+
+BENCHMARK(gabriel_fib)->Unit(benchmark::kMillisecond);
+BENCHMARK(gabriel_tak)->Unit(benchmark::kMillisecond);
+BENCHMARK(gabriel_ack)->Unit(benchmark::kMillisecond);
+BENCHMARK(gabriel_nqueens)->Unit(benchmark::kMillisecond);
+BENCHMARK(gabriel_deriv)->Unit(benchmark::kMicrosecond);
+BENCHMARK(gabriel_destruct)->Unit(benchmark::kMillisecond);
+BENCHMARK(gabriel_nboyer)->Unit(benchmark::kMillisecond);
+BENCHMARK(r7rs_string_append)->Unit(benchmark::kMillisecond);
+BENCHMARK(r7rs_bignum_factorial)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,134 @@
+#include "bench_support.hpp"
+#include "shaka_scheme/runtime/stdproc/pairs_and_lists.hpp"
+#include "shaka_scheme/system/core/lists.hpp"
+#include "shaka_scheme/system/core/types.hpp"
+#include "shaka_scheme/system/core/vectors.hpp"
+#include "shaka_scheme/system/gc/GC.hpp"
+#include "shaka_scheme/system/gc/init_gc.hpp"
+#include "shaka_scheme/system/gc/make_node.hpp"
+
+using namespace shaka;
+
+namespace {
+
+/**
+ * @brief Builds a proper list of the numbers 0 to length - 1.
+ */
+NodePtr make_number_list(std::size_t length) {
+  NodePtr list = make_null();
+  for (std::size_t i = length; i > 0; --i) {
+    list = make_pair(create_node(Number(static_cast<int>(i - 1))), list);
+  }
+  return list;
+}
+
+/**
+ * @brief Conses a list of state.range(0) elements onto the empty list.
+ *
+ * Each iteration allocates into its own heap, which is freed with it.
+ */
+void lists_cons(benchmark::State& state) {
+  const std::size_t length = state.range(0);
+  for (auto _ : state) {
+    gc::GC scratch;
+    gc::HeapScope scope(scratch);
+    NodePtr element = create_node(Number(0));
+    NodePtr list = core::list();
+    for (std::size_t i = 0; i < length; ++i) {
+      list = core::cons(element, list);
+    }
+    benchmark::DoNotOptimize(list);
+  }
+  state.SetComplexityN(state.range(0));
+}
+
+/**
+ * @brief Takes the length of a list of state.range(0) elements.
+ */
+void lists_length(benchmark::State& state) {
+  gc::GC garbage_collector;
+  gc::HeapScope scope(garbage_collector);
+  stdproc::Args args{make_number_list(state.range(0))};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(stdproc::impl::length(args));
+  }
+  state.SetComplexityN(state.range(0));
+}
+
+/**
+ * @brief Appends two lists of state.range(0) elements.
+ */
+void lists_append(benchmark::State& state) {
+  gc::GC garbage_collector;
+  gc::HeapScope scope(garbage_collector);
+  NodePtr list = make_number_list(state.range(0));
+  for (auto _ : state) {
+    gc::GC scratch;
+    gc::HeapScope scratch_scope(scratch);
+    benchmark::DoNotOptimize(core::append(list, list));
+  }
+  state.SetComplexityN(state.range(0));
+}
+
+/**
+ * @brief Copies a list of state.range(0) elements with list-copy.
+ */
+void lists_list_copy(benchmark::State& state) {
+  gc::GC garbage_collector;
+  gc::HeapScope scope(garbage_collector);
+  stdproc::Args args{make_number_list(state.range(0))};
+  for (auto _ : state) {
+    gc::GC scratch;
+    gc::HeapScope scratch_scope(scratch);
+    benchmark::DoNotOptimize(stdproc::impl::list_copy(args));
+  }
+  state.SetComplexityN(state.range(0));
+}
+
+/**
+ * @brief Converts a vector of state.range(0) elements to a list.
+ */
+void lists_vector_to_list(benchmark::State& state) {
+  gc::GC garbage_collector;
+  gc::HeapScope scope(garbage_collector);
+  NodePtr vector = core::list_to_vector(make_number_list(state.range(0)));
+  for (auto _ : state) {
+    gc::GC scratch;
+    gc::HeapScope scratch_scope(scratch);
+    benchmark::DoNotOptimize(core::vector_to_list(vector));
+  }
+  state.SetComplexityN(state.range(0));
+}
+
+/**
+ * @brief Compares two equal lists of state.range(0) elements with equal?.
+ */
+void lists_equal(benchmark::State& state) {
+  gc::GC garbage_collector;
+  gc::HeapScope scope(garbage_collector);
+  NodePtr left = make_number_list(state.range(0));
+  NodePtr right = make_number_list(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(core::equal(left, right));
+  }
+  state.SetComplexityN(state.range(0));
+}
+
+} // namespace
+
+// Each of these reports its fitted complexity, which should come out as
+// O(N) now that pairs are no longer copied when they are consed onto.
+BENCHMARK(lists_cons)->RangeMultiplier(4)->Range(1 << 8, 1 << 16)
+    ->Complexity(benchmark::oN)->Unit(benchmark::kMicrosecond);
+BENCHMARK(lists_length)->RangeMultiplier(4)->Range(1 << 8, 1 << 16)
+    ->Complexity(benchmark::oN)->Unit(benchmark::kMicrosecond);
+BENCHMARK(lists_append)->RangeMultiplier(4)->Range(1 << 8, 1 << 16)
+    ->Complexity(benchmark::oN)->Unit(benchmark::kMicrosecond);
+BENCHMARK(lists_list_copy)->RangeMultiplier(4)->Range(1 << 8, 1 << 16)
+    ->Complexity(benchmark::oN)->Unit(benchmark::kMicrosecond);
+BENCHMARK(lists_vector_to_list)->RangeMultiplier(4)->Range(1 << 8, 1 << 16)
+    ->Complexity(benchmark::oN)->Unit(benchmark::kMicrosecond);
+// equal? walks long acyclic lists mostly without its union-find table, so
+// this is linear as well, up to the 100000-element case.
+BENCHMARK(lists_equal)->RangeMultiplier(4)->Range(1 << 8, 1 << 16)
+    ->Arg(100000)->Complexity(benchmark::oN)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,140 @@
+#include "bench_support.hpp"
+#include "programs.hpp"
+#include "shaka_scheme/system/vm/compiler/Compiler.hpp"
+#include "shaka_scheme/system/parser/parser_definitions.hpp"
+#include "shaka_scheme/system/gc/GC.hpp"
+#include "shaka_scheme/system/gc/init_gc.hpp"
+#include "shaka_scheme/system/gc/make_node.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace shaka;
+
+namespace {
+
+/**
+ * @brief Looks up a global from under state.range(0) nested scopes.
+ */
+void micro_environment_get_value(benchmark::State& state) {
+  EnvPtr env = std::make_shared<Environment>(nullptr);
+  for (int i = 0; i < 64; ++i) {
+    env->set_value(Symbol("global-" + std::to_string(i)),
+                   create_node(Number(i)));
+  }
+  for (int depth = 0; depth < state.range(0); ++depth) {
+    env = std::make_shared<Environment>(env);
+    for (int i = 0; i < 4; ++i) {
+      env->set_value(Symbol("local-" + std::to_string(i)),
+                     create_node(Number(i)));
+    }
+  }
+  Symbol key("global-42");
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(env->get_value(key));
+  }
+}
+
+/**
+ * @brief Allocates numbers, sweeping the heap every so often, untimed, so
+ * that it stays small.
+ */
+void micro_gc_create_data(benchmark::State& state) {
+  gc::GC garbage_collector;
+  Data data(Number(42));
+  std::size_t allocated = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(garbage_collector.create_data(data));
+    if (++allocated == 65536) {
+      state.PauseTiming();
+      garbage_collector.sweep();
+      allocated = 0;
+      state.ResumeTiming();
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief Conses pairs through create_node, which copies a Data built by
+ * the caller, sweeping the heap every so often, untimed.
+ */
+void micro_create_node_pair(benchmark::State& state) {
+  gc::GC garbage_collector;
+  gc::HeapScope scope(garbage_collector);
+  NodePtr null = create_node(Data());
+  std::size_t allocated = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(create_node(Data(DataPair(null, null))));
+    if (++allocated == 65536) {
+      state.PauseTiming();
+      garbage_collector.sweep();
+      null = create_node(Data());
+      allocated = 0;
+      state.ResumeTiming();
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief Conses pairs through make_pair, which builds them in place.
+ */
+void micro_make_pair(benchmark::State& state) {
+  gc::GC garbage_collector;
+  gc::HeapScope scope(garbage_collector);
+  NodePtr null = make_null();
+  std::size_t allocated = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(make_pair(null, null));
+    if (++allocated == 65536) {
+      state.PauseTiming();
+      garbage_collector.sweep();
+      null = make_null();
+      allocated = 0;
+      state.ResumeTiming();
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief Reads every token of the nboyer program.
+ */
+void micro_lexer(benchmark::State& state) {
+  const std::string& source = bench::nboyer_program;
+  for (auto _ : state) {
+    parser::ParserInput input(source);
+    while (!input.get().is_incomplete()) {}
+  }
+  state.SetBytesProcessed(state.iterations() * source.size());
+}
+
+/**
+ * @brief Compiles the already parsed definitions of the nboyer program.
+ */
+void micro_compiler_compile(benchmark::State& state) {
+  std::vector<Expression> data;
+  parser::ParserInput input(bench::nboyer_program);
+  while (!input.peek().is_incomplete()) {
+    data.push_back(parser::parse_datum(input).it);
+  }
+  Compiler compiler;
+  for (auto _ : state) {
+    gc::GC scratch;
+    gc::HeapScope scope(scratch);
+    for (const Expression& datum : data) {
+      benchmark::DoNotOptimize(compiler.compile(datum));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * data.size());
+}
+
+} // namespace
+
+BENCHMARK(micro_environment_get_value)->Arg(0)->Arg(4)->Arg(16);
+BENCHMARK(micro_gc_create_data);
+BENCHMARK(micro_create_node_pair);
+BENCHMARK(micro_make_pair);
+BENCHMARK(micro_lexer);
+BENCHMARK(micro_compiler_compile)->Unit(benchmark::kMicrosecond);
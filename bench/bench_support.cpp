@@ -0,0 +1,109 @@
+#include "bench_support.hpp"
+#include "shaka_scheme/runtime/stdproc/equivalence_predicates.hpp"
+#include "shaka_scheme/runtime/stdproc/list_library.hpp"
+#include "shaka_scheme/runtime/stdproc/numbers_arithmetic.hpp"
+#include "shaka_scheme/runtime/stdproc/pairs_and_lists.hpp"
+#include "shaka_scheme/system/vm/compiler/CodeCache.hpp"
+#include "shaka_scheme/system/vm/strings.hpp"
+#include "shaka_scheme/system/gc/GC.hpp"
+#include "shaka_scheme/system/gc/init_gc.hpp"
+
+#include <sstream>
+
+namespace shaka {
+namespace bench {
+
+namespace {
+
+void define_procedure(EnvPtr env, const std::string& name, Callable callable,
+                      bool variadic) {
+  env->set_value(Symbol(name), create_node(Closure(callable, variadic)));
+}
+
+} // namespace
+
+EnvPtr make_environment() {
+  EnvPtr env = std::make_shared<Environment>(nullptr);
+  for (const char* form : {"define", "set!", "lambda", "quote"}) {
+    env->set_value(Symbol(form), create_node(PrimitiveFormMarker(form)));
+  }
+
+  define_procedure(env, "+", stdproc::add, true);
+  define_procedure(env, "-", stdproc::sub, true);
+  define_procedure(env, "*", stdproc::mul, true);
+  native::define_native(env, "quotient", [](int a, int b) {
+    return a / b;
+  });
+  native::define_native(env, "remainder", [](int a, int b) {
+    return a % b;
+  });
+  native::define_native(env, "<", [](const Number& a, const Number& b) {
+    return a < b;
+  });
+  native::define_native(env, "=", [](const Number& a, const Number& b) {
+    return a == b;
+  });
+  native::define_native(env, "not", [](NodePtr x) {
+    return x->get_type() == Data::Type::BOOLEAN && !x->get<Boolean>().get_value();
+  });
+
+  define_procedure(env, "car", stdproc::car, false);
+  define_procedure(env, "cdr", stdproc::cdr, false);
+  define_procedure(env, "cons", stdproc::cons, false);
+  define_procedure(env, "set-car!", stdproc::set_car, false);
+  define_procedure(env, "set-cdr!", stdproc::set_cdr, false);
+  define_procedure(env, "null?", stdproc::is_null, false);
+  define_procedure(env, "pair?", stdproc::is_pair, false);
+  define_procedure(env, "list", stdproc::list, true);
+  define_procedure(env, "length", stdproc::length, false);
+  define_procedure(env, "eq?", stdproc::eq, false);
+  define_procedure(env, "equal?", stdproc::equal, false);
+  env->set_value(Symbol("map"), create_node(Closure(
+      std::make_shared<SteppingCallable>(stdproc::map), true)));
+
+  define_procedure(env, "string-append", string_append, true);
+  define_procedure(env, "string-length", string_length, false);
+  return env;
+}
+
+std::string to_string(NodePtr node) {
+  std::ostringstream out;
+  out << *node;
+  return out.str();
+}
+
+Program::Program(const std::string& definitions, const std::string& entry) :
+    hvm(nullptr, nullptr, make_environment(), ValueRib(), nullptr) {
+  for (const Expression& definition : compile_source(definitions, hvm)) {
+    hvm.run(definition);
+  }
+  this->entry = compile_source(entry, hvm).at(0);
+}
+
+NodePtr Program::run() {
+  return hvm.run(entry);
+}
+
+void run_program(benchmark::State& state, Program& program,
+                 const std::string& expected) {
+  std::string result;
+  try {
+    gc::GC scratch;
+    gc::HeapScope scope(scratch);
+    result = to_string(program.run());
+  } catch (const std::exception& error) {
+    result = error.what();
+  }
+  if (result != expected) {
+    state.SkipWithError(("expected " + expected + ", got " + result).c_str());
+    return;
+  }
+  for (auto _ : state) {
+    gc::GC scratch;
+    gc::HeapScope scope(scratch);
+    benchmark::DoNotOptimize(program.run());
+  }
+}
+
+} // namespace bench
+} // namespace shaka
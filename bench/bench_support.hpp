@@ -0,0 +1,63 @@
+#ifndef SHAKA_SCHEME_BENCH_SUPPORT_HPP
+#define SHAKA_SCHEME_BENCH_SUPPORT_HPP
+
+#include "shaka_scheme/system/vm/HeapVirtualMachine.hpp"
+#include "shaka_scheme/system/base/Environment.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+namespace shaka {
+namespace bench {
+
+/**
+ * @brief Makes a top-level environment with the primitive forms and the
+ * procedures that the benchmark programs use.
+ */
+EnvPtr make_environment();
+
+/**
+ * @brief Prints a node the way the REPL does.
+ */
+std::string to_string(NodePtr node);
+
+/**
+ * @brief A Scheme program whose definitions are run once, in its own
+ * environment, so that a call into it can be timed on its own.
+ */
+class Program {
+public:
+  /**
+   * @param definitions The source text of the definitions
+   * @param entry The expression to time, such as (fib 20)
+   * @throws InvalidInputException if either does not parse
+   */
+  Program(const std::string& definitions, const std::string& entry);
+
+  /**
+   * @brief Evaluates the entry expression.
+   */
+  NodePtr run();
+
+private:
+  HeapVirtualMachine hvm;
+  Expression entry;
+};
+
+/**
+ * @brief Times program.run().
+ *
+ * The result of a first, untimed run is checked against expected, so that a
+ * benchmark that computes the wrong answer is reported as an error rather
+ * than timed. Each run allocates from its own GC, which is freed when the
+ * run ends, so memory stays flat however many iterations are timed; the
+ * freeing is counted as part of the run.
+ */
+void run_program(benchmark::State& state, Program& program,
+                 const std::string& expected);
+
+} // namespace bench
+} // namespace shaka
+
+#endif //SHAKA_SCHEME_BENCH_SUPPORT_HPP
@@ -0,0 +1,33 @@
+#include "shaka_scheme/system/lexer/rules/init.hpp"
+#include "shaka_scheme/system/gc/GC.hpp"
+#include "shaka_scheme/system/gc/init_gc.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+/**
+ * @brief Runs the benchmarks, reporting JSON unless another format is asked
+ * for, so that runs can be saved and compared from one revision to the next.
+ * The usual Google Benchmark flags apply, such as --benchmark_filter and
+ * --benchmark_out.
+ */
+int main(int argc, char** argv) {
+  shaka::lexer::rules::init_lexer_rules();
+  shaka::gc::GC garbage_collector;
+  shaka::gc::init_create_node(garbage_collector);
+
+  // A later flag overrides an earlier one
+  std::vector<char*> arguments(argv, argv + argc + 1);
+  char json_format[] = "--benchmark_format=json";
+  arguments.insert(arguments.begin() + 1, json_format);
+  int count = argc + 1;
+
+  benchmark::Initialize(&count, arguments.data());
+  if (benchmark::ReportUnrecognizedArguments(count, arguments.data())) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
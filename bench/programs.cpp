@@ -0,0 +1,356 @@
+#include "programs.hpp"
+
+namespace shaka {
+namespace bench {
+
+const std::string fib_program = R"(
+(define fib
+  (lambda (n)
+    (if (< n 2)
+        n
+        (+ (fib (- n 1)) (fib (- n 2))))))
+)";
+
+const std::string tak_program = R"(
+(define tak
+  (lambda (x y z)
+    (if (not (< y x))
+        z
+        (tak (tak (- x 1) y z)
+             (tak (- y 1) z x)
+             (tak (- z 1) x y)))))
+)";
+
+const std::string ack_program = R"(
+(define ack
+  (lambda (m n)
+    (if (= m 0)
+        (+ n 1)
+        (if (= n 0)
+            (ack (- m 1) 1)
+            (ack (- m 1) (ack m (- n 1)))))))
+)";
+
+const std::string nqueens_program = R"(
+(define append
+  (lambda (x y)
+    (if (null? x)
+        y
+        (cons (car x) (append (cdr x) y)))))
+
+(define iota1
+  (lambda (i l)
+    (if (= i 0)
+        l
+        (iota1 (- i 1) (cons i l)))))
+
+(define ok?
+  (lambda (row dist placed)
+    (if (null? placed)
+        #t
+        (if (= (car placed) (+ row dist))
+            #f
+            (if (= (car placed) (- row dist))
+                #f
+                (ok? row (+ dist 1) (cdr placed)))))))
+
+(define try-it
+  (lambda (x y z)
+    (if (null? x)
+        (if (null? y) 1 0)
+        (+ (if (ok? (car x) 1 z)
+               (try-it (append (cdr x) y) '() (cons (car x) z))
+               0)
+           (try-it (cdr x) (cons (car x) y) z)))))
+
+(define queens
+  (lambda (n)
+    (try-it (iota1 n '()) '() '())))
+)";
+
+const std::string deriv_program = R"(
+(define deriv
+  (lambda (a)
+    (if (not (pair? a))
+        (if (eq? a 'x) 1 0)
+        (if (eq? (car a) '+)
+            (cons '+ (map deriv (cdr a)))
+            (if (eq? (car a) '-)
+                (cons '- (map deriv (cdr a)))
+                (if (eq? (car a) '*)
+                    (list '* a (cons '+ (map (lambda (a) (list '/ (deriv a) a))
+                                             (cdr a))))
+                    (if (eq? (car a) '/)
+                        (list '-
+                              (list '/ (deriv (car (cdr a))) (car (cdr (cdr a))))
+                              (list '/
+                                    (car (cdr a))
+                                    (list '*
+                                          (car (cdr (cdr a)))
+                                          (car (cdr (cdr a)))
+                                          (deriv (car (cdr (cdr a)))))))
+                        #f)))))))
+)";
+
+const std::string destruct_program = R"(
+(define make-nils
+  (lambda (k a)
+    (if (= k 0)
+        a
+        (make-nils (- k 1) (cons '() a)))))
+
+(define last-pair
+  (lambda (x)
+    (if (null? (cdr x))
+        x
+        (last-pair (cdr x)))))
+
+(define fill-all
+  (lambda (l m)
+    (if (null? l)
+        #t
+        ((lambda ()
+           (if (null? (car l))
+               (set-car! l (cons '() '()))
+               #f)
+           (set-cdr! (last-pair (car l)) (make-nils m '()))
+           (fill-all (cdr l) m))))))
+
+(define mark-and-skip
+  (lambda (j a i)
+    (if (= j 0)
+        a
+        ((lambda ()
+           (set-car! a i)
+           (mark-and-skip (- j 1) (cdr a) i))))))
+
+(define cut-tail
+  (lambda (j a i)
+    (if (= j 1)
+        ((lambda (x)
+           (set-cdr! a '())
+           x)
+         (cdr a))
+        ((lambda ()
+           (set-car! a i)
+           (cut-tail (- j 1) (cdr a) i))))))
+
+(define take-half
+  (lambda (l1 i)
+    ((lambda (n)
+       (if (= n 0)
+           ((lambda ()
+              (set-car! l1 '())
+              (car l1)))
+           (cut-tail n (car l1) i)))
+     (quotient (length (car l1)) 2))))
+
+(define shuffle
+  (lambda (l1 l2 i)
+    (if (null? l2)
+        #t
+        ((lambda ()
+           (set-cdr! (mark-and-skip (quotient (length (car l2)) 2) (car l2) i)
+                     (take-half l1 i))
+           (shuffle (cdr l1) (cdr l2) i))))))
+
+(define destructive-loop
+  (lambda (i l m)
+    (if (= i 0)
+        l
+        ((lambda ()
+           (if (null? (car l))
+               (fill-all l m)
+               (shuffle l (cdr l) i))
+           (destructive-loop (- i 1) l m))))))
+
+(define destructive
+  (lambda (n m)
+    (destructive-loop n (make-nils 10 '()) m)))
+
+(define list-lengths
+  (lambda (l)
+    (if (null? l)
+        '()
+        (cons (length (car l)) (list-lengths (cdr l))))))
+)";
+
+const std::string nboyer_program = R"(
+(define lemmas
+  '(((and p q) (if p (if q (t) (f)) (f)))
+    ((or p q) (if p (t) (if q (t) (f))))
+    ((not p) (if p (f) (t)))
+    ((implies p q) (if p (if q (t) (f)) (t)))
+    ((iff p q) (and (implies p q) (implies q p)))
+    ((plus (plus x y) z) (plus x (plus y z)))
+    ((times x (plus y z)) (plus (times x y) (times x z)))
+    ((times (times x y) z) (times x (times y z)))
+    ((equal (plus a b) (zero)) (and (zerop a) (zerop b)))
+    ((zerop (plus a b)) (and (zerop a) (zerop b)))
+    ((difference x x) (zero))
+    ((lessp (remainder x y) y) (not (zerop y)))
+    ((if (if a b c) d e) (if a (if b d e) (if c d e)))))
+
+(define assq-term
+  (lambda (key alist)
+    (if (null? alist)
+        #f
+        (if (eq? (car (car alist)) key)
+            (car alist)
+            (assq-term key (cdr alist))))))
+
+(define unify
+  (lambda (term pattern subst)
+    (if (not (pair? pattern))
+        ((lambda (binding)
+           (if binding
+               (if (equal? term (cdr binding)) subst #f)
+               (cons (cons pattern term) subst)))
+         (assq-term pattern subst))
+        (if (not (pair? term))
+            #f
+            (if (eq? (car term) (car pattern))
+                (unify-args (cdr term) (cdr pattern) subst)
+                #f)))))
+
+(define unify-args
+  (lambda (terms patterns subst)
+    (if (null? terms)
+        (if (null? patterns) subst #f)
+        (if (null? patterns)
+            #f
+            ((lambda (s)
+               (if s
+                   (unify-args (cdr terms) (cdr patterns) s)
+                   #f))
+             (unify (car terms) (car patterns) subst))))))
+
+(define apply-subst
+  (lambda (subst term)
+    (if (not (pair? term))
+        ((lambda (binding)
+           (if binding (cdr binding) term))
+         (assq-term term subst))
+        (cons (car term) (apply-subst-args subst (cdr term))))))
+
+(define apply-subst-args
+  (lambda (subst terms)
+    (if (null? terms)
+        '()
+        (cons (apply-subst subst (car terms))
+              (apply-subst-args subst (cdr terms))))))
+
+(define rewrite
+  (lambda (term)
+    (if (not (pair? term))
+        term
+        (rewrite-with-lemmas (cons (car term) (rewrite-args (cdr term)))
+                             lemmas))))
+
+(define rewrite-args
+  (lambda (terms)
+    (if (null? terms)
+        '()
+        (cons (rewrite (car terms)) (rewrite-args (cdr terms))))))
+
+(define rewrite-with-lemmas
+  (lambda (term lst)
+    (if (null? lst)
+        term
+        ((lambda (subst)
+           (if subst
+               (rewrite (apply-subst subst (car (cdr (car lst)))))
+               (rewrite-with-lemmas term (cdr lst))))
+         (unify term (car (car lst)) '())))))
+
+(define member-term
+  (lambda (x lst)
+    (if (null? lst)
+        #f
+        (if (equal? x (car lst))
+            #t
+            (member-term x (cdr lst))))))
+
+(define truep
+  (lambda (x lst)
+    (if (equal? x '(t)) #t (member-term x lst))))
+
+(define falsep
+  (lambda (x lst)
+    (if (equal? x '(f)) #t (member-term x lst))))
+
+(define tautologyp
+  (lambda (x true-lst false-lst)
+    (if (truep x true-lst)
+        #t
+        (if (falsep x false-lst)
+            #f
+            (if (not (pair? x))
+                #f
+                (if (eq? (car x) 'if)
+                    (if (truep (car (cdr x)) true-lst)
+                        (tautologyp (car (cdr (cdr x))) true-lst false-lst)
+                        (if (falsep (car (cdr x)) false-lst)
+                            (tautologyp (car (cdr (cdr (cdr x))))
+                                        true-lst false-lst)
+                            (if (tautologyp (car (cdr (cdr x)))
+                                            (cons (car (cdr x)) true-lst)
+                                            false-lst)
+                                (tautologyp (car (cdr (cdr (cdr x))))
+                                            true-lst
+                                            (cons (car (cdr x)) false-lst))
+                                #f)))
+                    #f))))))
+
+(define boyer-term
+  '(implies (and x (implies x y)) y))
+
+(define boyer-subst
+  '((x f (plus (plus a b) (zero)))
+    (y lessp (remainder (times (times a b) (plus c d)) b) b)))
+
+(define nboyer
+  (lambda (n result)
+    (if (= n 0)
+        result
+        (nboyer (- n 1)
+                (tautologyp (rewrite (apply-subst boyer-subst boyer-term))
+                            '() '())))))
+)";
+
+const std::string string_append_program = R"(
+(define string-append-loop
+  (lambda (i s)
+    (if (= i 0)
+        s
+        (string-append-loop (- i 1) (string-append s "abc")))))
+)";
+
+const std::string bignum_factorial_program = R"(
+(define limb-base 10000)
+
+(define bignum-mul-small
+  (lambda (limbs k carry)
+    (if (null? limbs)
+        (if (= carry 0)
+            '()
+            (cons (remainder carry limb-base)
+                  (bignum-mul-small '() k (quotient carry limb-base))))
+        ((lambda (product)
+           (cons (remainder product limb-base)
+                 (bignum-mul-small (cdr limbs) k (quotient product limb-base))))
+         (+ (* (car limbs) k) carry)))))
+
+(define bignum-factorial-loop
+  (lambda (i n acc)
+    (if (< n i)
+        acc
+        (bignum-factorial-loop (+ i 1) n (bignum-mul-small acc i 0)))))
+
+(define bignum-factorial
+  (lambda (n)
+    (bignum-factorial-loop 2 n '(1))))
+)";
+
+} // namespace bench
+} // namespace shaka
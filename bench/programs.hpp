@@ -0,0 +1,30 @@
+#ifndef SHAKA_SCHEME_BENCH_PROGRAMS_HPP
+#define SHAKA_SCHEME_BENCH_PROGRAMS_HPP
+
+#include <string>
+
+namespace shaka {
+namespace bench {
+
+/**
+ * @brief The source texts of the benchmark programs, after the Gabriel and
+ * R7RS benchmark suites.
+ *
+ * The compiler knows only quote, lambda, if, set! and define, so let, cond,
+ * do, and and or are written out as calls and nested ifs, and loops as
+ * tail calls. Every if has an else branch.
+ */
+extern const std::string fib_program;
+extern const std::string tak_program;
+extern const std::string ack_program;
+extern const std::string nqueens_program;
+extern const std::string deriv_program;
+extern const std::string destruct_program;
+extern const std::string nboyer_program;
+extern const std::string string_append_program;
+extern const std::string bignum_factorial_program;
+
+} // namespace bench
+} // namespace shaka
+
+#endif //SHAKA_SCHEME_BENCH_PROGRAMS_HPP
@@ -0,0 +1,10 @@
+# Google Benchmark
+# Only the shaka-scheme-bench target needs it, so the library, the REPL and
+# the tests still build where it is not installed.
+find_package(benchmark QUIET)
+
+if (benchmark_FOUND)
+    message("Benchmarks: enabled")
+else (benchmark_FOUND)
+    message("Benchmarks: disabled, Google Benchmark was not found")
+endif (benchmark_FOUND)
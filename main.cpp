@@ -3,10 +3,16 @@
 #include <vector>
 #include "shaka_scheme/system/lexer/rules/init.hpp"
 #include "shaka_scheme/runtime/stdproc/numbers_arithmetic.hpp"
+#include "shaka_scheme/runtime/stdproc/ephemerons.hpp"
 #include "shaka_scheme/runtime/stdproc/equivalence_predicates.hpp"
+#include "shaka_scheme/runtime/stdproc/hash_tables.hpp"
+#include "shaka_scheme/runtime/stdproc/list_library.hpp"
+#include "shaka_scheme/runtime/stdproc/parallel.hpp"
+#include "shaka_scheme/runtime/stdproc/ports.hpp"
 #include "shaka_scheme/system/exceptions/BaseException.hpp"
 #include "shaka_scheme/system/exceptions/TypeException.hpp"
 #include "shaka_scheme/system/vm/HeapVirtualMachine.hpp"
+#include "shaka_scheme/system/vm/Scheduler.hpp"
 #include "shaka_scheme/system/vm/compiler/Compiler.hpp"
 #include "shaka_scheme/system/vm/strings.hpp"
 #include "shaka_scheme/system/lexer/rules/rule_token.hpp"
@@ -81,6 +87,43 @@ int main() {
       shaka::Symbol("string-append"),
       create_node(string_append));
 
+  top_level->set_value(
+      shaka::Symbol("make-string-builder"),
+      create_node(shaka::Closure(shaka::make_string_builder, false)));
+  top_level->set_value(
+      shaka::Symbol("string-builder-append!"),
+      create_node(shaka::Closure(shaka::string_builder_append, true)));
+  top_level->set_value(
+      shaka::Symbol("string-builder->string"),
+      create_node(shaka::Closure(shaka::string_builder_to_string, false)));
+  top_level->set_value(
+      shaka::Symbol("string-length"),
+      create_node(shaka::Closure(shaka::string_length, false)));
+  top_level->set_value(
+      shaka::Symbol("string-ref"),
+      create_node(shaka::Closure(shaka::string_ref, false)));
+  top_level->set_value(
+      shaka::Symbol("string-upcase"),
+      create_node(shaka::Closure(shaka::string_upcase, false)));
+  top_level->set_value(
+      shaka::Symbol("string-downcase"),
+      create_node(shaka::Closure(shaka::string_downcase, false)));
+  top_level->set_value(
+      shaka::Symbol("string-index"),
+      create_node(shaka::Closure(shaka::string_index, false)));
+  top_level->set_value(
+      shaka::Symbol("string-contains"),
+      create_node(shaka::Closure(shaka::string_contains, false)));
+  top_level->set_value(
+      shaka::Symbol("string=?"),
+      create_node(shaka::Closure(shaka::string_equal, true)));
+  top_level->set_value(
+      shaka::Symbol("string<?"),
+      create_node(shaka::Closure(shaka::string_less, true)));
+  top_level->set_value(
+      shaka::Symbol("string-ci=?"),
+      create_node(shaka::Closure(shaka::string_ci_equal, true)));
+
   shaka::Closure add_numbers(
       top_level,
       nullptr,
@@ -151,11 +194,244 @@ int main() {
       shaka::Symbol("equal?"),
       create_node(equal_closure));
 
+  top_level->set_value(
+      shaka::Symbol("make-hash-table"),
+      create_node(shaka::Closure(shaka::stdproc::make_hash_table, true)));
+  top_level->set_value(
+      shaka::Symbol("make-weak-hash-table"),
+      create_node(shaka::Closure(shaka::stdproc::make_weak_hash_table, true)));
+  top_level->set_value(
+      shaka::Symbol("hash-table-weak?"),
+      create_node(shaka::Closure(shaka::stdproc::is_hash_table_weak, false)));
+  top_level->set_value(
+      shaka::Symbol("hash-table?"),
+      create_node(shaka::Closure(shaka::stdproc::is_hash_table, false)));
+  top_level->set_value(
+      shaka::Symbol("hash-table-ref"),
+      create_node(shaka::Closure(shaka::stdproc::hash_table_ref, false)));
+  top_level->set_value(
+      shaka::Symbol("hash-table-ref/default"),
+      create_node(shaka::Closure(shaka::stdproc::hash_table_ref_default,
+                                 false)));
+  top_level->set_value(
+      shaka::Symbol("hash-table-set!"),
+      create_node(shaka::Closure(shaka::stdproc::hash_table_set, false)));
+  top_level->set_value(
+      shaka::Symbol("hash-table-delete!"),
+      create_node(shaka::Closure(shaka::stdproc::hash_table_delete, false)));
+  top_level->set_value(
+      shaka::Symbol("hash-table-contains?"),
+      create_node(shaka::Closure(shaka::stdproc::hash_table_contains, false)));
+  top_level->set_value(
+      shaka::Symbol("hash-table-exists?"),
+      create_node(shaka::Closure(shaka::stdproc::hash_table_contains, false)));
+  top_level->set_value(
+      shaka::Symbol("hash-table-size"),
+      create_node(shaka::Closure(shaka::stdproc::hash_table_size, false)));
+  top_level->set_value(
+      shaka::Symbol("hash-table-keys"),
+      create_node(shaka::Closure(shaka::stdproc::hash_table_keys, false)));
+  top_level->set_value(
+      shaka::Symbol("hash-table-values"),
+      create_node(shaka::Closure(shaka::stdproc::hash_table_values, false)));
+  top_level->set_value(
+      shaka::Symbol("hash-table->alist"),
+      create_node(shaka::Closure(shaka::stdproc::hash_table_to_alist, false)));
+  top_level->set_value(
+      shaka::Symbol("hash-table-clear!"),
+      create_node(shaka::Closure(shaka::stdproc::hash_table_clear, false)));
+  top_level->set_value(
+      shaka::Symbol("hash"),
+      create_node(shaka::Closure(shaka::stdproc::hash, true)));
+  top_level->set_value(
+      shaka::Symbol("hash-by-identity"),
+      create_node(shaka::Closure(shaka::stdproc::hash_by_identity, true)));
+  top_level->set_value(
+      shaka::Symbol("make-ephemeron"),
+      create_node(shaka::Closure(shaka::stdproc::make_ephemeron, false)));
+  top_level->set_value(
+      shaka::Symbol("ephemeron?"),
+      create_node(shaka::Closure(shaka::stdproc::is_ephemeron, false)));
+  top_level->set_value(
+      shaka::Symbol("ephemeron-broken?"),
+      create_node(shaka::Closure(shaka::stdproc::is_ephemeron_broken, false)));
+  top_level->set_value(
+      shaka::Symbol("ephemeron-key"),
+      create_node(shaka::Closure(shaka::stdproc::ephemeron_key, false)));
+  top_level->set_value(
+      shaka::Symbol("ephemeron-datum"),
+      create_node(shaka::Closure(shaka::stdproc::ephemeron_datum, false)));
+  top_level->set_value(
+      shaka::Symbol("reference-barrier"),
+      create_node(shaka::Closure(shaka::stdproc::reference_barrier, false)));
+  top_level->set_value(
+      shaka::Symbol("open-input-file"),
+      create_node(shaka::Closure(shaka::stdproc::open_input_file, false)));
+  top_level->set_value(
+      shaka::Symbol("open-binary-input-file"),
+      create_node(shaka::Closure(shaka::stdproc::open_binary_input_file, false)));
+  top_level->set_value(
+      shaka::Symbol("open-output-file"),
+      create_node(shaka::Closure(shaka::stdproc::open_output_file, false)));
+  top_level->set_value(
+      shaka::Symbol("open-binary-output-file"),
+      create_node(shaka::Closure(shaka::stdproc::open_binary_output_file, false)));
+  top_level->set_value(
+      shaka::Symbol("open-input-string"),
+      create_node(shaka::Closure(shaka::stdproc::open_input_string, false)));
+  top_level->set_value(
+      shaka::Symbol("open-input-bytevector"),
+      create_node(shaka::Closure(shaka::stdproc::open_input_bytevector, false)));
+  top_level->set_value(
+      shaka::Symbol("open-output-string"),
+      create_node(shaka::Closure(shaka::stdproc::open_output_string, false)));
+  top_level->set_value(
+      shaka::Symbol("open-output-bytevector"),
+      create_node(shaka::Closure(shaka::stdproc::open_output_bytevector, false)));
+  top_level->set_value(
+      shaka::Symbol("get-output-string"),
+      create_node(shaka::Closure(shaka::stdproc::get_output_string, false)));
+  top_level->set_value(
+      shaka::Symbol("get-output-bytevector"),
+      create_node(shaka::Closure(shaka::stdproc::get_output_bytevector, false)));
+  top_level->set_value(
+      shaka::Symbol("close-port"),
+      create_node(shaka::Closure(shaka::stdproc::close_port, false)));
+  top_level->set_value(
+      shaka::Symbol("close-input-port"),
+      create_node(shaka::Closure(shaka::stdproc::close_input_port, false)));
+  top_level->set_value(
+      shaka::Symbol("close-output-port"),
+      create_node(shaka::Closure(shaka::stdproc::close_output_port, false)));
+  top_level->set_value(
+      shaka::Symbol("port?"),
+      create_node(shaka::Closure(shaka::stdproc::is_port, false)));
+  top_level->set_value(
+      shaka::Symbol("input-port?"),
+      create_node(shaka::Closure(shaka::stdproc::is_input_port, false)));
+  top_level->set_value(
+      shaka::Symbol("output-port?"),
+      create_node(shaka::Closure(shaka::stdproc::is_output_port, false)));
+  top_level->set_value(
+      shaka::Symbol("textual-port?"),
+      create_node(shaka::Closure(shaka::stdproc::is_textual_port, false)));
+  top_level->set_value(
+      shaka::Symbol("binary-port?"),
+      create_node(shaka::Closure(shaka::stdproc::is_binary_port, false)));
+  top_level->set_value(
+      shaka::Symbol("input-port-open?"),
+      create_node(shaka::Closure(shaka::stdproc::is_input_port_open, false)));
+  top_level->set_value(
+      shaka::Symbol("output-port-open?"),
+      create_node(shaka::Closure(shaka::stdproc::is_output_port_open, false)));
+  top_level->set_value(
+      shaka::Symbol("current-input-port"),
+      create_node(shaka::Closure(shaka::stdproc::current_input_port, false)));
+  top_level->set_value(
+      shaka::Symbol("current-output-port"),
+      create_node(shaka::Closure(shaka::stdproc::current_output_port, false)));
+  top_level->set_value(
+      shaka::Symbol("current-error-port"),
+      create_node(shaka::Closure(shaka::stdproc::current_error_port, false)));
+  top_level->set_value(
+      shaka::Symbol("write-string"),
+      create_node(shaka::Closure(shaka::stdproc::write_string, true)));
+  top_level->set_value(
+      shaka::Symbol("write-u8"),
+      create_node(shaka::Closure(shaka::stdproc::write_u8, true)));
+  top_level->set_value(
+      shaka::Symbol("write-bytevector"),
+      create_node(shaka::Closure(shaka::stdproc::write_bytevector, true)));
+  top_level->set_value(
+      shaka::Symbol("newline"),
+      create_node(shaka::Closure(shaka::stdproc::newline, true)));
+  top_level->set_value(
+      shaka::Symbol("flush-output-port"),
+      create_node(shaka::Closure(shaka::stdproc::flush_output_port, true)));
+  top_level->set_value(
+      shaka::Symbol("read-line"),
+      create_node(shaka::Closure(shaka::stdproc::read_line, true)));
+  top_level->set_value(
+      shaka::Symbol("read-string"),
+      create_node(shaka::Closure(shaka::stdproc::read_string, true)));
+  top_level->set_value(
+      shaka::Symbol("read-u8"),
+      create_node(shaka::Closure(shaka::stdproc::read_u8, true)));
+  top_level->set_value(
+      shaka::Symbol("peek-u8"),
+      create_node(shaka::Closure(shaka::stdproc::peek_u8, true)));
+  top_level->set_value(
+      shaka::Symbol("u8-ready?"),
+      create_node(shaka::Closure(shaka::stdproc::is_u8_ready, true)));
+  top_level->set_value(
+      shaka::Symbol("char-ready?"),
+      create_node(shaka::Closure(shaka::stdproc::is_char_ready, true)));
+  top_level->set_value(
+      shaka::Symbol("read-bytevector"),
+      create_node(shaka::Closure(shaka::stdproc::read_bytevector, true)));
+  top_level->set_value(
+      shaka::Symbol("read-bytevector!"),
+      create_node(shaka::Closure(shaka::stdproc::read_bytevector_into, true)));
+  top_level->set_value(
+      shaka::Symbol("eof-object"),
+      create_node(shaka::Closure(shaka::stdproc::eof_object, false)));
+  top_level->set_value(
+      shaka::Symbol("eof-object?"),
+      create_node(shaka::Closure(shaka::stdproc::is_eof_object, false)));
+  top_level->set_value(
+      shaka::Symbol("parallel-map"),
+      create_node(shaka::Closure(shaka::stdproc::parallel_map, false)));
+  top_level->set_value(
+      shaka::Symbol("parallel-for-each"),
+      create_node(shaka::Closure(shaka::stdproc::parallel_for_each, false)));
+  top_level->set_value(
+      shaka::Symbol("parallel-reduce"),
+      create_node(shaka::Closure(shaka::stdproc::parallel_reduce, false)));
+  top_level->set_value(
+      shaka::Symbol("future"),
+      create_node(shaka::Closure(shaka::stdproc::future, false)));
+  top_level->set_value(
+      shaka::Symbol("touch"),
+      create_node(shaka::Closure(shaka::stdproc::touch, false)));
+
+  top_level->set_value(
+      shaka::Symbol("map"),
+      create_node(shaka::Closure(
+          std::make_shared<shaka::SteppingCallable>(shaka::stdproc::map),
+          true)));
+  top_level->set_value(
+      shaka::Symbol("for-each"),
+      create_node(shaka::Closure(
+          std::make_shared<shaka::SteppingCallable>(shaka::stdproc::for_each),
+          true)));
+  top_level->set_value(
+      shaka::Symbol("filter"),
+      create_node(shaka::Closure(
+          std::make_shared<shaka::SteppingCallable>(shaka::stdproc::filter),
+          true)));
+  top_level->set_value(
+      shaka::Symbol("fold"),
+      create_node(shaka::Closure(
+          std::make_shared<shaka::SteppingCallable>(shaka::stdproc::fold),
+          true)));
+  top_level->set_value(
+      shaka::Symbol("fold-right"),
+      create_node(shaka::Closure(
+          std::make_shared<shaka::SteppingCallable>(shaka::stdproc::fold_right),
+          true)));
+  top_level->set_value(
+      shaka::Symbol("sort"),
+      create_node(shaka::Closure(
+          std::make_shared<shaka::SteppingCallable>(shaka::stdproc::sort),
+          true)));
 
   shaka::ValueRib vr;
 
   shaka::HeapVirtualMachine hvm(nullptr, nullptr, top_level, vr, nullptr);
 
+  shaka::Scheduler scheduler(hvm);
+  scheduler.define_procedures(top_level);
+
   shaka::Compiler compiler;
 
   shaka::Symbol halt("halt");
@@ -189,12 +465,7 @@ int main() {
       shaka::Expression compiled = compiler.compile(expr, halt_instruction);
       //std::cout << "compiled datum" << std::endl;
       //std::cout << *compiled << std::endl;
-      hvm.set_expression(compiled);
-      do {
-        hvm.evaluate_assembly_instruction();
-      } while (shaka::core::car(hvm.get_expression())->get<shaka::Symbol>() !=
-          shaka::Symbol("halt"));
-      std::cout << *hvm.get_accumulator() << std::endl;
+      std::cout << *scheduler.run(compiled) << std::endl;
     } catch (shaka::InvalidInputException e) {
       std::cerr << "InvalidInputException: " << e.what() << std::endl;
     } catch (shaka::TypeException e) {
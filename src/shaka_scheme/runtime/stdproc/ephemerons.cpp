@@ -0,0 +1,70 @@
+#include "shaka_scheme/runtime/stdproc/ephemerons.hpp"
+#include "shaka_scheme/system/core/types.hpp"
+
+namespace shaka {
+namespace stdproc {
+
+namespace {
+
+void check_arguments(const Args& args, std::size_t count,
+                     const std::string& name) {
+  if (args.size() != count) {
+    throw InvalidInputException(10055,
+                                name + ": invalid number of arguments");
+  }
+}
+
+Ephemeron& get_ephemeron(const Args& args, const std::string& name) {
+  check_arguments(args, 1, name);
+  if (args[0]->get_type() != Data::Type::EPHEMERON) {
+    throw TypeException(10056, name + ": expected an ephemeron");
+  }
+  return args[0]->get<Ephemeron>();
+}
+
+} // namespace
+
+namespace impl {
+
+Args make_ephemeron(Args args) {
+  check_arguments(args, 2, "make-ephemeron");
+  return {create_node(Ephemeron(args[0], args[1]))};
+}
+
+Args is_ephemeron(Args args) {
+  check_arguments(args, 1, "ephemeron?");
+  return {create_node(Boolean(
+      args[0]->get_type() == Data::Type::EPHEMERON))};
+}
+
+Args is_ephemeron_broken(Args args) {
+  return {create_node(Boolean(
+      get_ephemeron(args, "ephemeron-broken?").is_broken()))};
+}
+
+Args ephemeron_key(Args args) {
+  Ephemeron& e = get_ephemeron(args, "ephemeron-key");
+  return {e.is_broken() ? create_node(Boolean(false)) : e.get_key()};
+}
+
+Args ephemeron_datum(Args args) {
+  Ephemeron& e = get_ephemeron(args, "ephemeron-datum");
+  return {e.is_broken() ? create_node(Boolean(false)) : e.get_datum()};
+}
+
+Args reference_barrier(Args args) {
+  check_arguments(args, 1, "reference-barrier");
+  return {core::create_unspecified_node()};
+}
+
+} // namespace impl
+
+Callable make_ephemeron = impl::make_ephemeron;
+Callable is_ephemeron = impl::is_ephemeron;
+Callable is_ephemeron_broken = impl::is_ephemeron_broken;
+Callable ephemeron_key = impl::ephemeron_key;
+Callable ephemeron_datum = impl::ephemeron_datum;
+Callable reference_barrier = impl::reference_barrier;
+
+} // namespace stdproc
+} // namespace shaka
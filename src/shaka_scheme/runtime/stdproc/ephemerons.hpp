@@ -0,0 +1,71 @@
+#ifndef SHAKA_SCHEME_STDPROC_EPHEMERONS_HPP
+#define SHAKA_SCHEME_STDPROC_EPHEMERONS_HPP
+
+#include "shaka_scheme/system/base/Data.hpp"
+#include "shaka_scheme/system/exceptions/TypeException.hpp"
+#include "shaka_scheme/system/exceptions/InvalidInputException.hpp"
+
+#include <functional>
+#include <deque>
+
+namespace shaka {
+namespace stdproc {
+
+using Args = std::deque<NodePtr>;
+using Callable = std::function<std::deque<NodePtr>(std::deque<NodePtr>)>;
+
+/**
+ * @note The ephemeron procedures of SRFI 124.
+ */
+namespace impl {
+
+/**
+ * @brief Implementation of (make-ephemeron key datum)
+ * @return An ephemeron that keeps datum alive for as long as key is
+ * reachable from outside of it
+ */
+Args make_ephemeron(Args args);
+
+/**
+ * @brief Implementation of (ephemeron? obj)
+ */
+Args is_ephemeron(Args args);
+
+/**
+ * @brief Implementation of (ephemeron-broken? ephemeron)
+ * @return #t once the collector has collected the key
+ */
+Args is_ephemeron_broken(Args args);
+
+/**
+ * @brief Implementation of (ephemeron-key ephemeron)
+ * @return The key, or #f if the ephemeron is broken
+ */
+Args ephemeron_key(Args args);
+
+/**
+ * @brief Implementation of (ephemeron-datum ephemeron)
+ * @return The datum, or #f if the ephemeron is broken
+ */
+Args ephemeron_datum(Args args);
+
+/**
+ * @brief Implementation of (reference-barrier key)
+ * @return An unspecified value. Holding key as an argument keeps it
+ * reachable up to this call.
+ */
+Args reference_barrier(Args args);
+
+} // namespace impl
+
+extern Callable make_ephemeron;
+extern Callable is_ephemeron;
+extern Callable is_ephemeron_broken;
+extern Callable ephemeron_key;
+extern Callable ephemeron_datum;
+extern Callable reference_barrier;
+
+} // namespace stdproc
+} // namespace shaka
+
+#endif //SHAKA_SCHEME_STDPROC_EPHEMERONS_HPP
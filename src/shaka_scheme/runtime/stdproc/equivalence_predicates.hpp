@@ -46,7 +46,7 @@ Args is_eq(Args args);
  * @brief Implementation of equal an Equivalence Predicate
  * @param args List of arguments from a Shaka Scheme function call to equal?
  * @return Returns if the two items passed are equivalent to each other. Will
- * recursively compare two lists together for equivalence
+ * compare lists, vectors and bytevectors by content; see core::equal
  */
 Args is_equal(Args args);
 
@@ -0,0 +1,202 @@
+#include "shaka_scheme/runtime/stdproc/hash_tables.hpp"
+#include "shaka_scheme/runtime/stdproc/equivalence_predicates.hpp"
+#include "shaka_scheme/system/core/lists.hpp"
+#include "shaka_scheme/system/core/types.hpp"
+
+#include <climits>
+
+namespace shaka {
+namespace stdproc {
+
+namespace {
+
+using Predicate = Args (*)(Args);
+
+void check_arguments(const Args& args, std::size_t min, std::size_t max,
+                     const std::string& name) {
+  if (args.size() < min || args.size() > max) {
+    throw InvalidInputException(10050,
+                                name + ": invalid number of arguments");
+  }
+}
+
+HashTable& get_table(const Args& args, const std::string& name) {
+  if (args[0]->get_type() != Data::Type::HASH_TABLE) {
+    throw TypeException(10051, name + ": expected a hash table");
+  }
+  return args[0]->get<HashTable>();
+}
+
+/**
+ * @brief Finds which of eq?, eqv? or equal? a procedure is.
+ */
+HashTable::Equivalence get_equivalence(NodePtr proc,
+                                       const std::string& name) {
+  if (proc->get_type() == Data::Type::CLOSURE &&
+      proc->get<Closure>().is_native_closure()) {
+    const Predicate* target =
+        proc->get<Closure>().get_callable()->target<Predicate>();
+    if (target != nullptr && *target == impl::is_eq) {
+      return HashTable::Equivalence::EQ;
+    }
+    if (target != nullptr && *target == impl::is_eqv) {
+      return HashTable::Equivalence::EQV;
+    }
+    if (target != nullptr && *target == impl::is_equal) {
+      return HashTable::Equivalence::EQUAL;
+    }
+  }
+  throw TypeException(10052, name + ": expected eq?, eqv? or equal?");
+}
+
+/**
+ * @brief Reduces a hash to a non-negative integer below an optional bound.
+ */
+Args bounded_hash(Args args, HashTable::Equivalence equivalence,
+                  const std::string& name) {
+  check_arguments(args, 1, 2, name);
+  std::size_t result = HashTable::hash(args[0], equivalence) % INT_MAX;
+  if (args.size() == 2) {
+    if (args[1]->get_type() != Data::Type::NUMBER ||
+        args[1]->get<Number>().get_type() != Number::NumberType::INTEGER ||
+        args[1]->get<Number>().get<Integer>().get_value() <= 0) {
+      throw TypeException(10053, name + ": expected a positive bound");
+    }
+    result %= args[1]->get<Number>().get<Integer>().get_value();
+  }
+  return {create_node(Number(static_cast<int>(result)))};
+}
+
+} // namespace
+
+namespace impl {
+
+Args make_hash_table(Args args) {
+  check_arguments(args, 0, 1, "make-hash-table");
+  HashTable::Equivalence equivalence = args.empty() ?
+      HashTable::Equivalence::EQUAL :
+      get_equivalence(args[0], "make-hash-table");
+  return {create_node(HashTable(equivalence))};
+}
+
+Args make_weak_hash_table(Args args) {
+  check_arguments(args, 0, 1, "make-weak-hash-table");
+  HashTable::Equivalence equivalence = args.empty() ?
+      HashTable::Equivalence::EQUAL :
+      get_equivalence(args[0], "make-weak-hash-table");
+  return {create_node(HashTable(equivalence, 0, true))};
+}
+
+Args is_hash_table_weak(Args args) {
+  check_arguments(args, 1, 1, "hash-table-weak?");
+  return {create_node(Boolean(
+      get_table(args, "hash-table-weak?").is_weak()))};
+}
+
+Args is_hash_table(Args args) {
+  check_arguments(args, 1, 1, "hash-table?");
+  return {create_node(Boolean(
+      args[0]->get_type() == Data::Type::HASH_TABLE))};
+}
+
+Args hash_table_ref(Args args) {
+  check_arguments(args, 2, 2, "hash-table-ref");
+  NodePtr value = get_table(args, "hash-table-ref").get(args[1]);
+  if (!value) {
+    throw InvalidInputException(10054, "hash-table-ref: key not found");
+  }
+  return {value};
+}
+
+Args hash_table_ref_default(Args args) {
+  check_arguments(args, 3, 3, "hash-table-ref/default");
+  NodePtr value = get_table(args, "hash-table-ref/default").get(args[1]);
+  return {value ? value : args[2]};
+}
+
+Args hash_table_set(Args args) {
+  check_arguments(args, 3, 3, "hash-table-set!");
+  get_table(args, "hash-table-set!").set(args[1], args[2]);
+  return {core::create_unspecified_node()};
+}
+
+Args hash_table_delete(Args args) {
+  check_arguments(args, 2, 2, "hash-table-delete!");
+  get_table(args, "hash-table-delete!").remove(args[1]);
+  return {core::create_unspecified_node()};
+}
+
+Args hash_table_contains(Args args) {
+  check_arguments(args, 2, 2, "hash-table-contains?");
+  return {create_node(Boolean(
+      get_table(args, "hash-table-contains?").contains(args[1])))};
+}
+
+Args hash_table_size(Args args) {
+  check_arguments(args, 1, 1, "hash-table-size");
+  return {create_node(Number(static_cast<int>(
+      get_table(args, "hash-table-size").size())))};
+}
+
+Args hash_table_keys(Args args) {
+  check_arguments(args, 1, 1, "hash-table-keys");
+  NodePtr result = core::list();
+  for (const auto& entry : get_table(args, "hash-table-keys").entries()) {
+    result = core::cons(entry.first, result);
+  }
+  return {result};
+}
+
+Args hash_table_values(Args args) {
+  check_arguments(args, 1, 1, "hash-table-values");
+  NodePtr result = core::list();
+  for (const auto& entry : get_table(args, "hash-table-values").entries()) {
+    result = core::cons(entry.second, result);
+  }
+  return {result};
+}
+
+Args hash_table_to_alist(Args args) {
+  check_arguments(args, 1, 1, "hash-table->alist");
+  NodePtr result = core::list();
+  for (const auto& entry : get_table(args, "hash-table->alist").entries()) {
+    result = core::cons(core::cons(entry.first, entry.second), result);
+  }
+  return {result};
+}
+
+Args hash_table_clear(Args args) {
+  check_arguments(args, 1, 1, "hash-table-clear!");
+  get_table(args, "hash-table-clear!").clear();
+  return {core::create_unspecified_node()};
+}
+
+Args hash(Args args) {
+  return bounded_hash(args, HashTable::Equivalence::EQUAL, "hash");
+}
+
+Args hash_by_identity(Args args) {
+  return bounded_hash(args, HashTable::Equivalence::EQ, "hash-by-identity");
+}
+
+} // namespace impl
+
+Callable make_hash_table = impl::make_hash_table;
+Callable make_weak_hash_table = impl::make_weak_hash_table;
+Callable is_hash_table_weak = impl::is_hash_table_weak;
+Callable is_hash_table = impl::is_hash_table;
+Callable hash_table_ref = impl::hash_table_ref;
+Callable hash_table_ref_default = impl::hash_table_ref_default;
+Callable hash_table_set = impl::hash_table_set;
+Callable hash_table_delete = impl::hash_table_delete;
+Callable hash_table_contains = impl::hash_table_contains;
+Callable hash_table_size = impl::hash_table_size;
+Callable hash_table_keys = impl::hash_table_keys;
+Callable hash_table_values = impl::hash_table_values;
+Callable hash_table_to_alist = impl::hash_table_to_alist;
+Callable hash_table_clear = impl::hash_table_clear;
+Callable hash = impl::hash;
+Callable hash_by_identity = impl::hash_by_identity;
+
+} // namespace stdproc
+} // namespace shaka
@@ -0,0 +1,142 @@
+#ifndef SHAKA_SCHEME_STDPROC_HASH_TABLES_HPP
+#define SHAKA_SCHEME_STDPROC_HASH_TABLES_HPP
+
+#include "shaka_scheme/system/base/Data.hpp"
+#include "shaka_scheme/system/exceptions/TypeException.hpp"
+#include "shaka_scheme/system/exceptions/InvalidInputException.hpp"
+
+#include <functional>
+#include <deque>
+
+namespace shaka {
+namespace stdproc {
+
+using Args = std::deque<NodePtr>;
+using Callable = std::function<std::deque<NodePtr>(std::deque<NodePtr>)>;
+
+/**
+ * @note The hash table procedures follow SRFI 69, with the SRFI 125 names
+ * where SRFI 69 has none. A table compares its keys with eq?, eqv? or
+ * equal?; see shaka::HashTable for how keys are hashed.
+ */
+namespace impl {
+
+/**
+ * @brief Implementation of (make-hash-table [equiv])
+ * @param args Optionally, one of the procedures eq?, eqv? or equal?
+ * @return A new empty hash table comparing keys with equiv, which defaults
+ * to equal?
+ */
+Args make_hash_table(Args args);
+
+/**
+ * @brief Implementation of (make-weak-hash-table [equiv])
+ * @param args Optionally, one of the procedures eq?, eqv? or equal?
+ * @return A new empty hash table that holds its keys weakly. Once a key is
+ * only reachable through the table, the collector removes its entry.
+ */
+Args make_weak_hash_table(Args args);
+
+/**
+ * @brief Implementation of (hash-table-weak? table)
+ */
+Args is_hash_table_weak(Args args);
+
+/**
+ * @brief Implementation of (hash-table? obj)
+ */
+Args is_hash_table(Args args);
+
+/**
+ * @brief Implementation of (hash-table-ref table key)
+ * @return The value of key
+ * @throws InvalidInputException if key is not in table
+ */
+Args hash_table_ref(Args args);
+
+/**
+ * @brief Implementation of (hash-table-ref/default table key default)
+ * @return The value of key, or default if key is not in table
+ */
+Args hash_table_ref_default(Args args);
+
+/**
+ * @brief Implementation of (hash-table-set! table key value)
+ */
+Args hash_table_set(Args args);
+
+/**
+ * @brief Implementation of (hash-table-delete! table key)
+ */
+Args hash_table_delete(Args args);
+
+/**
+ * @brief Implementation of (hash-table-contains? table key)
+ */
+Args hash_table_contains(Args args);
+
+/**
+ * @brief Implementation of (hash-table-size table)
+ */
+Args hash_table_size(Args args);
+
+/**
+ * @brief Implementation of (hash-table-keys table)
+ * @return A list of the keys, in no particular order
+ */
+Args hash_table_keys(Args args);
+
+/**
+ * @brief Implementation of (hash-table-values table)
+ * @return A list of the values, in no particular order
+ */
+Args hash_table_values(Args args);
+
+/**
+ * @brief Implementation of (hash-table->alist table)
+ * @return A list of (key . value) pairs, in no particular order
+ */
+Args hash_table_to_alist(Args args);
+
+/**
+ * @brief Implementation of (hash-table-clear! table)
+ */
+Args hash_table_clear(Args args);
+
+/**
+ * @brief Implementation of (hash obj [bound])
+ * @return A non-negative integer below bound such that equal? objects hash
+ * alike
+ */
+Args hash(Args args);
+
+/**
+ * @brief Implementation of (hash-by-identity obj [bound])
+ * @return A non-negative integer below bound such that eq? objects hash
+ * alike
+ */
+Args hash_by_identity(Args args);
+
+} // namespace impl
+
+extern Callable make_hash_table;
+extern Callable make_weak_hash_table;
+extern Callable is_hash_table_weak;
+extern Callable is_hash_table;
+extern Callable hash_table_ref;
+extern Callable hash_table_ref_default;
+extern Callable hash_table_set;
+extern Callable hash_table_delete;
+extern Callable hash_table_contains;
+extern Callable hash_table_size;
+extern Callable hash_table_keys;
+extern Callable hash_table_values;
+extern Callable hash_table_to_alist;
+extern Callable hash_table_clear;
+extern Callable hash;
+extern Callable hash_by_identity;
+
+} // namespace stdproc
+} // namespace shaka
+
+#endif //SHAKA_SCHEME_STDPROC_HASH_TABLES_HPP
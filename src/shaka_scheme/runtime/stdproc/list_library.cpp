@@ -0,0 +1,472 @@
+#include "shaka_scheme/runtime/stdproc/list_library.hpp"
+#include "shaka_scheme/system/core/lists.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace shaka {
+namespace stdproc {
+
+namespace {
+
+void check_arguments(const Args& args, std::size_t min,
+                     const std::string& name) {
+  if (args.size() < min) {
+    throw InvalidInputException(10060,
+                                name + ": invalid number of arguments");
+  }
+}
+
+void check_procedure(NodePtr proc, const std::string& name) {
+  if (proc->get_type() != Data::Type::CLOSURE) {
+    throw TypeException(10061, name + ": expected a procedure");
+  }
+}
+
+void check_list(NodePtr list, const std::string& name) {
+  if (!core::is_pair(list) && !core::is_null_list(list)) {
+    throw TypeException(10062, name + ": expected a list");
+  }
+}
+
+void check_lists(const Args& args, std::size_t first,
+                 const std::string& name) {
+  for (std::size_t n = first; n < args.size(); ++n) {
+    check_list(args[n], name);
+  }
+}
+
+bool is_true(NodePtr node) {
+  return node->get_type() != Data::Type::BOOLEAN ||
+      node->get<Boolean>() != Boolean(false);
+}
+
+NativeStep return_value(NodePtr value) {
+  NativeStep step;
+  step.value = value;
+  return step;
+}
+
+/**
+ * @brief The part of a stepping loop that hands results back to it: the
+ * stepping Closure and the code that applies it, both made once per loop.
+ */
+struct SteppingLoop {
+  /**
+   * @brief Asks the VM to apply proc to args, then to pass the result and
+   * state on to the loop. Everything else the loop needs to continue is in
+   * state, so that re-entering an application through a continuation
+   * continues from the state of that step.
+   */
+  NativeStep apply_then(NodePtr proc, ValueRib args, ValueRib state) const {
+    NativeStep step;
+    step.procedure = proc;
+    step.arguments = args;
+    step.resume = resume;
+    step.resume_expression = resume_expression;
+    step.state = state;
+    return step;
+  }
+
+  /**
+   * @brief Lists the nodes the loop holds on to between steps, which the
+   * collector marks through the stepping Closure.
+   */
+  ValueRib roots() const {
+    return ValueRib{resume, resume_expression};
+  }
+
+  NodePtr resume;
+  NodePtr resume_expression;
+};
+
+/**
+ * @brief Makes the stepping Closure that hands each result and its state
+ * to a loop, and starts the loop.
+ */
+template <typename Loop>
+NativeStep start(std::shared_ptr<Loop> loop, const Args& args) {
+  loop->resume = create_node(Closure(std::make_shared<SteppingCallable>(
+      [loop](Args args) {
+        return loop->receive(args);
+      }), true, std::make_shared<SteppingRoots>([loop]() {
+        return loop->roots();
+      })));
+  loop->resume_expression = make_resume_expression(loop->resume);
+  return loop->first(args);
+}
+
+/**
+ * @brief Moves the next element of every list into elements, and the rest
+ * of every list into rests.
+ * @return false if one of the lists has no more elements
+ */
+bool next_elements(Args::const_iterator begin, Args::const_iterator end,
+                   ValueRib& elements, ValueRib& rests) {
+  for (Args::const_iterator it = begin; it != end; ++it) {
+    if (!core::is_pair(*it)) {
+      return false;
+    }
+  }
+  for (Args::const_iterator it = begin; it != end; ++it) {
+    elements.push_back(core::car(*it));
+    rests.push_back(core::cdr(*it));
+  }
+  return true;
+}
+
+/**
+ * @brief map and for-each. The state is the rest of every list, then the
+ * results so far, last first.
+ */
+struct MapLoop : SteppingLoop {
+  MapLoop(const Args& args, bool collect) :
+      proc(args[0]),
+      collect(collect) {}
+
+  NativeStep first(const Args& args) {
+    return next(args.begin() + 1, args.end(), core::list());
+  }
+
+  NativeStep next(Args::const_iterator begin, Args::const_iterator end,
+                  NodePtr results) {
+    ValueRib elements;
+    ValueRib state;
+    if (!next_elements(begin, end, elements, state)) {
+      return return_value(collect ? core::reverse(results) :
+                          create_unspecified());
+    }
+    state.push_back(results);
+    return apply_then(proc, elements, state);
+  }
+
+  NativeStep receive(const Args& args) {
+    NodePtr results = args.back();
+    if (collect) {
+      results = core::cons(args[0], results);
+    }
+    return next(args.begin() + 1, args.end() - 1, results);
+  }
+
+  ValueRib roots() const {
+    ValueRib nodes = SteppingLoop::roots();
+    nodes.push_back(proc);
+    return nodes;
+  }
+
+  NodePtr proc;
+  bool collect;
+};
+
+/**
+ * @brief filter. The state is the rest of the list, starting with the
+ * element pred was applied to, then the elements kept so far, last first.
+ */
+struct FilterLoop : SteppingLoop {
+  FilterLoop(const Args& args) :
+      pred(args[0]) {}
+
+  NativeStep first(const Args& args) {
+    return next(args[1], core::list());
+  }
+
+  NativeStep next(NodePtr list, NodePtr results) {
+    if (!core::is_pair(list)) {
+      return return_value(core::reverse(results));
+    }
+    return apply_then(pred, ValueRib{core::car(list)},
+                      ValueRib{list, results});
+  }
+
+  NativeStep receive(const Args& args) {
+    NodePtr list = args[1];
+    NodePtr results = args[2];
+    if (is_true(args[0])) {
+      results = core::cons(core::car(list), results);
+    }
+    return next(core::cdr(list), results);
+  }
+
+  ValueRib roots() const {
+    ValueRib nodes = SteppingLoop::roots();
+    nodes.push_back(pred);
+    return nodes;
+  }
+
+  NodePtr pred;
+};
+
+/**
+ * @brief fold. The state is the rest of every list; the result is the new
+ * accumulated value.
+ */
+struct FoldLoop : SteppingLoop {
+  FoldLoop(const Args& args) :
+      kons(args[0]) {}
+
+  NativeStep first(const Args& args) {
+    return next(args.begin() + 2, args.end(), args[1]);
+  }
+
+  NativeStep next(Args::const_iterator begin, Args::const_iterator end,
+                  NodePtr acc) {
+    ValueRib elements;
+    ValueRib state;
+    if (!next_elements(begin, end, elements, state)) {
+      return return_value(acc);
+    }
+    elements.push_back(acc);
+    return apply_then(kons, elements, state);
+  }
+
+  NativeStep receive(const Args& args) {
+    return next(args.begin() + 1, args.end(), args[0]);
+  }
+
+  ValueRib roots() const {
+    ValueRib nodes = SteppingLoop::roots();
+    nodes.push_back(kons);
+    return nodes;
+  }
+
+  NodePtr kons;
+};
+
+/**
+ * @brief fold-right. The lists are first copied reversed, up to the length
+ * of the shortest one, and then folded from the left; the state is the
+ * rest of every reversed list.
+ */
+struct FoldRightLoop : SteppingLoop {
+  FoldRightLoop(const Args& args) :
+      kons(args[0]) {}
+
+  NativeStep first(const Args& args) {
+    std::size_t length = 0;
+    for (NodePtr it = args[2]; core::is_pair(it); it = core::cdr(it)) {
+      ++length;
+    }
+    for (std::size_t n = 3; n < args.size(); ++n) {
+      std::size_t list_length = 0;
+      for (NodePtr it = args[n]; core::is_pair(it) && list_length < length;
+           it = core::cdr(it)) {
+        ++list_length;
+      }
+      length = list_length;
+    }
+    ValueRib reversed;
+    for (std::size_t n = 2; n < args.size(); ++n) {
+      NodePtr list = core::list();
+      NodePtr it = args[n];
+      for (std::size_t i = 0; i < length; ++i, it = core::cdr(it)) {
+        list = core::cons(core::car(it), list);
+      }
+      reversed.push_back(list);
+    }
+    return next(reversed.begin(), reversed.end(), args[1]);
+  }
+
+  NativeStep next(Args::const_iterator begin, Args::const_iterator end,
+                  NodePtr acc) {
+    ValueRib elements;
+    ValueRib state;
+    if (!next_elements(begin, end, elements, state)) {
+      return return_value(acc);
+    }
+    elements.push_back(acc);
+    return apply_then(kons, elements, state);
+  }
+
+  NativeStep receive(const Args& args) {
+    return next(args.begin() + 1, args.end(), args[0]);
+  }
+
+  ValueRib roots() const {
+    ValueRib nodes = SteppingLoop::roots();
+    nodes.push_back(kons);
+    return nodes;
+  }
+
+  NodePtr kons;
+};
+
+/**
+ * @brief A bottom-up merge sort that stops at every comparison. Runs of
+ * width elements are merged from one buffer into the other, and the
+ * buffers trade places after every pass. Unlike the other loops, its
+ * buffers are not kept per step: re-entering a comparison through a
+ * continuation continues from the latest one.
+ */
+struct SortLoop : SteppingLoop {
+  SortLoop(const Args& args) :
+      less(args[0]),
+      seq(args[1]) {
+    if (seq->get_type() == Data::Type::VECTOR) {
+      Vector& vector = seq->get<Vector>();
+      for (std::size_t n = 0; n < vector.length(); ++n) {
+        from.push_back(vector[n]);
+      }
+    } else {
+      for (NodePtr it = seq; core::is_pair(it); it = core::cdr(it)) {
+        from.push_back(core::car(it));
+      }
+    }
+    to.resize(from.size());
+    width = 1;
+    lo = 0;
+    start_merge();
+  }
+
+  NativeStep first(const Args&) {
+    return next();
+  }
+
+  void start_merge() {
+    mid = std::min(lo + width, from.size());
+    hi = std::min(lo + 2 * width, from.size());
+    i = lo;
+    j = mid;
+    k = lo;
+  }
+
+  NativeStep next() {
+    while (width < from.size()) {
+      // Ask whether the next element of the right run goes first; on a
+      // tie the left one does, which keeps the sort stable
+      if (i < mid && j < hi) {
+        return apply_then(less, ValueRib{from[j], from[i]}, ValueRib());
+      }
+      while (i < mid) {
+        to[k++] = from[i++];
+      }
+      while (j < hi) {
+        to[k++] = from[j++];
+      }
+      lo = hi;
+      if (lo >= from.size()) {
+        std::swap(from, to);
+        width *= 2;
+        lo = 0;
+      }
+      start_merge();
+    }
+    return return_value(make_result());
+  }
+
+  NativeStep receive(const Args& args) {
+    if (is_true(args[0])) {
+      to[k++] = from[j++];
+    } else {
+      to[k++] = from[i++];
+    }
+    return next();
+  }
+
+  NodePtr make_result() {
+    if (seq->get_type() == Data::Type::VECTOR) {
+      NodePtr vector = create_node(Vector(from.size()));
+      for (std::size_t n = 0; n < from.size(); ++n) {
+        vector->get<Vector>()[n] = from[n];
+      }
+      return vector;
+    }
+    NodePtr result = core::list();
+    for (std::size_t n = from.size(); n > 0; --n) {
+      result = core::cons(from[n - 1], result);
+    }
+    return result;
+  }
+
+  ValueRib roots() const {
+    ValueRib nodes = SteppingLoop::roots();
+    nodes.push_back(less);
+    nodes.push_back(seq);
+    nodes.insert(nodes.end(), from.begin(), from.end());
+    nodes.insert(nodes.end(), to.begin(), to.end());
+    return nodes;
+  }
+
+  NodePtr less;
+  NodePtr seq;
+  std::vector<NodePtr> from;
+  std::vector<NodePtr> to;
+  std::size_t width;
+  std::size_t lo;
+  std::size_t mid;
+  std::size_t hi;
+  std::size_t i;
+  std::size_t j;
+  std::size_t k;
+};
+
+} // namespace
+
+namespace impl {
+
+//(map ...)
+NativeStep map(Args args) {
+  check_arguments(args, 2, "map");
+  check_procedure(args[0], "map");
+  check_lists(args, 1, "map");
+  return start(std::make_shared<MapLoop>(args, true), args);
+}
+
+//(for-each ...)
+NativeStep for_each(Args args) {
+  check_arguments(args, 2, "for-each");
+  check_procedure(args[0], "for-each");
+  check_lists(args, 1, "for-each");
+  return start(std::make_shared<MapLoop>(args, false), args);
+}
+
+//(filter ...)
+NativeStep filter(Args args) {
+  if (args.size() != 2) {
+    throw InvalidInputException(10060, "filter: invalid number of arguments");
+  }
+  check_procedure(args[0], "filter");
+  check_list(args[1], "filter");
+  return start(std::make_shared<FilterLoop>(args), args);
+}
+
+//(fold ...)
+NativeStep fold(Args args) {
+  check_arguments(args, 3, "fold");
+  check_procedure(args[0], "fold");
+  check_lists(args, 2, "fold");
+  return start(std::make_shared<FoldLoop>(args), args);
+}
+
+//(fold-right ...)
+NativeStep fold_right(Args args) {
+  check_arguments(args, 3, "fold-right");
+  check_procedure(args[0], "fold-right");
+  check_lists(args, 2, "fold-right");
+  return start(std::make_shared<FoldRightLoop>(args), args);
+}
+
+//(sort ...)
+NativeStep sort(Args args) {
+  if (args.size() != 2) {
+    throw InvalidInputException(10060, "sort: invalid number of arguments");
+  }
+  check_procedure(args[0], "sort");
+  if (args[1]->get_type() != Data::Type::VECTOR &&
+      !core::is_proper_list(args[1])) {
+    throw TypeException(10062, "sort: expected a list or a vector");
+  }
+  return start(std::make_shared<SortLoop>(args), args);
+}
+
+} // namespace impl
+
+SteppingCallable map = impl::map;
+SteppingCallable for_each = impl::for_each;
+SteppingCallable filter = impl::filter;
+SteppingCallable fold = impl::fold;
+SteppingCallable fold_right = impl::fold_right;
+SteppingCallable sort = impl::sort;
+
+} // namespace stdproc
+} // namespace shaka
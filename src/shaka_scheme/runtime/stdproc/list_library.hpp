@@ -0,0 +1,94 @@
+#ifndef SHAKA_SCHEME_STDPROC_LIST_LIBRARY_HPP
+#define SHAKA_SCHEME_STDPROC_LIST_LIBRARY_HPP
+
+#include "shaka_scheme/system/base/Data.hpp"
+#include "shaka_scheme/system/exceptions/TypeException.hpp"
+#include "shaka_scheme/system/exceptions/InvalidInputException.hpp"
+
+#include <functional>
+#include <deque>
+
+namespace shaka {
+namespace stdproc {
+
+using Args = std::deque<NodePtr>;
+
+/**
+ * @note The higher-order list procedures are stepping native procedures:
+ * bind them with Closure(std::make_shared<SteppingCallable>(...), true).
+ * Every application of the procedure argument runs on the
+ * HeapVirtualMachine that applied the list procedure, under a CallFrame
+ * that returns into the list procedure, so no VM or dispatch loop is
+ * started per element. Native procedure arguments are called directly.
+ *
+ * The procedures walk their lists once, from left to right. What they need
+ * to continue is kept in the CallFrame of each application, never changed
+ * in place, so an application that is re-entered through a continuation
+ * continues from where it was, and lists that were already returned are
+ * left alone.
+ */
+namespace impl {
+
+/**
+ * @brief Implementation of (map proc list1 list2 ...)
+ * @param args A procedure taking one argument per list, and the lists
+ * @return The list of the results of applying proc to the first elements
+ * of the lists, then to the second elements, and so on, up to the end of
+ * the shortest list
+ */
+NativeStep map(Args args);
+
+/**
+ * @brief Implementation of (for-each proc list1 list2 ...)
+ * @param args A procedure taking one argument per list, and the lists
+ * @return An unspecified value once proc was applied like in map
+ */
+NativeStep for_each(Args args);
+
+/**
+ * @brief Implementation of (filter pred list)
+ * @param args A predicate of one argument and a list
+ * @return A fresh list of the elements of list that satisfy pred, in order
+ */
+NativeStep filter(Args args);
+
+/**
+ * @brief Implementation of (fold kons knil list1 list2 ...), as in SRFI 1
+ * @param args A procedure, an initial value and the lists
+ * @return knil if the shortest list is empty, else the fold of the rest of
+ * the lists with (kons e1 e2 ... knil) as the initial value
+ */
+NativeStep fold(Args args);
+
+/**
+ * @brief Implementation of (fold-right kons knil list1 list2 ...), as in
+ * SRFI 1
+ * @param args A procedure, an initial value and the lists
+ * @return (kons e1 (kons e2 ... (kons en knil))) with one list, where ei
+ * are the elements up to the end of the shortest list; with several, kons
+ * is applied to the ith element of every list, then the folded value
+ */
+NativeStep fold_right(Args args);
+
+/**
+ * @brief Implementation of (sort less? seq)
+ * @param args A procedure of two arguments and a list or vector
+ * @return A fresh list or vector, matching seq, with the elements of seq
+ * in order. The sort is a stable bottom-up merge sort, applying less? at
+ * most n log n times and allocating no Data between applications.
+ */
+NativeStep sort(Args args);
+
+} // namespace impl
+
+extern SteppingCallable map;
+extern SteppingCallable for_each;
+extern SteppingCallable filter;
+extern SteppingCallable fold;
+extern SteppingCallable fold_right;
+extern SteppingCallable sort;
+
+} // namespace stdproc
+} // namespace shaka
+
+#endif //SHAKA_SCHEME_STDPROC_LIST_LIBRARY_HPP
@@ -7,12 +7,15 @@
 
 #include "shaka_scheme/system/base/Number.hpp"
 #include "shaka_scheme/system/base/Data.hpp"
+#include "shaka_scheme/system/gc/make_node.hpp"
 #include "shaka_scheme/system/exceptions/TypeException.hpp"
 
 #include <cmath>
 #include <functional>
 #include <typeinfo>
 #include <deque>
+#include <iostream>
+#include <sstream>
 
 namespace shaka {
 namespace stdproc {
@@ -23,8 +26,16 @@ using Args = std::deque<NodePtr>;
 using Callable = std::function<std::deque<NodePtr>(std::deque<NodePtr>)>;
 namespace impl {
 
+// (display obj [port])
 Args display(Args args) {
-  std::cout << *args[0] << std::endl;
+  // Ends the line without flushing, so that output is written out in blocks
+  if (args.size() >= 2 && args[1]->get_type() == Data::Type::PORT) {
+    std::ostringstream text;
+    text << *args[0] << '\n';
+    args[1]->get<Port>().write(text.str());
+  } else {
+    std::cout << *args[0] << '\n';
+  }
   return Args{create_unspecified()};
 }
 
@@ -44,7 +55,7 @@ Args add_numbers(Args args) {
   }
 
   Args result_vector;
-  NodePtr result_value = create_node(result);
+  NodePtr result_value = make_number(result);
   result_vector.push_back(result_value);
 
   return result_vector;
@@ -67,7 +78,7 @@ Args mul_numbers(Args args) {
   }
 
   Args result_vector;
-  NodePtr result_value = create_node(Data(result));
+  NodePtr result_value = make_number(result);
   result_vector.push_back(result_value);
 
   return result_vector;
@@ -88,7 +99,7 @@ Args neg_numbers(Args args) {
   result = result - args[0]->get<shaka::Number>();
 
   Args result_vector;
-  NodePtr result_value = create_node(Data(result));
+  NodePtr result_value = make_number(result);
   result_vector.push_back(result_value);
 
   return result_vector;
@@ -116,7 +127,7 @@ Args sub_numbers(Args args) {
   }
 
   Args result_vector;
-  NodePtr result_value = create_node(Data(result));
+  NodePtr result_value = make_number(result);
   result_vector.push_back(result_value);
 
   return result_vector;
@@ -136,7 +147,7 @@ Args reciprocal_numbers(Args args) {
   shaka::Number result = shaka::Number(1);
   result = result / args[0]->get<shaka::Number>();
   Args result_vector;
-  NodePtr result_value = create_node(Data(result));
+  NodePtr result_value = make_number(result);
   result_vector.push_back(result_value);
 
   return result_vector;
@@ -159,7 +170,7 @@ Args div_numbers(Args args) {
     result = result / args[i]->get<shaka::Number>();
   }
 
-  NodePtr result_value = create_node(Data(result));
+  NodePtr result_value = make_number(result);
   Args result_vector = {result_value};
 
   return result_vector;
@@ -190,7 +201,7 @@ Args abs_numbers(Args args) {
     result = input;
   }
 
-  NodePtr result_value = create_node(Data(result));
+  NodePtr result_value = make_number(result);
 
 
   Args result_vector = {result_value};
@@ -231,8 +242,8 @@ Args floor_div_numbers(Args args) {
     q = (n1 - r) / n2;
   }
 
-  NodePtr v1 = create_node(Data(q));
-  NodePtr v2 = create_node(Data(r));
+  NodePtr v1 = make_number(q);
+  NodePtr v2 = make_number(r);
 
   Args result_vector = {v1, v2};
 
@@ -272,7 +283,7 @@ Args floor_quotient_numbers(Args args) {
     q = (n1 - r) / n2;
   }
 
-  NodePtr v1 = create_node(Data(q));
+  NodePtr v1 = make_number(q);
 
   Args result_vector = {v1};
 
@@ -307,7 +318,7 @@ Args floor_remainder_numbers(Args args) {
     r = n1 % n2 * shaka::Number(-1);
   }
 
-  NodePtr v1 = create_node(Data(r));
+  NodePtr v1 = make_number(r);
 
   Args result_vector = {v1};
 
@@ -329,8 +340,8 @@ Args truncate_div_numbers(Args args) {
   r = n1 % n2;
   q = (n1 - r) / n2;
 
-  NodePtr v1 = create_node(Data(q));
-  NodePtr v2 = create_node(Data(r));
+  NodePtr v1 = make_number(q);
+  NodePtr v2 = make_number(r);
 
   Args result_vector = {v1, v2};
 
@@ -348,7 +359,7 @@ Args truncate_quotient_numbers(Args args) {
   shaka::Number r = n1 % n2;
   shaka::Number q = (n1 - r) / n2;
 
-  NodePtr v = create_node(Data(q));
+  NodePtr v = make_number(q);
 
   Args result_vector = {v};
 
@@ -364,7 +375,7 @@ Args truncate_remainder_numbers(Args args) {
 
   shaka::Number r = n1 % n2;
 
-  NodePtr v = create_node(Data(r));
+  NodePtr v = make_number(r);
 
   Args result_vector = {v};
 
@@ -381,7 +392,7 @@ Args quotient_numbers(Args args) {
   shaka::Number r = n1 % n2;
   shaka::Number q = (n1 - r) / n2;
 
-  NodePtr v = create_node(Data(q));
+  NodePtr v = make_number(q);
 
   Args result_vector = {v};
 
@@ -397,7 +408,7 @@ Args remainder_numbers(Args args) {
 
   shaka::Number r = n1 % n2;
 
-  NodePtr v = create_node(Data(r));
+  NodePtr v = make_number(r);
 
   Args result_vector = {v};
 
@@ -424,7 +435,7 @@ Args modulo_numbers(Args args) {
     r = n1 % n2 * shaka::Number(-1);
   }
 
-  NodePtr v1 = create_node(Data(r));
+  NodePtr v1 = make_number(r);
 
   Args result_vector = {v1};
 
@@ -451,7 +462,7 @@ Args gcd_numbers(Args args) {
     result = gcd_pair(result, next);
   }
 
-  NodePtr result_value = create_node(Data(result));
+  NodePtr result_value = make_number(result);
 
   Args result_vector = {result_value};
 
@@ -473,7 +484,7 @@ Args lcm_numbers(Args args) {
     result = (result*next)|gcd;
   }
 
-  NodePtr result_value = create_node(Data(result));
+  NodePtr result_value = make_number(result);
 
   Args result_vector = {result_value};
 
@@ -489,7 +500,7 @@ Args numerator_numbers(Args args) {
 
   shaka::Number result(n1.get<Rational>().get_numerator());
 
-  NodePtr result_value = create_node(Data(result));
+  NodePtr result_value = make_number(result);
 
   Args result_vector = {result_value};
 
@@ -505,7 +516,7 @@ Args denominator_numbers(Args args) {
 
   shaka::Number result(n1.get<Rational>().get_denominator());
 
-  NodePtr result_value = create_node(Data(result));
+  NodePtr result_value = make_number(result);
 
   Args result_vector = {result_value};
 
@@ -519,13 +530,13 @@ Args floor_numbers(Args args) {
   shaka::Number n1 = args[0]->get<shaka::Number>();
   if (n1.get_type() == Number::NumberType::REAL) {
     shaka::Number result(floor(n1.get<Real>().get_value()));
-    NodePtr result_value = create_node(Data(result));
+    NodePtr result_value = make_number(result);
     Args result_vector = {result_value};
     return result_vector;
   }
   else if (n1.get_type() == Number::NumberType::INTEGER) {
     shaka::Number result(floor(n1.get<Integer>().get_value()));
-    NodePtr result_value = create_node(Data(result));
+    NodePtr result_value = make_number(result);
     Args result_vector = {result_value};
     return result_vector;
   }
@@ -534,7 +545,7 @@ Args floor_numbers(Args args) {
     int denominator = n1.get<Rational>().get_denominator();
 
     shaka::Number result(floor((double) numerator / (double) denominator));
-    NodePtr result_value = create_node(Data(result));
+    NodePtr result_value = make_number(result);
     Args result_vector = {result_value};
     return result_vector;
   }
@@ -546,13 +557,13 @@ Args ceiling_numbers(Args args) {
   shaka::Number n1 = args[0]->get<shaka::Number>();
   if (n1.get_type() == Number::NumberType::REAL) {
     shaka::Number result(ceil(n1.get<Real>().get_value()));
-    NodePtr result_value = create_node(Data(result));
+    NodePtr result_value = make_number(result);
     Args result_vector = {result_value};
     return result_vector;
   }
   else if (n1.get_type() == Number::NumberType::INTEGER) {
     shaka::Number result(ceil(n1.get<Integer>().get_value()));
-    NodePtr result_value = create_node(Data(result));
+    NodePtr result_value = make_number(result);
     Args result_vector = {result_value};
     return result_vector;
   }
@@ -561,7 +572,7 @@ Args ceiling_numbers(Args args) {
     int denominator = n1.get<Rational>().get_denominator();
 
     shaka::Number result(ceil((double) numerator / (double) denominator));
-    NodePtr result_value = create_node(Data(result));
+    NodePtr result_value = make_number(result);
     Args result_vector = {result_value};
     return result_vector;
   }
@@ -573,13 +584,13 @@ Args truncate_numbers(Args args) {
   shaka::Number n1 = args[0]->get<shaka::Number>();
   if (n1.get_type() == Number::NumberType::REAL) {
     shaka::Number result(trunc(n1.get<Real>().get_value()));
-    NodePtr result_value = create_node(Data(result));
+    NodePtr result_value = make_number(result);
     Args result_vector = {result_value};
     return result_vector;
   }
   else if (n1.get_type() == Number::NumberType::INTEGER) {
     shaka::Number result(trunc(n1.get<Integer>().get_value()));
-    NodePtr result_value = create_node(Data(result));
+    NodePtr result_value = make_number(result);
     Args result_vector = {result_value};
     return result_vector;
   }
@@ -588,7 +599,7 @@ Args truncate_numbers(Args args) {
     int denominator = n1.get<Rational>().get_denominator();
 
     shaka::Number result(trunc((double) numerator / (double) denominator));
-    NodePtr result_value = create_node(Data(result));
+    NodePtr result_value = make_number(result);
     Args result_vector = {result_value};
     return result_vector;
   }
@@ -601,13 +612,13 @@ Args round_numbers(Args args) {
 
   if (n1.get_type() == Number::NumberType::REAL) {
     shaka::Number result(round(n1.get<Real>().get_value()));
-    NodePtr result_value = create_node(Data(result));
+    NodePtr result_value = make_number(result);
     Args result_vector = {result_value};
     return result_vector;
   }
   else if (n1.get_type() == Number::NumberType::INTEGER) {
     shaka::Number result(round(n1.get<Integer>().get_value()));
-    NodePtr result_value = create_node(Data(result));
+    NodePtr result_value = make_number(result);
     Args result_vector = {result_value};
     return result_vector;
   }
@@ -615,7 +626,7 @@ Args round_numbers(Args args) {
     int numerator = n1.get<Rational>().get_numerator();
     int denominator = n1.get<Rational>().get_denominator();
     shaka::Number result(round((double) numerator / (double) denominator));
-    NodePtr result_value = create_node(Data(result));
+    NodePtr result_value = make_number(result);
     Args result_vector = {result_value};
     return result_vector;
   }
@@ -633,7 +644,7 @@ Args exp_numbers(Args args) {
     shaka::Number truncated_result(
         trunc(
             result.get<Real>().get_value() * 100000000000) / 100000000000);
-    NodePtr result_value = create_node(Data(truncated_result));
+    NodePtr result_value = make_number(truncated_result);
     Args result_vector = {result_value};
     return result_vector;
   }
@@ -642,7 +653,7 @@ Args exp_numbers(Args args) {
     shaka::Number truncated_result(
         trunc(
             result.get<Real>().get_value() * 100000000000) / 100000000000);
-    NodePtr result_value = create_node(Data(truncated_result));
+    NodePtr result_value = make_number(truncated_result);
     Args result_vector = {result_value};
     return result_vector;
   }
@@ -653,7 +664,7 @@ Args exp_numbers(Args args) {
     shaka::Number truncated_result(
         trunc(
             result.get<Real>().get_value() * 100000000000) / 100000000000);
-    NodePtr result_value = create_node(Data(truncated_result));
+    NodePtr result_value = make_number(truncated_result);
     Args result_vector = {result_value};
     return result_vector;
   }
@@ -671,7 +682,7 @@ Args log_numbers(Args args) {
     shaka::Number truncated_result(
         trunc(
             result.get<Real>().get_value() * 100000000000) / 100000000000);
-    NodePtr result_value = create_node(Data(truncated_result));
+    NodePtr result_value = make_number(truncated_result);
     Args result_vector = {result_value};
     return result_vector;
   }
@@ -680,7 +691,7 @@ Args log_numbers(Args args) {
     shaka::Number truncated_result(
         trunc(
             result.get<Real>().get_value() * 100000000000) / 100000000000);
-    NodePtr result_value = create_node(Data(truncated_result));
+    NodePtr result_value = make_number(truncated_result);
     Args result_vector = {result_value};
     return result_vector;
   }
@@ -691,7 +702,7 @@ Args log_numbers(Args args) {
     shaka::Number truncated_result(
         trunc(
             result.get<Real>().get_value() * 100000000000) / 100000000000);
-    NodePtr result_value = create_node(Data(truncated_result));
+    NodePtr result_value = make_number(truncated_result);
     Args result_vector = {result_value};
     return result_vector;
   }
@@ -717,7 +728,7 @@ Args log_n_numbers(Args args) {
       trunc(
           result.get<Real>().get_value() * 100000000000) / 100000000000);
 
-  NodePtr result_value = create_node(Data(truncated_result));
+  NodePtr result_value = make_number(truncated_result);
   Args result_vector = {result_value};
   return result_vector;
 
@@ -754,7 +765,7 @@ Args sqrt_numbers(Args args) {
   inter = std::sqrt(inter);
 
   // Rewrap it in a NodePtr
-  return {create_node(Data(shaka::Number(inter)))};
+  return {make_number(inter)};
 }
 
 } // namespace impl
@@ -27,9 +27,7 @@ Args cons(Args args) {
                                 "cons: Invalid number of arguments for "
                                     "procedure");
   }
-  return {create_node(Data(DataPair(Data(*args[0]),
-                               Data(*args[1]))))
-  };
+  return {core::cons(args[0], args[1])};
 }
 
 //(car ...)
@@ -46,7 +44,7 @@ Args car(Args args) {
                                     "an empty list");
   }
 
-  return {create_node(*args[0]->get<DataPair>().car())};
+  return {args[0]->get<DataPair>().car()};
 }
 
 //(cdr ...)
@@ -63,7 +61,7 @@ Args cdr(Args args) {
                                     "an empty list");
   }
 
-  return {create_node(*args[0]->get<DataPair>().cdr())};
+  return {args[0]->get<DataPair>().cdr()};
 }
 
 //(set-car! ...)
@@ -205,10 +203,8 @@ Args length(Args args) {
                                 "length:Type of given argument is "
                                     "not DATA_PAIR");
   }
-  // Create a variable set to the head of the given list
-  NodePtr head = create_node(*args[0]);
   // Call (length) on list
-  std::size_t length = core::length(head);
+  std::size_t length = core::length(args[0]);
   // Create a variable of type Args to hold the length of the list
   Args result{create_node(Number(Integer(length)))};
   // Return the Args variable
@@ -231,13 +227,13 @@ Args append(Args args) {
   }
   // Else
   else {
-    // Set list to the list provided
-    list = args[0];
-    // For each item given in the argument
-    for (std::size_t i = 1; i < args.size(); i++) {
-      // Add the item as a data pair at the end of the list
-      list = core::append(list, core::list(args[i]));
+    // Gather the rest of the items into a list, from the back
+    NodePtr rest = core::list();
+    for (std::size_t i = args.size(); i > 1; i--) {
+      rest = core::cons(args[i - 1], rest);
     }
+    // Copy the given list once, with the items after it
+    list = core::append(args[0], rest);
   }
   Args result{list};
   // Return the new list
@@ -396,28 +392,22 @@ Args list_copy(Args args) {
     Args result {shaka::create_node(*args[0])};
     return result;
   }
-  // Create a variable at the head of the list and an Args list
+  // Copy the pairs in one pass, keeping a pointer to the last one. The
+  // elements themselves are shared with the original list.
   NodePtr head {args[0]};
-  Args list_args;
-
-  // While the cdr of the head is a DataPair
-  //  Push a copy of the car value of head onto the Args list
-  //  Set the new head to the cdr of the current head
-  while (head->get<DataPair>().cdr()->get_type() == Data::Type::DATA_PAIR) {
-    list_args.push_back(create_node(Data(*head->get<DataPair>().car())));
-    head = head->get<DataPair>().cdr();
-  }
-  // If the final cdr is a NullList (proper list)
-  //  Push a copy of the car value of head onto the Args list
-  if(head->get<DataPair>().cdr()->get_type() == Data::Type::NULL_LIST){
-    list_args.push_back(create_node(Data(*head->get<DataPair>().car())));
-  }
-  // Else push a copy of the head onto the Args list (improper list)
-  else {
-    list_args.push_back(create_node(Data(*head)));
-  }
-  // Return a list of the Args list
-  return {stdproc::list(list_args)};
+  NodePtr nil {core::list()};
+  NodePtr root {core::cons(core::car(head), nil)};
+  NodePtr tail {root};
+  head = core::cdr(head);
+  while (head->get_type() == Data::Type::DATA_PAIR) {
+    NodePtr next {core::cons(core::car(head), nil)};
+    core::set_cdr(tail, next);
+    tail = next;
+    head = core::cdr(head);
+  }
+  // The last cdr of an improper list is kept as is
+  core::set_cdr(tail, head);
+  return {root};
 }
 
 } // namespace impl
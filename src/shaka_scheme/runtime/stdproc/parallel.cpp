@@ -0,0 +1,322 @@
+#include "shaka_scheme/runtime/stdproc/parallel.hpp"
+#include "shaka_scheme/system/core/lists.hpp"
+#include "shaka_scheme/system/gc/GC.hpp"
+#include "shaka_scheme/system/gc/init_gc.hpp"
+#include "shaka_scheme/system/vm/HeapVirtualMachine.hpp"
+#include "shaka_scheme/system/vm/WorkStealingPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace shaka {
+namespace stdproc {
+
+namespace {
+
+/**
+ * @brief Applies a procedure on the calling thread in a HeapVirtualMachine
+ * of its own, running until the application returns.
+ */
+NodePtr apply_procedure(NodePtr proc, ValueRib args) {
+  Closure& closure = proc->get<Closure>();
+  if (closure.is_native_closure()) {
+    return closure.call(args)[0];
+  }
+
+  HeapVirtualMachine hvm(nullptr, nullptr, closure.get_environment(),
+                         ValueRib(), nullptr);
+  return hvm.apply_procedure(proc, args);
+}
+
+/**
+ * @brief Collects the elements of a proper list or a vector.
+ */
+std::vector<NodePtr> get_elements(NodePtr seq, const std::string& name) {
+  std::vector<NodePtr> elements;
+  if (seq->get_type() == Data::Type::VECTOR) {
+    Vector& vector = seq->get<Vector>();
+    for (std::size_t i = 0; i < vector.length(); ++i) {
+      elements.push_back(vector[i]);
+    }
+    return elements;
+  }
+  if (!core::is_proper_list(seq)) {
+    throw TypeException(10040, name + ": expected a list or a vector");
+  }
+  for (NodePtr it = seq; core::is_pair(it); it = core::cdr(it)) {
+    elements.push_back(core::car(it));
+  }
+  return elements;
+}
+
+void check_procedure(NodePtr proc, const std::string& name) {
+  if (proc->get_type() != Data::Type::CLOSURE) {
+    throw TypeException(10041, name + ": expected a procedure");
+  }
+}
+
+/**
+ * @brief Runs body(begin, end) over consecutive chunks of [0, count) on the
+ * default pool, each chunk with create_node bound to a fresh heap, then
+ * moves every chunk heap into the heap of the calling thread.
+ */
+void for_each_chunk(std::size_t count,
+                    std::function<void(std::size_t, std::size_t)> body,
+                    const std::string& name) {
+  gc::GC* caller_gc = gc::get_current_gc();
+  if (caller_gc == nullptr) {
+    throw InvalidInputException(10042, name + ": the calling thread has no "
+        "heap bound to create_node");
+  }
+
+  WorkStealingPool& pool = WorkStealingPool::get_default();
+  std::size_t chunk_count = std::min(count, pool.get_thread_count() * 4);
+  if (chunk_count == 0) {
+    return;
+  }
+  std::size_t chunk_size = (count + chunk_count - 1) / chunk_count;
+  chunk_count = (count + chunk_size - 1) / chunk_size;
+
+  std::vector<gc::GC> heaps(chunk_count);
+  std::vector<WorkStealingPool::Task> tasks;
+  for (std::size_t c = 0; c < chunk_count; ++c) {
+    gc::GC* heap = &heaps[c];
+    std::size_t begin = c * chunk_size;
+    std::size_t end = std::min(count, begin + chunk_size);
+    tasks.push_back([heap, begin, end, &body]() {
+      gc::HeapScope scope(*heap);
+      body(begin, end);
+    });
+  }
+
+  // Results refer into the chunk heaps, so adopt them even on failure
+  try {
+    pool.run_all(std::move(tasks));
+  } catch (...) {
+    for (auto& heap : heaps) {
+      caller_gc->adopt(heap);
+    }
+    throw;
+  }
+  for (auto& heap : heaps) {
+    caller_gc->adopt(heap);
+  }
+}
+
+/**
+ * @brief Builds a list of the same type as seq from elements, in order.
+ */
+NodePtr make_sequence(NodePtr seq, const std::vector<NodePtr>& elements) {
+  if (seq->get_type() == Data::Type::VECTOR) {
+    NodePtr vector = create_node(Vector(elements.size()));
+    for (std::size_t i = 0; i < elements.size(); ++i) {
+      vector->get<Vector>()[i] = elements[i];
+    }
+    return vector;
+  }
+  // Link the pairs front to back, so each element is stored without a copy
+  NodePtr head = core::list();
+  NodePtr tail;
+  for (const NodePtr& element : elements) {
+    NodePtr pair = core::cons(core::list(), core::list());
+    core::set_car(pair, element);
+    if (tail) {
+      core::set_cdr(tail, pair);
+    } else {
+      head = pair;
+    }
+    tail = pair;
+  }
+  return head;
+}
+
+/**
+ * @brief The shared state of one future: the nursery the thunk allocates
+ * into, and the result once the thunk has returned.
+ */
+struct FutureState {
+  std::mutex mutex;
+  std::condition_variable done_signal;
+  bool done = false;
+  bool adopted = false;
+  NodePtr value;
+  std::exception_ptr error;
+  gc::GC nursery;
+};
+
+NodePtr touch_future(FutureState& state) {
+  WorkStealingPool& pool = WorkStealingPool::get_default();
+  std::unique_lock<std::mutex> lock(state.mutex);
+  while (!state.done) {
+    lock.unlock();
+    bool ran = pool.run_pending_task();
+    lock.lock();
+    if (!ran && !state.done) {
+      state.done_signal.wait_for(lock, std::chrono::milliseconds(1));
+    }
+  }
+  // The first toucher takes the nursery, so its GC owns the result
+  gc::GC* caller_gc = gc::get_current_gc();
+  if (!state.adopted && caller_gc != nullptr) {
+    caller_gc->adopt(state.nursery);
+    state.adopted = true;
+  }
+  if (state.error) {
+    std::rethrow_exception(state.error);
+  }
+  return state.value;
+}
+
+/**
+ * @brief The native procedure of a future, which touches it. touch looks
+ * for it among the targets of native closures, so that it rejects other
+ * procedures.
+ */
+struct FutureTouch {
+  Args operator()(Args touch_args) const {
+    if (!touch_args.empty()) {
+      throw InvalidInputException(10043, "touch: a future takes no "
+          "arguments");
+    }
+    return Args{touch_future(*state)};
+  }
+
+  std::shared_ptr<FutureState> state;
+};
+
+} // namespace
+
+namespace impl {
+
+//(parallel-map ...)
+Args parallel_map(Args args) {
+  if (args.size() != 2) {
+    throw InvalidInputException(10043, "parallel-map: Invalid number of "
+        "arguments for procedure");
+  }
+  check_procedure(args[0], "parallel-map");
+  NodePtr proc = args[0];
+  std::vector<NodePtr> elements = get_elements(args[1], "parallel-map");
+  std::vector<NodePtr> results(elements.size());
+
+  for_each_chunk(elements.size(), [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      results[i] = apply_procedure(proc, ValueRib{elements[i]});
+    }
+  }, "parallel-map");
+
+  return {make_sequence(args[1], results)};
+}
+
+//(parallel-for-each ...)
+Args parallel_for_each(Args args) {
+  if (args.size() != 2) {
+    throw InvalidInputException(10043, "parallel-for-each: Invalid number "
+        "of arguments for procedure");
+  }
+  check_procedure(args[0], "parallel-for-each");
+  NodePtr proc = args[0];
+  std::vector<NodePtr> elements = get_elements(args[1], "parallel-for-each");
+
+  for_each_chunk(elements.size(), [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      apply_procedure(proc, ValueRib{elements[i]});
+    }
+  }, "parallel-for-each");
+
+  return {create_unspecified()};
+}
+
+//(parallel-reduce ...)
+Args parallel_reduce(Args args) {
+  if (args.size() != 3) {
+    throw InvalidInputException(10043, "parallel-reduce: Invalid number of "
+        "arguments for procedure");
+  }
+  check_procedure(args[0], "parallel-reduce");
+  NodePtr proc = args[0];
+  std::vector<NodePtr> elements = get_elements(args[2], "parallel-reduce");
+
+  // One partial result per chunk, stored at the index the chunk starts at
+  std::vector<NodePtr> partials(elements.size());
+  for_each_chunk(elements.size(), [&](std::size_t begin, std::size_t end) {
+    NodePtr acc = elements[begin];
+    for (std::size_t i = begin + 1; i < end; ++i) {
+      acc = apply_procedure(proc, ValueRib{acc, elements[i]});
+    }
+    partials[begin] = acc;
+  }, "parallel-reduce");
+
+  NodePtr result = args[1];
+  for (const NodePtr& partial : partials) {
+    if (partial) {
+      result = apply_procedure(proc, ValueRib{result, partial});
+    }
+  }
+  return {result};
+}
+
+//(future ...)
+Args future(Args args) {
+  if (args.size() != 1) {
+    throw InvalidInputException(10043, "future: Invalid number of "
+        "arguments for procedure");
+  }
+  check_procedure(args[0], "future");
+  NodePtr thunk = args[0];
+  auto state = std::make_shared<FutureState>();
+
+  WorkStealingPool::get_default().submit([state, thunk]() {
+    NodePtr value;
+    std::exception_ptr error;
+    {
+      gc::HeapScope scope(state->nursery);
+      try {
+        value = apply_procedure(thunk, ValueRib());
+      } catch (...) {
+        error = std::current_exception();
+      }
+    }
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->value = value;
+    state->error = error;
+    state->done = true;
+    state->done_signal.notify_all();
+  });
+
+  return {create_node(Closure(FutureTouch{state}, false))};
+}
+
+//(touch ...)
+Args touch(Args args) {
+  if (args.size() != 1) {
+    throw InvalidInputException(10043, "touch: Invalid number of "
+        "arguments for procedure");
+  }
+  CallablePtr callable;
+  if (args[0]->get_type() == Data::Type::CLOSURE) {
+    callable = args[0]->get<Closure>().get_callable();
+  }
+  const FutureTouch* future_touch =
+      callable ? callable->target<FutureTouch>() : nullptr;
+  if (future_touch == nullptr) {
+    throw TypeException(10044, "touch: expected a future");
+  }
+  return {touch_future(*future_touch->state)};
+}
+
+} // namespace impl
+
+Callable parallel_map = impl::parallel_map;
+Callable parallel_for_each = impl::parallel_for_each;
+Callable parallel_reduce = impl::parallel_reduce;
+Callable future = impl::future;
+Callable touch = impl::touch;
+
+} // namespace stdproc
+} // namespace shaka
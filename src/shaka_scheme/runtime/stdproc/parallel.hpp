@@ -0,0 +1,83 @@
+#ifndef SHAKA_SCHEME_STDPROC_PARALLEL_HPP
+#define SHAKA_SCHEME_STDPROC_PARALLEL_HPP
+
+#include "shaka_scheme/system/base/Data.hpp"
+#include "shaka_scheme/system/exceptions/TypeException.hpp"
+#include "shaka_scheme/system/exceptions/InvalidInputException.hpp"
+
+#include <functional>
+#include <deque>
+
+namespace shaka {
+namespace stdproc {
+
+using Args = std::deque<NodePtr>;
+using Callable = std::function<std::deque<NodePtr>(std::deque<NodePtr>)>;
+
+/**
+ * @note The parallel procedures split a list or vector into chunks and
+ * apply a procedure to each chunk on the default WorkStealingPool. Every
+ * chunk runs in its own HeapVirtualMachine and allocates into its own heap,
+ * which is handed to the heap of the caller once all chunks are done.
+ * Futures run the same way, one thunk per task.
+ *
+ * The procedure must be pure: it may read, but must not mutate, any Data or
+ * environment that is shared with the caller or with other chunks.
+ */
+namespace impl {
+
+/**
+ * @brief Implementation of (parallel-map proc seq)
+ * @param args A procedure of one argument and a list or vector
+ * @return A list or vector, matching seq, of the results of applying proc
+ * to every element, in order
+ */
+Args parallel_map(Args args);
+
+/**
+ * @brief Implementation of (parallel-for-each proc seq)
+ * @param args A procedure of one argument and a list or vector
+ * @return An unspecified value once proc was applied to every element
+ */
+Args parallel_for_each(Args args);
+
+/**
+ * @brief Implementation of (parallel-reduce proc init seq)
+ * @param args An associative procedure of two arguments, an initial value
+ * and a list or vector
+ * @return The left fold of proc over seq starting from init. Each chunk is
+ * folded separately and the chunk results are then folded in order.
+ */
+Args parallel_reduce(Args args);
+
+/**
+ * @brief Implementation of (future thunk)
+ * @param args A procedure of no arguments
+ * @return A future: a native procedure of no arguments that touches the
+ * result. The thunk starts running on the default pool at once, in its own
+ * HeapVirtualMachine with its own heap as a nursery.
+ */
+Args future(Args args);
+
+/**
+ * @brief Implementation of (touch future)
+ * @param args A future created by (future thunk)
+ * @return The value returned by the thunk. Until it is available, the
+ * calling thread runs other pending pool tasks, then blocks. An exception
+ * thrown by the thunk is rethrown by every touch.
+ * @throws TypeException if the argument is any other procedure or object
+ */
+Args touch(Args args);
+
+} // namespace impl
+
+extern Callable parallel_map;
+extern Callable parallel_for_each;
+extern Callable parallel_reduce;
+extern Callable future;
+extern Callable touch;
+
+} // namespace stdproc
+} // namespace shaka
+
+#endif //SHAKA_SCHEME_STDPROC_PARALLEL_HPP
@@ -0,0 +1,472 @@
+#include "shaka_scheme/runtime/stdproc/ports.hpp"
+#include "shaka_scheme/system/core/types.hpp"
+
+#include <iostream>
+
+namespace shaka {
+namespace stdproc {
+
+namespace {
+
+void check_arguments(const Args& args, std::size_t min, std::size_t max,
+                     const std::string& name) {
+  if (args.size() < min || args.size() > max) {
+    throw InvalidInputException(10077,
+                                name + ": invalid number of arguments");
+  }
+}
+
+Port& get_console_port(Port::Direction direction) {
+  static Port input = Port::open_console(std::cin.rdbuf(),
+                                         Port::Direction::INPUT);
+  static Port output = Port::open_console(std::cout.rdbuf(),
+                                          Port::Direction::OUTPUT);
+  return direction == Port::Direction::INPUT ? input : output;
+}
+
+Port& get_error_port() {
+  static Port error = Port::open_console(std::cerr.rdbuf(),
+                                         Port::Direction::OUTPUT);
+  return error;
+}
+
+Port& get_any_port(const Args& args, const std::string& name) {
+  if (args[0]->get_type() != Data::Type::PORT) {
+    throw TypeException(10078, name + ": expected a port");
+  }
+  return args[0]->get<Port>();
+}
+
+/**
+ * @brief Gets the port at index, or the console port when the argument was
+ * left out, and checks its direction and whether it is binary.
+ */
+Port& get_port(const Args& args, std::size_t index,
+               Port::Direction direction, bool binary,
+               const std::string& name) {
+  if (index >= args.size()) {
+    Port& console = get_console_port(direction);
+    if (binary) {
+      throw TypeException(10078, name + ": expected a binary port");
+    }
+    return console;
+  }
+  if (args[index]->get_type() != Data::Type::PORT) {
+    throw TypeException(10078, name + ": expected a port");
+  }
+  Port& port = args[index]->get<Port>();
+  if ((direction == Port::Direction::INPUT) != port.is_input()) {
+    throw TypeException(10078, name + (direction == Port::Direction::INPUT ?
+        ": expected an input port" : ": expected an output port"));
+  }
+  if (port.is_binary() != binary) {
+    throw TypeException(10078, name + (binary ?
+        ": expected a binary port" : ": expected a textual port"));
+  }
+  return port;
+}
+
+std::size_t get_count(const NodePtr& node, const std::string& name) {
+  if (node->get_type() != Data::Type::NUMBER ||
+      node->get<Number>().get_type() != Number::NumberType::INTEGER ||
+      node->get<Number>().get<Integer>().get_value() < 0) {
+    throw TypeException(10078, name + ": expected a non-negative integer");
+  }
+  return static_cast<std::size_t>(
+      node->get<Number>().get<Integer>().get_value());
+}
+
+/**
+ * @brief Reads the optional start and end arguments at index and after,
+ * which default to the whole of a sequence of the given length.
+ */
+void get_range(const Args& args, std::size_t index, std::size_t length,
+               std::size_t& start, std::size_t& end,
+               const std::string& name) {
+  start = index < args.size() ? get_count(args[index], name) : 0;
+  end = index + 1 < args.size() ? get_count(args[index + 1], name) : length;
+  if (start > end || end > length) {
+    throw InvalidInputException(10077, name + ": invalid start and end");
+  }
+}
+
+std::string get_string(const NodePtr& node, const std::string& name) {
+  if (node->get_type() != Data::Type::STRING) {
+    throw TypeException(10078, name + ": expected a string");
+  }
+  return node->get<String>().get_string();
+}
+
+Bytevector& get_bytevector(const NodePtr& node, const std::string& name) {
+  if (node->get_type() != Data::Type::BYTEVECTOR) {
+    throw TypeException(10078, name + ": expected a bytevector");
+  }
+  return node->get<Bytevector>();
+}
+
+std::string to_bytes(Bytevector& bytevector, std::size_t start,
+                     std::size_t end) {
+  if (start == end) {
+    return std::string();
+  }
+  return std::string(reinterpret_cast<const char*>(&bytevector[start]),
+                     end - start);
+}
+
+NodePtr from_bytes(const std::string& bytes) {
+  Bytevector bytevector(bytes.size());
+  for (std::size_t i = 0; i < bytes.size(); ++i) {
+    bytevector[i] = static_cast<unsigned char>(bytes[i]);
+  }
+  return create_node(bytevector);
+}
+
+Args open_file(const Args& args, Port::Direction direction, bool binary,
+               const std::string& name) {
+  check_arguments(args, 1, 1, name);
+  return {create_node(Port::open_file(get_string(args[0], name), direction,
+                                      binary))};
+}
+
+Args port_predicate(const Args& args, bool (*test)(Port&),
+                    const std::string& name) {
+  check_arguments(args, 1, 1, name);
+  return {create_node(Boolean(args[0]->get_type() == Data::Type::PORT &&
+                                  test(args[0]->get<Port>())))};
+}
+
+NodePtr create_byte_or_eof(int byte) {
+  return byte < 0 ? create_eof_object() : create_node(Number(byte));
+}
+
+} // namespace
+
+namespace impl {
+
+Args open_input_file(Args args) {
+  return open_file(args, Port::Direction::INPUT, false, "open-input-file");
+}
+
+Args open_binary_input_file(Args args) {
+  return open_file(args, Port::Direction::INPUT, true,
+                   "open-binary-input-file");
+}
+
+Args open_output_file(Args args) {
+  return open_file(args, Port::Direction::OUTPUT, false, "open-output-file");
+}
+
+Args open_binary_output_file(Args args) {
+  return open_file(args, Port::Direction::OUTPUT, true,
+                   "open-binary-output-file");
+}
+
+Args open_input_string(Args args) {
+  check_arguments(args, 1, 1, "open-input-string");
+  return {create_node(Port::open_input_memory(
+      get_string(args[0], "open-input-string"), false))};
+}
+
+Args open_input_bytevector(Args args) {
+  check_arguments(args, 1, 1, "open-input-bytevector");
+  Bytevector& bytevector = get_bytevector(args[0], "open-input-bytevector");
+  return {create_node(Port::open_input_memory(
+      to_bytes(bytevector, 0, bytevector.length()), true))};
+}
+
+Args open_output_string(Args args) {
+  check_arguments(args, 0, 0, "open-output-string");
+  return {create_node(Port::open_output_memory(false))};
+}
+
+Args open_output_bytevector(Args args) {
+  check_arguments(args, 0, 0, "open-output-bytevector");
+  return {create_node(Port::open_output_memory(true))};
+}
+
+Args get_output_string(Args args) {
+  check_arguments(args, 1, 1, "get-output-string");
+  Port& port = get_any_port(args, "get-output-string");
+  if (port.is_binary()) {
+    throw TypeException(10078, "get-output-string: expected a textual port");
+  }
+  return {create_node(String(port.get_output()))};
+}
+
+Args get_output_bytevector(Args args) {
+  check_arguments(args, 1, 1, "get-output-bytevector");
+  Port& port = get_any_port(args, "get-output-bytevector");
+  if (!port.is_binary()) {
+    throw TypeException(10078, "get-output-bytevector: expected a binary port");
+  }
+  return {from_bytes(port.get_output())};
+}
+
+Args close_port(Args args) {
+  check_arguments(args, 1, 1, "close-port");
+  get_any_port(args, "close-port").close();
+  return {core::create_unspecified_node()};
+}
+
+Args close_input_port(Args args) {
+  check_arguments(args, 1, 1, "close-input-port");
+  Port& port = get_any_port(args, "close-input-port");
+  if (port.is_input()) {
+    port.close();
+  }
+  return {core::create_unspecified_node()};
+}
+
+Args close_output_port(Args args) {
+  check_arguments(args, 1, 1, "close-output-port");
+  Port& port = get_any_port(args, "close-output-port");
+  if (port.is_output()) {
+    port.close();
+  }
+  return {core::create_unspecified_node()};
+}
+
+Args is_port(Args args) {
+  return port_predicate(args, [](Port&) { return true; }, "port?");
+}
+
+Args is_input_port(Args args) {
+  return port_predicate(args, [](Port& port) {
+    return port.is_input();
+  }, "input-port?");
+}
+
+Args is_output_port(Args args) {
+  return port_predicate(args, [](Port& port) {
+    return port.is_output();
+  }, "output-port?");
+}
+
+Args is_textual_port(Args args) {
+  return port_predicate(args, [](Port& port) {
+    return !port.is_binary();
+  }, "textual-port?");
+}
+
+Args is_binary_port(Args args) {
+  return port_predicate(args, [](Port& port) {
+    return port.is_binary();
+  }, "binary-port?");
+}
+
+Args is_input_port_open(Args args) {
+  check_arguments(args, 1, 1, "input-port-open?");
+  Port& port = get_any_port(args, "input-port-open?");
+  return {create_node(Boolean(port.is_input() && port.is_open()))};
+}
+
+Args is_output_port_open(Args args) {
+  check_arguments(args, 1, 1, "output-port-open?");
+  Port& port = get_any_port(args, "output-port-open?");
+  return {create_node(Boolean(port.is_output() && port.is_open()))};
+}
+
+Args current_input_port(Args args) {
+  check_arguments(args, 0, 0, "current-input-port");
+  return {create_node(get_console_port(Port::Direction::INPUT))};
+}
+
+Args current_output_port(Args args) {
+  check_arguments(args, 0, 0, "current-output-port");
+  return {create_node(get_console_port(Port::Direction::OUTPUT))};
+}
+
+Args current_error_port(Args args) {
+  check_arguments(args, 0, 0, "current-error-port");
+  return {create_node(get_error_port())};
+}
+
+Args write_string(Args args) {
+  check_arguments(args, 1, 4, "write-string");
+  std::string text = get_string(args[0], "write-string");
+  Port& port = get_port(args, 1, Port::Direction::OUTPUT, false,
+                        "write-string");
+  std::size_t start, end;
+  get_range(args, 2, text.size(), start, end, "write-string");
+  port.write(text.data() + start, end - start);
+  return {core::create_unspecified_node()};
+}
+
+Args write_u8(Args args) {
+  check_arguments(args, 1, 2, "write-u8");
+  std::size_t byte = get_count(args[0], "write-u8");
+  if (byte > 255) {
+    throw TypeException(10078, "write-u8: expected a byte");
+  }
+  get_port(args, 1, Port::Direction::OUTPUT, true, "write-u8")
+      .write_byte(static_cast<unsigned char>(byte));
+  return {core::create_unspecified_node()};
+}
+
+Args write_bytevector(Args args) {
+  check_arguments(args, 1, 4, "write-bytevector");
+  Bytevector& bytevector = get_bytevector(args[0], "write-bytevector");
+  Port& port = get_port(args, 1, Port::Direction::OUTPUT, true,
+                        "write-bytevector");
+  std::size_t start, end;
+  get_range(args, 2, bytevector.length(), start, end, "write-bytevector");
+  if (start < end) {
+    port.write(reinterpret_cast<const char*>(&bytevector[start]),
+               end - start);
+  }
+  return {core::create_unspecified_node()};
+}
+
+Args newline(Args args) {
+  check_arguments(args, 0, 1, "newline");
+  get_port(args, 0, Port::Direction::OUTPUT, false, "newline").write("\n", 1);
+  return {core::create_unspecified_node()};
+}
+
+Args flush_output_port(Args args) {
+  check_arguments(args, 0, 1, "flush-output-port");
+  if (args.empty()) {
+    get_console_port(Port::Direction::OUTPUT).flush();
+  } else {
+    Port& port = get_any_port(args, "flush-output-port");
+    if (!port.is_output()) {
+      throw TypeException(10078, "flush-output-port: expected an output port");
+    }
+    port.flush();
+  }
+  return {core::create_unspecified_node()};
+}
+
+Args read_line(Args args) {
+  check_arguments(args, 0, 1, "read-line");
+  std::string line;
+  if (!get_port(args, 0, Port::Direction::INPUT, false, "read-line")
+      .read_line(line)) {
+    return {create_eof_object()};
+  }
+  return {create_node(String(line))};
+}
+
+Args read_string(Args args) {
+  check_arguments(args, 1, 2, "read-string");
+  std::size_t count = get_count(args[0], "read-string");
+  Port& port = get_port(args, 1, Port::Direction::INPUT, false,
+                        "read-string");
+  std::string text(count, '\0');
+  text.resize(count == 0 ? 0 : port.read(&text[0], count));
+  if (count > 0 && text.empty()) {
+    return {create_eof_object()};
+  }
+  return {create_node(String(text))};
+}
+
+Args read_u8(Args args) {
+  check_arguments(args, 0, 1, "read-u8");
+  return {create_byte_or_eof(get_port(args, 0, Port::Direction::INPUT, true,
+                                      "read-u8").read_byte())};
+}
+
+Args peek_u8(Args args) {
+  check_arguments(args, 0, 1, "peek-u8");
+  return {create_byte_or_eof(get_port(args, 0, Port::Direction::INPUT, true,
+                                      "peek-u8").peek_byte())};
+}
+
+Args is_u8_ready(Args args) {
+  check_arguments(args, 0, 1, "u8-ready?");
+  return {create_node(Boolean(get_port(args, 0, Port::Direction::INPUT, true,
+                                       "u8-ready?").is_ready()))};
+}
+
+Args is_char_ready(Args args) {
+  check_arguments(args, 0, 1, "char-ready?");
+  return {create_node(Boolean(get_port(args, 0, Port::Direction::INPUT, false,
+                                       "char-ready?").is_ready()))};
+}
+
+Args read_bytevector(Args args) {
+  check_arguments(args, 1, 2, "read-bytevector");
+  std::size_t count = get_count(args[0], "read-bytevector");
+  Port& port = get_port(args, 1, Port::Direction::INPUT, true,
+                        "read-bytevector");
+  std::string bytes(count, '\0');
+  bytes.resize(count == 0 ? 0 : port.read(&bytes[0], count));
+  if (count > 0 && bytes.empty()) {
+    return {create_eof_object()};
+  }
+  return {from_bytes(bytes)};
+}
+
+Args read_bytevector_into(Args args) {
+  check_arguments(args, 1, 4, "read-bytevector!");
+  Bytevector& bytevector = get_bytevector(args[0], "read-bytevector!");
+  Port& port = get_port(args, 1, Port::Direction::INPUT, true,
+                        "read-bytevector!");
+  std::size_t start, end;
+  get_range(args, 2, bytevector.length(), start, end, "read-bytevector!");
+  if (start == end) {
+    return {create_node(Number(0))};
+  }
+  // Straight from the port buffer into the bytevector's storage
+  std::size_t count = port.read(
+      reinterpret_cast<char*>(&bytevector[start]), end - start);
+  if (count == 0) {
+    return {create_eof_object()};
+  }
+  return {create_node(Number(static_cast<int>(count)))};
+}
+
+Args eof_object(Args args) {
+  check_arguments(args, 0, 0, "eof-object");
+  return {create_eof_object()};
+}
+
+Args is_eof_object(Args args) {
+  check_arguments(args, 1, 1, "eof-object?");
+  return {create_node(Boolean(
+      args[0]->get_type() == Data::Type::EOF_OBJECT))};
+}
+
+} // namespace impl
+
+Callable open_input_file = impl::open_input_file;
+Callable open_binary_input_file = impl::open_binary_input_file;
+Callable open_output_file = impl::open_output_file;
+Callable open_binary_output_file = impl::open_binary_output_file;
+Callable open_input_string = impl::open_input_string;
+Callable open_input_bytevector = impl::open_input_bytevector;
+Callable open_output_string = impl::open_output_string;
+Callable open_output_bytevector = impl::open_output_bytevector;
+Callable get_output_string = impl::get_output_string;
+Callable get_output_bytevector = impl::get_output_bytevector;
+Callable close_port = impl::close_port;
+Callable close_input_port = impl::close_input_port;
+Callable close_output_port = impl::close_output_port;
+Callable is_port = impl::is_port;
+Callable is_input_port = impl::is_input_port;
+Callable is_output_port = impl::is_output_port;
+Callable is_textual_port = impl::is_textual_port;
+Callable is_binary_port = impl::is_binary_port;
+Callable is_input_port_open = impl::is_input_port_open;
+Callable is_output_port_open = impl::is_output_port_open;
+Callable current_input_port = impl::current_input_port;
+Callable current_output_port = impl::current_output_port;
+Callable current_error_port = impl::current_error_port;
+Callable write_string = impl::write_string;
+Callable write_u8 = impl::write_u8;
+Callable write_bytevector = impl::write_bytevector;
+Callable newline = impl::newline;
+Callable flush_output_port = impl::flush_output_port;
+Callable read_line = impl::read_line;
+Callable read_string = impl::read_string;
+Callable read_u8 = impl::read_u8;
+Callable peek_u8 = impl::peek_u8;
+Callable is_u8_ready = impl::is_u8_ready;
+Callable is_char_ready = impl::is_char_ready;
+Callable read_bytevector = impl::read_bytevector;
+Callable read_bytevector_into = impl::read_bytevector_into;
+Callable eof_object = impl::eof_object;
+Callable is_eof_object = impl::is_eof_object;
+
+} // namespace stdproc
+} // namespace shaka
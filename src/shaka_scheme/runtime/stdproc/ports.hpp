@@ -0,0 +1,193 @@
+#ifndef SHAKA_SCHEME_STDPROC_PORTS_HPP
+#define SHAKA_SCHEME_STDPROC_PORTS_HPP
+
+#include "shaka_scheme/system/base/Data.hpp"
+#include "shaka_scheme/system/exceptions/TypeException.hpp"
+#include "shaka_scheme/system/exceptions/InvalidInputException.hpp"
+
+#include <functional>
+#include <deque>
+
+namespace shaka {
+namespace stdproc {
+
+using Args = std::deque<NodePtr>;
+using Callable = std::function<std::deque<NodePtr>(std::deque<NodePtr>)>;
+
+/**
+ * @note The input and output procedures of R7RS section 6.13. Where a port
+ * argument is optional, the console port of stdin, stdout or stderr is
+ * used.
+ */
+namespace impl {
+
+/**
+ * @brief Implementation of (open-input-file path),
+ * (open-binary-input-file path), (open-output-file path) and
+ * (open-binary-output-file path)
+ */
+Args open_input_file(Args args);
+Args open_binary_input_file(Args args);
+Args open_output_file(Args args);
+Args open_binary_output_file(Args args);
+
+/**
+ * @brief Implementation of (open-input-string string) and
+ * (open-input-bytevector bytevector)
+ */
+Args open_input_string(Args args);
+Args open_input_bytevector(Args args);
+
+/**
+ * @brief Implementation of (open-output-string) and (open-output-bytevector)
+ */
+Args open_output_string(Args args);
+Args open_output_bytevector(Args args);
+
+/**
+ * @brief Implementation of (get-output-string port) and
+ * (get-output-bytevector port)
+ * @return Everything written to the port so far
+ */
+Args get_output_string(Args args);
+Args get_output_bytevector(Args args);
+
+/**
+ * @brief Implementation of (close-port port), (close-input-port port) and
+ * (close-output-port port)
+ */
+Args close_port(Args args);
+Args close_input_port(Args args);
+Args close_output_port(Args args);
+
+/**
+ * @brief Implementation of the port predicates: (port? obj),
+ * (input-port? obj), (output-port? obj), (textual-port? obj),
+ * (binary-port? obj), (input-port-open? port) and (output-port-open? port)
+ */
+Args is_port(Args args);
+Args is_input_port(Args args);
+Args is_output_port(Args args);
+Args is_textual_port(Args args);
+Args is_binary_port(Args args);
+Args is_input_port_open(Args args);
+Args is_output_port_open(Args args);
+
+/**
+ * @brief Implementation of (current-input-port), (current-output-port) and
+ * (current-error-port)
+ */
+Args current_input_port(Args args);
+Args current_output_port(Args args);
+Args current_error_port(Args args);
+
+/**
+ * @brief Implementation of (write-string string [port [start [end]]])
+ */
+Args write_string(Args args);
+
+/**
+ * @brief Implementation of (write-u8 byte [port])
+ */
+Args write_u8(Args args);
+
+/**
+ * @brief Implementation of (write-bytevector bytevector [port [start [end]]])
+ */
+Args write_bytevector(Args args);
+
+/**
+ * @brief Implementation of (newline [port])
+ */
+Args newline(Args args);
+
+/**
+ * @brief Implementation of (flush-output-port [port])
+ */
+Args flush_output_port(Args args);
+
+/**
+ * @brief Implementation of (read-line [port])
+ * @return The next line without its line ending, or the end-of-file object
+ */
+Args read_line(Args args);
+
+/**
+ * @brief Implementation of (read-string k [port])
+ * @return Up to k bytes as a string, or the end-of-file object
+ */
+Args read_string(Args args);
+
+/**
+ * @brief Implementation of (read-u8 [port]), (peek-u8 [port]),
+ * (u8-ready? [port]) and (char-ready? [port])
+ */
+Args read_u8(Args args);
+Args peek_u8(Args args);
+Args is_u8_ready(Args args);
+Args is_char_ready(Args args);
+
+/**
+ * @brief Implementation of (read-bytevector k [port])
+ * @return A new bytevector of up to k bytes, or the end-of-file object
+ */
+Args read_bytevector(Args args);
+
+/**
+ * @brief Implementation of (read-bytevector! bytevector [port [start [end]]])
+ * @return The number of bytes read into bytevector, or the end-of-file
+ * object
+ */
+Args read_bytevector_into(Args args);
+
+/**
+ * @brief Implementation of (eof-object) and (eof-object? obj)
+ */
+Args eof_object(Args args);
+Args is_eof_object(Args args);
+
+} // namespace impl
+
+extern Callable open_input_file;
+extern Callable open_binary_input_file;
+extern Callable open_output_file;
+extern Callable open_binary_output_file;
+extern Callable open_input_string;
+extern Callable open_input_bytevector;
+extern Callable open_output_string;
+extern Callable open_output_bytevector;
+extern Callable get_output_string;
+extern Callable get_output_bytevector;
+extern Callable close_port;
+extern Callable close_input_port;
+extern Callable close_output_port;
+extern Callable is_port;
+extern Callable is_input_port;
+extern Callable is_output_port;
+extern Callable is_textual_port;
+extern Callable is_binary_port;
+extern Callable is_input_port_open;
+extern Callable is_output_port_open;
+extern Callable current_input_port;
+extern Callable current_output_port;
+extern Callable current_error_port;
+extern Callable write_string;
+extern Callable write_u8;
+extern Callable write_bytevector;
+extern Callable newline;
+extern Callable flush_output_port;
+extern Callable read_line;
+extern Callable read_string;
+extern Callable read_u8;
+extern Callable peek_u8;
+extern Callable is_u8_ready;
+extern Callable is_char_ready;
+extern Callable read_bytevector;
+extern Callable read_bytevector_into;
+extern Callable eof_object;
+extern Callable is_eof_object;
+
+} // namespace stdproc
+} // namespace shaka
+
+#endif //SHAKA_SCHEME_STDPROC_PORTS_HPP
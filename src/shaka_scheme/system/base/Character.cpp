@@ -3,13 +3,14 @@
 //
 
 #include "Character.hpp"
+#include "shaka_scheme/system/base/string_kernels.hpp"
 #include <string>
 
 namespace shaka{
 
 Character::Character(int val) {
-  if(val > -1 && val < 128) {
-    this->value = (char)val;
+  if(val > -1 && val <= 0x10FFFF && !(val >= 0xD800 && val <= 0xDFFF)) {
+    this->value = static_cast<char32_t>(val);
     return;
   }
   this->value = '\0';
@@ -70,7 +71,7 @@ std::ostream& operator<<(std::ostream& out, const shaka::Character& chara) {
     output += "delete";
     break;
   default:
-    output += chara.value;
+    string_kernels::encode_utf8(chara.value, output);
   }
   out << output;
   return out;
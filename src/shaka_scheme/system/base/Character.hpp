@@ -19,7 +19,8 @@ public:
 
   /**
    * @brief Constructor created via an integer.
-   * @param val Integer to be casted to character.
+   * @param val The Unicode code point of the character. Surrogates and
+   * values outside of Unicode give the null character.
    */
   Character(int val);
 
@@ -44,9 +45,9 @@ public:
 
   friend std::ostream& operator<<(std::ostream&, const shaka::Character&);
 
-  char get_value() const { return value; }
+  char32_t get_value() const { return value; }
 private:
-  char value;
+  char32_t value;
 };
 
 } // namespace shaka
@@ -50,6 +50,18 @@ shaka::Data::Data(const shaka::Data& other) :
     new(&bytevector) shaka::Bytevector(other.bytevector);
     break;
   }
+  case shaka::Data::Type::HASH_TABLE: {
+    new(&hash_table) shaka::HashTable(other.hash_table);
+    break;
+  }
+  case shaka::Data::Type::EPHEMERON: {
+    new(&ephemeron) shaka::Ephemeron(other.ephemeron);
+    break;
+  }
+  case shaka::Data::Type::PORT: {
+    new(&port) shaka::Port(other.port);
+    break;
+  }
 
 //  case shaka::Data::Type::DATA_NODE: {
 //    new(&data_node) std::shared_ptr<shaka::DataNode>(other.data_node);
@@ -67,6 +79,7 @@ shaka::Data::Data(const shaka::Data& other) :
         "constructor.");
   }
   case Type::UNSPECIFIED:break;
+  case Type::EOF_OBJECT:break;
     //case Type::DATANODE:break;
   case Type::ENVIRONMENT:break;
   }
@@ -115,6 +128,18 @@ shaka::Data::~Data() {
     this->bytevector.~Bytevector();
     break;
   }
+  case shaka::Data::Type::HASH_TABLE: {
+    this->hash_table.~HashTable();
+    break;
+  }
+  case shaka::Data::Type::EPHEMERON: {
+    this->ephemeron.~Ephemeron();
+    break;
+  }
+  case shaka::Data::Type::PORT: {
+    this->port.~Port();
+    break;
+  }
 //  case shaka::Data::Type::ENVIRONMENT: {
 //    this->environment::~environment();
 //    break;
@@ -208,6 +233,30 @@ shaka::Bytevector& shaka::Data::get<shaka::Bytevector>() {
   return this->bytevector;
 }
 
+template<>
+shaka::HashTable& shaka::Data::get<shaka::HashTable>() {
+  if (this->get_type() != Type::HASH_TABLE) {
+    throw shaka::TypeException(10, "Could not get() HashTable from Data");
+  }
+  return this->hash_table;
+}
+
+template<>
+shaka::Ephemeron& shaka::Data::get<shaka::Ephemeron>() {
+  if (this->get_type() != Type::EPHEMERON) {
+    throw shaka::TypeException(10, "Could not get() Ephemeron from Data");
+  }
+  return this->ephemeron;
+}
+
+template<>
+shaka::Port& shaka::Data::get<shaka::Port>() {
+  if (this->get_type() != Type::PORT) {
+    throw shaka::TypeException(10, "Could not get() Port from Data");
+  }
+  return this->port;
+}
+
 namespace shaka {
 
 std::ostream& operator<<(std::ostream& lhs, shaka::Data rhs) {
@@ -288,6 +337,22 @@ std::ostream& operator<<(std::ostream& lhs, shaka::Data rhs) {
     lhs << ")";
     break;
   }
+  case shaka::Data::Type::HASH_TABLE: {
+    lhs << "#<hash-table>";
+    break;
+  }
+  case shaka::Data::Type::EPHEMERON: {
+    lhs << "#<ephemeron>";
+    break;
+  }
+  case shaka::Data::Type::PORT: {
+    lhs << "#<port>";
+    break;
+  }
+  case shaka::Data::Type::EOF_OBJECT: {
+    lhs << "#<eof>";
+    break;
+  }
 
   case shaka::Data::Type::CALL_FRAME: {
     lhs << "#<stack-frame>";
@@ -318,4 +383,10 @@ NodePtr create_unspecified() {
   data.type_tag = shaka::Data::Type::UNSPECIFIED;
   return create_node(data);
 }
+
+NodePtr create_eof_object() {
+  Data data;
+  data.type_tag = shaka::Data::Type::EOF_OBJECT;
+  return create_node(data);
+}
 } // namespace shaka
@@ -16,6 +16,9 @@
 #include "shaka_scheme/system/base/PrimitiveFormMarker.hpp"
 #include "shaka_scheme/system/base/Vector.hpp"
 #include "shaka_scheme/system/base/Bytevector.hpp"
+#include "shaka_scheme/system/base/HashTable.hpp"
+#include "shaka_scheme/system/base/Ephemeron.hpp"
+#include "shaka_scheme/system/base/Port.hpp"
 
 #include "shaka_scheme/system/vm/Closure.hpp"
 #include "shaka_scheme/system/vm/CallFrame.hpp"
@@ -23,6 +26,7 @@
 
 
 #include <memory>
+#include <utility>
 
 namespace shaka {
 
@@ -37,6 +41,9 @@ class UserStructData;
 class Closure;
 class Vector;
 class Bytevector;
+class HashTable;
+class Ephemeron;
+class Port;
 
 class CallFrame;
 class PrimitiveFormMarker;
@@ -64,7 +71,11 @@ public:
     NULL_LIST,
     PRIMITIVE_FORM,
     VECTOR,
-    BYTEVECTOR
+    BYTEVECTOR,
+    HASH_TABLE,
+    EPHEMERON,
+    PORT,
+    EOF_OBJECT
   };
 private:
   Type type_tag;
@@ -80,60 +91,78 @@ private:
     shaka::PrimitiveFormMarker primitive_form;
     shaka::Vector vector;
     shaka::Bytevector bytevector;
+    shaka::HashTable hash_table;
+    shaka::Ephemeron ephemeron;
+    shaka::Port port;
   };
 
 public:
 
   Data(shaka::String other) {
-    new(&string) shaka::String(other);
+    new(&string) shaka::String(std::move(other));
     this->type_tag = Type::STRING;
   }
 
   Data(shaka::Symbol other) {
-    new(&symbol) shaka::Symbol(other);
+    new(&symbol) shaka::Symbol(std::move(other));
     this->type_tag = Type::SYMBOL;
   }
 
   Data(shaka::Boolean other) {
-    new(&boolean) shaka::Boolean(other);
+    new(&boolean) shaka::Boolean(std::move(other));
     this->type_tag = Type::BOOLEAN;
   }
 
   Data(shaka::Number other) {
-    new(&number) shaka::Number(other);
+    new(&number) shaka::Number(std::move(other));
     this->type_tag = Type::NUMBER;
   }
 
   Data(shaka::DataPair other) {
-    new(&data_pair) shaka::DataPair(other);
+    new(&data_pair) shaka::DataPair(std::move(other));
     this->type_tag = Type::DATA_PAIR;
   }
 
   Data(shaka::Closure other) {
-    new(&closure) shaka::Closure(other);
+    new(&closure) shaka::Closure(std::move(other));
     this->type_tag = Type::CLOSURE;
   }
 
   Data(shaka::CallFrame other) {
-    new(&call_frame) shaka::CallFrame(other);
+    new(&call_frame) shaka::CallFrame(std::move(other));
     this->type_tag = Type::CALL_FRAME;
   }
 
   Data(shaka::PrimitiveFormMarker other) {
-    new(&primitive_form) shaka::PrimitiveFormMarker(other);
+    new(&primitive_form) shaka::PrimitiveFormMarker(std::move(other));
     this->type_tag = Type::PRIMITIVE_FORM;
   }
 
   Data(shaka::Vector other) {
-    new(&vector) shaka::Vector(other);
+    new(&vector) shaka::Vector(std::move(other));
     this->type_tag = Type::VECTOR;
   }
 
   Data(shaka::Bytevector other) {
-    new(&bytevector) shaka::Bytevector(other);
+    new(&bytevector) shaka::Bytevector(std::move(other));
     this->type_tag = Type::BYTEVECTOR;
   }
 
+  Data(shaka::HashTable other) {
+    new(&hash_table) shaka::HashTable(std::move(other));
+    this->type_tag = Type::HASH_TABLE;
+  }
+
+  Data(shaka::Ephemeron other) {
+    new(&ephemeron) shaka::Ephemeron(std::move(other));
+    this->type_tag = Type::EPHEMERON;
+  }
+
+  Data(shaka::Port other) {
+    new(&port) shaka::Port(std::move(other));
+    this->type_tag = Type::PORT;
+  }
+
   /**
    * @brief A default constructor that constructs to a null list.
    */
@@ -173,6 +202,7 @@ public:
   }
 
   friend NodePtr create_unspecified();
+  friend NodePtr create_eof_object();
 };
 
 template<> shaka::String& shaka::Data::get<shaka::String>();
@@ -185,6 +215,9 @@ template<> shaka::PrimitiveFormMarker& shaka::Data::get<shaka::PrimitiveFormMark
 template<> shaka::Number& shaka::Data::get<shaka::Number>();
 template<> shaka::Vector& shaka::Data::get<shaka::Vector>();
 template<> shaka::Bytevector& shaka::Data::get<shaka::Bytevector>();
+template<> shaka::HashTable& shaka::Data::get<shaka::HashTable>();
+template<> shaka::Ephemeron& shaka::Data::get<shaka::Ephemeron>();
+template<> shaka::Port& shaka::Data::get<shaka::Port>();
 
 std::ostream& operator<<(std::ostream& lhs, shaka::Data rhs);
 
@@ -194,6 +227,13 @@ std::ostream& operator<<(std::ostream& lhs, shaka::Data rhs);
  */
 NodePtr create_unspecified();
 
+/**
+ * @brief A method to create the end-of-file object, returned by the input
+ * procedures at the end of a port.
+ * @return A new allocated node that represents the end-of-file object.
+ */
+NodePtr create_eof_object();
+
 } // namespace shaka
 
 #endif //SHAKA_SCHEME_DATA_HPP
@@ -14,13 +14,6 @@ std::shared_ptr<Data> create_node_shared_ptr(const Data& data) {
   return std::make_shared<Data>(data);
 }
 
-std::function<gc::GCNode(const Data&)> create_node;
-/* =
-    [](const Data& data) {
-      return create_node_shared_ptr(data);
-    };
-*/
-
 void swap (shaka::DataPair& lhs, shaka::DataPair& rhs) {
   using std::swap;
 
@@ -51,8 +44,8 @@ shaka::DataPair::DataPair(NodePtr left_node, NodePtr right_node) :
   right(right_node) {}
 
 shaka::DataPair::DataPair(const DataPair& other) :
-  left(create_node(*other.left)),
-  right(create_node(*other.right)) {}
+  left(other.left),
+  right(other.right) {}
 
 shaka::DataPair::DataPair(DataPair&& other) :
   left(std::move(other.left)),
@@ -30,7 +30,14 @@ using NodePtr = gc::GCNode;
  */
 std::shared_ptr<Data> create_node_shared_ptr(const Data& data);
 
-extern std::function<NodePtr(const Data&)> create_node;
+/**
+ * @brief Allocates a copy of data in the heap of the calling thread. Each OS
+ * thread binds its own heap with gc::init_create_node, so that separate
+ * HeapVirtualMachine instances can run in parallel without sharing a GC.
+ * @note The functions in gc/make_node.hpp build the Data in the heap
+ * directly, without the copy.
+ */
+NodePtr create_node(const Data& data);
 
 /**
  * @brief The data representation of a Scheme pair.
@@ -79,7 +86,8 @@ public:
   DataPair(NodePtr left_node, NodePtr right_node);
 
   /**
-   * @brief Copy constructor. Must copy all items by value, not reference.
+   * @brief Copy constructor. Copies the references to the car and cdr, so
+   * the new pair shares them with the old one, as in (cons (car p) (cdr p)).
    * @param other The object to copy.
    */
   DataPair(const DataPair& other);
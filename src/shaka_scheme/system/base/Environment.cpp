@@ -82,6 +82,10 @@ const std::map<Key, Value>& Environment::get_bindings() const {
   return local;
 }
 
+const Environment* Environment::get_parent_environment() const {
+  return dynamic_cast<const Environment*>(parent.get());
+}
+
 bool operator==(const Environment& lhs, const Environment& rhs) {
   return lhs.local == rhs.local && lhs.parent == rhs.parent;
 }
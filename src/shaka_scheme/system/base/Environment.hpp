@@ -97,6 +97,14 @@ public:
    */
   const std::map<Key, Value>& get_bindings() const;
 
+  /**
+   * @brief Gets the parent environment without going through IEnvironment,
+   *        so that it can be reached from a const Environment.
+   * @return The parent, or nullptr if there is none or it is not an
+   *         Environment
+   */
+  const Environment* get_parent_environment() const;
+
   friend bool operator==(const shaka::Environment&, const shaka::Environment&);
 
   friend bool operator!=(const shaka::Environment&, const shaka::Environment&);
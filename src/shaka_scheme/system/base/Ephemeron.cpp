@@ -0,0 +1,28 @@
+#include "shaka_scheme/system/base/Ephemeron.hpp"
+
+namespace shaka {
+
+Ephemeron::Ephemeron(NodePtr key, NodePtr datum) :
+    key(key),
+    datum(datum),
+    broken(false) {}
+
+NodePtr Ephemeron::get_key() const {
+  return key;
+}
+
+NodePtr Ephemeron::get_datum() const {
+  return datum;
+}
+
+bool Ephemeron::is_broken() const {
+  return broken;
+}
+
+void Ephemeron::set_broken() {
+  key = NodePtr();
+  datum = NodePtr();
+  broken = true;
+}
+
+} // namespace shaka
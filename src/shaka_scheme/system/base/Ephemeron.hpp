@@ -0,0 +1,61 @@
+#ifndef SHAKA_SCHEME_EPHEMERON_HPP
+#define SHAKA_SCHEME_EPHEMERON_HPP
+
+#include <shaka_scheme/system/gc/GCNode.hpp>
+
+namespace shaka {
+
+class Data;
+
+//using NodePtr = std::shared_ptr<Data>;
+using NodePtr = gc::GCNode;
+
+/**
+ * @brief A weak pair of a key and a datum, as in SRFI 124.
+ *
+ * The collector marks the datum only if the key is reachable from
+ * somewhere other than the ephemeron itself, so a datum that refers back
+ * to its own key does not keep the key alive. Once the key is collected,
+ * the ephemeron is broken: both references are dropped.
+ */
+class Ephemeron {
+public:
+  /**
+   * @brief Constructs an unbroken ephemeron.
+   * @param key The object whose liveness decides the ephemeron.
+   * @param datum The object kept alive for as long as the key is.
+   */
+  Ephemeron(NodePtr key, NodePtr datum);
+
+  /**
+   * @brief Gets the key.
+   * @return The key, or a null NodePtr once the ephemeron is broken.
+   */
+  NodePtr get_key() const;
+
+  /**
+   * @brief Gets the datum.
+   * @return The datum, or a null NodePtr once the ephemeron is broken.
+   */
+  NodePtr get_datum() const;
+
+  /**
+   * @brief Determines whether the key has been collected.
+   */
+  bool is_broken() const;
+
+  /**
+   * @brief Drops the key and the datum. Called by the collector when the
+   * key was not marked.
+   */
+  void set_broken();
+
+private:
+  NodePtr key;
+  NodePtr datum;
+  bool broken;
+};
+
+} // namespace shaka
+
+#endif //SHAKA_SCHEME_EPHEMERON_HPP
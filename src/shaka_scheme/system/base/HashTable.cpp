@@ -0,0 +1,317 @@
+#include "shaka_scheme/system/base/HashTable.hpp"
+#include "shaka_scheme/system/base/Data.hpp"
+#include "shaka_scheme/system/core/types.hpp"
+
+#include <cstring>
+#include <functional>
+
+namespace shaka {
+
+namespace {
+
+// The finalizer of splitmix64, which spreads every input bit over the word
+std::size_t mix(std::uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return static_cast<std::size_t>(x);
+}
+
+std::size_t combine(std::size_t seed, std::size_t value) {
+  return mix(seed * 31 + value);
+}
+
+std::size_t hash_number(const Number& number) {
+  std::size_t tag = static_cast<std::size_t>(number.get_type());
+  switch (number.get_type()) {
+  case Number::NumberType::INTEGER:
+    return combine(tag, static_cast<std::size_t>(
+        number.get<Integer>().get_value()));
+  case Number::NumberType::RATIONAL: {
+    Rational r = number.get<Rational>();
+    return combine(combine(tag, static_cast<std::size_t>(
+        r.get_numerator())), static_cast<std::size_t>(r.get_denominator()));
+  }
+  default: {
+    double value = number.get<Real>().get_value();
+    // 0.0 and -0.0 compare equal, so they must hash alike
+    if (value == 0.0) {
+      value = 0.0;
+    }
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return combine(tag, bits);
+  }
+  }
+}
+
+std::size_t hash_address(const NodePtr& node) {
+  return mix(reinterpret_cast<std::uintptr_t>(node.get()));
+}
+
+/**
+ * @brief Hashes the objects that eqv? compares by value, and everything
+ * else by address.
+ */
+std::size_t hash_eqv(const NodePtr& node) {
+  std::size_t tag = static_cast<std::size_t>(node->get_type()) + 2;
+  switch (node->get_type()) {
+  case Data::Type::BOOLEAN:
+    return combine(tag, node->get<Boolean>().get_value());
+  case Data::Type::SYMBOL:
+    return combine(tag, std::hash<std::string>()(
+        node->get<Symbol>().get_value()));
+  case Data::Type::NUMBER:
+    return hash_number(node->get<Number>());
+  case Data::Type::STRING:
+    return combine(tag, std::hash<std::string>()(
+        node->get<String>().get_string()));
+  case Data::Type::NULL_LIST:
+  case Data::Type::UNSPECIFIED:
+  case Data::Type::EOF_OBJECT:
+    return mix(tag);
+  default:
+    return hash_address(node);
+  }
+}
+
+/**
+ * @brief Hashes pairs, vectors and bytevectors by content, visiting at most
+ * budget objects.
+ */
+std::size_t hash_equal(const NodePtr& node, std::size_t& budget) {
+  if (budget == 0) {
+    return 0;
+  }
+  --budget;
+  std::size_t tag = static_cast<std::size_t>(node->get_type()) + 2;
+  switch (node->get_type()) {
+  case Data::Type::DATA_PAIR: {
+    DataPair& pair = node->get<DataPair>();
+    std::size_t car_hash = hash_equal(pair.car(), budget);
+    return combine(combine(tag, car_hash), hash_equal(pair.cdr(), budget));
+  }
+  case Data::Type::VECTOR: {
+    Vector& vector = node->get<Vector>();
+    std::size_t result = combine(tag, vector.length());
+    for (std::size_t i = 0; i < vector.length() && budget > 0; ++i) {
+      result = combine(result, hash_equal(vector[i], budget));
+    }
+    return result;
+  }
+  case Data::Type::BYTEVECTOR: {
+    Bytevector& bytes = node->get<Bytevector>();
+    std::size_t result = combine(tag, bytes.length());
+    for (std::size_t i = 0; i < bytes.length(); ++i) {
+      result = combine(result, bytes[i]);
+    }
+    return result;
+  }
+  default:
+    return hash_eqv(node);
+  }
+}
+
+/**
+ * @brief Compares like eqv?. Objects that eqv? does not know about are
+ * compared by identity.
+ */
+bool equivalent_eqv(const NodePtr& lhs, const NodePtr& rhs) {
+  if (lhs == rhs) {
+    return true;
+  }
+  if (lhs->get_type() != rhs->get_type()) {
+    return false;
+  }
+  switch (lhs->get_type()) {
+  case Data::Type::BOOLEAN:
+    return lhs->get<Boolean>() == rhs->get<Boolean>();
+  case Data::Type::SYMBOL:
+    return lhs->get<Symbol>() == rhs->get<Symbol>();
+  case Data::Type::NUMBER: {
+    const Number& a = lhs->get<Number>();
+    const Number& b = rhs->get<Number>();
+    return a.get_type() == b.get_type() && a == b;
+  }
+  case Data::Type::STRING:
+    return lhs->get<String>() == rhs->get<String>();
+  case Data::Type::NULL_LIST:
+  case Data::Type::UNSPECIFIED:
+  case Data::Type::EOF_OBJECT:
+    return true;
+  default:
+    return lhs.get() == rhs.get();
+  }
+}
+
+} // namespace
+
+HashTable::HashTable(Equivalence equivalence, std::size_t capacity,
+                     bool weak) :
+    equivalence(equivalence),
+    weak(weak),
+    count(0) {
+  if (capacity > 0) {
+    rehash(capacity * 100 / max_load_percent + 1);
+  }
+}
+
+HashTable::Equivalence HashTable::get_equivalence() const {
+  return equivalence;
+}
+
+bool HashTable::is_weak() const {
+  return weak;
+}
+
+std::size_t HashTable::size() const {
+  return count;
+}
+
+NodePtr HashTable::get(const NodePtr& key) const {
+  std::size_t i = find(key, hash(key, equivalence));
+  return i == slots.size() ? NodePtr() : slots[i].value;
+}
+
+bool HashTable::contains(const NodePtr& key) const {
+  return find(key, hash(key, equivalence)) != slots.size();
+}
+
+void HashTable::set(const NodePtr& key, const NodePtr& value) {
+  std::size_t key_hash = hash(key, equivalence);
+  std::size_t i = find(key, key_hash);
+  if (i != slots.size()) {
+    slots[i].value = value;
+    return;
+  }
+  if ((count + 1) * 100 > slots.size() * max_load_percent) {
+    rehash(slots.empty() ? 8 : slots.size() * 2);
+  }
+  Slot slot;
+  slot.key = key;
+  slot.value = value;
+  slot.hash = key_hash;
+  insert(std::move(slot));
+  ++count;
+}
+
+bool HashTable::remove(const NodePtr& key) {
+  std::size_t i = find(key, hash(key, equivalence));
+  if (i == slots.size()) {
+    return false;
+  }
+  // Shift the following entries back until one is in its home slot
+  std::size_t mask = slots.size() - 1;
+  std::size_t next = (i + 1) & mask;
+  while (slots[next].distance > 1) {
+    slots[i] = std::move(slots[next]);
+    --slots[i].distance;
+    i = next;
+    next = (next + 1) & mask;
+  }
+  slots[i] = Slot();
+  --count;
+  return true;
+}
+
+void HashTable::clear() {
+  for (Slot& slot : slots) {
+    slot = Slot();
+  }
+  count = 0;
+}
+
+std::size_t HashTable::remove_if(
+    const std::function<bool(const NodePtr&)>& predicate) {
+  std::size_t removed = 0;
+  for (Slot& slot : slots) {
+    if (slot.distance != 0 && predicate(slot.key)) {
+      slot = Slot();
+      ++removed;
+    }
+  }
+  if (removed > 0) {
+    // Reinsert the survivors, since the holes break their probe sequences
+    count -= removed;
+    rehash(slots.size());
+  }
+  return removed;
+}
+
+std::vector<std::pair<NodePtr, NodePtr>> HashTable::entries() const {
+  std::vector<std::pair<NodePtr, NodePtr>> result;
+  result.reserve(count);
+  for (const Slot& slot : slots) {
+    if (slot.distance != 0) {
+      result.emplace_back(slot.key, slot.value);
+    }
+  }
+  return result;
+}
+
+std::size_t HashTable::hash(const NodePtr& node, Equivalence equivalence) {
+  if (equivalence == Equivalence::EQUAL) {
+    std::size_t budget = equal_hash_budget;
+    return hash_equal(node, budget);
+  }
+  return hash_eqv(node);
+}
+
+bool HashTable::equivalent(const NodePtr& lhs, const NodePtr& rhs,
+                           Equivalence equivalence) {
+  if (equivalence == Equivalence::EQUAL) {
+    return core::equal(lhs, rhs);
+  }
+  return equivalent_eqv(lhs, rhs);
+}
+
+std::size_t HashTable::find(const NodePtr& key, std::size_t key_hash) const {
+  if (slots.empty()) {
+    return slots.size();
+  }
+  std::size_t mask = slots.size() - 1;
+  std::size_t i = key_hash & mask;
+  // An entry closer to its home than the probe ends the search, since the
+  // key would have displaced it
+  for (std::uint32_t distance = 1; distance <= slots[i].distance;
+       ++distance) {
+    if (slots[i].hash == key_hash &&
+        equivalent(slots[i].key, key, equivalence)) {
+      return i;
+    }
+    i = (i + 1) & mask;
+  }
+  return slots.size();
+}
+
+void HashTable::insert(Slot slot) {
+  std::size_t mask = slots.size() - 1;
+  std::size_t i = slot.hash & mask;
+  slot.distance = 1;
+  while (slots[i].distance != 0) {
+    if (slots[i].distance < slot.distance) {
+      std::swap(slots[i], slot);
+    }
+    i = (i + 1) & mask;
+    ++slot.distance;
+  }
+  slots[i] = std::move(slot);
+}
+
+void HashTable::rehash(std::size_t capacity) {
+  std::size_t size = 8;
+  while (size < capacity) {
+    size *= 2;
+  }
+  std::vector<Slot> old(size);
+  std::swap(old, slots);
+  for (Slot& slot : old) {
+    if (slot.distance != 0) {
+      insert(std::move(slot));
+    }
+  }
+}
+
+} // namespace shaka
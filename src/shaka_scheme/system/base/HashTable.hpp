@@ -0,0 +1,180 @@
+#ifndef SHAKA_SCHEME_HASHTABLE_HPP
+#define SHAKA_SCHEME_HASHTABLE_HPP
+
+#include <shaka_scheme/system/gc/GCNode.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace shaka {
+
+class Data;
+
+//using NodePtr = std::shared_ptr<Data>;
+using NodePtr = gc::GCNode;
+
+/**
+ * @brief A mutable hash table from Scheme objects to Scheme objects.
+ *
+ * The table uses open addressing with Robin Hood probing: an entry that is
+ * further from its home slot takes the place of one that is closer, which
+ * keeps every probe sequence short even at high load. Deletion shifts the
+ * following entries back instead of leaving tombstones. The capacity is a
+ * power of two and grows once the table is max_load_percent full.
+ *
+ * Keys are compared with eq?, eqv? or equal?, and hashed to match:
+ * - eq? and eqv? tables hash objects with identity, such as pairs, vectors
+ *   and procedures, by their address. The collector never moves objects,
+ *   and a key is freed only after the table drops it, so the address of a
+ *   key is stable for as long as the key is in the table. Symbols,
+ *   numbers, strings and booleans hash by value, as eq? and eqv? compare
+ *   them by value.
+ * - equal? tables hash pairs and vectors by their contents. Only the first
+ *   equal_hash_budget objects of a structure are visited, so cyclic
+ *   structures still hash in bounded time.
+ *
+ * A weak table holds its entries like ephemerons: the collector marks a
+ * value only if its key is reachable from outside the table, and removes
+ * the entries whose keys were not marked.
+ */
+class HashTable {
+public:
+  /**
+   * @brief The equivalence predicate used to compare keys.
+   */
+  enum class Equivalence : int {
+    EQ,
+    EQV,
+    EQUAL
+  };
+
+  /**
+   * @brief The percentage of slots that may be full before the table grows.
+   */
+  static const std::size_t max_load_percent = 80;
+
+  /**
+   * @brief The number of objects equal_hash visits in one structure.
+   */
+  static const std::size_t equal_hash_budget = 64;
+
+  /**
+   * @brief Constructs an empty table.
+   * @param equivalence The predicate used to compare keys.
+   * @param capacity The number of entries to make room for up front.
+   * @param weak Whether the keys are held weakly.
+   */
+  explicit HashTable(Equivalence equivalence = Equivalence::EQUAL,
+                     std::size_t capacity = 0,
+                     bool weak = false);
+
+  /**
+   * @brief Gets the predicate used to compare keys.
+   */
+  Equivalence get_equivalence() const;
+
+  /**
+   * @brief Determines whether the keys are held weakly.
+   */
+  bool is_weak() const;
+
+  /**
+   * @brief Gets the number of entries in the table.
+   */
+  std::size_t size() const;
+
+  /**
+   * @brief Looks up the value of a key.
+   * @param key The key to find.
+   * @return The value, or a null NodePtr if the key is not in the table.
+   */
+  NodePtr get(const NodePtr& key) const;
+
+  /**
+   * @brief Determines whether a key is in the table.
+   */
+  bool contains(const NodePtr& key) const;
+
+  /**
+   * @brief Sets the value of a key, adding the key if it is not present.
+   */
+  void set(const NodePtr& key, const NodePtr& value);
+
+  /**
+   * @brief Removes a key from the table.
+   * @return true if the key was present.
+   */
+  bool remove(const NodePtr& key);
+
+  /**
+   * @brief Removes every entry from the table.
+   */
+  void clear();
+
+  /**
+   * @brief Removes every entry whose key satisfies a predicate.
+   * @param predicate Called once with every key.
+   * @return The number of entries removed.
+   */
+  std::size_t remove_if(const std::function<bool(const NodePtr&)>& predicate);
+
+  /**
+   * @brief Gets every entry of the table, in no particular order.
+   * @return The (key, value) pairs.
+   */
+  std::vector<std::pair<NodePtr, NodePtr>> entries() const;
+
+  /**
+   * @brief Hashes an object to match an equivalence predicate.
+   * @param node The object to hash.
+   * @param equivalence The predicate the hash must agree with.
+   * @return A hash such that equivalent objects hash alike.
+   */
+  static std::size_t hash(const NodePtr& node, Equivalence equivalence);
+
+  /**
+   * @brief Compares two objects with an equivalence predicate.
+   */
+  static bool equivalent(const NodePtr& lhs, const NodePtr& rhs,
+                         Equivalence equivalence);
+
+private:
+  /**
+   * @brief One slot of the table. A distance of zero marks an empty slot;
+   * otherwise the entry sits distance - 1 slots after its home slot.
+   */
+  struct Slot {
+    NodePtr key;
+    NodePtr value;
+    std::size_t hash = 0;
+    std::uint32_t distance = 0;
+  };
+
+  /**
+   * @brief Finds the slot holding a key.
+   * @return The index of the slot, or slots.size() if the key is absent.
+   */
+  std::size_t find(const NodePtr& key, std::size_t key_hash) const;
+
+  /**
+   * @brief Places an entry whose key is known not to be in the table.
+   */
+  void insert(Slot slot);
+
+  /**
+   * @brief Reallocates the slots and reinserts every entry.
+   */
+  void rehash(std::size_t capacity);
+
+  Equivalence equivalence;
+  bool weak;
+  std::size_t count;
+  std::vector<Slot> slots;
+};
+
+} // namespace shaka
+
+#endif //SHAKA_SCHEME_HASHTABLE_HPP
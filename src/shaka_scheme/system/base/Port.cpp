@@ -0,0 +1,408 @@
+#include "shaka_scheme/system/base/Port.hpp"
+#include "shaka_scheme/system/exceptions/InvalidInputException.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace shaka {
+
+struct Port::State {
+  State(Direction direction, bool binary) :
+      direction(direction),
+      binary(binary),
+      open(true),
+      fd(-1),
+      seekable(false),
+      offset(0),
+      stream(nullptr),
+      position(0) {}
+
+  ~State() {
+    try {
+      close();
+    } catch (const InvalidInputException&) {
+      // Output that cannot be written out is lost with the last handle
+    }
+  }
+
+  bool is_memory() const {
+    return fd < 0 && stream == nullptr;
+  }
+
+  void close() {
+    if (!open) {
+      return;
+    }
+    open = false;
+    if (direction == Direction::OUTPUT && !is_memory()) {
+      drain();
+    }
+    if (fd >= 0) {
+      ::close(fd);
+      fd = -1;
+    }
+    if (direction == Direction::INPUT) {
+      std::string().swap(buffer);
+      position = 0;
+    }
+  }
+
+  /**
+   * @brief Writes the buffered output of a file port out to its file.
+   */
+  void drain() {
+    if (fd >= 0 && !buffer.empty()) {
+      write_out(buffer.data(), buffer.size());
+      buffer.clear();
+    }
+  }
+
+  void write_out(const char* data, std::size_t size) {
+    while (size > 0) {
+      ssize_t written = seekable ?
+          ::pwrite(fd, data, size, static_cast<off_t>(offset)) :
+          ::write(fd, data, size);
+      if (written < 0 && errno == EINTR) {
+        continue;
+      }
+      if (written <= 0) {
+        throw InvalidInputException(10076, std::string("port: write failed: ")
+            + std::strerror(errno));
+      }
+      data += written;
+      size -= static_cast<std::size_t>(written);
+      offset += static_cast<std::size_t>(written);
+    }
+  }
+
+  /**
+   * @brief Reads from the file or console into destination.
+   * @return The number of bytes read, 0 at the end of the input
+   */
+  std::size_t read_in(char* destination, std::size_t size) {
+    if (stream != nullptr) {
+      // A line at a time, so that an interactive read does not wait for
+      // more than the user has typed
+      std::size_t count = 0;
+      while (count < size) {
+        int c = stream->sbumpc();
+        if (c == std::char_traits<char>::eof()) {
+          break;
+        }
+        destination[count++] = static_cast<char>(c);
+        if (c == '\n') {
+          break;
+        }
+      }
+      return count;
+    }
+    while (true) {
+      ssize_t count = seekable ?
+          ::pread(fd, destination, size, static_cast<off_t>(offset)) :
+          ::read(fd, destination, size);
+      if (count < 0 && errno == EINTR) {
+        continue;
+      }
+      if (count < 0) {
+        throw InvalidInputException(10076, std::string("port: read failed: ")
+            + std::strerror(errno));
+      }
+      offset += static_cast<std::size_t>(count);
+      return static_cast<std::size_t>(count);
+    }
+  }
+
+  /**
+   * @brief Replaces the consumed input buffer with the next block.
+   * @return false at the end of the input
+   */
+  bool fill() {
+    if (is_memory()) {
+      return false;
+    }
+    buffer.resize(buffer_size);
+    buffer.resize(read_in(&buffer[0], buffer_size));
+    position = 0;
+    return !buffer.empty();
+  }
+
+  std::size_t available() const {
+    return buffer.size() - position;
+  }
+
+  Direction direction;
+  bool binary;
+  bool open;
+  int fd;
+  // Whether fd is read and written at offset, rather than at the position
+  // of the descriptor, as for pipes
+  bool seekable;
+  // The position in the file of the end of the input buffer, or of the start
+  // of the output buffer
+  std::uint64_t offset;
+  std::streambuf* stream;
+  // The pending output, or the input with the first position bytes consumed
+  std::string buffer;
+  std::size_t position;
+};
+
+Port::Port(std::shared_ptr<State> state) :
+    state(state) {}
+
+Port Port::open_file(const std::string& path, Direction direction,
+                     bool binary) {
+  int flags = direction == Direction::INPUT ?
+      O_RDONLY : O_WRONLY | O_CREAT | O_TRUNC;
+  int fd = ::open(path.c_str(), flags | O_CLOEXEC, 0666);
+  if (fd < 0) {
+    throw InvalidInputException(10073, "port: could not open " + path +
+        ": " + std::strerror(errno));
+  }
+  std::shared_ptr<State> state = std::make_shared<State>(direction, binary);
+  state->fd = fd;
+  state->seekable = ::lseek(fd, 0, SEEK_CUR) >= 0;
+  if (direction == Direction::OUTPUT) {
+    state->buffer.reserve(buffer_size);
+  }
+  return Port(state);
+}
+
+Port Port::open_input_memory(const std::string& contents, bool binary) {
+  std::shared_ptr<State> state =
+      std::make_shared<State>(Direction::INPUT, binary);
+  state->buffer = contents;
+  return Port(state);
+}
+
+Port Port::open_output_memory(bool binary) {
+  return Port(std::make_shared<State>(Direction::OUTPUT, binary));
+}
+
+Port Port::open_console(std::streambuf* stream, Direction direction) {
+  std::shared_ptr<State> state = std::make_shared<State>(direction, false);
+  state->stream = stream;
+  return Port(state);
+}
+
+bool Port::is_input() const {
+  return state->direction == Direction::INPUT;
+}
+
+bool Port::is_output() const {
+  return state->direction == Direction::OUTPUT;
+}
+
+bool Port::is_binary() const {
+  return state->binary;
+}
+
+bool Port::is_open() const {
+  return state->open;
+}
+
+void Port::close() {
+  state->close();
+}
+
+void Port::write(const char* data, std::size_t size) {
+  State& s = get_open_state(Direction::OUTPUT);
+  if (s.stream != nullptr) {
+    if (s.stream->sputn(data, size) != static_cast<std::streamsize>(size)) {
+      throw InvalidInputException(10076, "port: write failed");
+    }
+  } else if (s.is_memory()) {
+    s.buffer.append(data, size);
+  } else {
+    if (s.buffer.size() + size > buffer_size) {
+      s.drain();
+    }
+    if (size >= buffer_size) {
+      s.write_out(data, size);
+    } else {
+      s.buffer.append(data, size);
+    }
+  }
+}
+
+void Port::write(const std::string& data) {
+  write(data.data(), data.size());
+}
+
+void Port::write_byte(unsigned char byte) {
+  char c = static_cast<char>(byte);
+  write(&c, 1);
+}
+
+void Port::flush() {
+  State& s = get_open_state(Direction::OUTPUT);
+  if (s.stream != nullptr) {
+    s.stream->pubsync();
+  } else {
+    s.drain();
+  }
+}
+
+std::string Port::get_output() const {
+  if (!is_output() || !state->is_memory()) {
+    throw InvalidInputException(10075,
+                                "port: not a string or bytevector output port");
+  }
+  return state->buffer;
+}
+
+int Port::read_byte() {
+  State& s = get_open_state(Direction::INPUT);
+  if (s.available() == 0 && !s.fill()) {
+    return -1;
+  }
+  return static_cast<unsigned char>(s.buffer[s.position++]);
+}
+
+int Port::peek_byte() {
+  State& s = get_open_state(Direction::INPUT);
+  if (s.available() == 0 && !s.fill()) {
+    return -1;
+  }
+  return static_cast<unsigned char>(s.buffer[s.position]);
+}
+
+std::size_t Port::read(char* destination, std::size_t size) {
+  State& s = get_open_state(Direction::INPUT);
+  std::size_t count = 0;
+  while (count < size) {
+    if (s.available() == 0) {
+      // Large reads from a file skip the buffer
+      if (s.fd >= 0 && size - count >= buffer_size) {
+        std::size_t read = s.read_in(destination + count, size - count);
+        if (read == 0) {
+          break;
+        }
+        count += read;
+        continue;
+      }
+      if (!s.fill()) {
+        break;
+      }
+    }
+    std::size_t chunk = std::min(s.available(), size - count);
+    std::memcpy(destination + count, s.buffer.data() + s.position, chunk);
+    s.position += chunk;
+    count += chunk;
+  }
+  return count;
+}
+
+bool Port::read_line(std::string& line) {
+  State& s = get_open_state(Direction::INPUT);
+  line.clear();
+  bool found = false;
+  while (s.available() > 0 || s.fill()) {
+    found = true;
+    const char* begin = s.buffer.data() + s.position;
+    const char* end = static_cast<const char*>(
+        std::memchr(begin, '\n', s.available()));
+    if (end != nullptr) {
+      line.append(begin, end);
+      s.position += end - begin + 1;
+      if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+      }
+      return true;
+    }
+    line.append(begin, s.available());
+    s.position = s.buffer.size();
+  }
+  return found;
+}
+
+std::size_t Port::read_buffered(char* destination, std::size_t size) {
+  State& s = get_open_state(Direction::INPUT);
+  std::size_t count = std::min(s.available(), size);
+  std::memcpy(destination, s.buffer.data() + s.position, count);
+  s.position += count;
+  return count;
+}
+
+bool Port::reserve_file_range(Direction direction, std::size_t size,
+                              int& fd, std::uint64_t& offset) {
+  State& s = get_open_state(direction);
+  if (s.fd < 0 || !s.seekable) {
+    return false;
+  }
+  if (direction == Direction::OUTPUT) {
+    // Buffered output lands before the reserved range
+    s.drain();
+  }
+  fd = s.fd;
+  offset = s.offset;
+  s.offset += size;
+  return true;
+}
+
+void Port::truncate_file_offset(std::uint64_t offset) {
+  state->offset = std::min(state->offset, offset);
+}
+
+bool Port::is_ready() {
+  State& s = get_open_state(Direction::INPUT);
+  if (s.available() > 0 || s.is_memory()) {
+    return true;
+  }
+  if (s.stream != nullptr) {
+    return s.stream->in_avail() != 0;
+  }
+  pollfd descriptor = {s.fd, POLLIN, 0};
+  return ::poll(&descriptor, 1, 0) != 0;
+}
+
+int Port::get_wait_descriptor(std::size_t count, bool line) {
+  State& s = get_open_state(Direction::INPUT);
+  if (s.fd < 0 || s.seekable) {
+    return -1;
+  }
+  while (line ? std::memchr(s.buffer.data() + s.position, '\n',
+                            s.available()) == nullptr :
+                s.available() < count) {
+    pollfd descriptor = {s.fd, POLLIN, 0};
+    if (::poll(&descriptor, 1, 0) == 0) {
+      return s.fd;
+    }
+    // Keeps the unread input, with the next block after it
+    std::string block(buffer_size, '\0');
+    block.resize(s.read_in(&block[0], buffer_size));
+    if (block.empty()) {
+      return -1;
+    }
+    s.buffer.erase(0, s.position);
+    s.position = 0;
+    s.buffer += block;
+  }
+  return -1;
+}
+
+Port::State& Port::get_open_state(Direction direction) const {
+  if (state->direction != direction) {
+    throw InvalidInputException(10075, direction == Direction::INPUT ?
+        "port: not an input port" : "port: not an output port");
+  }
+  if (!state->open) {
+    throw InvalidInputException(10074, "port: the port is closed");
+  }
+  return *state;
+}
+
+bool operator==(const Port& lhs, const Port& rhs) {
+  return lhs.state == rhs.state;
+}
+
+bool operator!=(const Port& lhs, const Port& rhs) {
+  return !(lhs == rhs);
+}
+
+} // namespace shaka
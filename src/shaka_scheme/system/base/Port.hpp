@@ -0,0 +1,181 @@
+#ifndef SHAKA_SCHEME_PORT_HPP
+#define SHAKA_SCHEME_PORT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <streambuf>
+#include <string>
+
+namespace shaka {
+
+/**
+ * @brief An R7RS port: a buffered source or sink of bytes.
+ *
+ * A port reads from or writes to a file, an in-memory string or bytevector,
+ * or a console stream. File and console ports move data in blocks of
+ * buffer_size bytes, so reading a line or writing a string costs one copy
+ * into the buffer rather than a call into the system per character. Output
+ * reaches its file only when the buffer fills, on flush() or on close().
+ *
+ * A Port is a handle: copies refer to the same port, which is flushed and
+ * closed once the last copy is destroyed.
+ */
+class Port {
+public:
+  enum class Direction {
+    INPUT,
+    OUTPUT
+  };
+
+  /**
+   * @brief The size of the buffer of file and console ports.
+   */
+  static const std::size_t buffer_size = 65536;
+
+  /**
+   * @brief Opens a file port.
+   * @param path The file to open. An output file is created or truncated.
+   * @param direction Whether to read or write the file
+   * @param binary Whether the port is binary rather than textual
+   * @throws InvalidInputException if the file cannot be opened
+   */
+  static Port open_file(const std::string& path, Direction direction,
+                        bool binary);
+
+  /**
+   * @brief Makes an input port that reads the bytes of contents.
+   * @param binary Whether this is a bytevector port rather than a string port
+   */
+  static Port open_input_memory(const std::string& contents, bool binary);
+
+  /**
+   * @brief Makes an output port that accumulates what is written to it, to
+   * be taken with get_output().
+   * @param binary Whether this is a bytevector port rather than a string port
+   */
+  static Port open_output_memory(bool binary);
+
+  /**
+   * @brief Makes a textual port over a stream buffer, such as the one of
+   * std::cout. The stream buffer is not owned.
+   *
+   * An output console port hands every write to the stream buffer, which
+   * does its own buffering, so that its output stays in order with other
+   * writes to the same stream.
+   */
+  static Port open_console(std::streambuf* stream, Direction direction);
+
+  bool is_input() const;
+  bool is_output() const;
+  bool is_binary() const;
+  bool is_open() const;
+
+  /**
+   * @brief Flushes an output port and releases its file. Closing a closed
+   * port does nothing.
+   */
+  void close();
+
+  /**
+   * @brief Writes size bytes of data.
+   * @throws InvalidInputException if the port is closed, is not an output
+   * port, or the data cannot be written out
+   */
+  void write(const char* data, std::size_t size);
+  void write(const std::string& data);
+  void write_byte(unsigned char byte);
+
+  /**
+   * @brief Writes out the buffered output of a file or console port.
+   */
+  void flush();
+
+  /**
+   * @brief Gets everything written to a memory output port so far.
+   */
+  std::string get_output() const;
+
+  /**
+   * @brief Reads one byte.
+   * @return The byte, or -1 at the end of the input
+   */
+  int read_byte();
+
+  /**
+   * @brief Gets the next byte without consuming it.
+   * @return The byte, or -1 at the end of the input
+   */
+  int peek_byte();
+
+  /**
+   * @brief Reads up to size bytes into destination, stopping early only at
+   * the end of the input.
+   * @return The number of bytes read
+   */
+  std::size_t read(char* destination, std::size_t size);
+
+  /**
+   * @brief Reads up to the next line feed, which is consumed but not stored.
+   * A carriage return before it is dropped too.
+   * @param line Replaced by the line
+   * @return false if the input was already at its end
+   */
+  bool read_line(std::string& line);
+
+  /**
+   * @brief Determines whether a read would not block.
+   */
+  bool is_ready();
+
+  /**
+   * @brief Reads what a pipe has ready into the input buffer, until the
+   * buffer holds count bytes, or a whole line if line is true.
+   * @return The file descriptor to wait on before a read of that much would
+   * not block, or -1 if it would not block now: on memory, console and
+   * regular file ports, and at the end of the input
+   */
+  int get_wait_descriptor(std::size_t count, bool line);
+
+  /**
+   * @brief Reads up to size bytes that are already in the input buffer,
+   * without reading from the file.
+   * @return The number of bytes read
+   */
+  std::size_t read_buffered(char* destination, std::size_t size);
+
+  /**
+   * @brief Reserves the next size bytes of a file port for a read or write
+   * done outside of the port, such as an asynchronous one. The port moves
+   * past them, so the reads and writes that follow, buffered or reserved,
+   * go after them. Buffered output is written out first.
+   * @param fd Set to the file descriptor of the port
+   * @param offset Set to the position of the range in the file
+   * @return false if this is not a file port that can be read or written at
+   * a given position
+   */
+  bool reserve_file_range(Direction direction, std::size_t size, int& fd,
+                          std::uint64_t& offset);
+
+  /**
+   * @brief Moves a file port back to offset if it is past it, as after a
+   * reserved read came up short at the end of the file.
+   */
+  void truncate_file_offset(std::uint64_t offset);
+
+  friend bool operator==(const Port& lhs, const Port& rhs);
+  friend bool operator!=(const Port& lhs, const Port& rhs);
+
+private:
+  struct State;
+
+  explicit Port(std::shared_ptr<State> state);
+
+  State& get_open_state(Direction direction) const;
+
+  std::shared_ptr<State> state;
+};
+
+} // namespace shaka
+
+#endif //SHAKA_SCHEME_PORT_HPP
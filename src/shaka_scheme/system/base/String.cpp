@@ -1,9 +1,372 @@
 #include "shaka_scheme/system/base/String.hpp"
 
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
 namespace shaka {
 
+/**
+ * @brief A node of a rope: either a leaf holding characters, or the
+ * concatenation of two ropes. Nodes are never modified once built, except
+ * that flatten() caches the flat text in a concatenation and then lets go
+ * of its children, so the characters are not held twice. The children are
+ * therefore only read and cleared with the atomic shared_ptr functions.
+ */
+struct String::Rope {
+  Rope(std::string leaf, Index leaf_index) :
+      bytes(leaf.size()),
+      chars(leaf_index.char_count),
+      concatenation(false),
+      leaf(std::move(leaf)),
+      leaf_index(std::move(leaf_index)) {}
+
+  Rope(std::shared_ptr<const Rope> left, std::shared_ptr<const Rope> right) :
+      bytes(left->bytes + right->bytes),
+      chars(left->chars + right->chars),
+      concatenation(true),
+      left(std::move(left)),
+      right(std::move(right)) {}
+
+  ~Rope();
+
+  const std::string& flatten() const;
+  const Index& flatten_index() const;
+
+  /**
+   * @brief Gets the characters of a leaf, or of a concatenation that has
+   * already been flattened.
+   */
+  const std::string& text() const {
+    return concatenation ? flat : leaf;
+  }
+
+  std::size_t bytes;
+  std::size_t chars;
+  bool concatenation;
+  std::string leaf;
+  Index leaf_index;
+  mutable std::shared_ptr<const Rope> left;
+  mutable std::shared_ptr<const Rope> right;
+
+  mutable std::once_flag flattened;
+  mutable std::string flat;
+  mutable Index flat_index;
+};
+
+String::Rope::~Rope() {
+  // Ropes built by repeated appends are as deep as the number of appends,
+  // so release the children without recursing
+  std::vector<std::shared_ptr<const Rope>> pending;
+  pending.push_back(std::move(left));
+  pending.push_back(std::move(right));
+  while (!pending.empty()) {
+    std::shared_ptr<const Rope> node = std::move(pending.back());
+    pending.pop_back();
+    if (node && node.use_count() == 1) {
+      pending.push_back(std::move(node->left));
+      pending.push_back(std::move(node->right));
+    }
+  }
+}
+
+const std::string& String::Rope::flatten() const {
+  if (!concatenation) {
+    return leaf;
+  }
+  std::call_once(flattened, [this]() {
+    std::string text;
+    text.reserve(bytes);
+    std::vector<std::shared_ptr<const Rope>> pending{
+        std::atomic_load(&right), std::atomic_load(&left)};
+    while (!pending.empty()) {
+      std::shared_ptr<const Rope> node = std::move(pending.back());
+      pending.pop_back();
+      // The children are cleared left first, so right is loaded first: if
+      // it is still there, a left that is too was not cleared in between
+      std::shared_ptr<const Rope> node_right = std::atomic_load(&node->right);
+      std::shared_ptr<const Rope> node_left;
+      if (node_right) {
+        node_left = std::atomic_load(&node->left);
+      }
+      if (!node_left) {
+        // A leaf, or a concatenation some other rope already flattened
+        node->flatten();
+        text += node->text();
+      } else {
+        pending.push_back(std::move(node_right));
+        pending.push_back(std::move(node_left));
+      }
+    }
+    flat_index = make_index(text);
+    flat = std::move(text);
+    std::atomic_store(&left, std::shared_ptr<const Rope>());
+    std::atomic_store(&right, std::shared_ptr<const Rope>());
+  });
+  return flat;
+}
+
+const String::Index& String::Rope::flatten_index() const {
+  if (!concatenation) {
+    return leaf_index;
+  }
+  flatten();
+  return flat_index;
+}
+
+String::Index String::make_index(const std::string& text) {
+  Index result;
+  if (string_kernels::is_ascii(text.data(), text.size())) {
+    result.char_count = text.size();
+    return result;
+  }
+  result.ascii = false;
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < text.size();
+       i += string_kernels::sequence_length(text[i])) {
+    if (count % index_stride == 0) {
+      result.offsets.push_back(i);
+    }
+    ++count;
+  }
+  result.char_count = count;
+  return result;
+}
+
+String::String(std::string str) {
+  assign(std::move(str));
+}
+
+String::String(std::size_t size, char32_t c) {
+  std::string encoded;
+  string_kernels::encode_utf8(c, encoded);
+  std::string text;
+  text.reserve(size * encoded.size());
+  for (std::size_t i = 0; i < size; ++i) {
+    text += encoded;
+  }
+  assign(std::move(text));
+}
+
+String::String(String& c, std::size_t index) {
+  this->substring(c, index, c.length());
+}
+
+String::String(String& c, std::size_t index, std::size_t length) {
+  std::size_t end = std::min(c.length(), index + length);
+  this->substring(c, index, std::max(index, end));
+}
+
+std::size_t String::length() const {
+  return rope ? rope->chars : index.char_count;
+}
+
+std::size_t String::byte_length() const {
+  return rope ? rope->bytes : str.size();
+}
+
+bool String::is_ascii() const {
+  return length() == byte_length();
+}
+
+char32_t String::ref(std::size_t index) const {
+  if (index >= length()) {
+    throw std::out_of_range("String::ref: index out of range");
+  }
+  return string_kernels::decode_utf8(flat().data() + byte_offset(index));
+}
+
+void String::substring(const String& other, std::size_t start,
+                       std::size_t end) {
+  if (start > end) {
+    throw std::out_of_range("String::substring: start is after end");
+  }
+  std::size_t from = other.byte_offset(start);
+  std::size_t to = other.byte_offset(end);
+  assign(other.flat().substr(from, to - from));
+}
+
+void String::set(std::size_t index, char32_t c) {
+  if (index >= length()) {
+    throw std::out_of_range("String::set: index out of range");
+  }
+  make_flat();
+  if (this->index.ascii && c < 0x80) {
+    this->str[index] = static_cast<char>(c);
+    return;
+  }
+  // The new character may have a different width, so splice the bytes
+  splice(index, index + 1, c);
+}
+
+void String::fill(char32_t fill, std::size_t start, std::size_t end) {
+  if (start > end || end > length()) {
+    throw std::out_of_range("String::fill: range out of bounds");
+  }
+  make_flat();
+  if (this->index.ascii && fill < 0x80) {
+    std::fill(this->str.begin() + start, this->str.begin() + end,
+              static_cast<char>(fill));
+    return;
+  }
+  splice(start, end, fill);
+}
+
+void String::append(const String& other) {
+  if (this->byte_length() + other.byte_length() < rope_threshold) {
+    make_flat();
+    const Index& other_index = other.flat_index();
+    this->str += other.flat();
+    if (this->index.ascii && other_index.ascii) {
+      this->index.char_count += other_index.char_count;
+    } else {
+      this->index = make_index(this->str);
+    }
+    return;
+  }
+  if (this->rope && other.byte_length() < rope_threshold) {
+    // Extend the rightmost leaf rather than hanging another small leaf off
+    // the rope, so that appending characters one at a time does not build a
+    // node per character
+    std::shared_ptr<const Rope> left = std::atomic_load(&this->rope->left);
+    std::shared_ptr<const Rope> last = std::atomic_load(&this->rope->right);
+    if (left && last && !last->concatenation &&
+        last->bytes + other.byte_length() < rope_threshold) {
+      const Index& other_index = other.flat_index();
+      std::string text = last->leaf + other.flat();
+      Index text_index;
+      if (last->leaf_index.ascii && other_index.ascii) {
+        text_index.char_count = text.size();
+      } else {
+        text_index = make_index(text);
+      }
+      this->rope = std::make_shared<const Rope>(
+          std::move(left),
+          std::make_shared<const Rope>(std::move(text),
+                                       std::move(text_index)));
+      return;
+    }
+  }
+  // Take the right operand first, since other may be this string
+  std::shared_ptr<const Rope> right = other.rope ? other.rope :
+      std::make_shared<const Rope>(other.str, other.index);
+  std::shared_ptr<const Rope> left = this->rope ? this->rope :
+      std::make_shared<const Rope>(std::move(this->str),
+                                   std::move(this->index));
+  this->rope = std::make_shared<const Rope>(left, right);
+  this->str.clear();
+  this->index = Index();
+}
+
+std::size_t String::index_of(char32_t c) const {
+  const std::string& text = flat();
+  std::size_t k;
+  if (c < 0x80) {
+    k = string_kernels::find_char(text.data(), text.size(),
+                                  static_cast<char>(c));
+  } else {
+    std::string encoded;
+    string_kernels::encode_utf8(c, encoded);
+    k = string_kernels::find(text.data(), text.size(),
+                             encoded.data(), encoded.size());
+  }
+  if (k == string_kernels::npos || flat_index().ascii) {
+    return k;
+  }
+  return string_kernels::count_code_points(text.data(), k);
+}
+
+std::size_t String::find(const String& needle) const {
+  const std::string& text = flat();
+  const std::string& pattern = needle.flat();
+  std::size_t k = string_kernels::find(text.data(), text.size(),
+                                       pattern.data(), pattern.size());
+  if (k == string_kernels::npos || flat_index().ascii) {
+    return k;
+  }
+  return string_kernels::count_code_points(text.data(), k);
+}
+
+const std::string& String::flat() const {
+  return rope ? rope->flatten() : str;
+}
+
+const String::Index& String::flat_index() const {
+  return rope ? rope->flatten_index() : index;
+}
+
+std::size_t String::byte_offset(std::size_t char_index) const {
+  const Index& text_index = flat_index();
+  if (char_index > text_index.char_count) {
+    throw std::out_of_range("String: index out of range");
+  }
+  if (text_index.ascii) {
+    return char_index;
+  }
+  if (char_index == text_index.char_count) {
+    return flat().size();
+  }
+  // Start at the nearest indexed character and walk at most a stride
+  const std::string& text = flat();
+  std::size_t offset = text_index.offsets[char_index / index_stride];
+  for (std::size_t i = 0; i < char_index % index_stride; ++i) {
+    offset += string_kernels::sequence_length(text[offset]);
+  }
+  return offset;
+}
+
+void String::splice(std::size_t start, std::size_t end, char32_t c) {
+  // Surrogates and values past U+10FFFF have no UTF-8 encoding
+  if ((c >= 0xD800 && c <= 0xDFFF) || c > 0x10FFFF) {
+    c = 0xFFFD;
+  }
+  std::string encoded;
+  string_kernels::encode_utf8(c, encoded);
+  std::size_t from = byte_offset(start);
+  std::size_t to = byte_offset(end);
+  std::string replacement;
+  replacement.reserve((end - start) * encoded.size());
+  for (std::size_t i = start; i < end; ++i) {
+    replacement += encoded;
+  }
+  this->str.replace(from, to - from, replacement);
+  // Entries before start keep their offsets. Entries inside the range
+  // now point into the replacement, and entries after it move by the
+  // change in width.
+  Index& text_index = this->index;
+  if (text_index.ascii) {
+    text_index.ascii = false;
+    text_index.offsets.clear();
+    for (std::size_t i = 0; i < text_index.char_count; i += index_stride) {
+      text_index.offsets.push_back(i);
+    }
+  }
+  std::size_t k = (start + index_stride - 1) / index_stride;
+  for (; k < text_index.offsets.size() && k * index_stride < end; ++k) {
+    text_index.offsets[k] = from + (k * index_stride - start) * encoded.size();
+  }
+  for (; k < text_index.offsets.size(); ++k) {
+    text_index.offsets[k] = text_index.offsets[k] - (to - from) +
+        replacement.size();
+  }
+}
+
+void String::assign(std::string text) {
+  this->str = string_kernels::repair_utf8(std::move(text));
+  this->index = make_index(this->str);
+  this->rope.reset();
+}
+
+void String::make_flat() {
+  if (rope) {
+    str = rope->flatten();
+    index = rope->flatten_index();
+    rope.reset();
+  }
+}
+
 std::ostream& operator<<(std::ostream& lhs, const shaka::String& rhs) {
-  for (auto it : rhs.get_string()) {
+  for (auto it : rhs.flat()) {
     lhs << it;
   }
   return lhs;
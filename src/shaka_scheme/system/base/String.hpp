@@ -1,149 +1,337 @@
-#ifndef SHAKA_ASCII_STRING_H
-#define SHAKA_ASCII_STRING_H
+#ifndef SHAKA_SCHEME_STRING_HPP
+#define SHAKA_SCHEME_STRING_HPP
 
 #include <string>
 #include <vector>
 #include <iostream>
 #include <cctype>
 #include <algorithm>
+#include <iterator>
+#include <memory>
+
+#include "shaka_scheme/system/base/string_kernels.hpp"
 
 namespace shaka {
 
+/**
+ * @brief A mutable Scheme string of Unicode characters, stored as UTF-8.
+ *
+ * Indices and lengths count characters (code points), not bytes. Next to
+ * the bytes, every flat string keeps a sparse index: the byte offset of
+ * every index_stride-th character. Finding a character therefore takes one
+ * lookup and a bounded scan, and strings that are pure ASCII skip the
+ * index entirely. Invalid UTF-8 given to the constructor is replaced with
+ * U+FFFD.
+ *
+ * Short strings are held flat in a std::string, which stores them inline.
+ * Appending that produces a string of rope_threshold bytes or more
+ * builds a rope instead: an immutable tree that shares both operands, so
+ * repeated appends stay linear. A short string appended to a rope is merged
+ * into the rope's last leaf while that stays under rope_threshold bytes.
+ * The rope is flattened on the first access that needs the characters; the
+ * flat text replaces the children of the rope node, which is safe to do
+ * from several threads at once.
+ */
 class String {
 public:
+  /**
+   * @brief The length in bytes at which append starts building a rope
+   * instead of copying.
+   */
+  static const std::size_t rope_threshold = 256;
+
+  /**
+   * @brief The number of characters between two entries of the sparse
+   * index.
+   */
+  static const std::size_t index_stride = 64;
+
+  /**
+   * @brief Iterates over the characters of a string by walking the UTF-8
+   * bytes, so a full pass costs O(n) without any index lookups.
+   */
+  class const_iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = char32_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const char32_t*;
+    using reference = char32_t;
+
+    explicit const_iterator(const char* position) :
+        position(position) {}
+
+    char32_t operator*() const {
+      return string_kernels::decode_utf8(position);
+    }
+
+    const_iterator& operator++() {
+      position += string_kernels::sequence_length(*position);
+      return *this;
+    }
+
+    const_iterator operator++(int) {
+      const_iterator previous(*this);
+      ++(*this);
+      return previous;
+    }
+
+    friend bool operator==(const const_iterator& lhs,
+                           const const_iterator& rhs) {
+      return lhs.position == rhs.position;
+    }
+
+    friend bool operator!=(const const_iterator& lhs,
+                           const const_iterator& rhs) {
+      return lhs.position != rhs.position;
+    }
+
+  private:
+    const char* position;
+  };
+
   String() {}
 
-  // Construction from a std::string with iterators
-  String(std::string str) :
-      str(str) {}
+  // Construction from UTF-8 text in a std::string
+  String(std::string str);
 
   // make new string with length "size"
   String(std::size_t size) :
-      str(size, ' ') {}
+      str(size, ' ') {
+    index.char_count = size;
+  }
 
-  // Create string with size "size" and initialize with character "b""
-  String(std::size_t size, char b) :
-      str(size, b) {}
+  // Create string with size "size" and initialize with character "c"
+  String(std::size_t size, char32_t c);
 
-  //Makes a copy of a string
+  //Makes a copy of a string, sharing its rope if it has one
   String(const String& c) :
-      str(c.str) {}
+      str(c.str),
+      index(c.index),
+      rope(c.rope) {}
 
   String(String&& c) :
-      str(std::move(c.str)) {}
+      str(std::move(c.str)),
+      index(std::move(c.index)),
+      rope(std::move(c.rope)) {}
 
   // Copy and swap operator= assignment
   String& operator=(String rhs) {
-    this->str = rhs.str;
+    std::swap(this->str, rhs.str);
+    std::swap(this->index, rhs.index);
+    std::swap(this->rope, rhs.rope);
     return *this;
   }
 
   // Copy assignment with substring.
-  String(String& c, std::size_t index) :
-      str(c.str.substr(index, std::string::npos)) {
-  }
+  String(String& c, std::size_t index);
 
   // Makes a string out of part of another string
-  String(String& c, std::size_t index, std::size_t length) :
-      str(c.str.substr(index, length)) {}
+  String(String& c, std::size_t index, std::size_t length);
 
-  // return length of a_string
-  std::size_t length() const {
-    return str.size();
-  }
+  // return the number of characters in the string
+  std::size_t length() const;
 
-  // takes the index, and returns the value of the index
-  char ref(std::size_t index) const {
-    return str.at(index);
-  }
+  // return the number of bytes in the UTF-8 encoding of the string
+  std::size_t byte_length() const;
+
+  // takes the index, and returns the character at the index
+  char32_t ref(std::size_t index) const;
 
   // Set the internal string as another's shaka::String's substring
-  void substring(const String& other, std::size_t start, std::size_t end) {
-    this->str = other.str.substr(start, end-start);
-  }
+  void substring(const String& other, std::size_t start, std::size_t end);
 
-  void set(std::size_t index, char a) {
-    this->str.at(index) = a;
-  }
+  void set(std::size_t index, char32_t c);
 
-  void append(const String& other) {
-    this->str += other.str;
-  }
+  /**
+   * @brief Appends another string to this one. Below rope_threshold the
+   * characters are copied; at or above it the two strings are joined into a
+   * rope in constant time, or a short string is copied into the last leaf.
+   * @param other The string to append.
+   */
+  void append(const String& other);
 
   void copy(const String& other) {
     this->str = other.str;
+    this->index = other.index;
+    this->rope = other.rope;
   }
 
   void copy(const String& other, std::size_t start) {
-    this->str = other.str.substr(start, std::string::npos);
+    this->substring(other, start, other.length());
   }
 
   void copy(const String& other, std::size_t start, std::size_t end) {
-    this->str = other.str.substr(start, end);
+    this->substring(other, start, end);
   }
 
-  void fill(char fill) {
-    for (char& c : this->str) {
-      c = fill;
-    }
+  void fill(char32_t fill) {
+    this->fill(fill, 0, this->length());
   }
 
-  void fill(char fill, std::size_t start) {
-    for (std::size_t i = start; i < this->str.size(); ++i) {
-      this->str.at(i) = fill;
-    }
+  void fill(char32_t fill, std::size_t start) {
+    this->fill(fill, start, this->length());
   }
 
-  void fill(char fill, std::size_t start, std::size_t end) {
-    for (std::size_t i = start; i < end; ++i) {
-      this->str.at(i) = fill;
-    }
-  }
+  void fill(char32_t fill, std::size_t start, std::size_t end);
 
+  // Converts the ASCII letters to upper case
   void upcase() {
-    std::for_each(str.begin(), str.end(), [](char c) {
-      return static_cast<char>(std::toupper(static_cast<int>(c)));
-    });
+    make_flat();
+    string_kernels::upcase(&this->str[0], this->str.size());
   }
 
+  // Converts the ASCII letters to lower case
   void downcase() {
-    std::for_each(str.begin(), str.end(), [](char c) {
-      return static_cast<char>(std::tolower(static_cast<int>(c)));
-    });
+    make_flat();
+    string_kernels::downcase(&this->str[0], this->str.size());
+  }
+
+  /**
+   * @brief Finds the first occurrence of a character.
+   * @param c The character to find.
+   * @return Its index, or string_kernels::npos.
+   */
+  std::size_t index_of(char32_t c) const;
+
+  /**
+   * @brief Finds the first occurrence of another string.
+   * @param needle The string to find.
+   * @return Its index, or string_kernels::npos.
+   */
+  std::size_t find(const String& needle) const;
+
+  /**
+   * @brief Compares two strings by code point. UTF-8 bytes sort in code
+   * point order, so this compares the bytes directly.
+   * @return A negative number, zero or a positive number as this string is
+   * less than, equal to or greater than other.
+   */
+  int compare(const String& other) const {
+    const std::string& lhs = flat();
+    const std::string& rhs = other.flat();
+    return string_kernels::compare(lhs.data(), lhs.size(),
+                                   rhs.data(), rhs.size());
+  }
+
+  /**
+   * @brief Compares two strings as if their ASCII letters were lower case.
+   * @return A negative number, zero or a positive number as this string is
+   * less than, equal to or greater than other.
+   */
+  int compare_ci(const String& other) const {
+    const std::string& lhs = flat();
+    const std::string& rhs = other.flat();
+    return string_kernels::compare_ci(lhs.data(), lhs.size(),
+                                      rhs.data(), rhs.size());
+  }
+
+  const_iterator begin() const {
+    return const_iterator(flat().data());
+  }
+
+  const_iterator end() const {
+    const std::string& text = flat();
+    return const_iterator(text.data() + text.size());
   }
 
   friend bool operator==(const String& s1, const String& s2) {
-    return s1.str.compare(s2.str) == 0;
+    return s1.byte_length() == s2.byte_length() && s1.compare(s2) == 0;
   }
 
   friend bool operator!=(const String& s1, const String& s2) {
-    return s1.str.compare(s2.str) != 0;
+    return !(s1 == s2);
   }
 
-  //  return !(s1 == s2);
-
   friend bool operator<(const String& s1, const String& s2) {
-    return s1.str.compare(s2.str) < 0;
+    return s1.compare(s2) < 0;
   }
   friend bool operator>(const String& s1, const String& s2) {
-    return s1.str.compare(s2.str) > 0;
+    return s1.compare(s2) > 0;
   }
   friend bool operator<=(const String& s1, const String& s2) {
-    return s1.str.compare(s2.str) <= 0;
+    return s1.compare(s2) <= 0;
   }
   friend bool operator>=(const String& s1, const String& s2) {
-    return s1.str.compare(s2.str) >= 0;
+    return s1.compare(s2) >= 0;
   }
 
+  // return the UTF-8 encoding of the string
   const std::string get_string() const {
-    return this->str;
+    return flat();
+  }
+
+  /**
+   * @brief Determines whether every character is ASCII, in which case
+   * character and byte indices coincide.
+   * @return true if the string is pure ASCII.
+   */
+  bool is_ascii() const;
+
+  /**
+   * @brief Determines whether the string is currently held as a rope.
+   * @return true if the characters have not been copied into one buffer.
+   */
+  bool is_rope() const {
+    return rope != nullptr;
   }
 
   friend std::ostream& operator<<(std::ostream& lhs, const shaka::String& rhs);
 
 private:
+  struct Rope;
+
+  /**
+   * @brief The character count and the sparse index of a flat string.
+   */
+  struct Index {
+    std::size_t char_count = 0;
+    bool ascii = true;
+    std::vector<std::size_t> offsets;
+  };
+
+  static Index make_index(const std::string& text);
+
+  /**
+   * @brief Gets the characters of the string, flattening the rope if needed.
+   */
+  const std::string& flat() const;
+
+  /**
+   * @brief Gets the index matching flat().
+   */
+  const Index& flat_index() const;
+
+  /**
+   * @brief Gets the byte offset of a character.
+   * @param char_index A character index up to length().
+   * @throws std::out_of_range if char_index is past the end.
+   */
+  std::size_t byte_offset(std::size_t char_index) const;
+
+  /**
+   * @brief Replaces the characters from start to end with copies of c in
+   * place, updating only the index entries from start onwards.
+   * @param start The index of the first character to replace.
+   * @param end The index after the last character to replace.
+   * @param c The new character; ones with no UTF-8 encoding become U+FFFD.
+   */
+  void splice(std::size_t start, std::size_t end, char32_t c);
+
+  /**
+   * @brief Replaces the contents with valid UTF-8 text and indexes it.
+   */
+  void assign(std::string text);
+
+  /**
+   * @brief Copies the characters of the rope into str before a mutation.
+   */
+  void make_flat();
+
   std::string str;
+  Index index;
+  std::shared_ptr<const Rope> rope;
 };
 
 } // namespace shaka
-#endif // SHAKA_ASCII_STRING_H
+#endif // SHAKA_SCHEME_STRING_HPP
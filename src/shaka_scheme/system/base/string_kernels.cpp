@@ -0,0 +1,506 @@
+#include "shaka_scheme/system/base/string_kernels.hpp"
+
+#include <cstring>
+
+#if defined(__GNUC__) && defined(__SSE2__) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define SHAKA_SCHEME_STRING_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace shaka {
+namespace string_kernels {
+
+namespace {
+
+inline char to_lower(char c) {
+  return (c >= 'A' && c <= 'Z') ? static_cast<char>(c ^ 0x20) : c;
+}
+
+// Flips the case bit of every byte in [lo, hi], starting at index i
+void flip_case_scalar(char* data, std::size_t i, std::size_t length,
+                      char lo, char hi) {
+  for (; i < length; ++i) {
+    if (data[i] >= lo && data[i] <= hi) {
+      data[i] = static_cast<char>(data[i] ^ 0x20);
+    }
+  }
+}
+
+std::size_t find_char_scalar(const char* data, std::size_t i,
+                             std::size_t length, char c) {
+  for (; i < length; ++i) {
+    if (data[i] == c) {
+      return i;
+    }
+  }
+  return npos;
+}
+
+std::size_t mismatch_scalar(const char* lhs, const char* rhs,
+                            std::size_t i, std::size_t length) {
+  while (i < length && lhs[i] == rhs[i]) {
+    ++i;
+  }
+  return i;
+}
+
+std::size_t mismatch_ci_scalar(const char* lhs, const char* rhs,
+                               std::size_t i, std::size_t length) {
+  while (i < length && to_lower(lhs[i]) == to_lower(rhs[i])) {
+    ++i;
+  }
+  return i;
+}
+
+// Gets the length of the valid UTF-8 sequence at data, or 0 if invalid
+std::size_t valid_sequence_length(const unsigned char* data,
+                                  std::size_t length) {
+  unsigned char b = data[0];
+  std::size_t n;
+  unsigned char lo = 0x80;
+  unsigned char hi = 0xBF;
+  if (b < 0x80) {
+    return 1;
+  } else if (b >= 0xC2 && b <= 0xDF) {
+    n = 2;
+  } else if (b >= 0xE0 && b <= 0xEF) {
+    n = 3;
+    if (b == 0xE0) lo = 0xA0;
+    if (b == 0xED) hi = 0x9F;
+  } else if (b >= 0xF0 && b <= 0xF4) {
+    n = 4;
+    if (b == 0xF0) lo = 0x90;
+    if (b == 0xF4) hi = 0x8F;
+  } else {
+    return 0;
+  }
+  if (n > length || data[1] < lo || data[1] > hi) {
+    return 0;
+  }
+  for (std::size_t i = 2; i < n; ++i) {
+    if ((data[i] & 0xC0) != 0x80) {
+      return 0;
+    }
+  }
+  return n;
+}
+
+std::size_t count_code_points_scalar(const char* data, std::size_t i,
+                                     std::size_t length) {
+  std::size_t count = 0;
+  for (; i < length; ++i) {
+    if ((static_cast<unsigned char>(data[i]) & 0xC0) != 0x80) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+#ifdef SHAKA_SCHEME_STRING_KERNELS_X86
+
+// Signed byte comparisons leave bytes >= 0x80 outside of every ASCII range
+inline __m128i in_range_sse2(__m128i x, char lo, char hi) {
+  return _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8(lo - 1)),
+                       _mm_cmplt_epi8(x, _mm_set1_epi8(hi + 1)));
+}
+
+inline __m128i to_lower_sse2(__m128i x) {
+  __m128i upper = in_range_sse2(x, 'A', 'Z');
+  return _mm_xor_si128(x, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+void flip_case_sse2(char* data, std::size_t length, char lo, char hi) {
+  std::size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    __m128i flip = _mm_and_si128(in_range_sse2(x, lo, hi),
+                                 _mm_set1_epi8(0x20));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i),
+                     _mm_xor_si128(x, flip));
+  }
+  flip_case_scalar(data, i, length, lo, hi);
+}
+
+std::size_t find_char_sse2(const char* data, std::size_t length, char c) {
+  const __m128i target = _mm_set1_epi8(c);
+  std::size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(x, target));
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return find_char_scalar(data, i, length, c);
+}
+
+std::size_t mismatch_sse2(const char* lhs, const char* rhs,
+                          std::size_t length, bool fold_case) {
+  std::size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+    __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i));
+    if (fold_case) {
+      x = to_lower_sse2(x);
+      y = to_lower_sse2(y);
+    }
+    unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) ^ 0xFFFFu;
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return fold_case ? mismatch_ci_scalar(lhs, rhs, i, length) :
+      mismatch_scalar(lhs, rhs, i, length);
+}
+
+// Continuation bytes 0x80 to 0xBF are the signed bytes below -64
+std::size_t count_code_points_sse2(const char* data, std::size_t length) {
+  const __m128i limit = _mm_set1_epi8(-64);
+  std::size_t count = 0;
+  std::size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    int continuation = _mm_movemask_epi8(_mm_cmplt_epi8(x, limit));
+    count += 16 - __builtin_popcount(continuation);
+  }
+  return count + count_code_points_scalar(data, i, length);
+}
+
+// Gets the length of the run of ASCII bytes starting at i
+std::size_t ascii_run_sse2(const char* data, std::size_t i,
+                           std::size_t length) {
+  std::size_t start = i;
+  for (; i + 16 <= length; i += 16) {
+    int mask = _mm_movemask_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+    if (mask != 0) {
+      return i - start + __builtin_ctz(mask);
+    }
+  }
+  while (i < length && static_cast<unsigned char>(data[i]) < 0x80) {
+    ++i;
+  }
+  return i - start;
+}
+
+#define SHAKA_SCHEME_AVX2 __attribute__((target("avx2")))
+
+SHAKA_SCHEME_AVX2
+inline __m256i in_range_avx2(__m256i x, char lo, char hi) {
+  return _mm256_and_si256(_mm256_cmpgt_epi8(x, _mm256_set1_epi8(lo - 1)),
+                          _mm256_cmpgt_epi8(_mm256_set1_epi8(hi + 1), x));
+}
+
+SHAKA_SCHEME_AVX2
+inline __m256i to_lower_avx2(__m256i x) {
+  __m256i upper = in_range_avx2(x, 'A', 'Z');
+  return _mm256_xor_si256(x, _mm256_and_si256(upper,
+                                               _mm256_set1_epi8(0x20)));
+}
+
+SHAKA_SCHEME_AVX2
+void flip_case_avx2(char* data, std::size_t length, char lo, char hi) {
+  std::size_t i = 0;
+  for (; i + 32 <= length; i += 32) {
+    __m256i x = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(data + i));
+    __m256i flip = _mm256_and_si256(in_range_avx2(x, lo, hi),
+                                    _mm256_set1_epi8(0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i),
+                        _mm256_xor_si256(x, flip));
+  }
+  flip_case_scalar(data, i, length, lo, hi);
+}
+
+SHAKA_SCHEME_AVX2
+std::size_t find_char_avx2(const char* data, std::size_t length, char c) {
+  const __m256i target = _mm256_set1_epi8(c);
+  std::size_t i = 0;
+  for (; i + 32 <= length; i += 32) {
+    __m256i x = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(data + i));
+    unsigned mask = static_cast<unsigned>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, target)));
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return find_char_scalar(data, i, length, c);
+}
+
+SHAKA_SCHEME_AVX2
+std::size_t mismatch_avx2(const char* lhs, const char* rhs,
+                          std::size_t length, bool fold_case) {
+  std::size_t i = 0;
+  for (; i + 32 <= length; i += 32) {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+    __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+    if (fold_case) {
+      x = to_lower_avx2(x);
+      y = to_lower_avx2(y);
+    }
+    unsigned mask = ~static_cast<unsigned>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return fold_case ? mismatch_ci_scalar(lhs, rhs, i, length) :
+      mismatch_scalar(lhs, rhs, i, length);
+}
+
+SHAKA_SCHEME_AVX2
+std::size_t count_code_points_avx2(const char* data, std::size_t length) {
+  const __m256i limit = _mm256_set1_epi8(-64);
+  std::size_t count = 0;
+  std::size_t i = 0;
+  for (; i + 32 <= length; i += 32) {
+    __m256i x = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(data + i));
+    unsigned continuation = static_cast<unsigned>(
+        _mm256_movemask_epi8(_mm256_cmpgt_epi8(limit, x)));
+    count += 32 - __builtin_popcount(continuation);
+  }
+  return count + count_code_points_scalar(data, i, length);
+}
+
+SHAKA_SCHEME_AVX2
+std::size_t ascii_run_avx2(const char* data, std::size_t i,
+                           std::size_t length) {
+  std::size_t start = i;
+  for (; i + 32 <= length; i += 32) {
+    unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i))));
+    if (mask != 0) {
+      return i - start + __builtin_ctz(mask);
+    }
+  }
+  while (i < length && static_cast<unsigned char>(data[i]) < 0x80) {
+    ++i;
+  }
+  return i - start;
+}
+
+#undef SHAKA_SCHEME_AVX2
+
+bool has_avx2() {
+  static const bool supported = []() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+  }();
+  return supported;
+}
+
+#endif // SHAKA_SCHEME_STRING_KERNELS_X86
+
+void flip_case(char* data, std::size_t length, char lo, char hi) {
+#ifdef SHAKA_SCHEME_STRING_KERNELS_X86
+  if (has_avx2()) {
+    return flip_case_avx2(data, length, lo, hi);
+  }
+  return flip_case_sse2(data, length, lo, hi);
+#else
+  return flip_case_scalar(data, 0, length, lo, hi);
+#endif
+}
+
+std::size_t mismatch_impl(const char* lhs, const char* rhs,
+                          std::size_t length, bool fold_case) {
+#ifdef SHAKA_SCHEME_STRING_KERNELS_X86
+  if (has_avx2()) {
+    return mismatch_avx2(lhs, rhs, length, fold_case);
+  }
+  return mismatch_sse2(lhs, rhs, length, fold_case);
+#else
+  return fold_case ? mismatch_ci_scalar(lhs, rhs, 0, length) :
+      mismatch_scalar(lhs, rhs, 0, length);
+#endif
+}
+
+std::size_t ascii_run(const char* data, std::size_t i, std::size_t length) {
+#ifdef SHAKA_SCHEME_STRING_KERNELS_X86
+  if (has_avx2()) {
+    return ascii_run_avx2(data, i, length);
+  }
+  return ascii_run_sse2(data, i, length);
+#else
+  std::size_t start = i;
+  while (i < length && static_cast<unsigned char>(data[i]) < 0x80) {
+    ++i;
+  }
+  return i - start;
+#endif
+}
+
+int compare_impl(const char* lhs, std::size_t lhs_length,
+                 const char* rhs, std::size_t rhs_length, bool fold_case) {
+  std::size_t length = lhs_length < rhs_length ? lhs_length : rhs_length;
+  std::size_t k = mismatch_impl(lhs, rhs, length, fold_case);
+  if (k < length) {
+    unsigned char a = static_cast<unsigned char>(
+        fold_case ? to_lower(lhs[k]) : lhs[k]);
+    unsigned char b = static_cast<unsigned char>(
+        fold_case ? to_lower(rhs[k]) : rhs[k]);
+    return a < b ? -1 : 1;
+  }
+  if (lhs_length == rhs_length) {
+    return 0;
+  }
+  return lhs_length < rhs_length ? -1 : 1;
+}
+
+} // namespace
+
+void upcase(char* data, std::size_t length) {
+  flip_case(data, length, 'a', 'z');
+}
+
+void downcase(char* data, std::size_t length) {
+  flip_case(data, length, 'A', 'Z');
+}
+
+std::size_t find_char(const char* data, std::size_t length, char c) {
+#ifdef SHAKA_SCHEME_STRING_KERNELS_X86
+  if (has_avx2()) {
+    return find_char_avx2(data, length, c);
+  }
+  return find_char_sse2(data, length, c);
+#else
+  return find_char_scalar(data, 0, length, c);
+#endif
+}
+
+std::size_t find(const char* data, std::size_t length,
+                 const char* needle, std::size_t needle_length) {
+  if (needle_length == 0) {
+    return 0;
+  }
+  if (needle_length > length) {
+    return npos;
+  }
+  // Scan for the first byte of the needle, then check the rest in place
+  std::size_t last = length - needle_length;
+  std::size_t i = 0;
+  while (i <= last) {
+    std::size_t k = find_char(data + i, last - i + 1, needle[0]);
+    if (k == npos) {
+      return npos;
+    }
+    i += k;
+    if (std::memcmp(data + i + 1, needle + 1, needle_length - 1) == 0) {
+      return i;
+    }
+    ++i;
+  }
+  return npos;
+}
+
+std::size_t mismatch(const char* lhs, const char* rhs, std::size_t length) {
+  return mismatch_impl(lhs, rhs, length, false);
+}
+
+std::size_t mismatch_ci(const char* lhs, const char* rhs, std::size_t length) {
+  return mismatch_impl(lhs, rhs, length, true);
+}
+
+int compare(const char* lhs, std::size_t lhs_length,
+            const char* rhs, std::size_t rhs_length) {
+  return compare_impl(lhs, lhs_length, rhs, rhs_length, false);
+}
+
+int compare_ci(const char* lhs, std::size_t lhs_length,
+               const char* rhs, std::size_t rhs_length) {
+  return compare_impl(lhs, lhs_length, rhs, rhs_length, true);
+}
+
+bool is_ascii(const char* data, std::size_t length) {
+  return ascii_run(data, 0, length) == length;
+}
+
+std::size_t count_code_points(const char* data, std::size_t length) {
+#ifdef SHAKA_SCHEME_STRING_KERNELS_X86
+  if (has_avx2()) {
+    return count_code_points_avx2(data, length);
+  }
+  return count_code_points_sse2(data, length);
+#else
+  return count_code_points_scalar(data, 0, length);
+#endif
+}
+
+std::size_t validate_utf8(const char* data, std::size_t length) {
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+  std::size_t i = 0;
+  while (i < length) {
+    i += ascii_run(data, i, length);
+    if (i == length) {
+      break;
+    }
+    std::size_t n = valid_sequence_length(bytes + i, length - i);
+    if (n == 0) {
+      return i;
+    }
+    i += n;
+  }
+  return npos;
+}
+
+char32_t decode_utf8(const char* data) {
+  const unsigned char* b = reinterpret_cast<const unsigned char*>(data);
+  switch (sequence_length(data[0])) {
+  case 1:
+    return b[0];
+  case 2:
+    return (char32_t(b[0] & 0x1F) << 6) | (b[1] & 0x3F);
+  case 3:
+    return (char32_t(b[0] & 0x0F) << 12) | (char32_t(b[1] & 0x3F) << 6) |
+        (b[2] & 0x3F);
+  default:
+    return (char32_t(b[0] & 0x07) << 18) | (char32_t(b[1] & 0x3F) << 12) |
+        (char32_t(b[2] & 0x3F) << 6) | (b[3] & 0x3F);
+  }
+}
+
+void encode_utf8(char32_t c, std::string& out) {
+  if (c < 0x80) {
+    out += static_cast<char>(c);
+  } else if (c < 0x800) {
+    out += static_cast<char>(0xC0 | (c >> 6));
+    out += static_cast<char>(0x80 | (c & 0x3F));
+  } else if (c < 0x10000) {
+    out += static_cast<char>(0xE0 | (c >> 12));
+    out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (c & 0x3F));
+  } else {
+    out += static_cast<char>(0xF0 | (c >> 18));
+    out += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+    out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (c & 0x3F));
+  }
+}
+
+std::string repair_utf8(std::string text) {
+  std::size_t bad = validate_utf8(text.data(), text.size());
+  if (bad == npos) {
+    return text;
+  }
+  const unsigned char* bytes =
+      reinterpret_cast<const unsigned char*>(text.data());
+  std::string repaired(text, 0, bad);
+  std::size_t i = bad;
+  while (i < text.size()) {
+    std::size_t n = valid_sequence_length(bytes + i, text.size() - i);
+    if (n == 0) {
+      encode_utf8(0xFFFD, repaired);
+      ++i;
+    } else {
+      repaired.append(text, i, n);
+      i += n;
+    }
+  }
+  return repaired;
+}
+
+} // namespace string_kernels
+} // namespace shaka
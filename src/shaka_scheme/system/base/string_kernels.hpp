@@ -0,0 +1,148 @@
+#ifndef SHAKA_SCHEME_STRING_KERNELS_HPP
+#define SHAKA_SCHEME_STRING_KERNELS_HPP
+
+#include <cstddef>
+#include <string>
+
+namespace shaka {
+namespace string_kernels {
+
+/**
+ * @note Byte-wise kernels over ASCII text used by shaka::String. On x86
+ * they process 32 bytes at a time with AVX2 when the CPU supports it, and
+ * 16 bytes at a time with SSE2 otherwise. Other targets use scalar loops.
+ * Bytes outside of ASCII are never changed by the case kernels, so they
+ * can be run over UTF-8 text.
+ */
+
+/**
+ * @brief The index returned when a search finds nothing.
+ */
+const std::size_t npos = static_cast<std::size_t>(-1);
+
+/**
+ * @brief Converts the ASCII letters of a buffer to upper case in place.
+ * @param data The buffer.
+ * @param length The number of bytes in the buffer.
+ */
+void upcase(char* data, std::size_t length);
+
+/**
+ * @brief Converts the ASCII letters of a buffer to lower case in place.
+ * @param data The buffer.
+ * @param length The number of bytes in the buffer.
+ */
+void downcase(char* data, std::size_t length);
+
+/**
+ * @brief Finds the first occurrence of a byte.
+ * @param data The buffer to search.
+ * @param length The number of bytes in the buffer.
+ * @param c The byte to find.
+ * @return The index of the first c, or npos.
+ */
+std::size_t find_char(const char* data, std::size_t length, char c);
+
+/**
+ * @brief Finds the first occurrence of a substring.
+ * @param data The buffer to search.
+ * @param length The number of bytes in the buffer.
+ * @param needle The substring to find.
+ * @param needle_length The number of bytes in the substring.
+ * @return The index of the first match, or npos. An empty needle matches
+ * at 0.
+ */
+std::size_t find(const char* data, std::size_t length,
+                 const char* needle, std::size_t needle_length);
+
+/**
+ * @brief Finds the first index at which two buffers differ.
+ * @param lhs The first buffer.
+ * @param rhs The second buffer.
+ * @param length The number of bytes to compare.
+ * @return The index of the first difference, or length if there is none.
+ */
+std::size_t mismatch(const char* lhs, const char* rhs, std::size_t length);
+
+/**
+ * @brief Like mismatch, but ASCII letters compare equal to their other case.
+ */
+std::size_t mismatch_ci(const char* lhs, const char* rhs, std::size_t length);
+
+/**
+ * @brief Compares two buffers lexicographically by unsigned byte value.
+ * @return A negative number, zero or a positive number as lhs is less than,
+ * equal to or greater than rhs.
+ */
+int compare(const char* lhs, std::size_t lhs_length,
+            const char* rhs, std::size_t rhs_length);
+
+/**
+ * @brief Like compare, but ASCII letters are compared as lower case.
+ */
+int compare_ci(const char* lhs, std::size_t lhs_length,
+               const char* rhs, std::size_t rhs_length);
+
+/**
+ * @brief Determines whether a buffer holds only ASCII bytes.
+ * @param data The buffer.
+ * @param length The number of bytes in the buffer.
+ * @return true if every byte is below 0x80.
+ */
+bool is_ascii(const char* data, std::size_t length);
+
+/**
+ * @brief Counts the code points of valid UTF-8 text.
+ * @param data The buffer.
+ * @param length The number of bytes in the buffer.
+ * @return The number of bytes that are not continuation bytes.
+ */
+std::size_t count_code_points(const char* data, std::size_t length);
+
+/**
+ * @brief Checks that a buffer is well-formed UTF-8: no overlong forms,
+ * surrogates, code points above U+10FFFF or truncated sequences. Runs of
+ * ASCII are skipped a vector at a time.
+ * @param data The buffer.
+ * @param length The number of bytes in the buffer.
+ * @return npos if the buffer is valid, otherwise the offset of the first
+ * byte of the first invalid sequence.
+ */
+std::size_t validate_utf8(const char* data, std::size_t length);
+
+/**
+ * @brief Gets the number of bytes in the UTF-8 sequence of a code point.
+ * @param lead The first byte of a valid sequence.
+ * @return 1 to 4.
+ */
+inline std::size_t sequence_length(char lead) {
+  unsigned char b = static_cast<unsigned char>(lead);
+  return b < 0x80 ? 1 : b < 0xE0 ? 2 : b < 0xF0 ? 3 : 4;
+}
+
+/**
+ * @brief Decodes the code point of a valid UTF-8 sequence.
+ * @param data The first byte of the sequence.
+ * @return The code point.
+ */
+char32_t decode_utf8(const char* data);
+
+/**
+ * @brief Appends the UTF-8 encoding of a code point to a std::string.
+ * @param c A code point up to U+10FFFF that is not a surrogate.
+ * @param out The string to append to.
+ */
+void encode_utf8(char32_t c, std::string& out);
+
+/**
+ * @brief Copies UTF-8 text, replacing each byte that does not start a
+ * valid sequence with U+FFFD.
+ * @param text The text to check.
+ * @return text itself if it was valid, or the repaired copy.
+ */
+std::string repair_utf8(std::string text);
+
+} // namespace string_kernels
+} // namespace shaka
+
+#endif //SHAKA_SCHEME_STRING_KERNELS_HPP
@@ -1,10 +1,11 @@
 #include "shaka_scheme/system/core/lists.hpp"
+#include "shaka_scheme/system/gc/make_node.hpp"
 
 namespace shaka {
 namespace core {
 
 NodePtr cons(NodePtr left, NodePtr right) {
-  return create_node(Data(DataPair(left, right)));
+  return make_pair(left, right);
 }
 
 NodePtr car(NodePtr node) {
@@ -36,7 +37,7 @@ void set_cdr(NodePtr pair, NodePtr obj) {
 }
 
 NodePtr list() {
-  return create_node(Data());
+  return make_null();
 }
 
 /**
@@ -108,52 +109,29 @@ NodePtr append(NodePtr first) {
 }
 
 NodePtr append(NodePtr first, NodePtr second) {
-  // The first argument must be a proper list.
-  if (!is_proper_list(first)) {
+  // Return the second argument if the first argument is a null list.
+  if (is_null_list(first)) { return second; }
+  if (!is_pair(first)) {
     throw shaka::TypeException(2002, "append(): first argument is not a "
         "proper list");
   }
-  // Return the second argument if the first argument is a null list.
-  if (is_null_list(first)) { return second; }
 
-  // Otherwise, cons everything from first with the second after it.
-  // First, create the root node as a list with just the first item of first.
-  NodePtr root = cons(car(first), create_node(Data()));
+  // Copy the pairs of first in one pass, keeping a pointer to the last one,
+  // and share the elements and all of second.
+  NodePtr root = cons(car(first), second);
   NodePtr list_it = root;
-  // Get the NodePtr iterator for the cdr of the first list.
   NodePtr it = cdr(first);
-  // While it is still a pair
-  while (it->get_type() == shaka::Data::Type::DATA_PAIR) {
-    // Append the next pair onto the list.
-    set_cdr(list_it, cons(car(it), create_node(Data())));
-    list_it = cdr(list_it);
-    // Iterate.
-    it = cdr(it);
-  }
-
-  // If second is not a pair, set cdr of the list to be second.
-  if (!is_pair(second)) {
-    set_cdr(list_it, second);
-    return root;
-  }
-
-  // Otherwise, we need to iterate through second like first.
-  it = second;
-  set_cdr(list_it, cons(car(second), create_node(Data())));
-
-  // While it is still a pair
-  while (it->get_type() == shaka::Data::Type::DATA_PAIR) {
-    // Append the next pair onto the list.
-    set_cdr(list_it, cons(car(it), create_node(Data())));
-    list_it = cdr(list_it);
-    // Iterate.
-    if (!is_pair(it)) { break; }
+  while (is_pair(it)) {
+    NodePtr next = cons(car(it), second);
+    set_cdr(list_it, next);
+    list_it = next;
     it = cdr(it);
   }
 
-  // If the last item is a not a null list, append it.
+  // The first argument must be a proper list.
   if (!is_null_list(it)) {
-    set_cdr(list_it, it);
+    throw shaka::TypeException(2002, "append(): first argument is not a "
+        "proper list");
   }
   return root;
 }
@@ -165,7 +143,7 @@ NodePtr reverse_helper(const NodePtr left, const NodePtr right) {
 NodePtr reverse(NodePtr first) {
   NodePtr head {first};
   // Create an null list.
-  NodePtr rev_head {shaka::create_node(shaka::Data())};
+  NodePtr rev_head {make_null()};
   while (head->get_type() != Data::Type::NULL_LIST) {
     rev_head = core::cons(head->get<shaka::DataPair>().car(), rev_head);
     head = head->get<shaka::DataPair>().cdr();
@@ -53,8 +53,8 @@ NodePtr append(NodePtr first, NodePtr second);
 
 template <typename... Args>
 NodePtr append(NodePtr first, NodePtr second, Args... rest) {
-  auto node = append(first, second);
-  return append(node, rest...);
+  // Fold from the right, so that each list is copied only once
+  return append(first, append(second, rest...));
 }
 
 NodePtr reverse_helper(const NodePtr left, const NodePtr right);
@@ -1,8 +1,136 @@
 #include "shaka_scheme/system/core/types.hpp"
 
+#include <unordered_map>
+#include <vector>
+
 namespace shaka {
 namespace core {
 
+namespace {
+
+// equal() alternates between a fast walk of this many pairs and vectors,
+// which remembers nothing, and a stretch of union-find that records this
+// many new equivalences. A long acyclic list is thus walked mostly fast,
+// while cyclic data is cut short once union-find has seen its cycle.
+const std::size_t equal_fast_budget = 1000;
+const std::size_t equal_slow_budget = 40;
+
+/**
+ * @brief A union-find forest over the nodes that equal() has compared.
+ */
+class EqualityClasses {
+public:
+  /**
+   * @brief Merges the classes of two nodes.
+   * @return Whether they were already in the same class
+   */
+  bool unite(Data* left, Data* right) {
+    Data* a = find(left);
+    Data* b = find(right);
+    if (a == b) {
+      return true;
+    }
+    parent[a] = b;
+    return false;
+  }
+
+private:
+  Data* find(Data* node) {
+    // Path halving: point each visited node at its grandparent
+    while (true) {
+      auto it = parent.find(node);
+      if (it == parent.end()) {
+        return node;
+      }
+      auto up = parent.find(it->second);
+      if (up == parent.end()) {
+        return it->second;
+      }
+      it->second = up->second;
+      node = up->second;
+    }
+  }
+
+  std::unordered_map<Data*, Data*> parent;
+};
+
+/**
+ * @brief Walks two objects side by side, switching between the fast walk
+ * and union-find without restarting.
+ */
+bool walk_equal(NodePtr left, NodePtr right) {
+  std::vector<std::pair<NodePtr, NodePtr>> pending{{left, right}};
+  EqualityClasses classes;
+  bool slow = false;
+  std::size_t budget = equal_fast_budget;
+  while (!pending.empty()) {
+    NodePtr a = pending.back().first;
+    NodePtr b = pending.back().second;
+    pending.pop_back();
+    if (a == b) {
+      continue;
+    }
+    if (a->get_type() != b->get_type()) {
+      return false;
+    }
+    switch (a->get_type()) {
+    case Data::Type::DATA_PAIR:
+    case Data::Type::VECTOR:
+      // Only new equivalences count against the union-find stretch, so
+      // it drains everything it has already seen before handing back
+      if (slow) {
+        if (classes.unite(a.get(), b.get())) {
+          continue;
+        }
+        if (--budget == 0) {
+          slow = false;
+          budget = equal_fast_budget;
+        }
+      } else if (--budget == 0) {
+        slow = true;
+        budget = equal_slow_budget;
+      }
+      if (a->get_type() == Data::Type::DATA_PAIR) {
+        // The car is walked first, and the stack stays flat along a list
+        pending.emplace_back(a->get<DataPair>().cdr(),
+                             b->get<DataPair>().cdr());
+        pending.emplace_back(a->get<DataPair>().car(),
+                             b->get<DataPair>().car());
+      } else {
+        Vector& x = a->get<Vector>();
+        Vector& y = b->get<Vector>();
+        if (x.length() != y.length()) {
+          return false;
+        }
+        for (std::size_t i = x.length(); i-- > 0;) {
+          pending.emplace_back(x[i], y[i]);
+        }
+      }
+      break;
+    case Data::Type::BYTEVECTOR: {
+      Bytevector& x = a->get<Bytevector>();
+      Bytevector& y = b->get<Bytevector>();
+      if (x.length() != y.length()) {
+        return false;
+      }
+      for (std::size_t i = 0; i < x.length(); ++i) {
+        if (x[i] != y[i]) {
+          return false;
+        }
+      }
+      break;
+    }
+    default:
+      if (!HashTable::equivalent(a, b, HashTable::Equivalence::EQV)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+} // namespace
+
 /**
  * @brief Implements (boolean?).
  * @param node The data to take in
@@ -81,5 +209,9 @@ bool is_eqv(NodePtr left, NodePtr right) {
   else return left == right;
 }
 
+bool equal(NodePtr left, NodePtr right) {
+  return walk_equal(left, right);
+}
+
 } // namespace core
 } // namespace shaka
@@ -58,6 +58,24 @@ NodePtr create_unspecified_node();
  */
 bool is_eqv(NodePtr left, NodePtr right);
 
+/**
+ * @brief Implements (equal?), the structural equivalence comparison.
+ * @param left The left object
+ * @param right The right object
+ * @return Whether pairs, vectors and bytevectors have equal contents, and
+ * all other objects are equivalent as by eqv?.
+ *
+ * @note The walk keeps an explicit stack instead of recursing, and does not
+ * copy or allocate nodes, so very long lists are compared in constant stack
+ * space. Cyclic and shared structure is handled as in the interleaved
+ * union-find algorithm of Adams and Dybvig: after a bounded number of
+ * steps, the walk merges each pair of compared nodes into one equivalence
+ * class for a short stretch, and assumes nodes already in the same class
+ * equal instead of walking them again. It then goes back to the fast walk,
+ * so long acyclic lists rarely touch the union-find table.
+ */
+bool equal(NodePtr left, NodePtr right);
+
 } // namespace core
 } // namespace shaka
 
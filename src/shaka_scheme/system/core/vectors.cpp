@@ -35,7 +35,7 @@ NodePtr vector_to_list(NodePtr vector) {
   // For each item in the vector, starting from the back, cons it onto the
   // null list.
   for (std::size_t i = vec.length(); i > 0; --i) {
-    node = shaka::core::cons(create_node(*vec[i-1]), node);
+    node = shaka::core::cons(vec[i-1], node);
   }
   return node;
 }
@@ -8,6 +8,8 @@ namespace shaka {
 
     namespace gc {
 
+        std::atomic<AllocationObserver> GC::allocation_observer(nullptr);
+
         GC::GC() {}
         GC::~GC() {}
 
@@ -15,7 +17,7 @@ namespace shaka {
 
         GCData* GC::create_data(const Data& data) {
             GCData *gcd = new GCData(data);
-            this->list.add_data(gcd);
+            this->add_data(gcd);
             return gcd;
         }
 
@@ -24,7 +26,16 @@ namespace shaka {
         }
 
         void GC::sweep() {
+            mark_weak_references();
             this->list.sweep();
         }
+
+        void GC::adopt(GC& other) {
+            this->list.splice(other.list);
+        }
+
+        void set_allocation_observer(AllocationObserver observer) {
+            GC::allocation_observer.store(observer);
+        }
     }
 }
\ No newline at end of file
@@ -9,10 +9,19 @@
 #include "shaka_scheme/system/gc/GCData.hpp"
 #include "shaka_scheme/system/base/Data.hpp"
 
+#include <atomic>
+#include <utility>
+
 namespace shaka {
 
     namespace gc {
 
+        /**
+         * @brief A function called with each Data that any GC allocates,
+         * on the thread that allocates it
+         */
+        using AllocationObserver = void (*)(Data& data);
+
     /**
          * @brief Implements the factory method of the GC, which allows the
          * construction of GCData and automatically adds those GCData to the
@@ -27,12 +36,56 @@ namespace shaka {
             GC(GC&& other);
 
             GCData *create_data(const Data& data);
+
+            /**
+             * @brief Constructs the Data of a new GCData from args, in
+             * place, instead of copying a whole Data into it as create_data
+             * does
+             */
+            template <typename... Args>
+            GCData *emplace_data(Args&&... args) {
+                GCData *gcd =
+                    new GCData(GCData::InPlace(), std::forward<Args>(args)...);
+                this->add_data(gcd);
+                return gcd;
+            }
+
             int get_size();
+
+            /**
+             * @brief Clears the weak references whose keys were not
+             * marked, then frees every unmarked GCData
+             */
             void sweep();
 
+            /**
+             * @brief Takes ownership of every GCData allocated by another
+             * GC, leaving the other GC empty
+             */
+            void adopt(GC& other);
+
         private:
+            // Adds a new GCData to the list, and tells the observer
+            void add_data(GCData *gcd) {
+                this->list.add_data(gcd);
+                AllocationObserver observer =
+                    allocation_observer.load(std::memory_order_relaxed);
+                if (observer != nullptr) {
+                    observer(gcd->get_data());
+                }
+            }
+
+            static std::atomic<AllocationObserver> allocation_observer;
+            friend void set_allocation_observer(AllocationObserver observer);
+
             GCList list;
         };
+
+        /**
+         * @brief Sets the function that every GC calls with the Data it
+         * allocates, or nullptr to call none
+         */
+        void set_allocation_observer(AllocationObserver observer);
     }
 }
 #endif //SHAKA_SCHEME_GC_HPP
@@ -6,6 +6,8 @@
 #define SHAKA_SCHEME_GCDATA_HPP
 #include "shaka_scheme/system/base/Data.hpp"
 
+#include <utility>
+
 class GC;
 
 namespace shaka {
@@ -39,6 +41,15 @@ namespace shaka {
             GCData *next;
 
             GCData(const Data &data);
+
+            // Tags the constructor that builds the Data from its arguments
+            struct InPlace {};
+
+            template <typename... Args>
+            GCData(InPlace, Args&&... args) :
+                marked(false),
+                data(std::forward<Args>(args)...),
+                next(nullptr) {}
         };
     }
 }
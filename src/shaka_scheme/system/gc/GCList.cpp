@@ -44,6 +44,24 @@ namespace shaka {
             this->list_size++;
         }
 
+        void GCList::splice(GCList& other) {
+            if (other.is_empty()) {
+                return;
+            }
+
+            //Link the tail of the other GCList to the head of this one
+            GCData *tail = other.head;
+            while (tail->get_next() != nullptr) {
+                tail = tail->get_next();
+            }
+            tail->set_next(this->head);
+            this->head = other.head;
+            this->list_size += other.list_size;
+
+            other.head = nullptr;
+            other.list_size = 0;
+        }
+
         void GCList::sweep() {
             GCData *prev = nullptr;
             GCData *curr = this->head;
@@ -22,6 +22,7 @@ namespace shaka {
             bool is_empty();
             int get_size() const;
             void add_data(GCData *data);
+            void splice(GCList& other);
             void sweep();
 
         private:
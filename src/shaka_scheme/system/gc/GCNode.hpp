@@ -37,6 +37,7 @@ public:
   friend bool operator!=(const GCNode& lhs, const GCNode& rhs);
 
   friend void mark_node(const GCNode& node);
+  friend bool is_marked(const GCNode& node);
   friend void swap(GCNode& lhs, GCNode& rhs);
 
 private:
@@ -0,0 +1,145 @@
+#include "shaka_scheme/system/gc/Message.hpp"
+#include "shaka_scheme/system/gc/init_gc.hpp"
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace shaka {
+
+namespace gc {
+
+NodePtr deep_copy(NodePtr node) {
+  std::unordered_map<Data*, NodePtr> copies;
+  std::vector<std::pair<NodePtr, NodePtr>> pending;
+
+  // Tables are filled in last: equal? tables hash their keys by contents,
+  // which are only complete once every pair and vector has been copied.
+  std::vector<std::pair<NodePtr, std::vector<std::pair<NodePtr, NodePtr>>>>
+      tables;
+
+  // Allocates the copy of a single node. The fields of pairs, vectors,
+  // hash tables and ephemerons are filled in afterwards, so that long
+  // lists do not recurse.
+  auto visit = [&](NodePtr src) {
+    auto it = copies.find(src.get());
+    if (it != copies.end()) {
+      return it->second;
+    }
+    NodePtr dst;
+    switch (src->get_type()) {
+    case Data::Type::DATA_PAIR: {
+      dst = create_node(Data(DataPair(Data(), Data())));
+      pending.push_back(std::make_pair(src, dst));
+      break;
+    }
+    case Data::Type::VECTOR: {
+      dst = create_node(Data(Vector(src->get<Vector>().length())));
+      pending.push_back(std::make_pair(src, dst));
+      break;
+    }
+    case Data::Type::HASH_TABLE: {
+      const HashTable& table = src->get<HashTable>();
+      dst = create_node(Data(HashTable(table.get_equivalence(), table.size(),
+                                       table.is_weak())));
+      pending.push_back(std::make_pair(src, dst));
+      break;
+    }
+    case Data::Type::EPHEMERON: {
+      Ephemeron ephemeron{NodePtr(), NodePtr()};
+      if (src->get<Ephemeron>().is_broken()) {
+        ephemeron.set_broken();
+      }
+      dst = create_node(Data(ephemeron));
+      if (!ephemeron.is_broken()) {
+        pending.push_back(std::make_pair(src, dst));
+      }
+      break;
+    }
+    case Data::Type::NUMBER:
+    case Data::Type::STRING:
+    case Data::Type::SYMBOL:
+    case Data::Type::BOOLEAN:
+    case Data::Type::NULL_LIST:
+    case Data::Type::BYTEVECTOR:
+    case Data::Type::UNSPECIFIED:
+    case Data::Type::EOF_OBJECT: {
+      dst = create_node(*src);
+      break;
+    }
+    case Data::Type::CLOSURE:
+    case Data::Type::CALL_FRAME:
+    case Data::Type::ENVIRONMENT: {
+      throw TypeException(10030, "deep_copy: procedures and call frames "
+          "cannot be copied between heaps");
+    }
+    case Data::Type::PORT: {
+      throw TypeException(10030, "deep_copy: ports cannot be copied "
+          "between heaps");
+    }
+    default: {
+      throw TypeException(10030, "deep_copy: object cannot be copied "
+          "between heaps");
+    }
+    }
+    copies.insert(std::make_pair(src.get(), dst));
+    return dst;
+  };
+
+  NodePtr result = visit(node);
+  while (!pending.empty()) {
+    NodePtr src = pending.back().first;
+    NodePtr dst = pending.back().second;
+    pending.pop_back();
+    if (src->get_type() == Data::Type::DATA_PAIR) {
+      DataPair& pair = src->get<DataPair>();
+      NodePtr car = visit(pair.car());
+      NodePtr cdr = visit(pair.cdr());
+      dst->get<DataPair>().set_car(car);
+      dst->get<DataPair>().set_cdr(cdr);
+    } else if (src->get_type() == Data::Type::VECTOR) {
+      Vector& vector = src->get<Vector>();
+      for (std::size_t i = 0; i < vector.length(); ++i) {
+        NodePtr element = visit(vector[i]);
+        dst->get<Vector>()[i] = element;
+      }
+    } else if (src->get_type() == Data::Type::HASH_TABLE) {
+      std::vector<std::pair<NodePtr, NodePtr>> entries;
+      for (const auto& entry : src->get<HashTable>().entries()) {
+        NodePtr key = visit(entry.first);
+        NodePtr value = visit(entry.second);
+        entries.push_back(std::make_pair(key, value));
+      }
+      tables.push_back(std::make_pair(dst, std::move(entries)));
+    } else {
+      const Ephemeron& ephemeron = src->get<Ephemeron>();
+      NodePtr key = visit(ephemeron.get_key());
+      NodePtr datum = visit(ephemeron.get_datum());
+      dst->get<Ephemeron>() = Ephemeron(key, datum);
+    }
+  }
+  for (const auto& table : tables) {
+    for (const auto& entry : table.second) {
+      table.first->get<HashTable>().set(entry.first, entry.second);
+    }
+  }
+  return result;
+}
+
+Message::Message(NodePtr value) :
+    heap(new GC()) {
+  HeapScope scope(*heap);
+  root = deep_copy(value);
+}
+
+Message::Message(Message&& other) :
+    heap(std::move(other.heap)),
+    root(std::move(other.root)) {}
+
+NodePtr Message::adopt(GC& gc) {
+  gc.adopt(*heap);
+  return root;
+}
+
+} // namespace gc
+} // namespace shaka
@@ -0,0 +1,59 @@
+#ifndef SHAKA_SCHEME_MESSAGE_HPP
+#define SHAKA_SCHEME_MESSAGE_HPP
+
+#include "shaka_scheme/system/gc/GC.hpp"
+
+#include <memory>
+
+namespace shaka {
+
+namespace gc {
+
+/**
+ * @brief Copies a Data graph into the heap that create_node is currently
+ * bound to. Shared structure and cycles are preserved.
+ * @param node The root of the graph to copy.
+ * @return The root of the copy.
+ * @throws TypeException if the graph contains closures, call frames,
+ * environments or ports, which cannot leave the heap of their
+ * HeapVirtualMachine, or any other type that is not copied explicitly.
+ */
+NodePtr deep_copy(NodePtr node);
+
+/**
+ * @brief A Data graph copied into a private heap, so that it can be handed
+ * from one HeapVirtualMachine thread to another.
+ *
+ * The sender copies the value when the Message is constructed. The
+ * receiver then adopts the whole private heap into its own GC, so the
+ * value crosses threads with a single copy and no shared mutable state.
+ */
+class Message {
+public:
+
+    /**
+     * @brief Copies value into the private heap of the message. Must be
+     * called on the thread that owns value.
+     * @param value The root of the graph to send.
+     */
+    explicit Message(NodePtr value);
+
+    Message(Message&& other);
+    Message(const Message& other) = delete;
+
+    /**
+     * @brief Transfers ownership of the message heap to gc.
+     * @param gc The heap of the receiving thread.
+     * @return The root of the received graph, now owned by gc.
+     */
+    NodePtr adopt(GC& gc);
+
+private:
+    std::unique_ptr<GC> heap;
+    NodePtr root;
+};
+
+} // namespace gc
+} // namespace shaka
+
+#endif //SHAKA_SCHEME_MESSAGE_HPP
@@ -7,13 +7,29 @@
 #include "shaka_scheme/system/base/DataPair.hpp"
 
 namespace shaka {
+    NodePtr create_node(const Data& data) {
+        return gc::GCNode(gc::current_gc->create_data(data));
+    }
+
     namespace gc {
 
+        thread_local GC* current_gc = nullptr;
+
         void init_create_node(GC& gc) {
-            create_node = [&gc](const Data& data) {
+            current_gc = &gc;
+        }
+
+        GC* get_current_gc() {
+            return current_gc;
+        }
+
+        HeapScope::HeapScope(GC& gc) :
+            previous_gc(current_gc) {
+            init_create_node(gc);
+        }
 
-                return GCNode(gc.create_data(data));
-            };
+        HeapScope::~HeapScope() {
+            current_gc = previous_gc;
         }
     }
 }
@@ -5,7 +5,6 @@
 #ifndef SHAKA_SCHEME_INIT_GC_HPP
 #define SHAKA_SCHEME_INIT_GC_HPP
 
-#include <functional>
 #include "shaka_scheme/system/gc/GCNode.hpp"
 #include "shaka_scheme/system/base/Data.hpp"
 
@@ -15,7 +14,33 @@ namespace shaka {
         class GC;
         using NodePtr = GCNode;
 
+        /**
+         * @brief The GC that create_node allocates from on the calling
+         * thread. Set it with init_create_node or HeapScope.
+         */
+        extern thread_local GC* current_gc;
+
         void init_create_node(GC& gc);
+
+        /**
+         * @brief Gets the GC that create_node is bound to on the calling
+         * thread, or nullptr if init_create_node was never called on it
+         */
+        GC* get_current_gc();
+
+        /**
+         * @brief Binds create_node on the calling thread to a GC for the
+         * lifetime of this object, then restores the previous binding
+         */
+        class HeapScope {
+        public:
+            HeapScope(GC& gc);
+            ~HeapScope();
+            HeapScope(const HeapScope& other) = delete;
+
+        private:
+            GC* previous_gc;
+        };
     
     }
 }
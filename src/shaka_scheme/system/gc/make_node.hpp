@@ -0,0 +1,62 @@
+#ifndef SHAKA_SCHEME_MAKE_NODE_HPP
+#define SHAKA_SCHEME_MAKE_NODE_HPP
+
+#include "shaka_scheme/system/gc/GC.hpp"
+#include "shaka_scheme/system/gc/init_gc.hpp"
+
+#include <string>
+#include <utility>
+
+namespace shaka {
+
+/**
+ * @brief Allocates a Data in the heap of the calling thread, constructing
+ * it in place from args. Unlike create_node, no Data is built and then
+ * copied, and the call can be inlined.
+ * @param args The arguments of a constructor of Data, usually one of the
+ * types it can hold
+ * @return The new managed NodePtr
+ */
+template <typename... Args>
+inline NodePtr make_node(Args&&... args) {
+  return NodePtr(gc::current_gc->emplace_data(std::forward<Args>(args)...));
+}
+
+/**
+ * @brief Allocates a pair.
+ */
+inline NodePtr make_pair(NodePtr car, NodePtr cdr) {
+  return make_node(DataPair(std::move(car), std::move(cdr)));
+}
+
+/**
+ * @brief Allocates the empty list.
+ */
+inline NodePtr make_null() {
+  return make_node();
+}
+
+/**
+ * @brief Allocates a number.
+ */
+inline NodePtr make_number(Number n) {
+  return make_node(std::move(n));
+}
+
+/**
+ * @brief Allocates a symbol.
+ */
+inline NodePtr make_symbol(const std::string& name) {
+  return make_node(Symbol(name));
+}
+
+/**
+ * @brief Allocates a boolean.
+ */
+inline NodePtr make_boolean(bool value) {
+  return make_node(Boolean(value));
+}
+
+} // namespace shaka
+
+#endif //SHAKA_SCHEME_MAKE_NODE_HPP
@@ -5,9 +5,29 @@
 #include "shaka_scheme/system/vm/HeapVirtualMachine.hpp"
 #include "shaka_scheme/system/gc/GCData.hpp"
 
+#include <map>
+#include <unordered_set>
+#include <vector>
+
 namespace shaka {
 namespace gc {
 
+namespace {
+
+// The weak hash tables and ephemerons reached by mark_node, whose keys can
+// only be decided once every strong reference has been marked
+thread_local std::vector<GCNode> weak_nodes;
+
+// The environments and call frames marked since the last collection. They
+// are shared by many closures and continuations, so each is walked once.
+thread_local std::unordered_set<const void*> marked_structures;
+
+// The root sets added on this thread, by id
+thread_local std::map<std::size_t, std::function<void()>> root_sets;
+thread_local std::size_t next_root_set = 0;
+
+}
+
 void mark_accumulator(const Accumulator& a) {
   mark_node(a);
 }
@@ -17,13 +37,34 @@ void mark_expression(const Expression& e) {
 }
 
 void mark_environment(const Environment& env) {
-  for(auto it = env.get_bindings().begin(); it != env.get_bindings().end();
-      it++) {
-    mark_node(it->second);
+  // Walk up the parents in a loop, stopping at one already marked
+  for (const Environment* e = &env;
+       e != nullptr && marked_structures.insert(e).second;
+       e = e->get_parent_environment()) {
+    for(auto it = e->get_bindings().begin(); it != e->get_bindings().end();
+        it++) {
+      mark_node(it->second);
+    }
   }
 }
 
 void mark_call_frame(const CallFrame& f) {
+  // Walk down the control stack in a loop, stopping at a frame already
+  // marked, such as the rest of a stack shared with a continuation
+  for (const CallFrame* frame = &f;
+       frame != nullptr && marked_structures.insert(frame).second;
+       frame = frame->get_next_frame().get()) {
+    if (frame->get_next_expression()) {
+      mark_expression(frame->get_next_expression());
+    }
+    if (frame->get_environment_pointer() != nullptr) {
+      mark_environment(*frame->get_environment_pointer());
+    }
+    mark_value_rib(frame->get_value_rib());
+    if (frame->get_procedure()) {
+      mark_node(frame->get_procedure());
+    }
+  }
 }
 
 void mark_value_rib(const ValueRib& vr) {
@@ -33,11 +74,22 @@ void mark_value_rib(const ValueRib& vr) {
 }
 
 void mark(const HeapVirtualMachine& hvm) {
-  mark_accumulator(hvm.get_accumulator());
-  mark_expression(hvm.get_expression());
-  mark_environment(*hvm.get_environment());
-  mark_call_frame(*hvm.get_call_frame());
+  // The registers are null before the VM first runs and after a Scheduler
+  // hands them back
+  if (hvm.get_accumulator()) {
+    mark_accumulator(hvm.get_accumulator());
+  }
+  if (hvm.get_expression()) {
+    mark_expression(hvm.get_expression());
+  }
+  if (hvm.get_environment() != nullptr) {
+    mark_environment(*hvm.get_environment());
+  }
+  if (hvm.get_call_frame() != nullptr) {
+    mark_call_frame(*hvm.get_call_frame());
+  }
   mark_value_rib(hvm.get_value_rib());
+  mark_root_sets();
 }
 
 void mark_node(const GCNode& node) {
@@ -56,11 +108,20 @@ void mark_node(const GCNode& node) {
     break;
   }
   case shaka::Data::Type::CLOSURE: {
-    // If the argument is a closure, mark its environment, frame, and expression
+    // If the argument is a closure, mark its environment, frames,
+    // expression, and what a stepping native procedure holds between steps
     Closure c = node->get<Closure>();
     if (c.get_call_frame() != nullptr) {
       mark_call_frame(*c.get_call_frame());
     }
+    if (c.get_prompt_frame() != nullptr) {
+      mark_call_frame(*c.get_prompt_frame());
+    }
+    for (const NodePtr& root : c.get_stepping_roots()) {
+      if (root) {
+        mark_node(root);
+      }
+    }
     if (c.get_environment() != nullptr) {
       mark_environment(*c.get_environment());
     }
@@ -69,20 +130,104 @@ void mark_node(const GCNode& node) {
     }
     break;
   }
+  case shaka::Data::Type::VECTOR: {
+    // If the argument is a vector, mark its elements
+    Vector& vector = node->get<Vector>();
+    for (std::size_t i = 0; i < vector.length(); ++i) {
+      mark_node(vector[i]);
+    }
+    break;
+  }
   case shaka::Data::Type::CALL_FRAME: {
     // If the argument is a call frame, mark its contents
     mark_call_frame(node->get<CallFrame>());
     break;
   }
+  case shaka::Data::Type::HASH_TABLE: {
+    // If the argument is a weak hash table, leave it to
+    // mark_weak_references; otherwise mark every key and value
+    if (node->get<HashTable>().is_weak()) {
+      weak_nodes.push_back(node);
+      break;
+    }
+    for (const auto& entry : node->get<HashTable>().entries()) {
+      mark_node(entry.first);
+      mark_node(entry.second);
+    }
+    break;
+  }
+  case shaka::Data::Type::EPHEMERON: {
+    // If the argument is an unbroken ephemeron, leave it to
+    // mark_weak_references
+    if (!node->get<Ephemeron>().is_broken()) {
+      weak_nodes.push_back(node);
+    }
+    break;
+  }
   default:
     break;
+  }
+}
+
+void mark_weak_references() {
+  // Mark the values of marked keys until no more are found, since marking
+  // a value may reach the key of another entry
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (std::size_t i = 0; i < weak_nodes.size(); ++i) {
+      GCNode node = weak_nodes[i];
+      if (node->get_type() == shaka::Data::Type::EPHEMERON) {
+        Ephemeron& e = node->get<Ephemeron>();
+        if (is_marked(e.get_key()) && !is_marked(e.get_datum())) {
+          mark_node(e.get_datum());
+          changed = true;
+        }
+        continue;
+      }
+      for (const auto& entry : node->get<HashTable>().entries()) {
+        if (is_marked(entry.first) && !is_marked(entry.second)) {
+          mark_node(entry.second);
+          changed = true;
+        }
+      }
+    }
+  }
+
+  // Clear every reference whose key is about to be freed
+  for (const GCNode& node : weak_nodes) {
+    if (node->get_type() == shaka::Data::Type::EPHEMERON) {
+      Ephemeron& e = node->get<Ephemeron>();
+      if (!is_marked(e.get_key())) {
+        e.set_broken();
+      }
+    } else {
+      node->get<HashTable>().remove_if([](const GCNode& key) {
+        return !is_marked(key);
+      });
+    }
+  }
+  weak_nodes.clear();
+  marked_structures.clear();
+}
+
+bool is_marked(const GCNode& node) {
+  return node.gc_data->is_marked();
+}
+
+std::size_t add_root_set(std::function<void()> mark_roots) {
+  std::size_t id = next_root_set++;
+  root_sets.insert(std::make_pair(id, mark_roots));
+  return id;
+}
+
+void remove_root_set(std::size_t id) {
+  root_sets.erase(id);
+}
 
-  /*
-   * The following two cases will be added when the respective classes
-   * have been rolled into the Data variant class
-   * case shaka::Data::Type::VECTOR
-   * case shaka::Data::Type::BYTE_VECTOR
-   */
+void mark_root_sets() {
+  for (const auto& root_set : root_sets) {
+    root_set.second();
   }
 }
 
@@ -4,7 +4,9 @@
 
 #ifndef SHAKA_SCHEME_MARK_PROCEDURES_HPP
 #define SHAKA_SCHEME_MARK_PROCEDURES_HPP
+#include <cstddef>
 #include <deque>
+#include <functional>
 
 namespace shaka {
 
@@ -21,14 +23,58 @@ using Accumulator = NodePtr;
 using Expression = NodePtr;
 using ValueRib = std::deque<NodePtr>;
 
+/**
+ * @brief Marks the registers of a VM, then every root set added on the
+ * calling thread with add_root_set.
+ */
 extern void mark(const HeapVirtualMachine& hvm);
 extern void mark_node(const GCNode& node);
 extern void mark_accumulator(const Accumulator& acc);
+/**
+ * @brief Marks the bindings of an environment and of its parents.
+ */
 extern void mark_environment(const Environment& env);
 extern void mark_expression(const Expression& e);
+/**
+ * @brief Marks a call frame and every frame below it: the expression each
+ * returns into, its environment, its value rib and its procedure.
+ */
 extern void mark_call_frame(const CallFrame& f);
 extern void mark_value_rib(const ValueRib& vr);
 
+/**
+ * @brief Finishes marking the weak hash tables and ephemerons reached by
+ * mark_node since the last call. Values are marked whose keys were marked,
+ * until no more are found, and then the entries and ephemerons whose keys
+ * are still unmarked are cleared. Also forgets which environments and call
+ * frames were walked, so the next collection walks them again. Called by
+ * GC::sweep.
+ */
+extern void mark_weak_references();
+
+/**
+ * @brief Determines whether a node was marked in the current collection.
+ */
+extern bool is_marked(const GCNode& node);
+
+/**
+ * @brief Adds a root set on the calling thread: a function that marks the
+ * nodes held outside of any VM register, such as the registers of parked
+ * green threads.
+ * @return The id to remove the root set with
+ */
+extern std::size_t add_root_set(std::function<void()> mark_roots);
+
+/**
+ * @brief Removes a root set added with add_root_set.
+ */
+extern void remove_root_set(std::size_t id);
+
+/**
+ * @brief Calls every root set added on the calling thread.
+ */
+extern void mark_root_sets();
+
 
 }
 }
@@ -16,21 +16,21 @@
 namespace shaka {
 namespace macro {
 
-bool is_primitive_set(Symbol symbol, MacroContext& context) {
+inline bool is_primitive_set(Symbol symbol, MacroContext& context) {
   try {
     if (context.hvm.get_environment()->get_value(symbol)
         ->get<PrimitiveFormMarker>() == PrimitiveFormMarker("set!")) {
       return true;
     }
-  } catch (shaka::InvalidInputException e) {
+  } catch (const shaka::InvalidInputException&) {
     return false;
-  } catch (shaka::TypeException e) {
+  } catch (const shaka::TypeException&) {
     return false;
   }
   return false;
 };
 
-MacroPtr get_macro(Symbol symbol, MacroContext& context) {
+inline MacroPtr get_macro(Symbol symbol, MacroContext& context) {
   IdentifierData current_binding(context.curr_scopes, nullptr);
   IdentifierData max_data(std::set<std::size_t>(), nullptr);
   for (auto it = context.get_bindings(symbol);
@@ -52,94 +52,94 @@ MacroPtr get_macro(Symbol symbol, MacroContext& context) {
   return max_data.macro;
 };
 
-bool is_primitive_syntax_rules(Symbol symbol, MacroContext& context) {
+inline bool is_primitive_syntax_rules(Symbol symbol, MacroContext& context) {
   try {
     if (context.hvm.get_environment()->get_value(symbol)
         ->get<PrimitiveFormMarker>()
         == PrimitiveFormMarker("syntax-rules")) {
       return true;
     }
-  } catch (shaka::InvalidInputException e) {
+  } catch (const shaka::InvalidInputException&) {
     return false;
-  } catch (shaka::TypeException e) {
+  } catch (const shaka::TypeException&) {
     return false;
   }
   return false;
 };
 
-bool is_primitive_lambda(Symbol symbol, MacroContext& context) {
+inline bool is_primitive_lambda(Symbol symbol, MacroContext& context) {
   try {
     if (context.hvm.get_environment()->get_value(symbol)
         ->get<PrimitiveFormMarker>() == PrimitiveFormMarker("lambda")) {
       return true;
     }
-  } catch (shaka::InvalidInputException e) {
+  } catch (const shaka::InvalidInputException&) {
     return false;
-  } catch (shaka::TypeException e) {
+  } catch (const shaka::TypeException&) {
     return false;
   }
   return false;
 };
 
-bool is_primitive_define(Symbol symbol, MacroContext& context) {
+inline bool is_primitive_define(Symbol symbol, MacroContext& context) {
   try {
     if (context.hvm.get_environment()->get_value(symbol)
         ->get<PrimitiveFormMarker>() == PrimitiveFormMarker("define")) {
       return true;
     }
-  } catch (shaka::InvalidInputException e) {
+  } catch (const shaka::InvalidInputException&) {
     return false;
-  } catch (shaka::TypeException e) {
+  } catch (const shaka::TypeException&) {
     return false;
   }
   return false;
 };
 
-bool is_primitive_quote(Symbol symbol, MacroContext& context) {
+inline bool is_primitive_quote(Symbol symbol, MacroContext& context) {
   try {
     if (context.hvm.get_environment()->get_value(symbol)
         ->get<PrimitiveFormMarker>() == PrimitiveFormMarker("quote")) {
       return true;
     }
-  } catch (shaka::InvalidInputException e) {
+  } catch (const shaka::InvalidInputException&) {
     return false;
-  } catch (shaka::TypeException e) {
+  } catch (const shaka::TypeException&) {
     return false;
   }
   return false;
 };
 
-bool is_primitive_define_syntax(Symbol symbol, MacroContext& context) {
+inline bool is_primitive_define_syntax(Symbol symbol, MacroContext& context) {
   try {
     if (context.hvm.get_environment()->get_value(symbol)
         ->get<PrimitiveFormMarker>() ==
         PrimitiveFormMarker("define-syntax")) {
       return true;
     }
-  } catch (shaka::InvalidInputException e) {
+  } catch (const shaka::InvalidInputException&) {
     return false;
-  } catch (shaka::TypeException e) {
+  } catch (const shaka::TypeException&) {
     return false;
   }
   return false;
 };
 
-bool is_primitive_let_syntax(Symbol symbol, MacroContext& context) {
+inline bool is_primitive_let_syntax(Symbol symbol, MacroContext& context) {
   try {
     if (context.hvm.get_environment()->get_value(symbol)
         ->get<PrimitiveFormMarker>() ==
         PrimitiveFormMarker("let-syntax")) {
       return true;
     }
-  } catch (shaka::InvalidInputException e) {
+  } catch (const shaka::InvalidInputException&) {
     return false;
-  } catch (shaka::TypeException e) {
+  } catch (const shaka::TypeException&) {
     return false;
   }
   return false;
 };
 
-bool process_define_form(NodePtr& it, MacroContext& context) {
+inline bool process_define_form(NodePtr& it, MacroContext& context) {
   if (!is_primitive_define(core::car(it)->get<Symbol>(), context)) {
     return false;
   }
@@ -170,9 +170,11 @@ bool process_define_form(NodePtr& it, MacroContext& context) {
     it = core::cdr(it);
     return true;
   }
+  throw MacroExpansionException(60009, "(define) must have an identifier "
+      "or a list as its second argument");
 };
 
-bool process_set_form(NodePtr& it, MacroContext& context) {
+inline bool process_set_form(NodePtr& it, MacroContext& context) {
   if (!is_primitive_set(core::car(it)->get<Symbol>(), context)) {
     return false;
   }
@@ -189,7 +191,7 @@ bool process_set_form(NodePtr& it, MacroContext& context) {
   return true;
 };
 
-bool process_quote_form(NodePtr& it, MacroContext& context) {
+inline bool process_quote_form(NodePtr& it, MacroContext& context) {
   if (!is_primitive_quote(core::car(it)->get<Symbol>(), context)) {
     return false;
   }
@@ -201,7 +203,7 @@ bool process_quote_form(NodePtr& it, MacroContext& context) {
   return true;
 };
 
-bool process_lambda_form(NodePtr& it, MacroContext& context) {
+inline bool process_lambda_form(NodePtr& it, MacroContext& context) {
   if (!is_primitive_lambda(core::car(it)->get<Symbol>(), context)) {
     return false;
   }
@@ -264,7 +266,7 @@ bool process_lambda_form(NodePtr& it, MacroContext& context) {
   }
 };
 
-std::ostream& operator<<(
+inline std::ostream& operator<<(
     std::ostream& lhs,
     const MacroContext& rhs) {
   lhs << "MacroContext(curr_scope: " << rhs.curr_scope << " | scope_stack: { ";
@@ -279,7 +281,7 @@ std::ostream& operator<<(
   return lhs;
 }
 
-void run_macro_expansion(
+inline void run_macro_expansion(
     NodePtr root,
     MacroContext& macro_context) {
   //std::cout << "\nBEFORE TRAVERSE TREE: " << *root << std::endl;
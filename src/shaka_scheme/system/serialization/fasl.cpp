@@ -0,0 +1,503 @@
+#include "shaka_scheme/system/serialization/fasl.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+namespace shaka {
+namespace fasl {
+
+namespace {
+
+const char magic[7] = {'S', 'H', 'K', 'F', 'A', 'S', 'L'};
+const std::uint64_t version = 1;
+
+/**
+ * @brief The tag that starts every object. DEFINE precedes an object that
+ * later REF records refer to, and LIST is followed by a count of pairs,
+ * their cars, and then the tail of the last pair.
+ */
+enum Tag : unsigned char {
+  NULL_LIST = 0,
+  UNSPECIFIED,
+  FALSE,
+  TRUE,
+  INTEGER,
+  RATIONAL,
+  REAL,
+  STRING,
+  SYMBOL,
+  SYMBOL_REF,
+  LIST,
+  VECTOR,
+  BYTEVECTOR,
+  DEFINE,
+  REF
+};
+
+void malformed(const std::string& what) {
+  throw InvalidInputException(10071, "fasl: " + what);
+}
+
+/**
+ * @brief Whether an object has an identity worth keeping.
+ */
+bool is_shareable(NodePtr node) {
+  switch (node->get_type()) {
+  case Data::Type::DATA_PAIR:
+  case Data::Type::VECTOR:
+  case Data::Type::STRING:
+  case Data::Type::BYTEVECTOR:
+    return true;
+  default:
+    return false;
+  }
+}
+
+} // namespace
+
+Writer::Writer(std::ostream& out) :
+    out(out),
+    started(false) {}
+
+void Writer::write(NodePtr datum) {
+  if (!started) {
+    put_bytes(magic, sizeof(magic));
+    put_varint(version);
+    started = true;
+  }
+  seen.clear();
+  labels.clear();
+  symbols.clear();
+  find_shared(datum);
+  write_object(datum);
+  if (!out) {
+    throw InvalidInputException(10070, "fasl: cannot write to the stream");
+  }
+}
+
+void Writer::find_shared(NodePtr datum) {
+  std::vector<NodePtr> stack{datum};
+  while (!stack.empty()) {
+    NodePtr node = stack.back();
+    stack.pop_back();
+    if (!is_shareable(node)) {
+      continue;
+    }
+    auto visit = seen.emplace(node.get(), false);
+    if (!visit.second) {
+      visit.first->second = true;
+      continue;
+    }
+    if (node->get_type() == Data::Type::DATA_PAIR) {
+      stack.push_back(node->get<DataPair>().cdr());
+      stack.push_back(node->get<DataPair>().car());
+    } else if (node->get_type() == Data::Type::VECTOR) {
+      Vector& vector = node->get<Vector>();
+      for (std::size_t i = vector.length(); i > 0; --i) {
+        stack.push_back(vector[i - 1]);
+      }
+    }
+  }
+}
+
+bool Writer::write_label(NodePtr node) {
+  if (!is_shareable(node) || !seen.find(node.get())->second) {
+    return false;
+  }
+  auto label = labels.find(node.get());
+  if (label != labels.end()) {
+    put_byte(REF);
+    put_varint(label->second);
+    return true;
+  }
+  labels.emplace(node.get(), labels.size());
+  put_byte(DEFINE);
+  return false;
+}
+
+void Writer::write_object(NodePtr node) {
+  // Follows the cdrs in a loop, and the cars by recursion
+  while (true) {
+    if (write_label(node)) {
+      return;
+    }
+    if (node->get_type() != Data::Type::DATA_PAIR) {
+      write_atom(node);
+      return;
+    }
+    std::vector<NodePtr> run{node};
+    NodePtr tail = node->get<DataPair>().cdr();
+    while (tail->get_type() == Data::Type::DATA_PAIR &&
+           !seen.find(tail.get())->second) {
+      run.push_back(tail);
+      tail = tail->get<DataPair>().cdr();
+    }
+    put_byte(LIST);
+    put_varint(run.size());
+    for (const NodePtr& pair : run) {
+      write_object(pair->get<DataPair>().car());
+    }
+    node = tail;
+  }
+}
+
+void Writer::write_atom(NodePtr node) {
+  switch (node->get_type()) {
+  case Data::Type::NULL_LIST:
+    put_byte(NULL_LIST);
+    break;
+  case Data::Type::UNSPECIFIED:
+    put_byte(UNSPECIFIED);
+    break;
+  case Data::Type::BOOLEAN:
+    put_byte(node->get<Boolean>().get_value() ? TRUE : FALSE);
+    break;
+  case Data::Type::NUMBER: {
+    const Number& number = node->get<Number>();
+    if (number.get_type() == Number::NumberType::INTEGER) {
+      put_byte(INTEGER);
+      put_integer(number.get<Integer>().get_value());
+    } else if (number.get_type() == Number::NumberType::RATIONAL) {
+      put_byte(RATIONAL);
+      put_integer(number.get<Rational>().get_numerator());
+      put_integer(number.get<Rational>().get_denominator());
+    } else {
+      double value = number.get<Real>().get_value();
+      char bytes[sizeof(double)];
+      std::uint64_t bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+      for (std::size_t i = 0; i < sizeof(bytes); ++i) {
+        bytes[i] = static_cast<char>(bits >> (8 * i));
+      }
+      put_byte(REAL);
+      put_bytes(bytes, sizeof(bytes));
+    }
+    break;
+  }
+  case Data::Type::STRING: {
+    const std::string& text = node->get<String>().get_string();
+    put_byte(STRING);
+    put_varint(text.size());
+    put_bytes(text.data(), text.size());
+    break;
+  }
+  case Data::Type::SYMBOL: {
+    std::string name = node->get<Symbol>().get_value();
+    auto symbol = symbols.find(name);
+    if (symbol != symbols.end()) {
+      put_byte(SYMBOL_REF);
+      put_varint(symbol->second);
+      break;
+    }
+    symbols.emplace(name, symbols.size());
+    put_byte(SYMBOL);
+    put_varint(name.size());
+    put_bytes(name.data(), name.size());
+    break;
+  }
+  case Data::Type::VECTOR: {
+    Vector& vector = node->get<Vector>();
+    put_byte(VECTOR);
+    put_varint(vector.length());
+    for (std::size_t i = 0; i < vector.length(); ++i) {
+      write_object(vector[i]);
+    }
+    break;
+  }
+  case Data::Type::BYTEVECTOR: {
+    Bytevector& bytevector = node->get<Bytevector>();
+    put_byte(BYTEVECTOR);
+    put_varint(bytevector.length());
+    std::string bytes(bytevector.length(), '\0');
+    for (std::size_t i = 0; i < bytevector.length(); ++i) {
+      bytes[i] = static_cast<char>(bytevector[i]);
+    }
+    put_bytes(bytes.data(), bytes.size());
+    break;
+  }
+  default:
+    throw InvalidInputException(10070, "fasl: cannot write an object of "
+        "type " + std::to_string(static_cast<int>(node->get_type())));
+  }
+}
+
+void Writer::put_byte(unsigned char byte) {
+  if (out.rdbuf()->sputc(static_cast<char>(byte)) ==
+      std::char_traits<char>::eof()) {
+    out.setstate(std::ios::badbit);
+  }
+}
+
+void Writer::put_varint(std::uint64_t value) {
+  while (value >= 0x80) {
+    put_byte(static_cast<unsigned char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  put_byte(static_cast<unsigned char>(value));
+}
+
+void Writer::put_integer(std::int64_t value) {
+  put_varint((static_cast<std::uint64_t>(value) << 1) ^
+      static_cast<std::uint64_t>(value >> 63));
+}
+
+void Writer::put_bytes(const char* bytes, std::size_t size) {
+  if (out.rdbuf()->sputn(bytes, static_cast<std::streamsize>(size)) !=
+      static_cast<std::streamsize>(size)) {
+    out.setstate(std::ios::badbit);
+  }
+}
+
+Reader::Reader(std::istream& in) :
+    in(in),
+    started(false) {}
+
+bool Reader::read(NodePtr& datum) {
+  if (in.rdbuf()->sgetc() == std::char_traits<char>::eof()) {
+    return false;
+  }
+  if (!started) {
+    if (get_bytes(sizeof(magic)) != std::string(magic, sizeof(magic))) {
+      malformed("not a FASL stream");
+    }
+    if (get_varint() != version) {
+      malformed("unsupported version");
+    }
+    started = true;
+    if (in.rdbuf()->sgetc() == std::char_traits<char>::eof()) {
+      return false;
+    }
+  }
+  labels.clear();
+  symbols.clear();
+  placeholder = create_node(Data());
+  datum = read_object();
+  return true;
+}
+
+NodePtr Reader::read_object() {
+  // Builds runs of pairs in a loop, filling in the cdr of the last pair
+  // of each run with the object that follows it
+  NodePtr result;
+  NodePtr last_pair;
+  while (true) {
+    unsigned char tag = get_tag();
+    bool define = tag == DEFINE;
+    if (define) {
+      tag = get_tag();
+    }
+    NodePtr value;
+    if (tag == LIST) {
+      std::uint64_t count = get_length();
+      if (count == 0) {
+        malformed("empty list record");
+      }
+      for (std::uint64_t i = 0; i < count; ++i) {
+        NodePtr pair = create_node(DataPair(placeholder, placeholder));
+        if (i == 0) {
+          if (define) {
+            labels.push_back(pair);
+          }
+          value = pair;
+          if (last_pair) {
+            last_pair->get<DataPair>().set_cdr(pair);
+          } else {
+            result = pair;
+          }
+        } else {
+          last_pair->get<DataPair>().set_cdr(pair);
+        }
+        last_pair = pair;
+        NodePtr car = read_object();
+        pair->get<DataPair>().set_car(car);
+      }
+      continue;
+    }
+    if (tag == REF) {
+      std::uint64_t label = get_varint();
+      if (define || label >= labels.size()) {
+        malformed("bad label");
+      }
+      value = labels[label];
+    } else {
+      value = read_atom(tag, define);
+    }
+    if (last_pair) {
+      last_pair->get<DataPair>().set_cdr(value);
+      return result;
+    }
+    return value;
+  }
+}
+
+NodePtr Reader::read_atom(unsigned char tag, bool define) {
+  NodePtr value;
+  switch (tag) {
+  case NULL_LIST:
+    value = create_node(Data());
+    break;
+  case UNSPECIFIED:
+    value = create_unspecified();
+    break;
+  case FALSE:
+  case TRUE:
+    value = create_node(Boolean(tag == TRUE));
+    break;
+  case INTEGER:
+    value = create_node(Number(static_cast<int>(get_integer())));
+    break;
+  case RATIONAL: {
+    int numerator = static_cast<int>(get_integer());
+    int denominator = static_cast<int>(get_integer());
+    if (denominator == 0) {
+      malformed("zero denominator");
+    }
+    value = create_node(Number(numerator, denominator));
+    break;
+  }
+  case REAL: {
+    std::string bytes = get_bytes(sizeof(double));
+    std::uint64_t bits = 0;
+    for (std::size_t i = 0; i < sizeof(double); ++i) {
+      bits |= static_cast<std::uint64_t>(
+          static_cast<unsigned char>(bytes[i])) << (8 * i);
+    }
+    double real;
+    std::memcpy(&real, &bits, sizeof(real));
+    value = create_node(Number(real));
+    break;
+  }
+  case STRING:
+    value = create_node(String(get_bytes(get_length())));
+    break;
+  case SYMBOL:
+    symbols.emplace_back(get_bytes(get_length()));
+    value = create_node(symbols.back());
+    break;
+  case SYMBOL_REF: {
+    std::uint64_t index = get_varint();
+    if (index >= symbols.size()) {
+      malformed("bad symbol reference");
+    }
+    value = create_node(symbols[index]);
+    break;
+  }
+  case VECTOR: {
+    // The elements may refer back to the vector, so it is labelled before
+    // they are read. They are collected as they are read, so a corrupted
+    // length fails at the end of the stream instead of allocating all of it
+    // up front.
+    std::uint64_t length = get_length();
+    value = create_node(Vector(0));
+    if (define) {
+      labels.push_back(value);
+    }
+    std::vector<NodePtr> elements;
+    for (std::uint64_t i = 0; i < length; ++i) {
+      elements.push_back(read_object());
+    }
+    Vector& vector = value->get<Vector>();
+    vector = Vector(elements.size());
+    for (std::size_t i = 0; i < elements.size(); ++i) {
+      vector[i] = elements[i];
+    }
+    return value;
+  }
+  case BYTEVECTOR: {
+    std::string bytes = get_bytes(get_length());
+    value = create_node(Bytevector(bytes.size()));
+    for (std::size_t i = 0; i < bytes.size(); ++i) {
+      value->get<Bytevector>()[i] = static_cast<unsigned char>(bytes[i]);
+    }
+    break;
+  }
+  default:
+    malformed("bad tag");
+  }
+  if (define) {
+    if (tag != STRING && tag != BYTEVECTOR) {
+      malformed("label on an object without identity");
+    }
+    labels.push_back(value);
+  }
+  return value;
+}
+
+unsigned char Reader::get_tag() {
+  int byte = in.rdbuf()->sbumpc();
+  if (byte == std::char_traits<char>::eof()) {
+    malformed("truncated");
+  }
+  return static_cast<unsigned char>(byte);
+}
+
+std::uint64_t Reader::get_varint() {
+  std::uint64_t value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    unsigned char byte = get_tag();
+    value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      return value;
+    }
+  }
+  malformed("varint too long");
+  return 0;
+}
+
+std::int64_t Reader::get_integer() {
+  std::uint64_t value = get_varint();
+  std::int64_t integer = static_cast<std::int64_t>(value >> 1) ^
+      -static_cast<std::int64_t>(value & 1);
+  if (integer < std::numeric_limits<int>::min() ||
+      integer > std::numeric_limits<int>::max()) {
+    malformed("integer out of range");
+  }
+  return integer;
+}
+
+std::uint64_t Reader::get_length() {
+  std::uint64_t length = get_varint();
+  if (length > std::numeric_limits<std::uint32_t>::max()) {
+    malformed("length out of range");
+  }
+  return length;
+}
+
+std::string Reader::get_bytes(std::size_t size) {
+  // Reads in chunks, so a corrupted length fails at the end of the stream
+  // instead of allocating all of it up front
+  const std::size_t chunk = 1 << 16;
+  std::string bytes;
+  while (bytes.size() < size) {
+    std::size_t offset = bytes.size();
+    std::size_t count = std::min(chunk, size - offset);
+    bytes.resize(offset + count);
+    if (in.rdbuf()->sgetn(&bytes[offset], static_cast<std::streamsize>(count))
+        != static_cast<std::streamsize>(count)) {
+      malformed("truncated");
+    }
+  }
+  return bytes;
+}
+
+std::string encode(NodePtr datum) {
+  std::ostringstream out;
+  Writer writer(out);
+  writer.write(datum);
+  return out.str();
+}
+
+NodePtr decode(const std::string& bytes) {
+  std::istringstream in(bytes);
+  Reader reader(in);
+  NodePtr datum;
+  if (!reader.read(datum)) {
+    malformed("no datum");
+  }
+  return datum;
+}
+
+} // namespace fasl
+} // namespace shaka
@@ -0,0 +1,117 @@
+#ifndef SHAKA_SCHEME_FASL_HPP
+#define SHAKA_SCHEME_FASL_HPP
+
+#include "shaka_scheme/system/base/Data.hpp"
+#include "shaka_scheme/system/exceptions/InvalidInputException.hpp"
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace shaka {
+namespace fasl {
+
+/**
+ * @brief Writes data to a stream in the FASL binary format.
+ *
+ * A stream starts with a short header, followed by one record per datum.
+ * Every object starts with a type tag, and tags, lengths and integers are
+ * encoded as LEB128 varints, with integers zigzag-encoded first. Runs of
+ * pairs are written as one list record, so long lists cost neither
+ * recursion nor a tag per pair. Within a datum, every symbol name is
+ * written once and then referred to by number.
+ *
+ * Pairs, vectors, strings and bytevectors that are reachable more than once
+ * from a datum are written once, and referred to by label afterwards, so
+ * shared structure and cycles are kept.
+ *
+ * Supported are the empty list, the unspecified value, booleans, numbers,
+ * strings, symbols, pairs, vectors and bytevectors.
+ */
+class Writer {
+public:
+  explicit Writer(std::ostream& out);
+
+  /**
+   * @brief Writes one datum. The datum shares nothing with the data
+   * written before it.
+   * @throws InvalidInputException on an object FASL cannot hold, such as a
+   * procedure
+   */
+  void write(NodePtr datum);
+
+private:
+  void find_shared(NodePtr datum);
+  void write_object(NodePtr node);
+  void write_atom(NodePtr node);
+  bool write_label(NodePtr node);
+  void put_byte(unsigned char byte);
+  void put_varint(std::uint64_t value);
+  void put_integer(std::int64_t value);
+  void put_bytes(const char* bytes, std::size_t size);
+
+  std::ostream& out;
+  bool started;
+
+  /**
+   * @brief For every object seen by find_shared, whether it was seen more
+   * than once.
+   */
+  std::unordered_map<const Data*, bool> seen;
+  std::unordered_map<const Data*, std::uint64_t> labels;
+  std::unordered_map<std::string, std::uint64_t> symbols;
+};
+
+/**
+ * @brief Reads data written by a Writer from a stream.
+ */
+class Reader {
+public:
+  explicit Reader(std::istream& in);
+
+  /**
+   * @brief Reads the next datum.
+   * @param datum Set to the datum that was read
+   * @return false if the stream ended before the datum
+   * @throws InvalidInputException if the stream is malformed or ends in the
+   * middle of a datum
+   */
+  bool read(NodePtr& datum);
+
+private:
+  NodePtr read_object();
+  NodePtr read_atom(unsigned char tag, bool define);
+  unsigned char get_tag();
+  std::uint64_t get_varint();
+  std::int64_t get_integer();
+  std::uint64_t get_length();
+  std::string get_bytes(std::size_t size);
+
+  std::istream& in;
+  bool started;
+  std::vector<NodePtr> labels;
+  std::vector<Symbol> symbols;
+
+  /**
+   * @brief What pairs and vectors hold until their elements are read.
+   */
+  NodePtr placeholder;
+};
+
+/**
+ * @brief Encodes one datum, with its header, into a string.
+ */
+std::string encode(NodePtr datum);
+
+/**
+ * @brief Decodes one datum encoded by encode.
+ * @throws InvalidInputException if the string holds no datum
+ */
+NodePtr decode(const std::string& bytes);
+
+} // namespace fasl
+} // namespace shaka
+
+#endif //SHAKA_SCHEME_FASL_HPP
@@ -0,0 +1,45 @@
+#include "shaka_scheme/system/serialization/files.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+#include <unistd.h>
+
+namespace shaka {
+namespace serialization {
+
+bool write_file_atomically(const std::string& path,
+                           const std::string& bytes) {
+  static std::atomic<unsigned> counter(0);
+  std::string temporary = path + ".tmp." + std::to_string(::getpid()) + "." +
+      std::to_string(counter++);
+  {
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    file.flush();
+    if (!file) {
+      std::remove(temporary.c_str());
+      return false;
+    }
+  }
+  if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+    std::remove(temporary.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool read_file(const std::string& path, std::string& bytes) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  bytes.assign(std::istreambuf_iterator<char>(file),
+               std::istreambuf_iterator<char>());
+  return !file.bad();
+}
+
+} // namespace serialization
+} // namespace shaka
@@ -0,0 +1,31 @@
+#ifndef SHAKA_SCHEME_FILES_HPP
+#define SHAKA_SCHEME_FILES_HPP
+
+#include <string>
+
+namespace shaka {
+namespace serialization {
+
+/**
+ * @brief Replaces the contents of a file. The bytes are written to a
+ * temporary file next to path, which is then renamed over path, so readers
+ * see either the old or the new contents, never a partial file, even with
+ * several writers at once.
+ * @param path The file to write
+ * @param bytes The new contents
+ * @return false if the file could not be written
+ */
+bool write_file_atomically(const std::string& path, const std::string& bytes);
+
+/**
+ * @brief Reads a whole file.
+ * @param path The file to read
+ * @param bytes Set to the contents of the file
+ * @return false if the file could not be read
+ */
+bool read_file(const std::string& path, std::string& bytes);
+
+} // namespace serialization
+} // namespace shaka
+
+#endif //SHAKA_SCHEME_FILES_HPP
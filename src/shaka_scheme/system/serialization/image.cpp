@@ -0,0 +1,771 @@
+#include "shaka_scheme/system/serialization/image.hpp"
+#include "shaka_scheme/system/serialization/files.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace shaka {
+namespace image {
+
+namespace {
+
+const char magic[8] = {'S', 'H', 'A', 'K', 'A', 'I', 'M', 'G'};
+const std::uint32_t version = 1;
+const std::uint32_t none = 0xffffffff;
+
+/**
+ * @brief The tag that starts every object record of an image.
+ */
+enum class Tag : unsigned char {
+  NULL_LIST = 0,
+  UNSPECIFIED,
+  BOOLEAN,
+  INTEGER,
+  RATIONAL,
+  REAL,
+  STRING,
+  SYMBOL,
+  PRIMITIVE_FORM,
+  DATA_PAIR,
+  VECTOR,
+  BYTEVECTOR,
+  CLOSURE,
+  NATIVE
+};
+
+void malformed(const std::string& what) {
+  throw InvalidInputException(10067, "image: " + what);
+}
+
+/**
+ * @brief Appends little-endian fields to a buffer.
+ */
+class Writer {
+public:
+  void put_u8(unsigned char value) {
+    buffer.push_back(static_cast<char>(value));
+  }
+
+  void put_u32(std::uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+      put_u8(static_cast<unsigned char>(value >> shift));
+    }
+  }
+
+  void put_u64(std::uint64_t value) {
+    for (int shift = 0; shift < 64; shift += 8) {
+      put_u8(static_cast<unsigned char>(value >> shift));
+    }
+  }
+
+  void put_bytes(const char* bytes, std::size_t size) {
+    buffer.append(bytes, size);
+  }
+
+  void put_string(const std::string& value) {
+    put_u32(static_cast<std::uint32_t>(value.size()));
+    put_bytes(value.data(), value.size());
+  }
+
+  std::string buffer;
+};
+
+/**
+ * @brief Reads little-endian fields from a buffer, checking every read
+ * against its end.
+ */
+class Reader {
+public:
+  Reader(const char* data, std::size_t size) :
+      data(data),
+      size(size),
+      position(0) {}
+
+  unsigned char get_u8() {
+    require(1);
+    return static_cast<unsigned char>(data[position++]);
+  }
+
+  std::uint32_t get_u32() {
+    require(4);
+    std::uint32_t value = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+      value |= static_cast<std::uint32_t>(
+          static_cast<unsigned char>(data[position++])) << shift;
+    }
+    return value;
+  }
+
+  std::uint64_t get_u64() {
+    require(8);
+    std::uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 8) {
+      value |= static_cast<std::uint64_t>(
+          static_cast<unsigned char>(data[position++])) << shift;
+    }
+    return value;
+  }
+
+  const char* get_bytes(std::size_t count) {
+    require(count);
+    const char* bytes = data + position;
+    position += count;
+    return bytes;
+  }
+
+  std::string get_string() {
+    std::uint32_t length = get_u32();
+    return std::string(get_bytes(length), length);
+  }
+
+  /**
+   * @brief Checks that count more bytes can be read.
+   */
+  void require(std::size_t count) const {
+    if (size - position < count) {
+      malformed("truncated");
+    }
+  }
+
+  std::size_t remaining() const {
+    return size - position;
+  }
+
+  std::size_t get_position() const {
+    return position;
+  }
+
+  void seek(std::size_t new_position) {
+    position = new_position;
+  }
+
+private:
+  const char* data;
+  std::size_t size;
+  std::size_t position;
+};
+
+EnvPtr as_environment(std::shared_ptr<IEnvironment<Symbol, NodePtr>> env) {
+  if (!env) {
+    return nullptr;
+  }
+  EnvPtr environment = std::dynamic_pointer_cast<Environment>(env);
+  if (!environment) {
+    throw InvalidInputException(10066, "image: unsupported environment");
+  }
+  return environment;
+}
+
+/**
+ * @brief Numbers every object reachable from an environment, then writes
+ * the records in that order, so that every reference is an index that is
+ * already known.
+ */
+class ImageWriter {
+public:
+  ImageWriter(const NativeTable& natives) :
+      natives(natives) {}
+
+  std::string write(EnvPtr env) {
+    std::uint32_t root = environment(env);
+    discover();
+
+    out.put_bytes(magic, sizeof(magic));
+    out.put_u32(version);
+    out.put_u32(static_cast<std::uint32_t>(symbols.size()));
+    for (const std::string& name : symbols) {
+      out.put_string(name);
+    }
+    out.put_u32(static_cast<std::uint32_t>(native_ids.size()));
+    for (const std::string& id : native_ids) {
+      out.put_string(id);
+    }
+    out.put_u32(static_cast<std::uint32_t>(environments.size()));
+    out.put_u32(static_cast<std::uint32_t>(nodes.size()));
+    out.put_u32(root);
+    for (const NodePtr& node : nodes) {
+      write_node(node);
+    }
+    for (const EnvPtr& environment : environments) {
+      write_environment(environment);
+    }
+    return out.buffer;
+  }
+
+private:
+  std::uint32_t symbol(const std::string& name) {
+    auto it = symbol_indices.find(name);
+    if (it != symbol_indices.end()) {
+      return it->second;
+    }
+    std::uint32_t index = static_cast<std::uint32_t>(symbols.size());
+    symbols.push_back(name);
+    symbol_indices.emplace(name, index);
+    return index;
+  }
+
+  std::uint32_t native(NodePtr node) {
+    const std::string* id = natives.get_id(node);
+    if (!id) {
+      throw InvalidInputException(10066,
+                                  "image: native procedure without an id");
+    }
+    auto it = native_indices.find(*id);
+    if (it != native_indices.end()) {
+      return it->second;
+    }
+    std::uint32_t index = static_cast<std::uint32_t>(native_ids.size());
+    native_ids.push_back(*id);
+    native_indices.emplace(*id, index);
+    return index;
+  }
+
+  std::uint32_t node(NodePtr node) {
+    if (!node) {
+      return none;
+    }
+    auto it = node_indices.find(node.get());
+    if (it != node_indices.end()) {
+      return it->second;
+    }
+    std::uint32_t index = static_cast<std::uint32_t>(nodes.size());
+    nodes.push_back(node);
+    node_indices.emplace(node.get(), index);
+    return index;
+  }
+
+  std::uint32_t environment(EnvPtr env) {
+    if (!env) {
+      return none;
+    }
+    auto it = environment_indices.find(env.get());
+    if (it != environment_indices.end()) {
+      return it->second;
+    }
+    std::uint32_t index = static_cast<std::uint32_t>(environments.size());
+    environments.push_back(env);
+    environment_indices.emplace(env.get(), index);
+    return index;
+  }
+
+  /**
+   * @brief Numbers the objects breadth first, so that long lists do not
+   * recurse.
+   */
+  void discover() {
+    std::size_t next_node = 0;
+    std::size_t next_environment = 0;
+    while (next_node < nodes.size() ||
+           next_environment < environments.size()) {
+      while (next_environment < environments.size()) {
+        EnvPtr env = environments[next_environment++];
+        environment(as_environment(env->get_parent()));
+        for (const auto& binding : env->get_bindings()) {
+          symbol(binding.first.get_value());
+          node(binding.second);
+        }
+      }
+      while (next_node < nodes.size()) {
+        discover_children(nodes[next_node++]);
+      }
+    }
+  }
+
+  void discover_children(NodePtr current) {
+    switch (current->get_type()) {
+    case Data::Type::NULL_LIST:
+    case Data::Type::UNSPECIFIED:
+    case Data::Type::BOOLEAN:
+    case Data::Type::NUMBER:
+    case Data::Type::STRING:
+    case Data::Type::BYTEVECTOR:
+      break;
+    case Data::Type::SYMBOL:
+      symbol(current->get<Symbol>().get_value());
+      break;
+    case Data::Type::PRIMITIVE_FORM:
+      symbol(current->get<PrimitiveFormMarker>().get());
+      break;
+    case Data::Type::DATA_PAIR:
+      node(current->get<DataPair>().car());
+      node(current->get<DataPair>().cdr());
+      break;
+    case Data::Type::VECTOR: {
+      Vector& vector = current->get<Vector>();
+      for (std::size_t i = 0; i < vector.length(); ++i) {
+        node(vector[i]);
+      }
+      break;
+    }
+    case Data::Type::CLOSURE: {
+      Closure& closure = current->get<Closure>();
+      if (closure.is_continuation_closure()) {
+        throw InvalidInputException(10066, "image: cannot save a "
+            "continuation");
+      }
+      if (closure.is_native_closure() || closure.is_stepping_closure()) {
+        native(current);
+        break;
+      }
+      environment(closure.get_environment());
+      node(closure.get_function_body());
+      for (const Symbol& variable : closure.get_variable_list()) {
+        symbol(variable.get_value());
+      }
+      break;
+    }
+    default:
+      throw InvalidInputException(10066, "image: cannot save an object of "
+          "type " + std::to_string(static_cast<int>(current->get_type())));
+    }
+  }
+
+  void write_node(NodePtr current) {
+    switch (current->get_type()) {
+    case Data::Type::NULL_LIST:
+      out.put_u8(static_cast<unsigned char>(Tag::NULL_LIST));
+      break;
+    case Data::Type::UNSPECIFIED:
+      out.put_u8(static_cast<unsigned char>(Tag::UNSPECIFIED));
+      break;
+    case Data::Type::BOOLEAN:
+      out.put_u8(static_cast<unsigned char>(Tag::BOOLEAN));
+      out.put_u8(current->get<Boolean>().get_value() ? 1 : 0);
+      break;
+    case Data::Type::NUMBER:
+      write_number(current->get<Number>());
+      break;
+    case Data::Type::STRING:
+      out.put_u8(static_cast<unsigned char>(Tag::STRING));
+      out.put_string(current->get<String>().get_string());
+      break;
+    case Data::Type::SYMBOL:
+      out.put_u8(static_cast<unsigned char>(Tag::SYMBOL));
+      out.put_u32(symbol(current->get<Symbol>().get_value()));
+      break;
+    case Data::Type::PRIMITIVE_FORM:
+      out.put_u8(static_cast<unsigned char>(Tag::PRIMITIVE_FORM));
+      out.put_u32(symbol(current->get<PrimitiveFormMarker>().get()));
+      break;
+    case Data::Type::DATA_PAIR:
+      out.put_u8(static_cast<unsigned char>(Tag::DATA_PAIR));
+      out.put_u32(node(current->get<DataPair>().car()));
+      out.put_u32(node(current->get<DataPair>().cdr()));
+      break;
+    case Data::Type::VECTOR: {
+      Vector& vector = current->get<Vector>();
+      out.put_u8(static_cast<unsigned char>(Tag::VECTOR));
+      out.put_u32(static_cast<std::uint32_t>(vector.length()));
+      for (std::size_t i = 0; i < vector.length(); ++i) {
+        out.put_u32(node(vector[i]));
+      }
+      break;
+    }
+    case Data::Type::BYTEVECTOR: {
+      Bytevector& bytevector = current->get<Bytevector>();
+      out.put_u8(static_cast<unsigned char>(Tag::BYTEVECTOR));
+      out.put_u32(static_cast<std::uint32_t>(bytevector.length()));
+      for (std::size_t i = 0; i < bytevector.length(); ++i) {
+        out.put_u8(bytevector[i]);
+      }
+      break;
+    }
+    default: {
+      Closure& closure = current->get<Closure>();
+      if (closure.is_native_closure() || closure.is_stepping_closure()) {
+        out.put_u8(static_cast<unsigned char>(Tag::NATIVE));
+        out.put_u32(native(current));
+        break;
+      }
+      out.put_u8(static_cast<unsigned char>(Tag::CLOSURE));
+      out.put_u32(environment(closure.get_environment()));
+      out.put_u32(node(closure.get_function_body()));
+      out.put_u8(closure.is_variable_arity() ? 1 : 0);
+      VariableList variables = closure.get_variable_list();
+      out.put_u32(static_cast<std::uint32_t>(variables.size()));
+      for (const Symbol& variable : variables) {
+        out.put_u32(symbol(variable.get_value()));
+      }
+    }
+    }
+  }
+
+  void write_number(const Number& number) {
+    switch (number.get_type()) {
+    case Number::NumberType::INTEGER:
+      out.put_u8(static_cast<unsigned char>(Tag::INTEGER));
+      out.put_u32(static_cast<std::uint32_t>(
+          number.get<Integer>().get_value()));
+      break;
+    case Number::NumberType::RATIONAL:
+      out.put_u8(static_cast<unsigned char>(Tag::RATIONAL));
+      out.put_u32(static_cast<std::uint32_t>(
+          number.get<Rational>().get_numerator()));
+      out.put_u32(static_cast<std::uint32_t>(
+          number.get<Rational>().get_denominator()));
+      break;
+    case Number::NumberType::REAL: {
+      double value = number.get<Real>().get_value();
+      std::uint64_t bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+      out.put_u8(static_cast<unsigned char>(Tag::REAL));
+      out.put_u64(bits);
+      break;
+    }
+    }
+  }
+
+  void write_environment(EnvPtr env) {
+    out.put_u32(environment(as_environment(env->get_parent())));
+    const std::map<Symbol, NodePtr>& bindings = env->get_bindings();
+    out.put_u32(static_cast<std::uint32_t>(bindings.size()));
+    for (const auto& binding : bindings) {
+      out.put_u32(symbol(binding.first.get_value()));
+      out.put_u32(node(binding.second));
+    }
+  }
+
+  const NativeTable& natives;
+  Writer out;
+  std::vector<std::string> symbols;
+  std::unordered_map<std::string, std::uint32_t> symbol_indices;
+  std::vector<std::string> native_ids;
+  std::unordered_map<std::string, std::uint32_t> native_indices;
+  std::vector<NodePtr> nodes;
+  std::unordered_map<const Data*, std::uint32_t> node_indices;
+  std::vector<EnvPtr> environments;
+  std::unordered_map<const Environment*, std::uint32_t> environment_indices;
+};
+
+/**
+ * @brief Rebuilds the objects of an image in three passes over the records:
+ * the first creates every object, with placeholders in pairs and vectors,
+ * the second creates the Closures, whose bodies are then known, and the
+ * third fills in the pairs and vectors.
+ */
+class ImageReader {
+public:
+  ImageReader(const char* data, std::size_t size,
+              const NativeTable& natives) :
+      in(data, size),
+      natives(natives) {}
+
+  EnvPtr read() {
+    if (std::memcmp(in.get_bytes(sizeof(magic)), magic, sizeof(magic)) != 0) {
+      malformed("not an image");
+    }
+    if (in.get_u32() != version) {
+      malformed("unsupported version");
+    }
+    std::uint32_t symbol_count = count(4);
+    symbols.reserve(symbol_count);
+    for (std::uint32_t i = 0; i < symbol_count; ++i) {
+      symbols.emplace_back(in.get_string());
+    }
+    std::uint32_t native_count = count(4);
+    for (std::uint32_t i = 0; i < native_count; ++i) {
+      native_nodes.push_back(natives.get_native(in.get_string()));
+    }
+    std::uint32_t environment_count = count(8);
+    std::uint32_t node_count = count(1);
+    std::uint32_t root = in.get_u32();
+
+    for (std::uint32_t i = 0; i < environment_count; ++i) {
+      environments.push_back(std::make_shared<Environment>(nullptr));
+    }
+    nodes.resize(node_count);
+    std::vector<std::size_t> closures;
+    std::vector<std::size_t> containers;
+    NodePtr placeholder = create_node(Data());
+    for (std::uint32_t i = 0; i < node_count; ++i) {
+      std::size_t start = in.get_position();
+      Tag tag = static_cast<Tag>(in.get_u8());
+      switch (tag) {
+      case Tag::NULL_LIST:
+        nodes[i] = create_node(Data());
+        break;
+      case Tag::UNSPECIFIED:
+        nodes[i] = create_unspecified();
+        break;
+      case Tag::BOOLEAN:
+        nodes[i] = create_node(Boolean(in.get_u8() != 0));
+        break;
+      case Tag::INTEGER:
+        nodes[i] = create_node(Number(static_cast<int>(in.get_u32())));
+        break;
+      case Tag::RATIONAL: {
+        int numerator = static_cast<int>(in.get_u32());
+        int denominator = static_cast<int>(in.get_u32());
+        nodes[i] = create_node(Number(numerator, denominator));
+        break;
+      }
+      case Tag::REAL: {
+        std::uint64_t bits = in.get_u64();
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        nodes[i] = create_node(Number(value));
+        break;
+      }
+      case Tag::STRING:
+        nodes[i] = create_node(String(in.get_string()));
+        break;
+      case Tag::SYMBOL:
+        nodes[i] = create_node(symbol(in.get_u32()));
+        break;
+      case Tag::PRIMITIVE_FORM:
+        nodes[i] = create_node(PrimitiveFormMarker(
+            symbol(in.get_u32()).get_value()));
+        break;
+      case Tag::DATA_PAIR:
+        in.get_bytes(8);
+        nodes[i] = create_node(DataPair(placeholder, placeholder));
+        containers.push_back(start);
+        containers.push_back(i);
+        break;
+      case Tag::VECTOR: {
+        std::uint32_t length = in.get_u32();
+        in.get_bytes(4 * static_cast<std::size_t>(length));
+        nodes[i] = create_node(Vector(length, placeholder));
+        containers.push_back(start);
+        containers.push_back(i);
+        break;
+      }
+      case Tag::BYTEVECTOR: {
+        std::uint32_t length = in.get_u32();
+        const char* bytes = in.get_bytes(length);
+        Bytevector bytevector(length);
+        for (std::uint32_t k = 0; k < length; ++k) {
+          bytevector[k] = static_cast<unsigned char>(bytes[k]);
+        }
+        nodes[i] = create_node(bytevector);
+        break;
+      }
+      case Tag::CLOSURE: {
+        in.get_bytes(9);
+        std::uint32_t variable_count = in.get_u32();
+        in.get_bytes(4 * static_cast<std::size_t>(variable_count));
+        closures.push_back(start);
+        closures.push_back(i);
+        break;
+      }
+      case Tag::NATIVE: {
+        std::uint32_t index = in.get_u32();
+        if (index >= native_nodes.size()) {
+          malformed("bad native index");
+        }
+        nodes[i] = native_nodes[index];
+        break;
+      }
+      default:
+        malformed("bad tag");
+      }
+    }
+    std::size_t environment_start = in.get_position();
+
+    for (std::size_t c = 0; c < closures.size(); c += 2) {
+      in.seek(closures[c] + 1);
+      EnvPtr env = environment(in.get_u32());
+      NodePtr body = node(in.get_u32());
+      bool variable_arity = in.get_u8() != 0;
+      VariableList variables;
+      std::uint32_t variable_count = in.get_u32();
+      for (std::uint32_t k = 0; k < variable_count; ++k) {
+        variables.push_back(symbol(in.get_u32()));
+      }
+      nodes[closures[c + 1]] = create_node(Closure(
+          env, body, variables, nullptr, nullptr, variable_arity));
+    }
+
+    for (std::size_t c = 0; c < containers.size(); c += 2) {
+      in.seek(containers[c]);
+      NodePtr container = nodes[containers[c + 1]];
+      if (static_cast<Tag>(in.get_u8()) == Tag::DATA_PAIR) {
+        NodePtr car = node(in.get_u32());
+        container->get<DataPair>().set_car(car);
+        NodePtr cdr = node(in.get_u32());
+        container->get<DataPair>().set_cdr(cdr);
+      } else {
+        Vector& vector = container->get<Vector>();
+        std::uint32_t length = in.get_u32();
+        for (std::uint32_t k = 0; k < length; ++k) {
+          vector[k] = node(in.get_u32());
+        }
+      }
+    }
+
+    in.seek(environment_start);
+    for (std::uint32_t i = 0; i < environment_count; ++i) {
+      environments[i]->set_parent(environment(in.get_u32()));
+      std::uint32_t binding_count = in.get_u32();
+      for (std::uint32_t k = 0; k < binding_count; ++k) {
+        const Symbol& key = symbol(in.get_u32());
+        environments[i]->set_value(key, node(in.get_u32()));
+      }
+    }
+    if (root >= environments.size()) {
+      malformed("bad root environment");
+    }
+    return environments[root];
+  }
+
+private:
+  /**
+   * @brief Reads a count of records of at least record_size bytes each,
+   * rejecting counts that the rest of the image cannot hold.
+   */
+  std::uint32_t count(std::size_t record_size) {
+    std::uint32_t value = in.get_u32();
+    if (value > in.remaining() / record_size) {
+      malformed("bad count");
+    }
+    return value;
+  }
+
+  const Symbol& symbol(std::uint32_t index) {
+    if (index >= symbols.size()) {
+      malformed("bad symbol index");
+    }
+    return symbols[index];
+  }
+
+  NodePtr node(std::uint32_t index) {
+    if (index == none) {
+      return NodePtr();
+    }
+    if (index >= nodes.size() || !nodes[index]) {
+      malformed("bad object index");
+    }
+    return nodes[index];
+  }
+
+  EnvPtr environment(std::uint32_t index) {
+    if (index == none) {
+      return nullptr;
+    }
+    if (index >= environments.size()) {
+      malformed("bad environment index");
+    }
+    return environments[index];
+  }
+
+  Reader in;
+  const NativeTable& natives;
+  std::vector<Symbol> symbols;
+  std::vector<NodePtr> native_nodes;
+  std::vector<NodePtr> nodes;
+  std::vector<EnvPtr> environments;
+};
+
+/**
+ * @brief A read-only memory mapping of a whole file.
+ */
+class MappedFile {
+public:
+  MappedFile(const std::string& path) :
+      descriptor(::open(path.c_str(), O_RDONLY)),
+      data(MAP_FAILED),
+      size(0) {
+    if (descriptor < 0) {
+      throw InvalidInputException(10068, "image: cannot open " + path);
+    }
+    struct stat status;
+    if (::fstat(descriptor, &status) == 0 && status.st_size > 0) {
+      size = static_cast<std::size_t>(status.st_size);
+      data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    }
+    if (data == MAP_FAILED) {
+      ::close(descriptor);
+      throw InvalidInputException(10068, "image: cannot map " + path);
+    }
+  }
+
+  ~MappedFile() {
+    ::munmap(data, size);
+    ::close(descriptor);
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char* get_data() const {
+    return static_cast<const char*>(data);
+  }
+
+  std::size_t get_size() const {
+    return size;
+  }
+
+private:
+  int descriptor;
+  void* data;
+  std::size_t size;
+};
+
+} // namespace
+
+void NativeTable::add(const std::string& id, NodePtr native) {
+  if (native->get_type() != Data::Type::CLOSURE ||
+      !(native->get<Closure>().is_native_closure() ||
+        native->get<Closure>().is_stepping_closure())) {
+    throw InvalidInputException(10066, "image: " + id +
+        " is not a native procedure");
+  }
+  natives[id] = native;
+  ids.emplace(native.get(), id);
+}
+
+void NativeTable::add_environment(EnvPtr env) {
+  for (const auto& binding : env->get_bindings()) {
+    NodePtr value = binding.second;
+    if (value->get_type() == Data::Type::CLOSURE &&
+        (value->get<Closure>().is_native_closure() ||
+         value->get<Closure>().is_stepping_closure())) {
+      add(binding.first.get_value(), value);
+    }
+  }
+}
+
+NodePtr NativeTable::get_native(const std::string& id) const {
+  auto it = natives.find(id);
+  if (it == natives.end()) {
+    throw InvalidInputException(10069, "image: unknown native procedure " +
+        id);
+  }
+  return it->second;
+}
+
+const std::string* NativeTable::get_id(NodePtr native) const {
+  auto it = ids.find(native.get());
+  return it == ids.end() ? nullptr : &it->second;
+}
+
+std::string write_image(EnvPtr env, const NativeTable& natives) {
+  return ImageWriter(natives).write(env);
+}
+
+EnvPtr read_image(const char* data, std::size_t size,
+                  const NativeTable& natives) {
+  return ImageReader(data, size, natives).read();
+}
+
+void save_image(const std::string& path, EnvPtr env,
+                const NativeTable& natives) {
+  if (!serialization::write_file_atomically(path,
+                                            write_image(env, natives))) {
+    throw InvalidInputException(10068, "image: cannot write " + path);
+  }
+}
+
+EnvPtr load_image(const std::string& path, const NativeTable& natives) {
+  MappedFile file(path);
+  return read_image(file.get_data(), file.get_size(), natives);
+}
+
+} // namespace image
+} // namespace shaka
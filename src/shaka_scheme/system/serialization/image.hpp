@@ -0,0 +1,108 @@
+#ifndef SHAKA_SCHEME_IMAGE_HPP
+#define SHAKA_SCHEME_IMAGE_HPP
+
+#include "shaka_scheme/system/base/Data.hpp"
+#include "shaka_scheme/system/exceptions/InvalidInputException.hpp"
+
+#include <map>
+#include <string>
+#include <unordered_map>
+
+namespace shaka {
+namespace image {
+
+/**
+ * @brief Gives native procedures stable ids, so that an image can refer to
+ * them by name instead of by address.
+ *
+ * The program that saves an image and the program that loads it must both
+ * register the same natives under the same ids. Registering natives only
+ * constructs Closures, so it is cheap compared to evaluating Scheme code.
+ */
+class NativeTable {
+public:
+  /**
+   * @brief Registers a native procedure under an id.
+   * @param id The stable id of the native procedure
+   * @param native The native Closure node
+   */
+  void add(const std::string& id, NodePtr native);
+
+  /**
+   * @brief Registers every native procedure bound in env, under the name it
+   * is bound to. The parent environments are not visited.
+   * @param env The environment holding the natives
+   */
+  void add_environment(EnvPtr env);
+
+  /**
+   * @brief Gets the native procedure registered under an id.
+   * @throws InvalidInputException if there is none
+   */
+  NodePtr get_native(const std::string& id) const;
+
+  /**
+   * @brief Gets the id of a registered native procedure.
+   * @return A pointer to the id, or nullptr if native is not registered
+   */
+  const std::string* get_id(NodePtr native) const;
+
+private:
+  std::map<std::string, NodePtr> natives;
+  std::unordered_map<const Data*, std::string> ids;
+};
+
+/**
+ * @brief Serializes an environment, with its parents, into an image.
+ *
+ * The image holds every object reachable from the bindings: compiled
+ * Closures with their environments and bodies, pairs, vectors,
+ * bytevectors, numbers, strings, booleans and primitive forms. Shared
+ * structure and cycles are kept. Symbols are written once, into a symbol
+ * table, and native procedures are written as their ids in natives.
+ *
+ * An image is a flat buffer of little-endian fields in which objects refer
+ * to each other by index, so it can be mapped into memory and read in one
+ * pass, without lexing, parsing or compiling.
+ *
+ * @param env The environment to serialize
+ * @param natives The ids of the native procedures
+ * @return The image
+ * @throws InvalidInputException on an object an image cannot hold, such as
+ * a continuation, a hash table, or a native procedure without an id
+ */
+std::string write_image(EnvPtr env, const NativeTable& natives);
+
+/**
+ * @brief Rebuilds the environment of an image. Every object is created
+ * anew, and references between objects are relocated from indices to
+ * nodes, except native procedures, which are taken from natives.
+ * @param data The image
+ * @param size The size of the image in bytes
+ * @param natives The native procedures that the image refers to
+ * @return The environment that was passed to write_image
+ * @throws InvalidInputException if the image is malformed or refers to a
+ * native procedure missing from natives
+ */
+EnvPtr read_image(const char* data, std::size_t size,
+                  const NativeTable& natives);
+
+/**
+ * @brief Writes the image of env to a file. The image is written to a
+ * temporary file that is then renamed over path, so a reader never sees a
+ * partial image.
+ * @see write_image
+ */
+void save_image(const std::string& path, EnvPtr env,
+                const NativeTable& natives);
+
+/**
+ * @brief Maps an image file into memory and rebuilds its environment.
+ * @see read_image
+ */
+EnvPtr load_image(const std::string& path, const NativeTable& natives);
+
+} // namespace image
+} // namespace shaka
+
+#endif //SHAKA_SCHEME_IMAGE_HPP
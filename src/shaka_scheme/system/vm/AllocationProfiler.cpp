@@ -0,0 +1,357 @@
+#include "shaka_scheme/system/vm/AllocationProfiler.hpp"
+#include "shaka_scheme/system/vm/HeapVirtualMachine.hpp"
+#include "shaka_scheme/system/vm/SamplingProfiler.hpp"
+#include "shaka_scheme/system/gc/GC.hpp"
+#include "shaka_scheme/system/exceptions/InvalidInputException.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+
+namespace shaka {
+
+namespace {
+
+// Guards active, and the allocation observer that goes with it
+std::mutex active_mutex;
+AllocationProfiler* active = nullptr;
+
+// The deepest that create_node is looked for on the stack
+const int max_frames = 32;
+
+// The number of C++ callers that a site is told apart by
+const std::size_t caller_depth = 2;
+
+/**
+ * @brief Gets the demangled name of the function that an address is in,
+ * without its parameters, or an empty string if it is not exported.
+ */
+std::string get_function_name(void* address) {
+  Dl_info info;
+  // A return address may be just past the end of the calling function
+  if (dladdr(static_cast<char*>(address) - 1, &info) == 0 ||
+      info.dli_sname == nullptr) {
+    return "";
+  }
+  int status = 0;
+  char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr,
+                                        &status);
+  std::string name = status == 0 ? demangled : info.dli_sname;
+  std::free(demangled);
+
+  // Cut the parameters, but not those of the lambdas in the name
+  int depth = 0;
+  for (std::size_t i = 0; i < name.size(); ++i) {
+    char c = name[i];
+    if (c == '<' || c == '{') {
+      ++depth;
+    } else if (c == '>' || c == '}') {
+      --depth;
+    } else if (c == '(' && depth == 0 && i != 0) {
+      return name.substr(0, i);
+    }
+  }
+  return name;
+}
+
+/**
+ * @brief Determines whether a function is part of allocation: create_node,
+ * the make_node helpers, the GC, or the profiler itself. Functions that are
+ * not exported cannot be told apart, and are skipped as well.
+ */
+bool is_internal(const std::string& name) {
+  if (name.empty()) {
+    return true;
+  }
+  static const char* const prefixes[] = {
+      "shaka::create_node", "shaka::make_", "shaka::gc::",
+      "shaka::AllocationProfiler::", "std::function<",
+      "std::_Function_handler<", "std::__invoke"
+  };
+  for (const char* prefix : prefixes) {
+    if (name.compare(0, std::strlen(prefix), prefix) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief The profiler started by SHAKA_SCHEME_ALLOCATION_PROFILE, which
+ * writes its report when the process exits.
+ */
+class ProcessProfile {
+public:
+  explicit ProcessProfile(const std::string& path) :
+      path(path) {
+    try {
+      profiler.start();
+    } catch (const InvalidInputException& e) {
+      std::cerr << e.what() << std::endl;
+    }
+  }
+
+  ~ProcessProfile() {
+    profiler.stop();
+    if (path.empty() || path == "-") {
+      profiler.write_report(std::cerr);
+      return;
+    }
+    std::ofstream out(path.c_str());
+    if (out) {
+      profiler.write_report(out);
+    } else {
+      std::cerr << "AllocationProfiler: could not write " << path
+                << std::endl;
+    }
+  }
+
+private:
+  std::string path;
+  AllocationProfiler profiler;
+};
+
+} // namespace
+
+AllocationProfiler::AllocationProfiler() :
+    allocation_count(0),
+    allocated_bytes(0),
+    running(false) {}
+
+AllocationProfiler::~AllocationProfiler() {
+  stop();
+}
+
+void AllocationProfiler::start() {
+  std::lock_guard<std::mutex> lock(active_mutex);
+  if (active == this) {
+    return;
+  }
+  if (active != nullptr) {
+    throw InvalidInputException(10082, "AllocationProfiler: another "
+        "profiler is already running");
+  }
+  active = this;
+  gc::set_allocation_observer(&AllocationProfiler::observe);
+  std::lock_guard<std::mutex> data_lock(mutex);
+  // Code may have been freed, and its address reused, while stopped
+  procedure_names.clear();
+  running = true;
+}
+
+void AllocationProfiler::stop() {
+  std::lock_guard<std::mutex> lock(active_mutex);
+  if (active != this) {
+    return;
+  }
+  gc::set_allocation_observer(nullptr);
+  active = nullptr;
+  std::lock_guard<std::mutex> data_lock(mutex);
+  running = false;
+}
+
+bool AllocationProfiler::is_running() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return running;
+}
+
+void AllocationProfiler::record(Data& data) {
+  void* frames[max_frames];
+  int frame_count = backtrace(frames, max_frames);
+  std::size_t size = get_allocation_size(data);
+  HeapVirtualMachine* hvm = HeapVirtualMachine::get_current();
+  NodePtr procedure = hvm != nullptr ? hvm->get_procedure() : NodePtr();
+
+  std::lock_guard<std::mutex> lock(mutex);
+  // The address of new Data may be that of freed code that was named
+  procedure_names.erase(&data);
+  std::string procedure_name;
+  if (hvm == nullptr) {
+    procedure_name = "(none)";
+  } else if (!procedure) {
+    procedure_name = "(top level)";
+  } else {
+    // Named once for each lambda, since that looks through environments
+    Data* code = procedure->get<Closure>().get_function_body().get();
+    auto it = procedure_names.find(code);
+    if (it == procedure_names.end()) {
+      it = procedure_names.insert(std::make_pair(
+          code, SamplingProfiler::get_procedure_name(procedure))).first;
+    }
+    procedure_name = it->second;
+  }
+  SiteKey key(procedure_name, find_callers(frames, frame_count),
+              static_cast<int>(data.get_type()));
+  Counts& counts = sites[key];
+  ++counts.count;
+  counts.bytes += size;
+  ++allocation_count;
+  allocated_bytes += size;
+}
+
+std::size_t AllocationProfiler::get_allocation_count() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return allocation_count;
+}
+
+std::size_t AllocationProfiler::get_allocated_bytes() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return allocated_bytes;
+}
+
+std::vector<AllocationProfiler::Site> AllocationProfiler::get_sites() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::vector<Site> result;
+  for (const auto& site : sites) {
+    result.push_back(Site{
+        std::get<0>(site.first),
+        get_caller_name(std::get<1>(site.first)),
+        static_cast<Data::Type>(std::get<2>(site.first)),
+        site.second.count,
+        site.second.bytes
+    });
+  }
+  std::stable_sort(result.begin(), result.end(),
+                   [](const Site& a, const Site& b) {
+    return a.count > b.count;
+  });
+  return result;
+}
+
+void AllocationProfiler::write_report(std::ostream& out,
+                                      std::size_t limit) const {
+  std::vector<Site> by_count = get_sites();
+  std::vector<Site> by_bytes = by_count;
+  std::stable_sort(by_bytes.begin(), by_bytes.end(),
+                   [](const Site& a, const Site& b) {
+    return a.bytes > b.bytes;
+  });
+  std::size_t total_count = get_allocation_count();
+  std::size_t total_bytes = get_allocated_bytes();
+
+  std::ios::fmtflags flags = out.flags();
+  out << std::fixed << std::setprecision(1);
+  out << "Allocation profile (" << total_count << " allocations, "
+      << total_bytes << " bytes)\n";
+  const std::pair<const char*, const std::vector<Site>*> lists[] = {
+      std::make_pair("count", &by_count), std::make_pair("bytes", &by_bytes)
+  };
+  for (const auto& list : lists) {
+    out << "\nSites by " << list.first << "\n";
+    out << std::right << std::setw(12) << "count" << std::setw(8) << "%"
+        << std::setw(14) << "bytes" << std::setw(8) << "%" << "  "
+        << std::left << std::setw(16) << "type" << "procedure / caller\n";
+    for (std::size_t i = 0; i < list.second->size() && i < limit; ++i) {
+      const Site& site = (*list.second)[i];
+      out << std::right << std::setw(12) << site.count
+          << std::setw(8) << 100.0 * site.count / total_count
+          << std::setw(14) << site.bytes
+          << std::setw(8) << 100.0 * site.bytes / total_bytes << "  "
+          << std::left << std::setw(16) << get_type_name(site.type)
+          << site.procedure << " / " << site.caller << "\n";
+    }
+  }
+  out.flags(flags);
+}
+
+void AllocationProfiler::reset() {
+  std::lock_guard<std::mutex> lock(mutex);
+  sites.clear();
+  procedure_names.clear();
+  allocation_count = 0;
+  allocated_bytes = 0;
+}
+
+std::size_t AllocationProfiler::get_allocation_size(Data& data) {
+  std::size_t size = sizeof(gc::GCData);
+  switch (data.get_type()) {
+  case Data::Type::STRING:
+    size += data.get<String>().byte_length();
+    break;
+  case Data::Type::VECTOR:
+    size += data.get<Vector>().length() * sizeof(NodePtr);
+    break;
+  case Data::Type::BYTEVECTOR:
+    size += data.get<Bytevector>().length();
+    break;
+  default:
+    break;
+  }
+  return size;
+}
+
+const char* AllocationProfiler::get_type_name(Data::Type type) {
+  switch (type) {
+  case Data::Type::UNSPECIFIED: return "unspecified";
+  case Data::Type::DATA_PAIR: return "pair";
+  case Data::Type::ENVIRONMENT: return "environment";
+  case Data::Type::SYMBOL: return "symbol";
+  case Data::Type::NUMBER: return "number";
+  case Data::Type::STRING: return "string";
+  case Data::Type::BOOLEAN: return "boolean";
+  case Data::Type::CLOSURE: return "closure";
+  case Data::Type::CALL_FRAME: return "call-frame";
+  case Data::Type::NULL_LIST: return "null";
+  case Data::Type::PRIMITIVE_FORM: return "primitive-form";
+  case Data::Type::VECTOR: return "vector";
+  case Data::Type::BYTEVECTOR: return "bytevector";
+  case Data::Type::HASH_TABLE: return "hash-table";
+  case Data::Type::EPHEMERON: return "ephemeron";
+  case Data::Type::PORT: return "port";
+  case Data::Type::EOF_OBJECT: return "eof-object";
+  }
+  return "unknown";
+}
+
+void AllocationProfiler::start_from_environment() {
+  static const bool enabled =
+      std::getenv("SHAKA_SCHEME_ALLOCATION_PROFILE") != nullptr;
+  if (!enabled) {
+    return;
+  }
+  static ProcessProfile profile(std::getenv("SHAKA_SCHEME_ALLOCATION_PROFILE"));
+}
+
+void AllocationProfiler::observe(Data& data) {
+  std::lock_guard<std::mutex> lock(active_mutex);
+  if (active != nullptr) {
+    active->record(data);
+  }
+}
+
+std::vector<void*> AllocationProfiler::find_callers(void* const* frames,
+                                                   int count) {
+  std::vector<void*> callers;
+  for (int i = 0; i < count && callers.size() < caller_depth; ++i) {
+    auto it = internal_addresses.find(frames[i]);
+    if (it == internal_addresses.end()) {
+      it = internal_addresses.insert(std::make_pair(
+          frames[i], is_internal(get_function_name(frames[i])))).first;
+    }
+    if (!it->second) {
+      callers.push_back(frames[i]);
+    }
+  }
+  return callers;
+}
+
+std::string AllocationProfiler::get_caller_name(
+    const std::vector<void*>& callers) const {
+  if (callers.empty()) {
+    return "(unknown)";
+  }
+  std::string name;
+  for (void* address : callers) {
+    name += (name.empty() ? "" : " <- ") + get_function_name(address);
+  }
+  return name;
+}
+
+} // namespace shaka
@@ -0,0 +1,163 @@
+#ifndef SHAKA_SCHEME_ALLOCATIONPROFILER_HPP
+#define SHAKA_SCHEME_ALLOCATIONPROFILER_HPP
+
+#include "shaka_scheme/system/base/Data.hpp"
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace shaka {
+
+/**
+ * @brief Finds out where the Data that the GCs allocate comes from.
+ *
+ * While a profiler is running, every allocation is recorded with its
+ * Data::Type, its size, the Scheme procedure that the current
+ * HeapVirtualMachine of the thread is applying (in run(), apply_procedure()
+ * or a Scheduler), and the C++ function that
+ * called create_node along with its own caller. The allocations are added
+ * up by site, which is all three of those, and the sites that allocate the
+ * most are reported.
+ *
+ * Recording takes a backtrace of every allocation, so it is much slower
+ * than allocating; a GC that is not being profiled only checks for an
+ * observer. C++ functions are named from the dynamic symbol table, so an
+ * allocation made by a function that is not exported is attributed to the
+ * nearest exported function that called it.
+ *
+ * Only one profiler runs at a time. Setting the environment variable
+ * SHAKA_SCHEME_ALLOCATION_PROFILE runs one from the first
+ * HeapVirtualMachine on, and writes its report when the process exits, to
+ * the file the variable names, or to standard error if it is empty or "-".
+ */
+class AllocationProfiler {
+public:
+  /**
+   * @brief The allocations of one site.
+   */
+  struct Site {
+    // The Scheme procedure, "(top level)", or "(none)" outside of any VM
+    std::string procedure;
+    // The exported C++ functions nearest to create_node on the stack, the
+    // one that called it first, as "f <- g", or "(unknown)" if there are none
+    std::string caller;
+    Data::Type type;
+    std::size_t count;
+    std::size_t bytes;
+  };
+
+  /**
+   * @brief Constructs a stopped AllocationProfiler with no allocations.
+   */
+  AllocationProfiler();
+
+  /**
+   * @brief Stops the profiler if it is running.
+   */
+  ~AllocationProfiler();
+
+  AllocationProfiler(const AllocationProfiler&) = delete;
+  AllocationProfiler& operator=(const AllocationProfiler&) = delete;
+
+  /**
+   * @brief Starts recording every allocation of every GC.
+   * @throws InvalidInputException if another profiler is running
+   */
+  void start();
+
+  /**
+   * @brief Stops recording. The allocations recorded so far are kept.
+   */
+  void stop();
+
+  /**
+   * @brief Determines whether this profiler is recording.
+   */
+  bool is_running() const;
+
+  /**
+   * @brief Records one allocation, made by the first exported C++ functions
+   * on the stack that are not part of create_node or this profiler.
+   */
+  void record(Data& data);
+
+  /**
+   * @brief Gets the number of allocations recorded.
+   */
+  std::size_t get_allocation_count() const;
+
+  /**
+   * @brief Gets the number of bytes of the allocations recorded.
+   */
+  std::size_t get_allocated_bytes() const;
+
+  /**
+   * @brief Gets every site, the ones that allocate most often first.
+   */
+  std::vector<Site> get_sites() const;
+
+  /**
+   * @brief Writes the sites that allocate most often, then the ones that
+   * allocate the most bytes.
+   * @param limit The number of sites in each list
+   */
+  void write_report(std::ostream& out, std::size_t limit = 20) const;
+
+  /**
+   * @brief Discards every allocation recorded.
+   */
+  void reset();
+
+  /**
+   * @brief Gets the size of a Data in the heap: its GCData, and what the
+   * contents of strings, vectors and bytevectors take up.
+   */
+  static std::size_t get_allocation_size(Data& data);
+
+  /**
+   * @brief Gets the name of a Data::Type, as in the report.
+   */
+  static const char* get_type_name(Data::Type type);
+
+  /**
+   * @brief Starts the process profiler if SHAKA_SCHEME_ALLOCATION_PROFILE
+   * is set and it is not running yet.
+   */
+  static void start_from_environment();
+
+private:
+  // The allocation observer of the GCs
+  static void observe(Data& data);
+
+  // Finds the first return addresses on the stack in exported functions
+  // outside of create_node
+  std::vector<void*> find_callers(void* const* frames, int count);
+  std::string get_caller_name(const std::vector<void*>& callers) const;
+
+  struct Counts {
+    std::size_t count;
+    std::size_t bytes;
+  };
+  using SiteKey = std::tuple<std::string, std::vector<void*>, int>;
+
+  mutable std::mutex mutex;
+  std::map<SiteKey, Counts> sites;
+  // Whether each return address seen is part of create_node
+  std::map<void*, bool> internal_addresses;
+  // The names of Scheme procedures by the address of their code. An entry
+  // is dropped when its address is allocated again, so the addresses of
+  // the entries always belong to the code that was named.
+  std::map<Data*, std::string> procedure_names;
+  std::size_t allocation_count;
+  std::size_t allocated_bytes;
+  bool running;
+};
+
+} // namespace shaka
+
+#endif //SHAKA_SCHEME_ALLOCATIONPROFILER_HPP
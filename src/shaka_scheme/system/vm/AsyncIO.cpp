@@ -0,0 +1,444 @@
+#include "shaka_scheme/system/vm/AsyncIO.hpp"
+#include "shaka_scheme/system/exceptions/InvalidInputException.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace shaka {
+
+#if defined(__linux__) && defined(__NR_io_uring_setup)
+
+/**
+ * @brief An io_uring instance, driven through the raw system calls.
+ */
+struct AsyncIO::Ring {
+  static const unsigned entries = 256;
+
+  /**
+   * @brief Sets up a ring whose completions are signalled on event_fd.
+   * @return nullptr if the kernel does not support io_uring, or forbids it
+   */
+  static std::unique_ptr<Ring> create(int event_fd) {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    int fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries,
+                                        &params));
+    if (fd < 0) {
+      return nullptr;
+    }
+    std::unique_ptr<Ring> ring(new Ring(fd, params));
+    // IORING_OP_READ and IORING_OP_WRITE came with this feature, in 5.6
+    if (!(params.features & IORING_FEAT_RW_CUR_POS) || !ring->map() ||
+        ::syscall(__NR_io_uring_register, fd, IORING_REGISTER_EVENTFD,
+                  &event_fd, 1) < 0) {
+      return nullptr;
+    }
+    return ring;
+  }
+
+  Ring(int fd, const io_uring_params& params) :
+      fd(fd),
+      params(params),
+      sq_ring(MAP_FAILED),
+      cq_ring(MAP_FAILED),
+      sqes(static_cast<io_uring_sqe*>(MAP_FAILED)),
+      to_submit(0) {
+    sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+      sq_size = cq_size = std::max(sq_size, cq_size);
+    }
+  }
+
+  ~Ring() {
+    if (sqes != MAP_FAILED) {
+      ::munmap(sqes, params.sq_entries * sizeof(io_uring_sqe));
+    }
+    if (cq_ring != MAP_FAILED && cq_ring != sq_ring) {
+      ::munmap(cq_ring, cq_size);
+    }
+    if (sq_ring != MAP_FAILED) {
+      ::munmap(sq_ring, sq_size);
+    }
+    ::close(fd);
+  }
+
+  bool map() {
+    sq_ring = ::mmap(nullptr, sq_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (sq_ring == MAP_FAILED) {
+      return false;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+      cq_ring = sq_ring;
+    } else {
+      cq_ring = ::mmap(nullptr, cq_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+      if (cq_ring == MAP_FAILED) {
+        return false;
+      }
+    }
+    sqes = static_cast<io_uring_sqe*>(::mmap(
+        nullptr, params.sq_entries * sizeof(io_uring_sqe),
+        PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+        IORING_OFF_SQES));
+    return sqes != MAP_FAILED;
+  }
+
+  unsigned* sq_field(unsigned offset) {
+    return reinterpret_cast<unsigned*>(static_cast<char*>(sq_ring) + offset);
+  }
+
+  unsigned* cq_field(unsigned offset) {
+    return reinterpret_cast<unsigned*>(static_cast<char*>(cq_ring) + offset);
+  }
+
+  /**
+   * @brief Places a request in the submission queue.
+   * @return false if the queue is full
+   */
+  bool push(std::uint64_t id, const Request& request) {
+    unsigned tail = *sq_field(params.sq_off.tail);
+    unsigned head = __atomic_load_n(sq_field(params.sq_off.head),
+                                    __ATOMIC_ACQUIRE);
+    if (tail - head >= params.sq_entries) {
+      return false;
+    }
+    unsigned index = tail & *sq_field(params.sq_off.ring_mask);
+    io_uring_sqe& sqe = sqes[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = request.writing ? IORING_OP_WRITE : IORING_OP_READ;
+    sqe.fd = request.fd;
+    sqe.off = request.offset + request.done;
+    sqe.addr = reinterpret_cast<std::uint64_t>(request.data.data() +
+                                               request.done);
+    sqe.len = static_cast<unsigned>(std::min<std::size_t>(
+        request.data.size() - request.done, 1u << 30));
+    sqe.user_data = id;
+    sq_field(params.sq_off.array)[index] = index;
+    __atomic_store_n(sq_field(params.sq_off.tail), tail + 1,
+                     __ATOMIC_RELEASE);
+    ++to_submit;
+    return true;
+  }
+
+  /**
+   * @brief Hands the pushed requests to the kernel with one system call.
+   */
+  void submit() {
+    while (to_submit > 0) {
+      long submitted = ::syscall(__NR_io_uring_enter, fd, to_submit, 0, 0,
+                                 nullptr, 0);
+      if (submitted < 0 && (errno == EINTR || errno == EAGAIN ||
+                            errno == EBUSY)) {
+        continue;
+      }
+      if (submitted < 0) {
+        throw InvalidInputException(10080, std::string("AsyncIO: "
+            "io_uring_enter failed: ") + std::strerror(errno));
+      }
+      to_submit -= static_cast<unsigned>(submitted);
+    }
+  }
+
+  /**
+   * @brief Takes the completions off the completion queue.
+   */
+  template<typename F>
+  void reap(F on_completion) {
+    unsigned* head_field = cq_field(params.cq_off.head);
+    unsigned head = *head_field;
+    unsigned tail = __atomic_load_n(cq_field(params.cq_off.tail),
+                                    __ATOMIC_ACQUIRE);
+    unsigned mask = *cq_field(params.cq_off.ring_mask);
+    io_uring_cqe* cqes = reinterpret_cast<io_uring_cqe*>(
+        static_cast<char*>(cq_ring) + params.cq_off.cqes);
+    while (head != tail) {
+      io_uring_cqe& cqe = cqes[head & mask];
+      on_completion(cqe.user_data, cqe.res);
+      ++head;
+    }
+    __atomic_store_n(head_field, head, __ATOMIC_RELEASE);
+  }
+
+  int fd;
+  io_uring_params params;
+  std::size_t sq_size;
+  std::size_t cq_size;
+  void* sq_ring;
+  void* cq_ring;
+  io_uring_sqe* sqes;
+  unsigned to_submit;
+};
+
+#else
+
+struct AsyncIO::Ring {
+  static const unsigned entries = 256;
+
+  static std::unique_ptr<Ring> create(int) {
+    return nullptr;
+  }
+
+  bool push(std::uint64_t, const Request&) {
+    return false;
+  }
+
+  void submit() {}
+
+  template<typename F>
+  void reap(F) {}
+};
+
+#endif
+
+AsyncIO::AsyncIO(bool use_io_uring, std::size_t workers) :
+    next_id(0),
+    in_flight(0),
+    use_io_uring(use_io_uring),
+    worker_count(std::max<std::size_t>(workers, 1)),
+    started(false),
+    stopping(false) {
+#ifdef __linux__
+  event_fd = event_write_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (event_fd < 0) {
+    throw InvalidInputException(10080, "AsyncIO: could not create eventfd");
+  }
+#else
+  int fds[2];
+  if (::pipe(fds) < 0) {
+    throw InvalidInputException(10080, "AsyncIO: could not create pipe");
+  }
+  for (int fd : fds) {
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+  }
+  event_fd = fds[0];
+  event_write_fd = fds[1];
+#endif
+}
+
+AsyncIO::~AsyncIO() {
+  // The kernel and the workers write into the requests until they complete
+  try {
+    while (!is_empty()) {
+      wait(-1);
+    }
+  } catch (const InvalidInputException&) {
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  jobs_available.notify_all();
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+  ring.reset();
+  if (event_write_fd != event_fd) {
+    ::close(event_write_fd);
+  }
+  ::close(event_fd);
+}
+
+void AsyncIO::read(int fd, std::uint64_t offset, std::size_t size,
+                   std::size_t thread_id) {
+  std::uint64_t id = next_id++;
+  requests[id] = Request{thread_id, fd, offset, false, std::string(size, '\0'),
+                         0, 0};
+  queued.push_back(id);
+}
+
+void AsyncIO::write(int fd, std::uint64_t offset, std::string data,
+                    std::size_t thread_id) {
+  std::uint64_t id = next_id++;
+  requests[id] = Request{thread_id, fd, offset, true, std::move(data), 0, 0};
+  queued.push_back(id);
+}
+
+bool AsyncIO::is_empty() const {
+  return requests.empty();
+}
+
+std::vector<AsyncIO::Completion> AsyncIO::wait(int timeout_ms) {
+  std::vector<Completion> completions;
+  submit_queued();
+  collect(completions);
+  if (completions.empty() && timeout_ms != 0 && in_flight > 0) {
+    wait_for_event(timeout_ms);
+    collect(completions);
+  }
+  return completions;
+}
+
+int AsyncIO::get_event_descriptor() const {
+  return event_fd;
+}
+
+bool AsyncIO::is_using_io_uring() const {
+  return ring != nullptr;
+}
+
+void AsyncIO::start() {
+  started = true;
+  if (use_io_uring) {
+    ring = Ring::create(event_fd);
+  }
+  if (ring == nullptr) {
+    for (std::size_t i = 0; i < worker_count; ++i) {
+      workers.push_back(std::thread(&AsyncIO::run_worker, this));
+    }
+  }
+}
+
+void AsyncIO::submit_queued() {
+  if (queued.empty()) {
+    return;
+  }
+  if (!started) {
+    start();
+  }
+  if (ring != nullptr) {
+    // Keep the completion queue, which is twice as large, from overflowing
+    while (!queued.empty() && in_flight < Ring::entries &&
+           ring->push(queued.front(), requests.at(queued.front()))) {
+      queued.pop_front();
+      ++in_flight;
+    }
+    ring->submit();
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (std::uint64_t id : queued) {
+      jobs.push_back(std::make_pair(id, &requests.at(id)));
+    }
+  }
+  in_flight += queued.size();
+  queued.clear();
+  jobs_available.notify_all();
+}
+
+void AsyncIO::collect(std::vector<Completion>& completions) {
+  // Reset the event first, so that later completions set it again
+  char drain[64];
+  while (::read(event_fd, drain, sizeof(drain)) > 0) {
+  }
+  if (ring != nullptr) {
+    bool resubmit = false;
+    ring->reap([&](std::uint64_t id, int result) {
+      --in_flight;
+      Request& request = requests.at(id);
+      if (result > 0) {
+        request.done += static_cast<std::size_t>(result);
+        if (request.done < request.data.size()) {
+          // A short read or write goes on from where it stopped
+          queued.push_front(id);
+          resubmit = true;
+          return;
+        }
+      }
+      request.result = result < 0 ? result : 0;
+      finish(id, completions);
+    });
+    if (resubmit) {
+      submit_queued();
+    }
+    return;
+  }
+  std::vector<std::uint64_t> done;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    done.swap(done_jobs);
+  }
+  for (std::uint64_t id : done) {
+    --in_flight;
+    finish(id, completions);
+  }
+}
+
+void AsyncIO::finish(std::uint64_t id, std::vector<Completion>& completions) {
+  Request& request = requests.at(id);
+  Completion completion{request.thread_id, request.result, std::string()};
+  if (request.result >= 0) {
+    completion.result = static_cast<long>(request.done);
+    if (!request.writing) {
+      request.data.resize(request.done);
+      completion.data.swap(request.data);
+    }
+  }
+  completions.push_back(std::move(completion));
+  requests.erase(id);
+}
+
+void AsyncIO::run_worker() {
+  while (true) {
+    std::pair<std::uint64_t, Request*> job;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      jobs_available.wait(lock, [this] { return stopping || !jobs.empty(); });
+      if (jobs.empty()) {
+        return;
+      }
+      job = jobs.front();
+      jobs.pop_front();
+    }
+    Request& request = *job.second;
+    while (request.done < request.data.size()) {
+      char* data = &request.data[0] + request.done;
+      std::size_t size = request.data.size() - request.done;
+      off_t offset = static_cast<off_t>(request.offset + request.done);
+      ssize_t count = request.writing ?
+          ::pwrite(request.fd, data, size, offset) :
+          ::pread(request.fd, data, size, offset);
+      if (count < 0 && errno == EINTR) {
+        continue;
+      }
+      if (count < 0) {
+        request.result = -errno;
+        break;
+      }
+      if (count == 0) {
+        break;
+      }
+      request.done += static_cast<std::size_t>(count);
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      done_jobs.push_back(job.first);
+    }
+    signal_event();
+  }
+}
+
+void AsyncIO::wait_for_event(int timeout_ms) {
+  pollfd descriptor = {event_fd, POLLIN, 0};
+  if (::poll(&descriptor, 1, timeout_ms) < 0 && errno != EINTR) {
+    throw InvalidInputException(10080, "AsyncIO: poll failed");
+  }
+}
+
+void AsyncIO::signal_event() {
+#ifdef __linux__
+  std::uint64_t one = 1;
+  ssize_t written = ::write(event_write_fd, &one, sizeof(one));
+#else
+  char one = 1;
+  ssize_t written = ::write(event_write_fd, &one, sizeof(one));
+#endif
+  (void) written;
+}
+
+} // namespace shaka
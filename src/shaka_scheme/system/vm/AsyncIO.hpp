@@ -0,0 +1,148 @@
+#ifndef SHAKA_SCHEME_ASYNCIO_HPP
+#define SHAKA_SCHEME_ASYNCIO_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace shaka {
+
+/**
+ * @brief Reads and writes files at given offsets on behalf of parked green
+ * threads, without blocking the thread that runs the VM.
+ *
+ * On Linux, requests go through io_uring. Requests made between two calls
+ * to wait() are queued and submitted together with one system call. Where
+ * io_uring is not available, as on older kernels, in containers that forbid
+ * it, or on other systems, a pool of worker threads does the reads and
+ * writes with pread(2) and pwrite(2) instead.
+ *
+ * Either way, a descriptor given by get_event_descriptor() becomes readable
+ * whenever requests have completed, so that waiting for them can be
+ * combined with waiting for other descriptors.
+ */
+class AsyncIO {
+public:
+  /**
+   * @brief The outcome of a request.
+   */
+  struct Completion {
+    // The id of the green thread that made the request
+    std::size_t thread_id;
+    // The number of bytes read or written, or -errno on failure
+    long result;
+    // The bytes read
+    std::string data;
+  };
+
+  /**
+   * @brief Constructs an AsyncIO with no requests.
+   * @param use_io_uring false to always use the worker threads
+   * @param workers The number of worker threads, if they are used
+   * @throws InvalidInputException if neither backend can be set up
+   */
+  AsyncIO(bool use_io_uring = true, std::size_t workers = 4);
+
+  /**
+   * @brief Waits for the requests in flight, then releases the ring or stops
+   * the worker threads.
+   */
+  ~AsyncIO();
+
+  AsyncIO(const AsyncIO& other) = delete;
+  AsyncIO& operator=(const AsyncIO& other) = delete;
+
+  /**
+   * @brief Queues a read of up to size bytes at offset.
+   * @param thread_id The green thread to report the completion to
+   */
+  void read(int fd, std::uint64_t offset, std::size_t size,
+            std::size_t thread_id);
+
+  /**
+   * @brief Queues a write of all of data at offset.
+   * @param thread_id The green thread to report the completion to
+   */
+  void write(int fd, std::uint64_t offset, std::string data,
+             std::size_t thread_id);
+
+  /**
+   * @brief Determines whether any request is queued or in flight.
+   */
+  bool is_empty() const;
+
+  /**
+   * @brief Submits the queued requests, then collects the completed ones.
+   * @param timeout_ms The maximum time to block if none has completed yet:
+   * 0 not to block, or -1 to block indefinitely
+   * @return The completions, in no particular order
+   */
+  std::vector<Completion> wait(int timeout_ms);
+
+  /**
+   * @brief Gets a descriptor that is readable while completions are
+   * waiting to be collected by wait().
+   */
+  int get_event_descriptor() const;
+
+  /**
+   * @brief Determines whether requests go through io_uring rather than the
+   * worker threads.
+   */
+  bool is_using_io_uring() const;
+
+private:
+  struct Request {
+    std::size_t thread_id;
+    int fd;
+    std::uint64_t offset;
+    bool writing;
+    // The bytes to write, or the space to read into
+    std::string data;
+    // How much of data has been written or read
+    std::size_t done;
+    long result;
+  };
+
+  struct Ring;
+
+  void start();
+  void submit_queued();
+  void collect(std::vector<Completion>& completions);
+  void finish(std::uint64_t id, std::vector<Completion>& completions);
+  void run_worker();
+  void wait_for_event(int timeout_ms);
+  void signal_event();
+
+  std::map<std::uint64_t, Request> requests;
+  std::deque<std::uint64_t> queued;
+  std::uint64_t next_id;
+  std::size_t in_flight;
+  bool use_io_uring;
+  std::size_t worker_count;
+  bool started;
+
+  std::unique_ptr<Ring> ring;
+
+  // The worker threads take from jobs and put into done_jobs
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable jobs_available;
+  std::deque<std::pair<std::uint64_t, Request*>> jobs;
+  std::vector<std::uint64_t> done_jobs;
+  bool stopping;
+
+  int event_fd;
+  int event_write_fd;
+};
+
+} // namespace shaka
+
+#endif //SHAKA_SCHEME_ASYNCIO_HPP
@@ -14,7 +14,9 @@ shaka::CallFrame::CallFrame(shaka::Expression ret,
   return_expression(ret),
   env(env),
   value_rib(rib),
-  next_frame(next_frame) {}
+  next_frame(next_frame),
+  prompt(false),
+  frame_count(1) {}
 
 shaka::CallFrame::CallFrame() {
   //return_expression = std::make_shared<Data>();
@@ -22,22 +24,24 @@ shaka::CallFrame::CallFrame() {
   env = std::make_shared<Environment>(nullptr);
   value_rib = std::deque<NodePtr>(0);
   next_frame = nullptr;
+  prompt = false;
+  frame_count = 1;
 }
 
 
-shaka::Expression shaka::CallFrame::get_next_expression() {
+shaka::Expression shaka::CallFrame::get_next_expression() const {
   return return_expression;
 }
 
-shaka::EnvPtr shaka::CallFrame::get_environment_pointer() {
+shaka::EnvPtr shaka::CallFrame::get_environment_pointer() const {
   return env;
 }
 
-shaka::ValueRib shaka::CallFrame::get_value_rib() {
+const shaka::ValueRib& shaka::CallFrame::get_value_rib() const {
   return value_rib;
 }
 
-shaka::FramePtr shaka::CallFrame::get_next_frame() {
+shaka::FramePtr shaka::CallFrame::get_next_frame() const {
   return next_frame;
 }
 
@@ -57,6 +61,28 @@ void shaka::CallFrame::set_value_rib(shaka::ValueRib rib) {
   this->value_rib = rib;
 }
 
+bool shaka::CallFrame::is_prompt() const {
+  return prompt;
+}
+
+void shaka::CallFrame::set_prompt(bool prompt) {
+  this->prompt = prompt;
+}
+
+shaka::NodePtr shaka::CallFrame::get_procedure() const {
+  return procedure;
+}
+
+std::size_t shaka::CallFrame::get_frame_count() const {
+  return frame_count;
+}
+
+void shaka::CallFrame::set_procedure(shaka::NodePtr procedure,
+                                     std::size_t frame_count) {
+  this->procedure = procedure;
+  this->frame_count = frame_count;
+}
+
 
 
 
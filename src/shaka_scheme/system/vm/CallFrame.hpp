@@ -49,27 +49,27 @@ public:
    * @brief Getter method for next_expression (return address)
    * @return The contents of the next expression field
    */
-  Expression get_next_expression();
+  Expression get_next_expression() const;
 
 
   /**
    * @brief Getter method for the active environment
    * @return The contents of the environment field (EnvPtr)
    */
-  EnvPtr get_environment_pointer();
+  EnvPtr get_environment_pointer() const;
 
   /**
    * @brief Getter method for the value rib
    * @return The vector of the arugments evaluated thus far in the CallFrame
    */
-  ValueRib get_value_rib();
+  const ValueRib& get_value_rib() const;
 
 
   /**
    * @brief Getter method for the pointer to the ControlStack
    * @return The contents of the next_frame field (rest of ControlStack)
    */
-  FramePtr get_next_frame();
+  FramePtr get_next_frame() const;
 
   /**
    * @brief Setter method for the expression field (return address)
@@ -97,13 +97,48 @@ public:
    */
   void set_next_frame(FramePtr next_frame);
 
+  /**
+   * @brief Determines whether this frame delimits continuations (reset)
+   * @return true if this frame was pushed by a (reset ret x) instruction
+   */
+  bool is_prompt() const;
+
+  /**
+   * @brief Setter method for the prompt flag
+   * @param prompt Whether this frame delimits continuations captured by shift
+   */
+  void set_prompt(bool prompt);
+
+  /**
+   * @brief Getter method for the procedure that the frame returns into
+   * @return The Closure that was running when the frame was pushed, or a
+   * null NodePtr at top level
+   */
+  NodePtr get_procedure() const;
+
+  /**
+   * @brief Getter method for the number of frames that the procedure had
+   * pushed and not yet returned through, counting this one
+   * @return The number of frames, which is 1 unless set otherwise
+   */
+  std::size_t get_frame_count() const;
+
+  /**
+   * @brief Setter method for the procedure that the frame returns into
+   * @param procedure The Closure that is running when the frame is pushed
+   * @param frame_count The number of frames it has pushed, counting this one
+   */
+  void set_procedure(NodePtr procedure, std::size_t frame_count);
+
 private:
 
   Expression return_expression;
   EnvPtr env;
   ValueRib value_rib;
   FramePtr next_frame;
-
+  bool prompt;
+  NodePtr procedure;
+  std::size_t frame_count;
 
 };
 
@@ -5,6 +5,7 @@
 #include "shaka_scheme/system/vm/Closure.hpp"
 #include "shaka_scheme/system/base/Data.hpp"
 #include "shaka_scheme/system/core/lists.hpp"
+#include "shaka_scheme/system/gc/make_node.hpp"
 
 namespace shaka {
 
@@ -21,7 +22,11 @@ Closure::Closure(EnvPtr env,
     variable_list(vl),
     callable(cl),
     frame(frame),
-    variable_arity(arity) {}
+    variable_arity(arity),
+    prompt(nullptr),
+    resumed(nullptr),
+    stepping(nullptr),
+    stepping_roots(nullptr) {}
 
 Closure::Closure(Callable cl, bool arity) {
 
@@ -31,8 +36,37 @@ Closure::Closure(Callable cl, bool arity) {
     this->callable = std::make_shared<Callable>(cl);
     this->frame = nullptr,
     this->variable_arity = arity;
+    this->prompt = nullptr;
+    this->resumed = nullptr;
+    this->stepping = nullptr;
+    this->stepping_roots = nullptr;
 }
 
+Closure::Closure(SteppingCallablePtr step, bool arity,
+                 SteppingRootsPtr roots) :
+    env(nullptr),
+    func_body(nullptr),
+    variable_list(std::vector<shaka::Symbol>(0)),
+    callable(nullptr),
+    frame(nullptr),
+    variable_arity(arity),
+    prompt(nullptr),
+    resumed(nullptr),
+    stepping(step),
+    stepping_roots(roots) {}
+
+Closure::Closure(FramePtr frame, FramePtr prompt, bool one_shot) :
+    env(nullptr),
+    func_body(nullptr),
+    variable_list(std::vector<shaka::Symbol>(0)),
+    callable(nullptr),
+    frame(frame),
+    variable_arity(false),
+    prompt(prompt),
+    resumed(one_shot ? std::make_shared<bool>(false) : nullptr),
+    stepping(nullptr),
+    stepping_roots(nullptr) {}
+
 Closure::Closure() {
   env = std::make_shared<Environment>(nullptr);
   //func_body = std::make_shared<Data>();
@@ -41,7 +75,10 @@ Closure::Closure() {
   callable = nullptr;
   frame = std::make_shared<CallFrame>();
   variable_arity = false;
-
+  prompt = nullptr;
+  resumed = nullptr;
+  stepping = nullptr;
+  stepping_roots = nullptr;
 }
 
 NodePtr Closure::get_function_body() {
@@ -49,6 +86,10 @@ NodePtr Closure::get_function_body() {
 }
 
 void Closure::extend_environment(ValueRib vr) {
+  this->env = this->bind_arguments(vr);
+}
+
+EnvPtr Closure::bind_arguments(ValueRib vr) const {
 
   EnvPtr new_frame = std::make_shared<Environment>(env);
 
@@ -62,9 +103,10 @@ void Closure::extend_environment(ValueRib vr) {
     }
 
     if (i < vr.size()) {
+      // Build the rest arguments from the back, one cons per argument
       NodePtr var_args = core::list();
-      for (;i < vr.size(); i++) {
-        var_args = core::append(var_args, core::list(vr[i]));
+      for (size_t j = vr.size(); j > i; j--) {
+        var_args = core::cons(vr[j - 1], var_args);
       }
       new_frame->set_value(
           variable_list[variable_list.size() - 1],
@@ -80,7 +122,7 @@ void Closure::extend_environment(ValueRib vr) {
     }
   }
 
-  this->env = new_frame;
+  return new_frame;
 }
 
 EnvPtr Closure::get_environment() {
@@ -91,6 +133,24 @@ std::deque<NodePtr> Closure::call(std::deque<NodePtr> args) {
   return (*callable)(args);
 }
 
+NativeStep Closure::step(std::deque<NodePtr> args) {
+  return (*stepping)(args);
+}
+
+ValueRib Closure::get_stepping_roots() {
+  return stepping_roots ? (*stepping_roots)() : ValueRib();
+}
+
+NodePtr make_resume_expression(NodePtr resume) {
+  return core::list(make_symbol("argument"),
+                    core::list(make_symbol("constant"), resume,
+                               core::list(make_symbol("apply"))));
+}
+
+CallablePtr Closure::get_callable() {
+  return this->callable;
+}
+
 FramePtr Closure::get_call_frame() {
   return this->frame;
 }
@@ -103,6 +163,10 @@ bool Closure::is_native_closure() {
   return this->callable != nullptr;
 }
 
+bool Closure::is_stepping_closure() {
+  return this->stepping != nullptr;
+}
+
 bool Closure::is_continuation_closure() {
   return this->frame != nullptr;
 }
@@ -111,5 +175,25 @@ bool Closure::is_variable_arity() {
   return this->variable_arity;
 }
 
+FramePtr Closure::get_prompt_frame() {
+  return this->prompt;
+}
+
+bool Closure::is_delimited_continuation() {
+  return this->prompt != nullptr;
+}
+
+bool Closure::is_one_shot() {
+  return this->resumed != nullptr;
+}
+
+void Closure::consume_one_shot() {
+  if (*this->resumed) {
+    throw InvalidInputException(10010, "call/1cc: one-shot continuation "
+        "was already resumed");
+  }
+  *this->resumed = true;
+}
+
 
 }
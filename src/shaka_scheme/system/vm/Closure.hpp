@@ -23,6 +23,37 @@ using CallablePtr = std::shared_ptr<Callable>;
 
 using VariableList = std::vector<Symbol>;
 
+/**
+ * @brief One step of a stepping native procedure. If procedure is null, the
+ * native procedure returns value. Otherwise the HeapVirtualMachine applies
+ * procedure to arguments, and then applies resume, another stepping
+ * Closure, to the result followed by state.
+ */
+struct NativeStep {
+  NodePtr value;
+  NodePtr procedure;
+  ValueRib arguments;
+  NodePtr resume;
+  // The code that procedure returns into, from make_resume_expression(), or
+  // null to have the HeapVirtualMachine make it
+  NodePtr resume_expression;
+  // Kept in the CallFrame that procedure returns into, so that a
+  // continuation captured in procedure resumes with the state of this step
+  ValueRib state;
+};
+
+/**
+ * @brief Makes (argument (constant resume (apply))), which passes the value
+ * a procedure returns on to resume. A stepping native procedure can make it
+ * once and use it in all of its steps.
+ */
+NodePtr make_resume_expression(NodePtr resume);
+
+using SteppingCallable = std::function<NativeStep(std::deque<NodePtr>)>;
+using SteppingCallablePtr = std::shared_ptr<SteppingCallable>;
+using SteppingRoots = std::function<ValueRib()>;
+using SteppingRootsPtr = std::shared_ptr<SteppingRoots>;
+
 class Closure {
 public:
 
@@ -44,6 +75,29 @@ public:
    */
   Closure(Callable cl, bool arity);
 
+  /**
+   * @brief Special purpose constructor for stepping native procedures,
+   * which can call back into Scheme procedures on the HeapVirtualMachine
+   * that applied them, instead of running a VM of their own
+   * @param step The function object that computes the next NativeStep
+   * @param arity Whether or not this object is of variable arity
+   * @param roots Lists the nodes that step holds on to between steps, so
+   * that the collector marks them with the Closure; may be nullptr
+   */
+  Closure(SteppingCallablePtr step, bool arity,
+          SteppingRootsPtr roots = nullptr);
+
+  /**
+   * @brief Special purpose constructor for one-shot and delimited
+   * continuations, which resume by re-linking CallFrames instead of
+   * going through (nuate s var)
+   * @param frame The top CallFrame of the captured continuation
+   * @param prompt The prompt CallFrame that delimits the continuation, or
+   * nullptr if the continuation extends to the bottom of the stack
+   * @param one_shot Whether the continuation may be resumed only once
+   */
+  Closure(FramePtr frame, FramePtr prompt, bool one_shot);
+
   /**
    * @brief Default constructor for Closure class
    * Initializes environment to be an empty environment
@@ -66,6 +120,16 @@ public:
    */
   void extend_environment(ValueRib vr);
 
+  /**
+   * @brief Creates the environment for one call of the closure, binding the
+   * contents of the ValueRib on top of the lexical environment. Unlike
+   * extend_environment, the closure itself is left unchanged, so one closure
+   * can be applied by several HeapVirtualMachine threads at once.
+   * @param vr The contents of the ValueRib register from the VM
+   * @return The new environment
+   */
+  EnvPtr bind_arguments(ValueRib vr) const;
+
   /**
    * @brief A getter method for accessing the lexical enviroment of the closure
    * @return A pointer to the lexical environment of the closure
@@ -79,6 +143,27 @@ public:
    */
   std::deque<NodePtr> call(std::deque<NodePtr> args);
 
+  /**
+   * @brief Runs one step of a stepping native procedure
+   * @param args The arguments to the procedure, or the result of the
+   * procedure applied by the previous step
+   * @return What the HeapVirtualMachine should do next
+   */
+  NativeStep step(std::deque<NodePtr> args);
+
+  /**
+   * @brief Lists the nodes a stepping native procedure holds on to
+   * between steps
+   * @return The nodes, or an empty ValueRib if there are none
+   */
+  ValueRib get_stepping_roots();
+
+  /**
+   * @brief A getter method for the callable object of a native closure
+   * @return The CallablePtr, or nullptr if this is not a native closure
+   */
+  CallablePtr get_callable();
+
   /**
    * @brief A procedure to retrieve the CallFrame from a continuation closure
    * @return The pointer to the CallFrame held by the continuation
@@ -97,6 +182,12 @@ public:
    */
   bool is_native_closure();
 
+  /**
+   * @brief Method to determine whether this is a stepping native procedure
+   * @return true if the SteppingCallablePtr is not null, false otherwise
+   */
+  bool is_stepping_closure();
+
   /**
    * @brief Method to determine wheter or not this is a Continuation Closure
    * @return true if the FramePtr is not null, false otherwise
@@ -109,7 +200,31 @@ public:
    */
   bool is_variable_arity();
 
+  /**
+   * @brief A procedure to retrieve the prompt CallFrame of a delimited
+   * continuation
+   * @return The pointer to the prompt frame, or nullptr if undelimited
+   */
+  FramePtr get_prompt_frame();
+
+  /**
+   * @brief Method to determine whether this is a delimited continuation
+   * @return true if the continuation was captured by shift, false otherwise
+   */
+  bool is_delimited_continuation();
 
+  /**
+   * @brief Method to determine whether this is a one-shot continuation
+   * @return true if the continuation was captured by call/1cc
+   */
+  bool is_one_shot();
+
+  /**
+   * @brief Marks a one-shot continuation as resumed. All copies of this
+   * Closure share the same flag.
+   * @throws InvalidInputException if the continuation was already resumed
+   */
+  void consume_one_shot();
 
 private:
 
@@ -119,6 +234,10 @@ private:
   CallablePtr callable;
   FramePtr frame;
   bool variable_arity;
+  FramePtr prompt;
+  std::shared_ptr<bool> resumed;
+  SteppingCallablePtr stepping;
+  SteppingRootsPtr stepping_roots;
 
 };
 
@@ -4,23 +4,131 @@
 
 #include "shaka_scheme/system/vm/HeapVirtualMachine.hpp"
 #include "shaka_scheme/system/core/lists.hpp"
+#include "shaka_scheme/system/gc/make_node.hpp"
 
 namespace shaka {
 
+namespace {
+
+thread_local HeapVirtualMachine* current_vm = nullptr;
+
+} // namespace
+
+HeapVirtualMachine::RegisterScope::RegisterScope(HeapVirtualMachine& hvm) :
+    hvm(hvm),
+    acc(hvm.get_accumulator()),
+    exp(hvm.get_expression()),
+    env(hvm.get_environment()),
+    rib(hvm.get_value_rib()),
+    frame(hvm.get_call_frame()),
+    procedure(hvm.get_procedure()),
+    frame_count(hvm.get_frame_count()),
+    previous(current_vm) {
+  current_vm = &hvm;
+}
+
+HeapVirtualMachine::RegisterScope::~RegisterScope() {
+  hvm.set_accumulator(acc);
+  hvm.set_expression(exp);
+  hvm.set_environment(env);
+  hvm.set_value_rib(rib);
+  hvm.set_call_frame(frame);
+  hvm.set_procedure(procedure, frame_count);
+  current_vm = previous;
+}
+
 HeapVirtualMachine::~HeapVirtualMachine() {}
 
+Accumulator HeapVirtualMachine::run(Expression x) {
+  RegisterScope scope(*this);
+  this->set_call_frame(nullptr);
+  this->set_procedure(NodePtr(), 0);
+  this->set_value_rib(ValueRib());
+  this->set_expression(x);
+  return this->run_until_halt();
+}
+
+Accumulator HeapVirtualMachine::apply_procedure(NodePtr proc,
+                                                ValueRib args) {
+  RegisterScope scope(*this);
+  // The procedure returns into a frame that halts
+  this->set_call_frame(std::make_shared<CallFrame>(
+      core::list(make_symbol("halt")), this->env, ValueRib(),
+      nullptr));
+  this->set_procedure(NodePtr(), 0);
+  this->set_accumulator(proc);
+  this->set_value_rib(args);
+  this->set_expression(core::list(make_symbol("apply")));
+  return this->run_until_halt();
+}
+
+HeapVirtualMachine* HeapVirtualMachine::get_current() {
+  return current_vm;
+}
+
+Accumulator HeapVirtualMachine::run_until_halt() {
+  // Checked once per run, so that a VM that is not profiled pays nothing
+  if (this->profiler != nullptr) {
+    while (!this->halted) {
+      this->profiler->evaluate(*this);
+      if (SamplingProfiler::is_sample_due()) {
+        SamplingProfiler::take_sample(*this);
+      }
+    }
+    return this->acc;
+  }
+  while (!this->halted) {
+    this->evaluate_assembly_instruction();
+    // The safe point where a pending sample is taken
+    if (SamplingProfiler::is_sample_due()) {
+      SamplingProfiler::take_sample(*this);
+    }
+  }
+  return this->acc;
+}
+
+void HeapVirtualMachine::set_profiler(VMProfiler* profiler) {
+  this->profiler = profiler;
+}
+
+VMProfiler* HeapVirtualMachine::get_profiler() const {
+  return this->profiler;
+}
+
+bool HeapVirtualMachine::is_halted() const {
+  return this->halted;
+}
+
 void HeapVirtualMachine::evaluate_assembly_instruction() {
+  // The instruction names are built once, not on every comparison
+  static const Symbol halt_instruction("halt");
+  static const Symbol refer_instruction("refer");
+  static const Symbol constant_instruction("constant");
+  static const Symbol close_instruction("close");
+  static const Symbol test_instruction("test");
+  static const Symbol assign_instruction("assign");
+  static const Symbol define_instruction("define");
+  static const Symbol conti_instruction("conti");
+  static const Symbol conti1_instruction("conti1");
+  static const Symbol reset_instruction("reset");
+  static const Symbol shift_instruction("shift");
+  static const Symbol nuate_instruction("nuate");
+  static const Symbol frame_instruction("frame");
+  static const Symbol argument_instruction("argument");
+  static const Symbol apply_instruction("apply");
+  static const Symbol return_instruction("return");
+
   shaka::DataPair& exp_pair = exp->get<DataPair>();
   shaka::Symbol& instruction = exp_pair.car()->get<Symbol>();
 
   // (halt)
-  if (instruction == shaka::Symbol("halt")) {
-
+  if (instruction == halt_instruction) {
+    this->halted = true;
     return;
   }
 
   // (refer var x)
-  if (instruction == shaka::Symbol("refer")) {
+  if (instruction == refer_instruction) {
     shaka::DataPair& exp_cdr = exp_pair.cdr()->get<DataPair>();
     shaka::Symbol& var = exp_cdr.car()->get<Symbol>();
     this->set_accumulator(env->get_value(var));
@@ -32,7 +140,7 @@ void HeapVirtualMachine::evaluate_assembly_instruction() {
   }
 
   // (constant obj x)
-  if (instruction == shaka::Symbol("constant")) {
+  if (instruction == constant_instruction) {
     shaka::DataPair& exp_cdr = exp_pair.cdr()->get<DataPair>();
     NodePtr obj = exp_cdr.car();
 
@@ -46,7 +154,7 @@ void HeapVirtualMachine::evaluate_assembly_instruction() {
   }
 
   // (close vars body x)
-  if (instruction == shaka::Symbol("close")) {
+  if (instruction == close_instruction) {
 
     // Get the rest of the instruction
     shaka::DataPair& exp_cdr = exp_pair.cdr()->get<DataPair>();
@@ -92,7 +200,7 @@ void HeapVirtualMachine::evaluate_assembly_instruction() {
   NodePtr next_expression = exp_cdr.cdr()->
       get<DataPair>().cdr()->get<DataPair>().car();
 
-  NodePtr closure = create_node(
+  NodePtr closure = make_node(
       Closure(
           this->get_environment(),
           body,
@@ -111,7 +219,7 @@ void HeapVirtualMachine::evaluate_assembly_instruction() {
 
 
   // (test then else)
-  if (instruction == shaka::Symbol("test")) {
+  if (instruction == test_instruction) {
     shaka::DataPair& exp_cdr = exp_pair.cdr()->get<DataPair>();
     NodePtr then_exp = exp_cdr.car();
     NodePtr else_exp = exp_cdr.cdr()->get<DataPair>().car();
@@ -129,7 +237,7 @@ void HeapVirtualMachine::evaluate_assembly_instruction() {
   }
 
   // (assign var x)
-  if (instruction == shaka::Symbol("assign")) {
+  if (instruction == assign_instruction) {
     shaka::DataPair& exp_cdr = exp_pair.cdr()->get<DataPair>();
     shaka::Symbol& var = exp_cdr.car()->get<Symbol>();
 
@@ -144,7 +252,7 @@ void HeapVirtualMachine::evaluate_assembly_instruction() {
   }
 
   // (define var x)
-  if (instruction == shaka::Symbol("define")) {
+  if (instruction == define_instruction) {
     shaka::DataPair& exp_cdr = exp_pair.cdr()->get<DataPair>();
     shaka::Symbol& var = exp_cdr.car()->get<Symbol>();
 
@@ -160,13 +268,13 @@ void HeapVirtualMachine::evaluate_assembly_instruction() {
 
   // (conti x)
 
-  if (instruction == shaka::Symbol("conti")) {
+  if (instruction == conti_instruction) {
 
     // Create the function body for the continuation
 
-    NodePtr call_frame = create_node(*this->frame);
-    NodePtr nuate = create_node(Symbol("nuate"));
-    NodePtr var = create_node(Symbol("kont_v000"));
+    NodePtr call_frame = make_node(*this->frame);
+    NodePtr nuate = make_symbol("nuate");
+    NodePtr var = make_symbol("kont_v000");
 
     // Create the variable list
 
@@ -179,7 +287,7 @@ void HeapVirtualMachine::evaluate_assembly_instruction() {
     NodePtr func_body = core::list(nuate, call_frame, var);
     EnvPtr empty_env = std::make_shared<Environment>(nullptr);
     NodePtr continuation =
-        create_node(
+        make_node(
             Closure(
                 empty_env,
                 func_body,
@@ -200,9 +308,70 @@ void HeapVirtualMachine::evaluate_assembly_instruction() {
 
   }
 
+  // (conti1 x)
+
+  if (instruction == conti1_instruction) {
+
+    // The CallFrame chain is never mutated in place, so the continuation
+    // can share it instead of copying the top frame.
+
+    this->set_accumulator(make_node(Closure(this->frame, nullptr, true)));
+
+    this->set_expression(exp_pair.cdr()->get<DataPair>().car());
+
+  }
+
+  // (reset ret x)
+
+  if (instruction == reset_instruction) {
+    shaka::DataPair& expr_cdr = exp_pair.cdr()->get<DataPair>();
+
+    NodePtr ret = expr_cdr.car();
+
+    NodePtr x = expr_cdr.cdr()->get<DataPair>().car();
+
+    FramePtr prompt_frame =
+        std::make_shared<CallFrame>(ret, this->env,
+                                    this->rib, this->frame);
+    prompt_frame->set_prompt(true);
+    prompt_frame->set_procedure(this->procedure, ++this->frame_count);
+    this->frame = prompt_frame;
+    this->set_expression(x);
+
+    shaka::ValueRib vr;
+
+    this->set_value_rib(vr);
+
+  }
+
+  // (shift x)
+
+  if (instruction == shift_instruction) {
+
+    // Find the nearest enclosing prompt
+
+    FramePtr prompt_frame = this->frame;
+    while (prompt_frame != nullptr && !prompt_frame->is_prompt()) {
+      prompt_frame = prompt_frame->get_next_frame();
+    }
+    if (prompt_frame == nullptr) {
+      throw InvalidInputException(10011, "shift: no enclosing reset");
+    }
+
+    // Capture the frames above the prompt without copying them, then abort
+    // to the prompt so that the body of shift returns from reset
+
+    this->set_accumulator(
+        make_node(Closure(this->frame, prompt_frame, false)));
+    this->frame = prompt_frame;
+
+    this->set_expression(exp_pair.cdr()->get<DataPair>().car());
+
+  }
+
   // (nuate s var)
 
-  if (instruction == shaka::Symbol("nuate")) {
+  if (instruction == nuate_instruction) {
     // Set the top of the control stack to be s
     NodePtr continuation_frame = exp_pair.cdr()->get<DataPair>().car();
     FramePtr frame = std::make_shared<CallFrame>(
@@ -219,12 +388,12 @@ void HeapVirtualMachine::evaluate_assembly_instruction() {
     this->set_accumulator(this->get_environment()->get_value(var));
 
     // Set the next expression to be (return)
-    this->set_expression(core::list(create_node(Data(Symbol("return")))));
+    this->set_expression(core::list(make_symbol("return")));
   }
 
   // (frame ret x)
 
-  if (instruction == shaka::Symbol("frame")) {
+  if (instruction == frame_instruction) {
     shaka::DataPair& expr_cdr = exp_pair.cdr()->get<DataPair>();
 
     NodePtr ret = expr_cdr.car();
@@ -234,6 +403,7 @@ void HeapVirtualMachine::evaluate_assembly_instruction() {
     FramePtr new_frame =
         std::make_shared<CallFrame>(ret, this->env,
                                     this->rib, this->frame);
+    new_frame->set_procedure(this->procedure, ++this->frame_count);
     this->frame = new_frame;
     this->set_expression(x);
 
@@ -245,7 +415,7 @@ void HeapVirtualMachine::evaluate_assembly_instruction() {
 
   // (argument x)
 
-  if (instruction == shaka::Symbol("argument")) {
+  if (instruction == argument_instruction) {
     shaka::DataPair& exp_cdr = exp_pair.cdr()->get<DataPair>();
 
     NodePtr x = exp_cdr.car();
@@ -258,23 +428,32 @@ void HeapVirtualMachine::evaluate_assembly_instruction() {
 
   // (apply)
 
-  if (instruction == shaka::Symbol("apply")) {
+  if (instruction == apply_instruction) {
     shaka::Closure& closure = this->get_accumulator()->get<Closure>();
 
     if (closure.is_native_closure()) {
       this->set_value_rib(closure.call(this->get_value_rib()));
       this->set_accumulator(this->get_value_rib()[0]);
       if (this->get_call_frame() != nullptr) {
-        this->set_expression(core::list(create_node(Symbol("return"))));
+        this->set_expression(core::list(make_symbol("return")));
       }
       else {
-        this->set_expression(core::list(create_node(Symbol("halt"))));
+        this->set_expression(core::list(make_symbol("halt")));
       }
     }
 
+    else if (closure.is_stepping_closure()) {
+      this->continue_native_step(closure.step(this->get_value_rib()));
+    }
+
+    else if (closure.is_one_shot() || closure.is_delimited_continuation()) {
+      this->reinstate_continuation(closure);
+    }
+
     else {
-      closure.extend_environment(this->get_value_rib());
-      this->set_environment(closure.get_environment());
+      this->procedure = this->acc;
+      this->frame_count = 0;
+      this->set_environment(closure.bind_arguments(this->get_value_rib()));
       this->set_value_rib(std::deque<NodePtr>(0));
       this->set_expression(closure.get_function_body());
     }
@@ -282,16 +461,89 @@ void HeapVirtualMachine::evaluate_assembly_instruction() {
 
   // (return)
 
-  if (instruction == shaka::Symbol("return")) {
+  if (instruction == return_instruction) {
     this->set_expression(this->frame->get_next_expression());
     this->set_value_rib(this->frame->get_value_rib());
     this->set_environment(this->frame->get_environment_pointer());
+    this->procedure = this->frame->get_procedure();
+    this->frame_count = this->frame->get_frame_count() - 1;
     this->frame = this->frame->get_next_frame();
 
   }
 
 }
 
+void HeapVirtualMachine::reinstate_continuation(Closure& k) {
+  NodePtr value = this->rib.empty() ? create_unspecified() : this->rib[0];
+
+  if (k.is_one_shot()) {
+    k.consume_one_shot();
+  }
+
+  FramePtr top = k.get_call_frame();
+
+  if (k.is_delimited_continuation()) {
+    // Push a new prompt that returns into the caller of k
+    NodePtr ret = this->frame != nullptr ?
+        core::list(make_symbol("return")) :
+        core::list(make_symbol("halt"));
+    FramePtr base = std::make_shared<CallFrame>(ret, this->env,
+                                                ValueRib(), this->frame);
+    base->set_prompt(true);
+    base->set_procedure(this->procedure, ++this->frame_count);
+
+    // Re-link the captured segment on top of the new prompt
+    std::vector<FramePtr> segment;
+    for (FramePtr f = top; f != k.get_prompt_frame(); f = f->get_next_frame()) {
+      segment.push_back(f);
+    }
+    for (auto it = segment.rbegin(); it != segment.rend(); ++it) {
+      FramePtr copy = std::make_shared<CallFrame>(**it);
+      copy->set_next_frame(base);
+      base = copy;
+    }
+    top = base;
+  }
+
+  this->set_call_frame(top);
+  this->set_accumulator(value);
+  this->set_expression(core::list(make_symbol("return")));
+}
+
+void HeapVirtualMachine::continue_native_step(NativeStep step) {
+  while (step.procedure && step.procedure->get<Closure>().is_native_closure()) {
+    ValueRib args = step.state;
+    args.push_front(step.procedure->get<Closure>().call(step.arguments)[0]);
+    step = step.resume->get<Closure>().step(args);
+  }
+
+  // The native procedure is done: return its value like any native
+  if (!step.procedure) {
+    this->set_value_rib(ValueRib{step.value});
+    this->set_accumulator(step.value);
+    if (this->get_call_frame() != nullptr) {
+      this->set_expression(core::list(make_symbol("return")));
+    }
+    else {
+      this->set_expression(core::list(make_symbol("halt")));
+    }
+    return;
+  }
+
+  // The procedure returns into (argument (constant resume (apply))), which
+  // passes its result and the state saved in the CallFrame on to resume
+  Expression resume_expression = step.resume_expression ?
+      step.resume_expression : make_resume_expression(step.resume);
+  this->frame = std::make_shared<CallFrame>(resume_expression, this->env,
+                                            step.state, this->frame);
+  this->frame->set_procedure(this->procedure, ++this->frame_count);
+  this->set_accumulator(step.procedure);
+  this->set_value_rib(step.arguments);
+  // The (apply) at the end of resume_expression
+  this->set_expression(core::car(core::cdr(core::cdr(
+      core::car(core::cdr(resume_expression))))));
+}
+
 Accumulator HeapVirtualMachine::get_accumulator() const {
   return this->acc;
 }
@@ -312,12 +564,21 @@ FramePtr HeapVirtualMachine::get_call_frame() const {
   return this->frame;
 }
 
+NodePtr HeapVirtualMachine::get_procedure() const {
+  return this->procedure;
+}
+
+std::size_t HeapVirtualMachine::get_frame_count() const {
+  return this->frame_count;
+}
+
 void HeapVirtualMachine::set_accumulator(Accumulator a) {
   this->acc = a;
 }
 
 void HeapVirtualMachine::set_expression(Expression x) {
   this->exp = x;
+  this->halted = false;
 }
 
 void HeapVirtualMachine::set_call_frame(FramePtr s) {
@@ -332,6 +593,12 @@ void HeapVirtualMachine::set_value_rib(ValueRib r) {
   this->rib = r;
 }
 
+void HeapVirtualMachine::set_procedure(NodePtr procedure,
+                                       std::size_t frame_count) {
+  this->procedure = procedure;
+  this->frame_count = frame_count;
+}
+
 
 } //namespace shaka
 
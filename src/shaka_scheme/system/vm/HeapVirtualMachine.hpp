@@ -8,6 +8,10 @@
 
 #include <deque>
 #include "shaka_scheme/system/base/Data.hpp"
+#include "shaka_scheme/system/vm/native.hpp"
+#include "shaka_scheme/system/vm/VMProfiler.hpp"
+#include "shaka_scheme/system/vm/SamplingProfiler.hpp"
+#include "shaka_scheme/system/vm/AllocationProfiler.hpp"
 
 namespace shaka {
 
@@ -47,7 +51,12 @@ public:
       Expression x,
       EnvPtr e,
       ValueRib r,
-      FramePtr s) : acc(a), exp(x), env(e), rib(r), frame(s) {}
+      FramePtr s) : acc(a), exp(x), env(e), rib(r), frame(s), frame_count(0),
+                    halted(false),
+                    profiler(VMProfiler::get_thread_profiler()) {
+    SamplingProfiler::start_from_environment();
+    AllocationProfiler::start_from_environment();
+  }
 
    ~HeapVirtualMachine();
 
@@ -57,6 +66,92 @@ public:
     */
   void evaluate_assembly_instruction();
 
+  /**
+   * @brief Runs a compiled expression until it reaches (halt)
+   * @param x The compiled expression, in the current environment
+   * @return The contents of the Accumulator at (halt)
+   *
+   * @note The other registers are restored afterwards, even if evaluation
+   * throws, so native procedures may call run() or apply_procedure() on the
+   * VM that is running them. A nested run starts with an empty stack:
+   * continuations captured inside it cannot return past it.
+   */
+  Accumulator run(Expression x);
+
+  /**
+   * @brief Applies a procedure to arguments and runs until it returns
+   * @param proc The Closure to apply
+   * @param args The arguments to apply it to
+   * @return The value returned by the procedure
+   *
+   * @note Like run(), this restores the registers and may be nested.
+   */
+  Accumulator apply_procedure(NodePtr proc, ValueRib args);
+
+  /**
+   * @brief Gets the HeapVirtualMachine that is inside run() or
+   * apply_procedure(), or a RegisterScope, on this thread, for native
+   * procedures that call back into Scheme
+   * @return The innermost running VM, or nullptr if there is none
+   */
+  static HeapVirtualMachine* get_current();
+
+  /**
+   * @brief Saves the registers of a HeapVirtualMachine and makes it the
+   * current one, then restores both when it goes out of scope. run() and
+   * apply_procedure() run under one; so should anything else that
+   * evaluates instructions itself, such as a Scheduler.
+   */
+  class RegisterScope {
+  public:
+    RegisterScope(HeapVirtualMachine& hvm);
+    ~RegisterScope();
+    RegisterScope(const RegisterScope& other) = delete;
+
+  private:
+    HeapVirtualMachine& hvm;
+    Accumulator acc;
+    Expression exp;
+    EnvPtr env;
+    ValueRib rib;
+    FramePtr frame;
+    NodePtr procedure;
+    std::size_t frame_count;
+    HeapVirtualMachine* previous;
+  };
+
+  /**
+   * @brief Binds name to a typed native procedure in the environment
+   * register, for example
+   * hvm.define_native("f", [](int a, double b) -> double { ... });
+   * @param name The name to bind
+   * @param function The C++ function, with its argument and result types
+   * @see native::make_native
+   */
+  template <typename F>
+  void define_native(const std::string& name, F function) {
+    native::define_native(this->env, name, function);
+  }
+
+  /**
+   * @brief Attaches a profiler that counts and times every instruction
+   * evaluated from the next run() or apply_procedure() on.
+   * @param profiler The profiler, which is not owned, or nullptr to stop
+   * profiling
+   */
+  void set_profiler(VMProfiler* profiler);
+
+  /**
+   * @brief Gets the attached profiler, or nullptr if there is none.
+   */
+  VMProfiler* get_profiler() const;
+
+  /**
+   * @brief Determines whether the last instruction evaluated was (halt).
+   * Setting the Expression register clears this.
+   */
+  bool is_halted() const;
+
   /**
   * @brief Returns the current contents of the Accumulator register
   * @return The contents of the Accumulator
@@ -87,6 +182,20 @@ public:
    */
   FramePtr get_call_frame() const;
 
+  /**
+   * @brief Returns the Closure being applied, which (return) restores from
+   * the CallFrame
+   * @return The Closure, or a null NodePtr at top level
+   */
+  NodePtr get_procedure() const;
+
+  /**
+   * @brief Returns the number of CallFrames on top of the stack that the
+   * Closure being applied has pushed
+   * @return The number of frames
+   */
+  std::size_t get_frame_count() const;
+
   /**
    * @brief Sets the value of the Accumulator register
    * @param a The new value to be placed in the Accumulator
@@ -117,12 +226,51 @@ public:
    */
   void set_value_rib(ValueRib r);
 
+  /**
+   * @brief Sets the Closure being applied
+   * @param procedure The Closure, or a null NodePtr at top level
+   * @param frame_count The number of CallFrames on top of the stack that it
+   * has pushed
+   */
+  void set_procedure(NodePtr procedure, std::size_t frame_count);
+
 private:
+  /**
+   * @brief Resumes a one-shot or delimited continuation with the value in
+   * the ValueRib. Undelimited continuations share the captured CallFrame
+   * chain; delimited continuations re-link only the frames above the prompt.
+   * @param k The continuation Closure being applied
+   */
+  void reinstate_continuation(Closure& k);
+
+  /**
+   * @brief Evaluates instructions until (halt)
+   * @return The contents of the Accumulator at (halt)
+   */
+  Accumulator run_until_halt();
+
+  /**
+   * @brief Carries out a step of a stepping native procedure. Native
+   * procedures it calls back are applied at once; a Scheme procedure is
+   * applied under a new CallFrame that returns into the resume Closure.
+   * @param step The step returned by the stepping native procedure
+   */
+  void continue_native_step(NativeStep step);
+
   Accumulator acc;
   Expression exp;
   EnvPtr env;
   ValueRib rib;
   FramePtr frame;
+  // Only read by the SamplingProfiler, to name the procedures on the stack
+  NodePtr procedure;
+  std::size_t frame_count;
+
+  // Set by (halt), and cleared whenever the Expression register is set
+  bool halted;
+
+  // Not owned; nullptr unless profiling
+  VMProfiler* profiler;
 };
 
 }// namespace shaka
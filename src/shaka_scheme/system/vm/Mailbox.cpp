@@ -0,0 +1,36 @@
+#include "shaka_scheme/system/vm/Mailbox.hpp"
+
+namespace shaka {
+
+void Mailbox::send(NodePtr value) {
+  // Copy outside of the lock; only the sending thread touches its heap
+  gc::Message message(value);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    messages.push_back(std::move(message));
+  }
+  available.notify_one();
+}
+
+NodePtr Mailbox::receive(gc::GC& gc) {
+  std::unique_lock<std::mutex> lock(mutex);
+  available.wait(lock, [this] { return !messages.empty(); });
+  gc::Message message(std::move(messages.front()));
+  messages.pop_front();
+  lock.unlock();
+  return message.adopt(gc);
+}
+
+bool Mailbox::try_receive(gc::GC& gc, NodePtr& value) {
+  std::unique_lock<std::mutex> lock(mutex);
+  if (messages.empty()) {
+    return false;
+  }
+  gc::Message message(std::move(messages.front()));
+  messages.pop_front();
+  lock.unlock();
+  value = message.adopt(gc);
+  return true;
+}
+
+} // namespace shaka
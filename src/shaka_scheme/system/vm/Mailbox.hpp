@@ -0,0 +1,50 @@
+#ifndef SHAKA_SCHEME_MAILBOX_HPP
+#define SHAKA_SCHEME_MAILBOX_HPP
+
+#include "shaka_scheme/system/gc/Message.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace shaka {
+
+/**
+ * @brief A thread-safe queue of messages between HeapVirtualMachine
+ * instances running on different OS threads.
+ */
+class Mailbox {
+public:
+
+  /**
+   * @brief Copies a value out of the heap of the calling thread and queues
+   * it for the receiver.
+   * @param value The value to send.
+   */
+  void send(NodePtr value);
+
+  /**
+   * @brief Blocks until a message is available, then transfers its heap to
+   * the receiving GC.
+   * @param gc The heap of the calling thread.
+   * @return The received value.
+   */
+  NodePtr receive(gc::GC& gc);
+
+  /**
+   * @brief Receives a message if one is available without blocking.
+   * @param gc The heap of the calling thread.
+   * @param value Set to the received value on success.
+   * @return true if a message was received.
+   */
+  bool try_receive(gc::GC& gc, NodePtr& value);
+
+private:
+  std::mutex mutex;
+  std::condition_variable available;
+  std::deque<gc::Message> messages;
+};
+
+} // namespace shaka
+
+#endif //SHAKA_SCHEME_MAILBOX_HPP
@@ -0,0 +1,155 @@
+#include "shaka_scheme/system/vm/Poller.hpp"
+#include "shaka_scheme/system/exceptions/InvalidInputException.hpp"
+
+#include <cerrno>
+#include <cstdint>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <unistd.h>
+#else
+#include <poll.h>
+#endif
+
+namespace shaka {
+
+#ifdef __linux__
+
+Poller::Poller() :
+    epoll_fd(epoll_create1(EPOLL_CLOEXEC)) {
+  if (epoll_fd < 0) {
+    throw InvalidInputException(10020, "Poller: could not create epoll "
+        "instance");
+  }
+}
+
+Poller::~Poller() {
+  close(epoll_fd);
+}
+
+void Poller::watch(int fd, bool writable, std::size_t thread_id) {
+  int op = waiters.count(fd) ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+  std::vector<Waiter>& fd_waiters = waiters[fd];
+  fd_waiters.push_back(Waiter{thread_id, writable});
+  try {
+    arm(fd, op);
+  } catch (...) {
+    fd_waiters.pop_back();
+    if (fd_waiters.empty()) {
+      waiters.erase(fd);
+    }
+    throw;
+  }
+}
+
+void Poller::unwatch(int fd) {
+  if (waiters.erase(fd)) {
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+  }
+}
+
+std::vector<std::size_t> Poller::wait(int timeout_ms) {
+  std::vector<std::size_t> ready;
+  epoll_event events[64];
+  int count = epoll_wait(epoll_fd, events, 64, timeout_ms);
+  if (count < 0 && errno != EINTR) {
+    throw InvalidInputException(10022, "Poller: epoll_wait failed");
+  }
+  for (int i = 0; i < count; ++i) {
+    int fd = events[i].data.fd;
+    std::uint32_t revents = events[i].events;
+    // The descriptor is disarmed after each event; it is armed again for
+    // the waiters that are left
+    if (wake(fd, (revents & EPOLLIN) != 0, (revents & EPOLLOUT) != 0,
+             (revents & (EPOLLERR | EPOLLHUP)) != 0, ready)) {
+      arm(fd, EPOLL_CTL_MOD);
+    } else {
+      epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    }
+  }
+  return ready;
+}
+
+void Poller::arm(int fd, int op) {
+  epoll_event event;
+  event.events = EPOLLONESHOT;
+  for (const Waiter& waiter : waiters[fd]) {
+    event.events |= waiter.writable ? EPOLLOUT : EPOLLIN;
+  }
+  event.data.fd = fd;
+  if (epoll_ctl(epoll_fd, op, fd, &event) < 0) {
+    throw InvalidInputException(10021, "Poller: could not watch file "
+        "descriptor");
+  }
+}
+
+#else
+
+Poller::Poller() {}
+
+Poller::~Poller() {}
+
+void Poller::watch(int fd, bool writable, std::size_t thread_id) {
+  waiters[fd].push_back(Waiter{thread_id, writable});
+}
+
+void Poller::unwatch(int fd) {
+  waiters.erase(fd);
+}
+
+std::vector<std::size_t> Poller::wait(int timeout_ms) {
+  std::vector<std::size_t> ready;
+  std::vector<pollfd> fds;
+  for (auto it = waiters.begin(); it != waiters.end(); ++it) {
+    pollfd entry;
+    entry.fd = it->first;
+    entry.events = 0;
+    for (const Waiter& waiter : it->second) {
+      entry.events |= waiter.writable ? POLLOUT : POLLIN;
+    }
+    entry.revents = 0;
+    fds.push_back(entry);
+  }
+  int count = poll(fds.data(), fds.size(), timeout_ms);
+  if (count < 0 && errno != EINTR) {
+    throw InvalidInputException(10022, "Poller: poll failed");
+  }
+  for (std::size_t i = 0; count > 0 && i < fds.size(); ++i) {
+    short revents = fds[i].revents;
+    if (revents != 0) {
+      wake(fds[i].fd, (revents & POLLIN) != 0, (revents & POLLOUT) != 0,
+           (revents & (POLLERR | POLLHUP | POLLNVAL)) != 0, ready);
+    }
+  }
+  return ready;
+}
+
+#endif
+
+bool Poller::is_empty() const {
+  return waiters.empty();
+}
+
+bool Poller::wake(int fd, bool readable, bool writable, bool failed,
+                  std::vector<std::size_t>& ready) {
+  auto it = waiters.find(fd);
+  if (it == waiters.end()) {
+    return false;
+  }
+  std::vector<Waiter> left;
+  for (const Waiter& waiter : it->second) {
+    if (failed || (waiter.writable ? writable : readable)) {
+      ready.push_back(waiter.thread_id);
+    } else {
+      left.push_back(waiter);
+    }
+  }
+  if (left.empty()) {
+    waiters.erase(it);
+    return false;
+  }
+  it->second = left;
+  return true;
+}
+
+} // namespace shaka
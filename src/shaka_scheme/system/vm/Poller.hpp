@@ -0,0 +1,90 @@
+#ifndef SHAKA_SCHEME_POLLER_HPP
+#define SHAKA_SCHEME_POLLER_HPP
+
+#include <cstddef>
+#include <map>
+#include <vector>
+
+namespace shaka {
+
+/**
+ * @brief Waits for file descriptor readiness on behalf of parked green
+ * threads. Backed by epoll on Linux and by poll(2) everywhere else.
+ *
+ * @note Several threads may wait on the same file descriptor, for reading
+ * or for writing. Each one is woken when the descriptor is ready in the
+ * direction it waits for, or has an error or hang-up.
+ */
+class Poller {
+public:
+
+  /**
+   * @brief Constructs an empty Poller.
+   */
+  Poller();
+
+  /**
+   * @brief Releases the underlying epoll instance, if any.
+   */
+  ~Poller();
+
+  Poller(const Poller& other) = delete;
+  Poller& operator=(const Poller& other) = delete;
+
+  /**
+   * @brief Parks a thread until a file descriptor becomes ready.
+   * @param fd The file descriptor to watch.
+   * @param writable true to wait for writability, false for readability
+   * @param thread_id The id of the green thread to wake up.
+   */
+  void watch(int fd, bool writable, std::size_t thread_id);
+
+  /**
+   * @brief Stops watching a file descriptor for every thread waiting on it,
+   * if it is watched.
+   * @param fd The file descriptor to forget.
+   */
+  void unwatch(int fd);
+
+  /**
+   * @brief Determines whether any thread is waiting on a descriptor.
+   * @return true if no descriptors are being watched.
+   */
+  bool is_empty() const;
+
+  /**
+   * @brief Blocks until at least one watched descriptor is ready.
+   * @param timeout_ms The maximum time to block, or -1 to block indefinitely
+   * @return The ids of the threads whose descriptors became ready. Those
+   * threads are no longer waiting.
+   */
+  std::vector<std::size_t> wait(int timeout_ms);
+
+private:
+  struct Waiter {
+    std::size_t thread_id;
+    bool writable;
+  };
+
+  /**
+   * @brief Removes the waiters of fd that are woken by an event, and adds
+   * their ids to ready.
+   * @return true if waiters are left on fd
+   */
+  bool wake(int fd, bool readable, bool writable, bool failed,
+            std::vector<std::size_t>& ready);
+
+  std::map<int, std::vector<Waiter>> waiters;
+#ifdef __linux__
+  /**
+   * @brief Arms fd for the directions its waiters wait for.
+   */
+  void arm(int fd, int op);
+
+  int epoll_fd;
+#endif
+};
+
+} // namespace shaka
+
+#endif //SHAKA_SCHEME_POLLER_HPP
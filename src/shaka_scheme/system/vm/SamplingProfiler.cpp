@@ -0,0 +1,253 @@
+#include "shaka_scheme/system/vm/SamplingProfiler.hpp"
+#include "shaka_scheme/system/vm/HeapVirtualMachine.hpp"
+#include "shaka_scheme/system/exceptions/InvalidInputException.hpp"
+
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#include <sys/time.h>
+
+namespace shaka {
+
+namespace {
+
+// Guards active, and the timer and handler that go with it
+std::mutex active_mutex;
+SamplingProfiler* active = nullptr;
+struct sigaction previous_action;
+
+/**
+ * @brief The profiler started by SHAKA_SCHEME_SAMPLE_PROFILE, which writes
+ * its samples out when the process exits.
+ */
+class ProcessProfile {
+public:
+  ProcessProfile(const std::string& path, unsigned interval_us) :
+      path(path) {
+    try {
+      profiler.start(interval_us);
+    } catch (const InvalidInputException& e) {
+      std::cerr << e.what() << std::endl;
+    }
+  }
+
+  ~ProcessProfile() {
+    profiler.stop();
+    if (path.empty() || path == "-") {
+      profiler.write_collapsed(std::cerr);
+      return;
+    }
+    std::ofstream out(path.c_str());
+    if (out) {
+      profiler.write_collapsed(out);
+    } else {
+      std::cerr << "SamplingProfiler: could not write " << path << std::endl;
+    }
+  }
+
+private:
+  std::string path;
+  SamplingProfiler profiler;
+};
+
+} // namespace
+
+std::atomic<bool> SamplingProfiler::sample_due(false);
+
+SamplingProfiler::SamplingProfiler() :
+    sample_count(0),
+    running(false) {}
+
+SamplingProfiler::~SamplingProfiler() {
+  stop();
+}
+
+void SamplingProfiler::start(unsigned interval_us) {
+  std::lock_guard<std::mutex> lock(active_mutex);
+  if (active == this) {
+    return;
+  }
+  if (active != nullptr) {
+    throw InvalidInputException(10081, "SamplingProfiler: another profiler "
+        "is already running");
+  }
+  struct sigaction action;
+  action.sa_handler = &SamplingProfiler::request_sample;
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_RESTART;
+  if (sigaction(SIGPROF, &action, &previous_action) != 0) {
+    throw InvalidInputException(10081, "SamplingProfiler: could not install "
+        "the SIGPROF handler");
+  }
+  itimerval timer;
+  timer.it_interval.tv_sec = interval_us / 1000000;
+  timer.it_interval.tv_usec = interval_us % 1000000;
+  timer.it_value = timer.it_interval;
+  if (interval_us == 0 || setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+    sigaction(SIGPROF, &previous_action, nullptr);
+    throw InvalidInputException(10081, "SamplingProfiler: could not set the "
+        "timer");
+  }
+  active = this;
+  std::lock_guard<std::mutex> data_lock(mutex);
+  running = true;
+}
+
+void SamplingProfiler::stop() {
+  std::lock_guard<std::mutex> lock(active_mutex);
+  if (active != this) {
+    return;
+  }
+  itimerval timer = {};
+  setitimer(ITIMER_PROF, &timer, nullptr);
+  sigaction(SIGPROF, &previous_action, nullptr);
+  sample_due.store(false);
+  active = nullptr;
+  std::lock_guard<std::mutex> data_lock(mutex);
+  running = false;
+}
+
+bool SamplingProfiler::is_running() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return running;
+}
+
+void SamplingProfiler::sample(const HeapVirtualMachine& hvm) {
+  std::vector<std::string> stack = get_stack(hvm);
+  std::string key;
+  for (std::size_t i = 0; i < stack.size(); ++i) {
+    if (i != 0) {
+      key += ';';
+    }
+    key += stack[i];
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  ++stacks[key];
+  ++sample_count;
+}
+
+std::size_t SamplingProfiler::get_sample_count() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return sample_count;
+}
+
+std::map<std::string, std::size_t> SamplingProfiler::get_stacks() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return stacks;
+}
+
+void SamplingProfiler::write_collapsed(std::ostream& out) const {
+  std::lock_guard<std::mutex> lock(mutex);
+  for (const auto& stack : stacks) {
+    out << stack.first << " " << stack.second << "\n";
+  }
+}
+
+void SamplingProfiler::reset() {
+  std::lock_guard<std::mutex> lock(mutex);
+  stacks.clear();
+  sample_count = 0;
+}
+
+std::vector<std::string> SamplingProfiler::get_stack(
+    const HeapVirtualMachine& hvm) {
+  // A recursive procedure is on the stack many times, but only named once
+  std::map<Data*, std::string> names;
+  auto get_name = [&names](NodePtr procedure) -> const std::string& {
+    Data* key = procedure ? procedure.get() : nullptr;
+    auto it = names.find(key);
+    if (it == names.end()) {
+      it = names.insert(std::make_pair(key,
+                                       get_procedure_name(procedure))).first;
+    }
+    return it->second;
+  };
+
+  // The frames that a procedure has pushed for calls it is still making
+  // are skipped, so that each call is listed once
+  std::vector<std::string> stack;
+  NodePtr procedure = hvm.get_procedure();
+  stack.push_back(get_name(procedure));
+  FramePtr frame = hvm.get_call_frame();
+  for (std::size_t i = 0; i < hvm.get_frame_count() && frame != nullptr; ++i) {
+    frame = frame->get_next_frame();
+  }
+  while (frame != nullptr) {
+    procedure = frame->get_procedure();
+    stack.push_back(get_name(procedure));
+    for (std::size_t i = frame->get_frame_count(); i > 0 && frame != nullptr;
+         --i) {
+      frame = frame->get_next_frame();
+    }
+  }
+  // A procedure applied in tail position from top level has no frame below
+  if (procedure) {
+    stack.push_back(get_name(NodePtr()));
+  }
+  // Semicolons separate the names in the collapsed format
+  for (std::string& name : stack) {
+    std::replace(name.begin(), name.end(), ';', ':');
+  }
+  return std::vector<std::string>(stack.rbegin(), stack.rend());
+}
+
+std::string SamplingProfiler::get_procedure_name(NodePtr procedure) {
+  if (!procedure) {
+    return "(top level)";
+  }
+  Closure& closure = procedure->get<Closure>();
+  NodePtr body = closure.get_function_body();
+  for (std::shared_ptr<IEnvironment<Symbol, NodePtr>> e =
+           closure.get_environment();
+       e != nullptr; e = e->get_parent()) {
+    std::shared_ptr<Environment> env = std::dynamic_pointer_cast<Environment>(e);
+    if (env == nullptr) {
+      break;
+    }
+    for (const auto& binding : env->get_bindings()) {
+      if (binding.second &&
+          binding.second->get_type() == Data::Type::CLOSURE &&
+          binding.second->get<Closure>().get_function_body() == body) {
+        return binding.first.get_value();
+      }
+    }
+  }
+  std::string name = "(lambda (";
+  VariableList variables = closure.get_variable_list();
+  for (std::size_t i = 0; i < variables.size(); ++i) {
+    name += (i == 0 ? "" : " ") + variables[i].get_value();
+  }
+  return name + "))";
+}
+
+void SamplingProfiler::take_sample(const HeapVirtualMachine& hvm) {
+  if (!sample_due.exchange(false)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(active_mutex);
+  if (active != nullptr) {
+    active->sample(hvm);
+  }
+}
+
+void SamplingProfiler::start_from_environment() {
+  static const bool enabled =
+      std::getenv("SHAKA_SCHEME_SAMPLE_PROFILE") != nullptr;
+  if (!enabled) {
+    return;
+  }
+  const char* path = std::getenv("SHAKA_SCHEME_SAMPLE_PROFILE");
+  const char* interval = std::getenv("SHAKA_SCHEME_SAMPLE_INTERVAL");
+  unsigned long interval_us =
+      interval != nullptr ? std::strtoul(interval, nullptr, 10) : 0;
+  static ProcessProfile profile(path, interval_us != 0 ? interval_us : 10000);
+}
+
+void SamplingProfiler::request_sample(int) {
+  sample_due.store(true, std::memory_order_relaxed);
+}
+
+} // namespace shaka
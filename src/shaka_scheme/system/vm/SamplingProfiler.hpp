@@ -0,0 +1,148 @@
+#ifndef SHAKA_SCHEME_SAMPLINGPROFILER_HPP
+#define SHAKA_SCHEME_SAMPLINGPROFILER_HPP
+
+#include "shaka_scheme/system/gc/GCNode.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace shaka {
+
+class HeapVirtualMachine;
+using NodePtr = gc::GCNode;
+
+/**
+ * @brief Finds where Scheme code spends its time by sampling the stack of
+ * procedures at regular intervals of CPU time, with no instrumentation.
+ *
+ * While a profiler is running, a SIGPROF timer only raises a flag. Every
+ * HeapVirtualMachine checks the flag between instructions, and the first one
+ * to see it records its stack: the procedure it is applying, then the
+ * procedure that each CallFrame returns into. Procedures are named by the
+ * variables they are bound to, found from their lexical environments.
+ *
+ * The samples are written in the collapsed stack format that flame graph
+ * tools read, one line per distinct stack:
+ *
+ *     (top level);fib;fib;fib 42
+ *
+ * Only one profiler runs at a time, since the timer is shared by the whole
+ * process. Setting the environment variable SHAKA_SCHEME_SAMPLE_PROFILE
+ * runs one from the first HeapVirtualMachine on, and writes its samples when
+ * the process exits, to the file the variable names, or to standard error
+ * if it is empty or "-". SHAKA_SCHEME_SAMPLE_INTERVAL then sets the interval
+ * in microseconds.
+ */
+class SamplingProfiler {
+public:
+  /**
+   * @brief Constructs a stopped SamplingProfiler with no samples.
+   */
+  SamplingProfiler();
+
+  /**
+   * @brief Stops the profiler if it is running.
+   */
+  ~SamplingProfiler();
+
+  SamplingProfiler(const SamplingProfiler&) = delete;
+  SamplingProfiler& operator=(const SamplingProfiler&) = delete;
+
+  /**
+   * @brief Starts taking a sample every interval of CPU time.
+   * @param interval_us The interval in microseconds
+   * @throws InvalidInputException if another profiler is running, or the
+   * timer could not be set
+   */
+  void start(unsigned interval_us = 10000);
+
+  /**
+   * @brief Stops taking samples. The samples taken so far are kept.
+   */
+  void stop();
+
+  /**
+   * @brief Determines whether this profiler is taking samples.
+   */
+  bool is_running() const;
+
+  /**
+   * @brief Records the current stack of a HeapVirtualMachine as one sample.
+   */
+  void sample(const HeapVirtualMachine& hvm);
+
+  /**
+   * @brief Gets the number of samples taken.
+   */
+  std::size_t get_sample_count() const;
+
+  /**
+   * @brief Gets the number of samples of each stack, keyed by the names of
+   * its procedures from the outermost, separated by ';'.
+   */
+  std::map<std::string, std::size_t> get_stacks() const;
+
+  /**
+   * @brief Writes the samples in the collapsed stack format.
+   */
+  void write_collapsed(std::ostream& out) const;
+
+  /**
+   * @brief Discards every sample.
+   */
+  void reset();
+
+  /**
+   * @brief Gets the names of the procedures on the stack of a
+   * HeapVirtualMachine, from the outermost to the one being applied.
+   */
+  static std::vector<std::string> get_stack(const HeapVirtualMachine& hvm);
+
+  /**
+   * @brief Gets the variable that a procedure is bound to in its lexical
+   * environment or an enclosing one, or describes its lambda if there is
+   * none.
+   * @param procedure The Closure, or a null NodePtr for top level
+   */
+  static std::string get_procedure_name(NodePtr procedure);
+
+  /**
+   * @brief Determines whether the timer has asked for a sample. This is
+   * checked between instructions, so it is kept to one relaxed load.
+   */
+  static bool is_sample_due() {
+    return sample_due.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Takes the sample the timer asked for, if no other
+   * HeapVirtualMachine has taken it yet.
+   */
+  static void take_sample(const HeapVirtualMachine& hvm);
+
+  /**
+   * @brief Starts the process profiler if SHAKA_SCHEME_SAMPLE_PROFILE is
+   * set and it is not running yet.
+   */
+  static void start_from_environment();
+
+private:
+  // The SIGPROF handler
+  static void request_sample(int signal);
+
+  static std::atomic<bool> sample_due;
+
+  mutable std::mutex mutex;
+  std::map<std::string, std::size_t> stacks;
+  std::size_t sample_count;
+  bool running;
+};
+
+} // namespace shaka
+
+#endif //SHAKA_SCHEME_SAMPLINGPROFILER_HPP
@@ -0,0 +1,653 @@
+#include "shaka_scheme/system/vm/Scheduler.hpp"
+#include "shaka_scheme/system/core/lists.hpp"
+#include "shaka_scheme/system/gc/mark_procedures.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <thread>
+
+namespace shaka {
+
+namespace {
+
+int get_int_argument(const std::deque<NodePtr>& args,
+                     std::size_t k,
+                     const std::string& name) {
+  if (args.size() <= k ||
+      args[k]->get_type() != Data::Type::NUMBER ||
+      args[k]->get<Number>().get_type() != Number::NumberType::INTEGER) {
+    throw TypeException(10023, name + ": expected an integer argument");
+  }
+  return args[k]->get<Number>().get<Integer>().get_value();
+}
+
+/**
+ * @brief Gets a count or an index argument of a port read procedure.
+ * @return false if it is not a non-negative integer, which the procedure
+ * itself reports
+ */
+bool get_size_argument(const std::deque<NodePtr>& args, std::size_t k,
+                       std::size_t& size) {
+  if (args.size() <= k ||
+      args[k]->get_type() != Data::Type::NUMBER ||
+      args[k]->get<Number>().get_type() != Number::NumberType::INTEGER ||
+      args[k]->get<Number>().get<Integer>().get_value() < 0) {
+    return false;
+  }
+  size = static_cast<std::size_t>(
+      args[k]->get<Number>().get<Integer>().get_value());
+  return true;
+}
+
+/**
+ * @brief Stands for the AsyncIO event descriptor among the Poller waiters.
+ */
+const std::size_t io_waiter = std::numeric_limits<std::size_t>::max();
+
+/**
+ * @brief Makes the result of a read of requested bytes: a string or a
+ * bytevector, or the end-of-file object if nothing was left to read.
+ */
+NodePtr make_read_result(const std::string& bytes, std::size_t requested,
+                         bool binary) {
+  if (requested > 0 && bytes.empty()) {
+    return create_eof_object();
+  }
+  if (!binary) {
+    return create_node(String(bytes));
+  }
+  Bytevector bytevector(bytes.size());
+  for (std::size_t i = 0; i < bytes.size(); ++i) {
+    bytevector[i] = static_cast<unsigned char>(bytes[i]);
+  }
+  return create_node(bytevector);
+}
+
+/**
+ * @brief Adds a value to the end of a channel queue.
+ */
+void enqueue(NodePtr queue, NodePtr value) {
+  NodePtr last = core::list(value);
+  if (core::is_null_list(core::car(queue))) {
+    core::set_car(queue, last);
+  } else {
+    core::set_cdr(core::cdr(queue), last);
+  }
+  core::set_cdr(queue, last);
+}
+
+/**
+ * @brief Takes the value at the front of a channel queue.
+ * @return The value, or a null NodePtr if the queue is empty.
+ */
+NodePtr dequeue(NodePtr queue) {
+  NodePtr first = core::car(queue);
+  if (core::is_null_list(first)) {
+    return NodePtr();
+  }
+  core::set_car(queue, core::cdr(first));
+  if (core::is_null_list(core::car(queue))) {
+    core::set_cdr(queue, core::list());
+  }
+  return core::car(first);
+}
+
+} // namespace
+
+Scheduler::Scheduler(HeapVirtualMachine& hvm, std::size_t quantum,
+                     bool use_io_uring) :
+    hvm(hvm),
+    quantum(quantum),
+    async_io(use_io_uring),
+    io_countdown(0),
+    next_channel(0),
+    next_id(0),
+    current(0),
+    running(false),
+    switch_requested(false),
+    main_thread(0),
+    main_halted(false) {
+  root_set = gc::add_root_set([this]() {
+    this->mark();
+  });
+}
+
+Scheduler::~Scheduler() {
+  gc::remove_root_set(root_set);
+}
+
+void Scheduler::define_procedures(EnvPtr env) {
+  using Args = std::deque<NodePtr>;
+
+  env->set_value(Symbol("spawn"), create_node(Closure([this](Args args) {
+    if (args.size() != 1 || args[0]->get_type() != Data::Type::CLOSURE) {
+      throw TypeException(10024, "spawn: expected a procedure");
+    }
+    std::size_t id = this->spawn(args[0]);
+    return Args{create_node(Number(static_cast<int>(id)))};
+  }, false)));
+
+  env->set_value(Symbol("yield"), create_node(Closure([this](Args) {
+    this->switch_requested = true;
+    return Args{create_unspecified()};
+  }, false)));
+
+  env->set_value(Symbol("sleep"), create_node(Closure([this](Args args) {
+    int ms = get_int_argument(args, 0, "sleep");
+    this->park_current();
+    this->sleepers.insert(std::make_pair(
+        Clock::now() + std::chrono::milliseconds(ms), this->current));
+    return Args{create_unspecified()};
+  }, false)));
+
+  env->set_value(Symbol("make-channel"), create_node(Closure([this](Args) {
+    // Drop the channels whose handles were collected
+    for (auto it = this->channels.begin(); it != this->channels.end();) {
+      if (it->second.buffer->get<Ephemeron>().is_broken()) {
+        it = this->channels.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    int id = this->next_channel++;
+    NodePtr handle = create_node(Number(id));
+    Channel channel;
+    channel.buffer = create_node(Ephemeron(handle,
+        core::cons(core::list(), core::list())));
+    this->channels.insert(std::make_pair(id, channel));
+    return Args{handle};
+  }, false)));
+
+  env->set_value(Symbol("channel-send"), create_node(Closure([this](Args args) {
+    if (args.size() != 2) {
+      throw InvalidInputException(10025, "channel-send: expected a channel "
+          "and an object");
+    }
+    Channel& channel = this->get_channel(args[0]);
+    if (!channel.receivers.empty()) {
+      // Hand the value directly to the oldest waiting receiver
+      std::size_t receiver = channel.receivers.front();
+      channel.receivers.pop_front();
+      this->threads.at(receiver).acc = args[1];
+      this->make_runnable(receiver);
+    } else {
+      enqueue(channel.buffer->get<Ephemeron>().get_datum(), args[1]);
+    }
+    return Args{create_unspecified()};
+  }, false)));
+
+  env->set_value(Symbol("channel-receive"),
+                 create_node(Closure([this](Args args) {
+    if (args.size() != 1) {
+      throw InvalidInputException(10025, "channel-receive: expected a "
+          "channel");
+    }
+    Channel& channel = this->get_channel(args[0]);
+    NodePtr value = dequeue(channel.buffer->get<Ephemeron>().get_datum());
+    if (value) {
+      return Args{value};
+    }
+    // The sender stores the value into the accumulator of this thread
+    this->park_current();
+    channel.receivers.push_back(this->current);
+    return Args{create_unspecified()};
+  }, false)));
+
+  env->set_value(Symbol("wait-readable"),
+                 create_node(Closure([this](Args args) {
+    int fd = get_int_argument(args, 0, "wait-readable");
+    this->park_current();
+    this->poller.watch(fd, false, this->current);
+    return Args{create_unspecified()};
+  }, false)));
+
+  env->set_value(Symbol("wait-writable"),
+                 create_node(Closure([this](Args args) {
+    int fd = get_int_argument(args, 0, "wait-writable");
+    this->park_current();
+    this->poller.watch(fd, true, this->current);
+    return Args{create_unspecified()};
+  }, false)));
+
+  env->set_value(Symbol("async-read"), create_node(Closure([this](Args args) {
+    int k = get_int_argument(args, 0, "async-read");
+    if (k < 0 || args.size() != 2 ||
+        args[1]->get_type() != Data::Type::PORT ||
+        !args[1]->get<Port>().is_input()) {
+      throw TypeException(10079, "async-read: expected a count and an input "
+          "port");
+    }
+    Port& port = args[1]->get<Port>();
+    std::size_t size = static_cast<std::size_t>(k);
+    std::string bytes(size, '\0');
+    bytes.resize(port.read_buffered(&bytes[0], size));
+    std::size_t rest = size - bytes.size();
+    int fd;
+    std::uint64_t offset;
+    if (rest == 0 || !this->running ||
+        !port.reserve_file_range(Port::Direction::INPUT, rest, fd, offset)) {
+      // Not a file port: read the rest at once
+      std::size_t buffered = bytes.size();
+      bytes.resize(size);
+      bytes.resize(buffered + port.read(&bytes[buffered], rest));
+      return Args{make_read_result(bytes, size, port.is_binary())};
+    }
+    this->park_current();
+    this->async_io.read(fd, offset, rest, this->current);
+    this->pending_io.insert(std::make_pair(
+        this->current, PendingIO{port, offset, rest, bytes, false}));
+    return Args{create_unspecified()};
+  }, false)));
+
+  env->set_value(Symbol("async-write"), create_node(Closure([this](Args args) {
+    if (args.size() != 2 || args[1]->get_type() != Data::Type::PORT ||
+        !args[1]->get<Port>().is_output()) {
+      throw TypeException(10079, "async-write: expected an object and an "
+          "output port");
+    }
+    std::string bytes;
+    if (args[0]->get_type() == Data::Type::STRING) {
+      bytes = args[0]->get<String>().get_string();
+    } else if (args[0]->get_type() == Data::Type::BYTEVECTOR) {
+      Bytevector& bytevector = args[0]->get<Bytevector>();
+      for (std::size_t i = 0; i < bytevector.length(); ++i) {
+        bytes.push_back(static_cast<char>(bytevector[i]));
+      }
+    } else {
+      throw TypeException(10079, "async-write: expected a string or a "
+          "bytevector");
+    }
+    Port& port = args[1]->get<Port>();
+    int fd;
+    std::uint64_t offset;
+    if (!this->running || !port.reserve_file_range(Port::Direction::OUTPUT,
+                                                   bytes.size(), fd,
+                                                   offset)) {
+      port.write(bytes);
+      return Args{create_unspecified()};
+    }
+    this->park_current();
+    std::size_t size = bytes.size();
+    this->async_io.write(fd, offset, std::move(bytes), this->current);
+    this->pending_io.insert(std::make_pair(
+        this->current, PendingIO{port, offset, size, std::string(), true}));
+    return Args{create_unspecified()};
+  }, false)));
+
+  wrap_port_read(env, "read-line", 0, ReadSize::LINE);
+  wrap_port_read(env, "read-string", 1, ReadSize::COUNT);
+  wrap_port_read(env, "read-u8", 0, ReadSize::BYTE);
+  wrap_port_read(env, "peek-u8", 0, ReadSize::BYTE);
+  wrap_port_read(env, "read-bytevector", 1, ReadSize::COUNT);
+  wrap_port_read(env, "read-bytevector!", 1, ReadSize::RANGE);
+}
+
+void Scheduler::wrap_port_read(EnvPtr env, const std::string& name,
+                               std::size_t port_index, ReadSize size) {
+  using Args = std::deque<NodePtr>;
+
+  Symbol symbol(name);
+  if (!env->contains(symbol)) {
+    return;
+  }
+  NodePtr binding = env->get_value(symbol);
+  if (binding->get_type() != Data::Type::CLOSURE ||
+      !binding->get<Closure>().is_native_closure()) {
+    return;
+  }
+  // A copy, as the node is no longer bound once the wrapper replaces it
+  std::shared_ptr<Closure> read =
+      std::make_shared<Closure>(binding->get<Closure>());
+  // The wrapper, which the thread applies again after it waits
+  std::shared_ptr<NodePtr> self = std::make_shared<NodePtr>();
+  NodePtr wrapper = create_node(Closure([this, read, port_index, size, self](
+      Args args) {
+    // Only a read the VM applies itself can be applied again
+    if (!this->running || this->hvm.get_accumulator().get() != self->get() ||
+        args.size() <= port_index ||
+        args[port_index]->get_type() != Data::Type::PORT ||
+        !args[port_index]->get<Port>().is_input() ||
+        !args[port_index]->get<Port>().is_open()) {
+      return read->call(args);
+    }
+    std::size_t count = 1;
+    if (size == ReadSize::COUNT && !get_size_argument(args, 0, count)) {
+      return read->call(args);
+    }
+    if (size == ReadSize::RANGE) {
+      if (args[0]->get_type() != Data::Type::BYTEVECTOR) {
+        return read->call(args);
+      }
+      std::size_t start = 0;
+      std::size_t end = args[0]->get<Bytevector>().length();
+      if ((args.size() > 2 && !get_size_argument(args, 2, start)) ||
+          (args.size() > 3 && !get_size_argument(args, 3, end)) ||
+          start > end) {
+        return read->call(args);
+      }
+      count = end - start;
+    }
+    int fd = args[port_index]->get<Port>().get_wait_descriptor(
+        count, size == ReadSize::LINE);
+    if (fd < 0) {
+      return read->call(args);
+    }
+    this->park_current();
+    this->poller.watch(fd, false, this->current);
+    this->retry_procedure = *self;
+    this->retry_arguments = args;
+    return Args{create_unspecified()};
+  }, true));
+  *self = wrapper;
+  env->set_value(symbol, wrapper);
+}
+
+std::size_t Scheduler::spawn(NodePtr thunk) {
+  // The thread starts by applying the thunk, then returns to (halt)
+  EnvPtr env = hvm.get_environment();
+  FramePtr frame = std::make_shared<CallFrame>(
+      core::list(create_node(Symbol("halt"))), env, ValueRib(), nullptr);
+  GreenThread thread{
+      thunk,
+      core::list(create_node(Symbol("apply"))),
+      env,
+      ValueRib(),
+      frame,
+      NodePtr(),
+      0,
+      State::RUNNABLE
+  };
+  return create_thread(thread);
+}
+
+NodePtr Scheduler::run(Expression main) {
+  GreenThread thread{
+      hvm.get_accumulator(),
+      main,
+      hvm.get_environment(),
+      hvm.get_value_rib(),
+      hvm.get_call_frame(),
+      NodePtr(),
+      0,
+      State::RUNNABLE
+  };
+  main_thread = create_thread(thread);
+  main_halted = false;
+  try {
+    schedule(true);
+  } catch (...) {
+    // Whatever thread threw, the main thread does not outlive this run
+    remove_thread(main_thread);
+    throw;
+  }
+  NodePtr result = main_result;
+  main_result = NodePtr();
+  return result;
+}
+
+void Scheduler::run() {
+  schedule(false);
+}
+
+std::size_t Scheduler::get_thread_count() const {
+  return threads.size();
+}
+
+std::size_t Scheduler::get_channel_count() const {
+  std::size_t count = 0;
+  for (const auto& entry : channels) {
+    if (!entry.second.buffer->get<Ephemeron>().is_broken()) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+const AsyncIO& Scheduler::get_async_io() const {
+  return async_io;
+}
+
+void Scheduler::mark() const {
+  for (const auto& entry : threads) {
+    const GreenThread& thread = entry.second;
+    if (thread.acc) {
+      gc::mark_accumulator(thread.acc);
+    }
+    if (thread.exp) {
+      gc::mark_expression(thread.exp);
+    }
+    if (thread.env != nullptr) {
+      gc::mark_environment(*thread.env);
+    }
+    gc::mark_value_rib(thread.rib);
+    if (thread.frame != nullptr) {
+      gc::mark_call_frame(*thread.frame);
+    }
+    if (thread.procedure) {
+      gc::mark_node(thread.procedure);
+    }
+  }
+  for (const auto& entry : channels) {
+    gc::mark_node(entry.second.buffer);
+  }
+  if (main_result) {
+    gc::mark_node(main_result);
+  }
+}
+
+std::size_t Scheduler::create_thread(GreenThread thread) {
+  std::size_t id = next_id++;
+  threads.insert(std::make_pair(id, thread));
+  run_queue.push_back(id);
+  return id;
+}
+
+void Scheduler::remove_thread(std::size_t id) {
+  threads.erase(id);
+  run_queue.erase(std::remove(run_queue.begin(), run_queue.end(), id),
+                  run_queue.end());
+  for (auto& entry : channels) {
+    std::deque<std::size_t>& receivers = entry.second.receivers;
+    receivers.erase(std::remove(receivers.begin(), receivers.end(), id),
+                    receivers.end());
+  }
+}
+
+void Scheduler::schedule(bool until_main) {
+  while (!(until_main && main_halted)) {
+    wake_sleepers();
+    // Requests made during a pass over the run queue are submitted together
+    if (!async_io.is_empty() && (run_queue.empty() || io_countdown == 0)) {
+      poll_io(0);
+      io_countdown = run_queue.size();
+    }
+    if (run_queue.empty()) {
+      if (sleepers.empty() && poller.is_empty() && async_io.is_empty()) {
+        if (until_main) {
+          throw InvalidInputException(10026, "Scheduler: deadlock, every "
+              "thread is blocked on a channel");
+        }
+        return;
+      }
+      // Block the OS thread until the next sleeper or descriptor is due
+      int timeout = -1;
+      if (!sleepers.empty()) {
+        auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(
+            sleepers.begin()->first - Clock::now()).count();
+        timeout = delay > 0 ? static_cast<int>(delay) : 0;
+      }
+      if (!async_io.is_empty() && poller.is_empty()) {
+        poll_io(timeout);
+      } else if (!async_io.is_empty()) {
+        int event = async_io.get_event_descriptor();
+        poller.watch(event, false, io_waiter);
+        for (std::size_t id : poller.wait(timeout)) {
+          if (id != io_waiter) {
+            make_runnable(id);
+          }
+        }
+        poller.unwatch(event);
+        poll_io(0);
+      } else if (poller.is_empty()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeout));
+      } else {
+        for (std::size_t id : poller.wait(timeout)) {
+          make_runnable(id);
+        }
+      }
+      continue;
+    }
+    std::size_t id = run_queue.front();
+    run_queue.pop_front();
+    if (io_countdown > 0) {
+      --io_countdown;
+    }
+    run_slice(id);
+  }
+}
+
+void Scheduler::run_slice(std::size_t id) {
+  // Makes hvm the current VM for native procedures and profilers, and gives
+  // it back its own registers after the slice
+  HeapVirtualMachine::RegisterScope scope(hvm);
+
+  GreenThread& thread = threads.at(id);
+  hvm.set_accumulator(thread.acc);
+  hvm.set_expression(thread.exp);
+  hvm.set_environment(thread.env);
+  hvm.set_value_rib(thread.rib);
+  hvm.set_call_frame(thread.frame);
+  hvm.set_procedure(thread.procedure, thread.frame_count);
+
+  current = id;
+  running = true;
+  switch_requested = false;
+
+  VMProfiler* profiler = hvm.get_profiler();
+  try {
+    for (std::size_t n = 0;
+         n < quantum && !switch_requested && !hvm.is_halted(); ++n) {
+      if (profiler != nullptr) {
+        profiler->evaluate(hvm);
+      } else {
+        hvm.evaluate_assembly_instruction();
+      }
+      if (SamplingProfiler::is_sample_due()) {
+        SamplingProfiler::take_sample(hvm);
+      }
+    }
+  } catch (...) {
+    running = false;
+    retry_procedure = NodePtr();
+    retry_arguments.clear();
+    threads.erase(id);
+    throw;
+  }
+  running = false;
+
+  if (hvm.is_halted()) {
+    if (id == main_thread) {
+      main_halted = true;
+      main_result = hvm.get_accumulator();
+    }
+    threads.erase(id);
+    return;
+  }
+
+  // Save the registers. A thread parked by a native procedure is queued
+  // again once it is woken up.
+  GreenThread& saved = threads.at(id);
+  saved.acc = hvm.get_accumulator();
+  saved.exp = hvm.get_expression();
+  saved.env = hvm.get_environment();
+  saved.rib = hvm.get_value_rib();
+  saved.frame = hvm.get_call_frame();
+  saved.procedure = hvm.get_procedure();
+  saved.frame_count = hvm.get_frame_count();
+  if (retry_procedure) {
+    // Back to the (apply) of the port read, with its arguments
+    saved.acc = retry_procedure;
+    saved.exp = core::list(create_node(Symbol("apply")));
+    saved.rib = retry_arguments;
+    retry_procedure = NodePtr();
+    retry_arguments.clear();
+  }
+  if (saved.state == State::RUNNABLE) {
+    run_queue.push_back(id);
+  }
+}
+
+void Scheduler::park_current() {
+  if (!running) {
+    throw InvalidInputException(10027, "Scheduler: blocking procedure "
+        "called outside of a green thread");
+  }
+  threads.at(current).state = State::PARKED;
+  switch_requested = true;
+}
+
+void Scheduler::make_runnable(std::size_t id) {
+  auto it = threads.find(id);
+  // A removed thread may still be asleep or waiting on a descriptor
+  if (it == threads.end()) {
+    return;
+  }
+  it->second.state = State::RUNNABLE;
+  run_queue.push_back(id);
+}
+
+void Scheduler::wake_sleepers() {
+  Clock::time_point now = Clock::now();
+  while (!sleepers.empty() && sleepers.begin()->first <= now) {
+    make_runnable(sleepers.begin()->second);
+    sleepers.erase(sleepers.begin());
+  }
+}
+
+void Scheduler::poll_io(int timeout) {
+  for (AsyncIO::Completion& completion : async_io.wait(timeout)) {
+    complete_io(completion);
+  }
+}
+
+void Scheduler::complete_io(AsyncIO::Completion& completion) {
+  auto it = pending_io.find(completion.thread_id);
+  PendingIO pending = it->second;
+  pending_io.erase(it);
+  if (threads.find(completion.thread_id) == threads.end()) {
+    return;
+  }
+  NodePtr result;
+  if (completion.result < 0) {
+    result = create_node(Boolean(false));
+  } else if (pending.writing) {
+    result = create_unspecified();
+  } else {
+    if (completion.data.size() < pending.size) {
+      pending.port.truncate_file_offset(pending.offset +
+                                        completion.data.size());
+    }
+    result = make_read_result(pending.prefix + completion.data,
+                              pending.prefix.size() + pending.size,
+                              pending.port.is_binary());
+  }
+  // The thread resumes with the result in its accumulator
+  threads.at(completion.thread_id).acc = result;
+  make_runnable(completion.thread_id);
+}
+
+Scheduler::Channel& Scheduler::get_channel(NodePtr handle) {
+  if (handle->get_type() != Data::Type::NUMBER ||
+      handle->get<Number>().get_type() != Number::NumberType::INTEGER) {
+    throw TypeException(10023, "channel: expected a channel handle");
+  }
+  auto it = channels.find(handle->get<Number>().get<Integer>().get_value());
+  if (it == channels.end() ||
+      it->second.buffer->get<Ephemeron>().is_broken()) {
+    throw InvalidInputException(10028, "channel: no such channel");
+  }
+  return it->second;
+}
+
+} // namespace shaka
@@ -0,0 +1,208 @@
+#ifndef SHAKA_SCHEME_SCHEDULER_HPP
+#define SHAKA_SCHEME_SCHEDULER_HPP
+
+#include "shaka_scheme/system/vm/HeapVirtualMachine.hpp"
+#include "shaka_scheme/system/vm/Poller.hpp"
+#include "shaka_scheme/system/vm/AsyncIO.hpp"
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace shaka {
+
+/**
+ * @brief A cooperative scheduler for lightweight (green) threads that share
+ * one HeapVirtualMachine.
+ *
+ * The whole state of a running program is the five VM registers, so a
+ * thread switch saves the registers of the current thread and loads those
+ * of the next one. Threads switch when they yield, sleep, block on a
+ * channel or a file descriptor, or after running for a quantum of
+ * instructions.
+ *
+ * Threads also park on file reads and writes, which an AsyncIO does while
+ * other threads run.
+ *
+ * A channel handle is a heap node. The values buffered in a channel are
+ * held by an ephemeron keyed on the handle, so they are marked only while
+ * the handle is reachable, and the channel is dropped once the collector
+ * has freed its handle.
+ */
+class Scheduler {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @brief Constructs a Scheduler that runs its threads on hvm.
+   * @param hvm The HeapVirtualMachine to run threads on.
+   * @param quantum The number of instructions a thread runs before it is
+   * preempted.
+   * @param use_io_uring false to do file reads and writes on worker threads
+   * even where io_uring is available.
+   */
+  Scheduler(HeapVirtualMachine& hvm, std::size_t quantum = 1000,
+            bool use_io_uring = true);
+
+  /**
+   * @brief Removes the threads and channels from the root set.
+   */
+  ~Scheduler();
+
+  Scheduler(const Scheduler& other) = delete;
+  Scheduler& operator=(const Scheduler& other) = delete;
+
+  /**
+   * @brief Binds the scheduler procedures in an environment:
+   * (spawn thunk), (yield), (sleep ms), (make-channel),
+   * (channel-send ch obj), (channel-receive ch), (wait-readable fd),
+   * (wait-writable fd), (async-read k port) and (async-write obj port).
+   *
+   * async-read reads up to k bytes from an input port, as a string or a
+   * bytevector after the type of the port, and async-write writes a string
+   * or a bytevector to an output port. On a file port, the thread parks
+   * until the transfer is done, and the read gives the end-of-file object
+   * at the end of the file; a failed transfer gives #f. A parked thread
+   * keeps its registers, which hold its continuation, and resumes there
+   * with the result in the accumulator. On other ports, they read and write
+   * at once, as the synchronous procedures do.
+   *
+   * The port reads already bound in env, read-line, read-string, read-u8,
+   * peek-u8, read-bytevector and read-bytevector!, are bound again so that
+   * on a pipe that has less input than they need, the thread waits in the
+   * Poller, as in wait-readable, and applies the read again once the pipe
+   * is readable, instead of blocking every thread. Regular files are always
+   * readable, so reads of them still run at once; async-read is the way to
+   * read them while other threads run.
+   * @param env The environment to define the procedures in.
+   */
+  void define_procedures(EnvPtr env);
+
+  /**
+   * @brief Creates a new runnable thread that applies a procedure of no
+   * arguments.
+   * @param thunk The Closure to apply.
+   * @return The id of the new thread.
+   */
+  std::size_t spawn(NodePtr thunk);
+
+  /**
+   * @brief Runs a compiled expression as the main thread, interleaved with
+   * the other threads, until the main thread halts.
+   * @param main The compiled expression to run.
+   * @return The contents of the accumulator when the main thread halts.
+   * @throws InvalidInputException if every thread is blocked forever.
+   */
+  NodePtr run(Expression main);
+
+  /**
+   * @brief Runs threads until all of them have halted or are blocked
+   * forever on a channel.
+   */
+  void run();
+
+  /**
+   * @brief Gets the number of threads that have not yet halted.
+   * @return The number of live threads.
+   */
+  std::size_t get_thread_count() const;
+
+  /**
+   * @brief Gets the number of channels whose handles have not been
+   * collected.
+   */
+  std::size_t get_channel_count() const;
+
+  /**
+   * @brief Gets the AsyncIO that does the file reads and writes.
+   */
+  const AsyncIO& get_async_io() const;
+
+  /**
+   * @brief Marks the registers and call frames of every thread that is not
+   * running, and the ephemeron of every channel, which marks the buffered
+   * values if the handle is reachable. The Scheduler adds this to the root
+   * set of its thread when it is constructed, so gc::mark() reaches them.
+   */
+  void mark() const;
+
+private:
+  enum class State { RUNNABLE, PARKED };
+
+  // How much input a port read procedure needs before it does not block
+  enum class ReadSize { BYTE, LINE, COUNT, RANGE };
+
+  struct GreenThread {
+    Accumulator acc;
+    Expression exp;
+    EnvPtr env;
+    ValueRib rib;
+    FramePtr frame;
+    NodePtr procedure;
+    std::size_t frame_count;
+    State state;
+  };
+
+  struct Channel {
+    // An ephemeron from the handle to a queue: a pair of the first and the
+    // last pair of the list of buffered values
+    NodePtr buffer;
+    std::deque<std::size_t> receivers;
+  };
+
+  struct PendingIO {
+    Port port;
+    std::uint64_t offset;
+    std::size_t size;
+    // Bytes that were already buffered in the port, ahead of the read
+    std::string prefix;
+    bool writing;
+  };
+
+  void wrap_port_read(EnvPtr env, const std::string& name,
+                      std::size_t port_index, ReadSize size);
+  std::size_t create_thread(GreenThread thread);
+  void remove_thread(std::size_t id);
+  void schedule(bool until_main);
+  void run_slice(std::size_t id);
+  void park_current();
+  void make_runnable(std::size_t id);
+  void wake_sleepers();
+  void poll_io(int timeout);
+  void complete_io(AsyncIO::Completion& completion);
+  Channel& get_channel(NodePtr handle);
+
+  HeapVirtualMachine& hvm;
+  std::size_t quantum;
+
+  std::unordered_map<std::size_t, GreenThread> threads;
+  std::deque<std::size_t> run_queue;
+  std::multimap<Clock::time_point, std::size_t> sleepers;
+  std::unordered_map<int, Channel> channels;
+  Poller poller;
+  AsyncIO async_io;
+  std::unordered_map<std::size_t, PendingIO> pending_io;
+  std::size_t io_countdown;
+  int next_channel;
+
+  std::size_t next_id;
+  std::size_t current;
+  bool running;
+  bool switch_requested;
+  // A port read that parked before reading, with its arguments, which the
+  // thread applies again when it is woken up
+  NodePtr retry_procedure;
+  ValueRib retry_arguments;
+  std::size_t main_thread;
+  bool main_halted;
+  // The accumulator of the main thread when it halted
+  NodePtr main_result;
+  // The id of mark() in the root set
+  std::size_t root_set;
+};
+
+} // namespace shaka
+
+#endif //SHAKA_SCHEME_SCHEDULER_HPP
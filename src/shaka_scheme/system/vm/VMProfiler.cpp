@@ -0,0 +1,262 @@
+#include "shaka_scheme/system/vm/VMProfiler.hpp"
+#include "shaka_scheme/system/vm/HeapVirtualMachine.hpp"
+#include "shaka_scheme/system/base/Symbol.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define SHAKA_SCHEME_VMPROFILER_RDTSC
+#else
+#include <time.h>
+#endif
+
+namespace shaka {
+
+namespace {
+
+const char* const opcode_names[VMProfiler::OPCODE_COUNT] = {
+    "halt", "refer", "constant", "close", "test", "assign", "define",
+    "conti", "conti1", "reset", "shift", "nuate", "frame", "argument",
+    "apply", "return", "(other)"
+};
+
+/**
+ * @brief The totals of the profilers of every thread, written out when the
+ * process exits.
+ */
+class ProcessProfile {
+public:
+  explicit ProcessProfile(const std::string& path) :
+      path(path) {}
+
+  ~ProcessProfile() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (path.empty() || path == "-") {
+      totals.write_report(std::cerr);
+      return;
+    }
+    std::ofstream out(path.c_str());
+    if (out) {
+      totals.write_report(out);
+    } else {
+      std::cerr << "VMProfiler: could not write " << path << std::endl;
+    }
+  }
+
+  void add(const VMProfiler& profiler) {
+    std::lock_guard<std::mutex> lock(mutex);
+    totals.merge(profiler);
+  }
+
+private:
+  std::string path;
+  std::mutex mutex;
+  VMProfiler totals;
+};
+
+ProcessProfile& get_process_profile() {
+  const char* path = std::getenv("SHAKA_SCHEME_VM_PROFILE");
+  static ProcessProfile profile(path != nullptr ? path : "");
+  return profile;
+}
+
+/**
+ * @brief The profiler of one thread, added to the process totals when the
+ * thread exits.
+ */
+class ThreadProfile {
+public:
+  // Made after the process totals, so that they are still there when this
+  // is destroyed
+  ThreadProfile() :
+      process(get_process_profile()) {}
+
+  ~ThreadProfile() {
+    process.add(profiler);
+  }
+
+  ProcessProfile& process;
+  VMProfiler profiler;
+};
+
+} // namespace
+
+VMProfiler::VMProfiler() {
+  reset();
+}
+
+void VMProfiler::evaluate(HeapVirtualMachine& hvm) {
+  Opcode opcode = get_opcode(hvm);
+  ++counts[opcode];
+  if (previous != OPCODE_COUNT) {
+    ++pairs[previous][opcode];
+  }
+  previous = opcode == HALT ? OPCODE_COUNT : opcode;
+
+  std::uint64_t start = read_clock();
+  hvm.evaluate_assembly_instruction();
+  ticks[opcode] += read_clock() - start;
+}
+
+std::uint64_t VMProfiler::get_count(Opcode opcode) const {
+  return counts[opcode];
+}
+
+std::uint64_t VMProfiler::get_ticks(Opcode opcode) const {
+  return ticks[opcode];
+}
+
+std::uint64_t VMProfiler::get_pair_count(Opcode first, Opcode second) const {
+  return pairs[first][second];
+}
+
+void VMProfiler::merge(const VMProfiler& other) {
+  for (std::size_t i = 0; i < OPCODE_COUNT; ++i) {
+    counts[i] += other.counts[i];
+    ticks[i] += other.ticks[i];
+    for (std::size_t j = 0; j < OPCODE_COUNT; ++j) {
+      pairs[i][j] += other.pairs[i][j];
+    }
+  }
+}
+
+void VMProfiler::reset() {
+  std::memset(counts, 0, sizeof(counts));
+  std::memset(ticks, 0, sizeof(ticks));
+  std::memset(pairs, 0, sizeof(pairs));
+  previous = OPCODE_COUNT;
+}
+
+void VMProfiler::write_report(std::ostream& out,
+                              std::size_t pair_limit) const {
+  std::uint64_t total_count = 0;
+  std::uint64_t total_ticks = 0;
+  std::vector<Opcode> opcodes;
+  for (std::size_t i = 0; i < OPCODE_COUNT; ++i) {
+    total_count += counts[i];
+    total_ticks += ticks[i];
+    if (counts[i] != 0) {
+      opcodes.push_back(static_cast<Opcode>(i));
+    }
+  }
+  // Where the time goes first
+  std::sort(opcodes.begin(), opcodes.end(), [this](Opcode a, Opcode b) {
+    return ticks[a] > ticks[b];
+  });
+
+  std::ios::fmtflags flags = out.flags();
+  out << std::fixed << std::setprecision(1);
+  out << "VM instruction profile (" << total_count << " instructions, "
+      << total_ticks << " " << get_clock_unit() << ")\n";
+  out << std::left << std::setw(10) << "opcode" << std::right
+      << std::setw(14) << "count" << std::setw(8) << "%"
+      << std::setw(16) << get_clock_unit() << std::setw(8) << "%"
+      << std::setw(12) << "per op" << "\n";
+  for (Opcode opcode : opcodes) {
+    out << std::left << std::setw(10) << get_name(opcode) << std::right
+        << std::setw(14) << counts[opcode]
+        << std::setw(8) << 100.0 * counts[opcode] / total_count
+        << std::setw(16) << ticks[opcode]
+        << std::setw(8) << (total_ticks == 0 ? 0.0 :
+                            100.0 * ticks[opcode] / total_ticks)
+        << std::setw(12) << static_cast<double>(ticks[opcode]) /
+                            counts[opcode]
+        << "\n";
+  }
+
+  std::vector<std::tuple<std::uint64_t, Opcode, Opcode>> frequent;
+  std::uint64_t total_pairs = 0;
+  for (std::size_t i = 0; i < OPCODE_COUNT; ++i) {
+    for (std::size_t j = 0; j < OPCODE_COUNT; ++j) {
+      if (pairs[i][j] != 0) {
+        total_pairs += pairs[i][j];
+        frequent.push_back(std::make_tuple(pairs[i][j],
+                                           static_cast<Opcode>(i),
+                                           static_cast<Opcode>(j)));
+      }
+    }
+  }
+  std::sort(frequent.begin(), frequent.end(),
+            [](const std::tuple<std::uint64_t, Opcode, Opcode>& a,
+               const std::tuple<std::uint64_t, Opcode, Opcode>& b) {
+    return std::get<0>(a) > std::get<0>(b);
+  });
+  if (frequent.size() > pair_limit) {
+    frequent.resize(pair_limit);
+  }
+  out << "\nMost frequent instruction pairs\n";
+  out << std::left << std::setw(22) << "first -> second" << std::right
+      << std::setw(14) << "count" << std::setw(8) << "%" << "\n";
+  for (const std::tuple<std::uint64_t, Opcode, Opcode>& pair : frequent) {
+    std::string name = std::string(get_name(std::get<1>(pair))) + " -> " +
+        get_name(std::get<2>(pair));
+    out << std::left << std::setw(22) << name << std::right
+        << std::setw(14) << std::get<0>(pair)
+        << std::setw(8) << 100.0 * std::get<0>(pair) / total_pairs << "\n";
+  }
+  out.flags(flags);
+}
+
+const char* VMProfiler::get_name(Opcode opcode) {
+  return opcode_names[opcode];
+}
+
+std::uint64_t VMProfiler::read_clock() {
+#ifdef SHAKA_SCHEME_VMPROFILER_RDTSC
+  return __rdtsc();
+#else
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<std::uint64_t>(now.tv_sec) * 1000000000u +
+      static_cast<std::uint64_t>(now.tv_nsec);
+#endif
+}
+
+const char* VMProfiler::get_clock_unit() {
+#ifdef SHAKA_SCHEME_VMPROFILER_RDTSC
+  return "cycles";
+#else
+  return "ns";
+#endif
+}
+
+VMProfiler* VMProfiler::get_thread_profiler() {
+  static const bool enabled = std::getenv("SHAKA_SCHEME_VM_PROFILE") != nullptr;
+  if (!enabled) {
+    return nullptr;
+  }
+  thread_local ThreadProfile profile;
+  return &profile.profiler;
+}
+
+VMProfiler::Opcode VMProfiler::get_opcode(HeapVirtualMachine& hvm) {
+  static const Symbol names[OTHER] = {
+      Symbol("halt"), Symbol("refer"), Symbol("constant"), Symbol("close"),
+      Symbol("test"), Symbol("assign"), Symbol("define"), Symbol("conti"),
+      Symbol("conti1"), Symbol("reset"), Symbol("shift"), Symbol("nuate"),
+      Symbol("frame"), Symbol("argument"), Symbol("apply"), Symbol("return")
+  };
+  NodePtr instruction = hvm.get_expression()->get<DataPair>().car();
+  if (instruction->get_type() != Data::Type::SYMBOL) {
+    return OTHER;
+  }
+  const Symbol& name = instruction->get<Symbol>();
+  for (std::size_t i = 0; i < OTHER; ++i) {
+    if (name == names[i]) {
+      return static_cast<Opcode>(i);
+    }
+  }
+  return OTHER;
+}
+
+} // namespace shaka
@@ -0,0 +1,129 @@
+#ifndef SHAKA_SCHEME_VMPROFILER_HPP
+#define SHAKA_SCHEME_VMPROFILER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+namespace shaka {
+
+class HeapVirtualMachine;
+
+/**
+ * @brief Counts and times the instructions that a HeapVirtualMachine
+ * evaluates, and how often each instruction follows each other one.
+ *
+ * Attach one with HeapVirtualMachine::set_profiler(). A VM with no
+ * profiler attached runs its original loop, so profiling costs nothing
+ * unless it is used.
+ *
+ * Setting the environment variable SHAKA_SCHEME_VM_PROFILE profiles every
+ * VM of the process instead: each thread gets its own profiler, and the
+ * totals of all of them are written out when the process exits, to the
+ * file the variable names, or to standard error if it is empty or "-".
+ *
+ * Time is measured with the time stamp counter on x86, in cycles, and with
+ * the monotonic clock elsewhere, in nanoseconds.
+ */
+class VMProfiler {
+public:
+  enum Opcode {
+    HALT,
+    REFER,
+    CONSTANT,
+    CLOSE,
+    TEST,
+    ASSIGN,
+    DEFINE,
+    CONTI,
+    CONTI1,
+    RESET,
+    SHIFT,
+    NUATE,
+    FRAME,
+    ARGUMENT,
+    APPLY,
+    RETURN,
+    // Anything that is not an instruction the VM knows
+    OTHER,
+    OPCODE_COUNT
+  };
+
+  /**
+   * @brief Constructs a VMProfiler with all counts at 0.
+   */
+  VMProfiler();
+
+  /**
+   * @brief Evaluates the next instruction of hvm, counting and timing it.
+   */
+  void evaluate(HeapVirtualMachine& hvm);
+
+  /**
+   * @brief Gets how many times an instruction was evaluated.
+   */
+  std::uint64_t get_count(Opcode opcode) const;
+
+  /**
+   * @brief Gets the time spent evaluating an instruction, in the units of
+   * read_clock().
+   */
+  std::uint64_t get_ticks(Opcode opcode) const;
+
+  /**
+   * @brief Gets how many times second was evaluated right after first.
+   */
+  std::uint64_t get_pair_count(Opcode first, Opcode second) const;
+
+  /**
+   * @brief Adds the counts and times of another profiler to this one.
+   */
+  void merge(const VMProfiler& other);
+
+  /**
+   * @brief Sets every count and time back to 0.
+   */
+  void reset();
+
+  /**
+   * @brief Writes a table of the counts and times of every instruction
+   * that was evaluated, then the most frequent instruction pairs.
+   * @param pair_limit The number of pairs to list
+   */
+  void write_report(std::ostream& out, std::size_t pair_limit = 20) const;
+
+  /**
+   * @brief Gets the name of an instruction, as in compiled code.
+   */
+  static const char* get_name(Opcode opcode);
+
+  /**
+   * @brief Reads the clock that instructions are timed with.
+   */
+  static std::uint64_t read_clock();
+
+  /**
+   * @brief Gets the unit of read_clock(), "cycles" or "ns".
+   */
+  static const char* get_clock_unit();
+
+  /**
+   * @brief Gets the profiler of the calling thread if SHAKA_SCHEME_VM_PROFILE
+   * is set, which new HeapVirtualMachines attach to.
+   * @return The profiler, or nullptr if profiling is not enabled
+   */
+  static VMProfiler* get_thread_profiler();
+
+private:
+  static Opcode get_opcode(HeapVirtualMachine& hvm);
+
+  std::uint64_t counts[OPCODE_COUNT];
+  std::uint64_t ticks[OPCODE_COUNT];
+  std::uint64_t pairs[OPCODE_COUNT][OPCODE_COUNT];
+  // The instruction evaluated last, or OPCODE_COUNT at the start of a run
+  Opcode previous;
+};
+
+} // namespace shaka
+
+#endif //SHAKA_SCHEME_VMPROFILER_HPP
@@ -0,0 +1,157 @@
+#include "shaka_scheme/system/vm/WorkStealingPool.hpp"
+
+#include <chrono>
+
+namespace shaka {
+
+namespace {
+
+// The index of the worker that owns the calling thread, or -1 if the
+// calling thread is not a worker of any pool
+thread_local std::size_t worker_index = static_cast<std::size_t>(-1);
+
+} // namespace
+
+WorkStealingPool::WorkStealingPool(std::size_t thread_count) :
+    queued(0),
+    next_worker(0),
+    stopping(false) {
+  if (thread_count == 0) {
+    thread_count = 1;
+  }
+  for (std::size_t i = 0; i < thread_count; ++i) {
+    workers.push_back(std::unique_ptr<Worker>(new Worker()));
+  }
+  for (std::size_t i = 0; i < thread_count; ++i) {
+    threads.push_back(std::thread(&WorkStealingPool::worker_loop, this, i));
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  available.notify_all();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+void WorkStealingPool::submit(Task task) {
+  std::size_t target;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    target = next_worker++ % workers.size();
+    ++queued;
+  }
+  {
+    std::lock_guard<std::mutex> lock(workers[target]->mutex);
+    workers[target]->tasks.push_back(std::move(task));
+  }
+  available.notify_one();
+}
+
+void WorkStealingPool::run_all(std::vector<Task> tasks) {
+  struct Batch {
+    std::mutex mutex;
+    std::condition_variable done;
+    std::size_t remaining;
+    std::exception_ptr error;
+  };
+  auto batch = std::make_shared<Batch>();
+  batch->remaining = tasks.size();
+
+  for (auto& task : tasks) {
+    Task body = std::move(task);
+    submit([batch, body]() {
+      std::exception_ptr error;
+      try {
+        body();
+      } catch (...) {
+        error = std::current_exception();
+      }
+      std::lock_guard<std::mutex> lock(batch->mutex);
+      if (error && !batch->error) {
+        batch->error = error;
+      }
+      if (--batch->remaining == 0) {
+        batch->done.notify_all();
+      }
+    });
+  }
+
+  // Help with queued work while waiting, so nested batches make progress
+  std::unique_lock<std::mutex> lock(batch->mutex);
+  while (batch->remaining != 0) {
+    lock.unlock();
+    bool ran = run_pending_task();
+    lock.lock();
+    if (!ran && batch->remaining != 0) {
+      batch->done.wait_for(lock, std::chrono::milliseconds(1));
+    }
+  }
+  if (batch->error) {
+    std::rethrow_exception(batch->error);
+  }
+}
+
+bool WorkStealingPool::run_pending_task() {
+  Task task;
+  std::size_t self = worker_index < workers.size() ? worker_index : 0;
+  if (!try_take(self, task)) {
+    return false;
+  }
+  try {
+    task();
+  } catch (...) {
+  }
+  return true;
+}
+
+std::size_t WorkStealingPool::get_thread_count() const {
+  return threads.size();
+}
+
+WorkStealingPool& WorkStealingPool::get_default() {
+  static WorkStealingPool pool(std::thread::hardware_concurrency());
+  return pool;
+}
+
+bool WorkStealingPool::try_take(std::size_t self, Task& task) {
+  // Take the newest task from our own deque, steal the oldest from others
+  for (std::size_t k = 0; k < workers.size(); ++k) {
+    Worker& worker = *workers[(self + k) % workers.size()];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.tasks.empty()) {
+      continue;
+    }
+    if (k == 0) {
+      task = std::move(worker.tasks.back());
+      worker.tasks.pop_back();
+    } else {
+      task = std::move(worker.tasks.front());
+      worker.tasks.pop_front();
+    }
+    std::lock_guard<std::mutex> count_lock(mutex);
+    --queued;
+    return true;
+  }
+  return false;
+}
+
+void WorkStealingPool::worker_loop(std::size_t self) {
+  worker_index = self;
+  for (;;) {
+    if (run_pending_task()) {
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    available.wait(lock, [this] { return stopping || queued != 0; });
+    if (stopping && queued == 0) {
+      return;
+    }
+  }
+}
+
+} // namespace shaka
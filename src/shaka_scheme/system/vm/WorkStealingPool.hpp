@@ -0,0 +1,100 @@
+#ifndef SHAKA_SCHEME_WORK_STEALING_POOL_HPP
+#define SHAKA_SCHEME_WORK_STEALING_POOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace shaka {
+
+/**
+ * @brief A fixed set of OS threads that run tasks from per-thread deques.
+ *
+ * A worker takes the newest task from its own deque and, when that is
+ * empty, steals the oldest task from the deque of another worker. A thread that
+ * waits for a batch of tasks runs queued tasks itself instead of blocking,
+ * so a task may submit and wait for a nested batch without deadlocking the
+ * pool.
+ *
+ * @note Tasks that allocate Data must bind create_node to a heap of their
+ * own, for example with gc::HeapScope.
+ */
+class WorkStealingPool {
+public:
+  using Task = std::function<void()>;
+
+  /**
+   * @brief Starts the worker threads.
+   * @param thread_count The number of workers, at least one.
+   */
+  explicit WorkStealingPool(std::size_t thread_count);
+
+  /**
+   * @brief Runs the remaining tasks, then stops and joins the workers.
+   */
+  ~WorkStealingPool();
+
+  WorkStealingPool(const WorkStealingPool& other) = delete;
+  WorkStealingPool& operator=(const WorkStealingPool& other) = delete;
+
+  /**
+   * @brief Queues a task on the next worker in round-robin order.
+   * @param task The task to run. Exceptions it throws are discarded.
+   */
+  void submit(Task task);
+
+  /**
+   * @brief Runs a batch of tasks on the pool and waits for all of them.
+   * @param tasks The tasks to run.
+   * @throws The first exception thrown by any of the tasks, after every
+   * task of the batch has finished.
+   */
+  void run_all(std::vector<Task> tasks);
+
+  /**
+   * @brief Runs one queued task on the calling thread, if there is one.
+   * Exceptions thrown by the task are discarded.
+   * @return true if a task was run.
+   */
+  bool run_pending_task();
+
+  /**
+   * @brief Gets the number of worker threads.
+   * @return The number of workers.
+   */
+  std::size_t get_thread_count() const;
+
+  /**
+   * @brief Gets the process-wide pool, with one worker per hardware thread.
+   * @return The shared pool, started on first use.
+   */
+  static WorkStealingPool& get_default();
+
+private:
+  struct Worker {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  bool try_take(std::size_t self, Task& task);
+  void worker_loop(std::size_t self);
+
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::vector<std::thread> threads;
+
+  std::mutex mutex;
+  std::condition_variable available;
+  std::size_t queued;
+  std::size_t next_worker;
+  bool stopping;
+};
+
+} // namespace shaka
+
+#endif //SHAKA_SCHEME_WORK_STEALING_POOL_HPP
@@ -0,0 +1,157 @@
+#include "shaka_scheme/system/vm/compiler/CodeCache.hpp"
+#include "shaka_scheme/system/parser/parser_definitions.hpp"
+#include "shaka_scheme/system/parser/syntax_rules/macro_engine.hpp"
+#include "shaka_scheme/system/serialization/fasl.hpp"
+#include "shaka_scheme/system/serialization/files.hpp"
+
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+
+#include <sys/stat.h>
+
+namespace shaka {
+
+namespace {
+
+/**
+ * @brief Changes whenever the compiled code or the entry layout changes, so
+ * that old entries stop matching.
+ */
+const char* const cache_format = "shaka-code-cache-1";
+
+std::uint64_t fnv1a(const std::string& bytes) {
+  std::uint64_t hash = 14695981039346656037ULL;
+  for (char c : bytes) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+/**
+ * @brief A second hash, unrelated to fnv1a, to tell colliding sources apart.
+ */
+std::uint64_t check_hash(const std::string& bytes) {
+  std::uint64_t hash = 0x243f6a8885a308d3ULL ^ bytes.size();
+  for (char c : bytes) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * 0x9e3779b97f4a7c15ULL;
+    hash ^= hash >> 29;
+  }
+  return hash;
+}
+
+std::string to_hex(std::uint64_t value) {
+  std::ostringstream out;
+  out << std::hex << std::setw(16) << std::setfill('0') << value;
+  return out.str();
+}
+
+} // namespace
+
+std::vector<Expression> compile_source(const std::string& source,
+                                       HeapVirtualMachine& hvm) {
+  parser::ParserInput input(source);
+  Compiler compiler;
+  std::vector<Expression> compiled;
+  while (true) {
+    lexer::LexResult next = input.peek();
+    if (next.is_incomplete()) {
+      break;
+    }
+    parser::ParserResult result = parser::parse_datum(input);
+    if (!result.is_complete()) {
+      std::ostringstream message;
+      message << "compile: " << result;
+      throw InvalidInputException(10072, message.str());
+    }
+    Expression expression = result.it;
+    macro::MacroContext macro_context(hvm);
+    macro::run_macro_expansion(expression, macro_context);
+    compiled.push_back(compiler.compile(expression));
+  }
+  return compiled;
+}
+
+CodeCache::CodeCache(const std::string& directory,
+                     const std::string& macro_version) :
+    directory(directory),
+    macro_version(macro_version),
+    hits(0),
+    misses(0) {
+  ::mkdir(directory.c_str(), 0777);
+}
+
+std::vector<Expression> CodeCache::compile(const std::string& source,
+                                           HeapVirtualMachine& hvm) {
+  std::vector<Expression> compiled;
+  if (load(source, compiled)) {
+    ++hits;
+    return compiled;
+  }
+  ++misses;
+  compiled = compile_source(source, hvm);
+  store(source, compiled);
+  return compiled;
+}
+
+std::string CodeCache::get_entry_path(const std::string& source) const {
+  std::string key = std::string(cache_format) + '\0' + macro_version + '\0';
+  return directory + "/" + to_hex(fnv1a(key + source)) + ".fasl";
+}
+
+std::size_t CodeCache::get_hits() const {
+  return hits;
+}
+
+std::size_t CodeCache::get_misses() const {
+  return misses;
+}
+
+bool CodeCache::load(const std::string& source,
+                     std::vector<Expression>& compiled) {
+  std::string bytes;
+  if (!serialization::read_file(get_entry_path(source), bytes)) {
+    return false;
+  }
+  try {
+    std::istringstream in(bytes);
+    fasl::Reader reader(in);
+    NodePtr datum;
+    if (!reader.read(datum) || datum->get_type() != Data::Type::STRING ||
+        datum->get<String>().get_string() != make_header(source)) {
+      return false;
+    }
+    while (reader.read(datum)) {
+      compiled.push_back(datum);
+    }
+  } catch (const InvalidInputException&) {
+    // A corrupted entry is recompiled and overwritten
+    compiled.clear();
+    return false;
+  }
+  return true;
+}
+
+void CodeCache::store(const std::string& source,
+                      const std::vector<Expression>& compiled) {
+  std::ostringstream out;
+  try {
+    fasl::Writer writer(out);
+    writer.write(create_node(String(make_header(source))));
+    for (const Expression& expression : compiled) {
+      writer.write(expression);
+    }
+  } catch (const InvalidInputException&) {
+    // The code holds a constant FASL cannot write, so it is not cached
+    return;
+  }
+  serialization::write_file_atomically(get_entry_path(source), out.str());
+}
+
+std::string CodeCache::make_header(const std::string& source) const {
+  return std::string(cache_format) + "\n" + macro_version + "\n" +
+      std::to_string(source.size()) + "\n" + to_hex(check_hash(source));
+}
+
+} // namespace shaka
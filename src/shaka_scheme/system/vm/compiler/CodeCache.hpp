@@ -0,0 +1,87 @@
+#ifndef SHAKA_SCHEME_CODECACHE_HPP
+#define SHAKA_SCHEME_CODECACHE_HPP
+
+#include "shaka_scheme/system/vm/compiler/Compiler.hpp"
+#include "shaka_scheme/system/vm/HeapVirtualMachine.hpp"
+#include "shaka_scheme/system/exceptions/InvalidInputException.hpp"
+
+#include <string>
+#include <vector>
+
+namespace shaka {
+
+/**
+ * @brief Lexes, parses, macro expands and compiles every datum of a source
+ * text, in order, the way the REPL does for each line.
+ * @param source The source text
+ * @param hvm The VM whose environment the macro expander looks at
+ * @return The compiled expressions, each ending in (halt)
+ * @throws InvalidInputException if the source does not parse
+ */
+std::vector<Expression> compile_source(const std::string& source,
+                                       HeapVirtualMachine& hvm);
+
+/**
+ * @brief An on-disk cache of compiled source texts.
+ *
+ * An entry holds the compiled expressions of one source text, in the FASL
+ * format, in a file named after a hash of the source, the macro version and
+ * the format of the cache. The entry also records the macro version, the
+ * length of the source and a second, independent hash of it, which are
+ * checked on every hit, so a stale or colliding entry is recompiled
+ * instead of used. Entries are written atomically, so concurrent processes
+ * can share a cache directory.
+ *
+ * Failing to write an entry is not an error: the compiled code is still
+ * returned, and the next load compiles again.
+ */
+class CodeCache {
+public:
+  /**
+   * @brief Uses directory for the entries, creating it if needed.
+   * @param directory The cache directory
+   * @param macro_version Identifies the macros the code is expanded with;
+   * entries made under another version are never used. The caller must
+   * change it whenever the macro environment changes, since the cache
+   * cannot tell.
+   */
+  CodeCache(const std::string& directory, const std::string& macro_version);
+
+  /**
+   * @brief Gets the compiled expressions of source from the cache, or
+   * compiles them with compile_source and stores them.
+   * @see compile_source
+   */
+  std::vector<Expression> compile(const std::string& source,
+                                  HeapVirtualMachine& hvm);
+
+  /**
+   * @brief Gets the path of the entry that would hold source.
+   */
+  std::string get_entry_path(const std::string& source) const;
+
+  /**
+   * @brief Gets the number of calls to compile served from the cache.
+   */
+  std::size_t get_hits() const;
+
+  /**
+   * @brief Gets the number of calls to compile that had to compile.
+   */
+  std::size_t get_misses() const;
+
+private:
+  bool load(const std::string& source, std::vector<Expression>& compiled);
+  void store(const std::string& source,
+             const std::vector<Expression>& compiled);
+  std::string make_header(const std::string& source) const;
+
+  std::string directory;
+  std::string macro_version;
+  std::size_t hits;
+  std::size_t misses;
+};
+
+} // namespace shaka
+
+#endif //SHAKA_SCHEME_CODECACHE_HPP
@@ -90,11 +90,24 @@ next_instruction) {
       return compile(x,list(create_node(instruction_data),
                             var,next_instruction));
     }
-      // call/cc case
-        else if (expression_type == Symbol("call/cc")) {
+      // call/cc, call/1cc and shift case
+        else if (expression_type == Symbol("call/cc") ||
+        expression_type == Symbol("call/1cc") ||
+        expression_type == Symbol("shift")) {
       Symbol conti_instruction("conti");
+      if (expression_type == Symbol("call/1cc")) {
+        conti_instruction = Symbol("conti1");
+      }
       Expression conti_op = create_node(Data(conti_instruction));
 
+      // (shift k body ...) receives k through (lambda (k) body ...)
+      Expression receiver = car(cdr(input));
+      if (expression_type == Symbol("shift")) {
+        conti_op = create_node(Data(Symbol("shift")));
+        receiver = cons(create_node(Data(Symbol("lambda"))),
+                        cons(list(car(cdr(input))), cdr(cdr(input))));
+      }
+
       Symbol argument_instruction("argument");
       Expression argument_op = create_node(Data(argument_instruction));
 
@@ -102,7 +115,7 @@ next_instruction) {
       Expression apply_op = create_node(Data(apply_instruction));
 
       Expression c = list(conti_op, list(argument_op,
-                                         compile(car(cdr(input)),
+                                         compile(receiver,
                                                  list(apply_op))));
       if (is_tail(next_instruction)) {
         return c;
@@ -111,6 +124,14 @@ next_instruction) {
         Data frame_op(Symbol("frame"));
         return list(create_node(frame_op), next_instruction, c);
       }
+    }
+      // (reset body ...) case
+    else if (expression_type == Symbol("reset")) {
+      Data reset_op(Symbol("reset"));
+      Data return_op(Symbol("return"));
+
+      return list(create_node(reset_op), next_instruction,
+                  compile_lambda(cdr(input), list(create_node(return_op))));
     }
       // application
     else {
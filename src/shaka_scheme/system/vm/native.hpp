@@ -0,0 +1,354 @@
+#ifndef SHAKA_SCHEME_NATIVE_HPP
+#define SHAKA_SCHEME_NATIVE_HPP
+
+#include "shaka_scheme/system/base/Data.hpp"
+#include "shaka_scheme/system/gc/make_node.hpp"
+#include "shaka_scheme/system/exceptions/TypeException.hpp"
+#include "shaka_scheme/system/exceptions/InvalidInputException.hpp"
+
+#include <deque>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+namespace shaka {
+namespace native {
+
+/**
+ * @brief Converts an argument NodePtr to the C++ type T of a parameter of a
+ * typed native procedure. Every specialization has:
+ * - check(node), whether node can be converted;
+ * - unbox(node), the conversion, for a node that passed check. Compound
+ *   types such as String or Vector are returned by reference into the
+ *   node, so a const String& parameter is not copied;
+ * - name, what the error message says was expected.
+ *
+ * Supported are NodePtr, bool, the integral and floating point types,
+ * std::string, Number, String, Symbol, Vector and Bytevector.
+ */
+template <typename T, typename Enable = void>
+struct ArgumentTraits;
+
+template <>
+struct ArgumentTraits<NodePtr> {
+  static bool check(NodePtr) { return true; }
+  static NodePtr unbox(NodePtr node) { return node; }
+  static const char* name() { return "an object"; }
+};
+
+template <>
+struct ArgumentTraits<bool> {
+  static bool check(NodePtr node) {
+    return node->get_type() == Data::Type::BOOLEAN;
+  }
+  static bool unbox(NodePtr node) {
+    return node->get<Boolean>().get_value();
+  }
+  static const char* name() { return "a boolean"; }
+};
+
+template <typename T>
+struct ArgumentTraits<T, typename std::enable_if<
+    std::is_integral<T>::value && !std::is_same<T, bool>::value>::type> {
+  static bool check(NodePtr node) {
+    if (node->get_type() != Data::Type::NUMBER ||
+        node->get<Number>().get_type() != Number::NumberType::INTEGER) {
+      return false;
+    }
+    int value = node->get<Number>().get<Integer>().get_value();
+    if (std::is_unsigned<T>::value) {
+      return value >= 0 && static_cast<unsigned long long>(value) <=
+          static_cast<unsigned long long>(std::numeric_limits<T>::max());
+    }
+    return static_cast<long long>(value) >=
+        static_cast<long long>(std::numeric_limits<T>::min()) &&
+        static_cast<long long>(value) <=
+            static_cast<long long>(std::numeric_limits<T>::max());
+  }
+  static T unbox(NodePtr node) {
+    return static_cast<T>(node->get<Number>().get<Integer>().get_value());
+  }
+  static const char* name() { return "an integer in range"; }
+};
+
+template <typename T>
+struct ArgumentTraits<T, typename std::enable_if<
+    std::is_floating_point<T>::value>::type> {
+  static bool check(NodePtr node) {
+    return node->get_type() == Data::Type::NUMBER;
+  }
+  static T unbox(NodePtr node) {
+    const Number& number = node->get<Number>();
+    switch (number.get_type()) {
+    case Number::NumberType::INTEGER:
+      return static_cast<T>(number.get<Integer>().get_value());
+    case Number::NumberType::RATIONAL: {
+      Rational rational = number.get<Rational>();
+      return static_cast<T>(rational.get_numerator()) /
+          static_cast<T>(rational.get_denominator());
+    }
+    default:
+      return static_cast<T>(number.get<Real>().get_value());
+    }
+  }
+  static const char* name() { return "a number"; }
+};
+
+template <>
+struct ArgumentTraits<std::string> {
+  static bool check(NodePtr node) {
+    return node->get_type() == Data::Type::STRING;
+  }
+  static std::string unbox(NodePtr node) {
+    return node->get<String>().get_string();
+  }
+  static const char* name() { return "a string"; }
+};
+
+/**
+ * @brief The types that are unboxed by reference into the node.
+ */
+template <typename T, Data::Type type>
+struct ReferenceTraits {
+  static bool check(NodePtr node) {
+    return node->get_type() == type;
+  }
+  static T& unbox(NodePtr node) {
+    return node->get<T>();
+  }
+};
+
+template <>
+struct ArgumentTraits<Number> :
+    ReferenceTraits<Number, Data::Type::NUMBER> {
+  static const char* name() { return "a number"; }
+};
+
+template <>
+struct ArgumentTraits<String> :
+    ReferenceTraits<String, Data::Type::STRING> {
+  static const char* name() { return "a string"; }
+};
+
+template <>
+struct ArgumentTraits<Symbol> :
+    ReferenceTraits<Symbol, Data::Type::SYMBOL> {
+  static const char* name() { return "a symbol"; }
+};
+
+template <>
+struct ArgumentTraits<Vector> :
+    ReferenceTraits<Vector, Data::Type::VECTOR> {
+  static const char* name() { return "a vector"; }
+};
+
+template <>
+struct ArgumentTraits<Bytevector> :
+    ReferenceTraits<Bytevector, Data::Type::BYTEVECTOR> {
+  static const char* name() { return "a bytevector"; }
+};
+
+/**
+ * @brief Converts the C++ result of a typed native procedure to a NodePtr.
+ * Integral results must fit in an Integer, and void results become the
+ * unspecified value.
+ */
+template <typename T, typename Enable = void>
+struct ResultTraits {
+  static NodePtr box(const T& value, const std::string&) {
+    return make_node(value);
+  }
+};
+
+template <>
+struct ResultTraits<NodePtr> {
+  static NodePtr box(NodePtr value, const std::string&) {
+    return value;
+  }
+};
+
+template <>
+struct ResultTraits<bool> {
+  static NodePtr box(bool value, const std::string&) {
+    return make_boolean(value);
+  }
+};
+
+template <typename T>
+struct ResultTraits<T, typename std::enable_if<
+    std::is_integral<T>::value && !std::is_same<T, bool>::value>::type> {
+  static NodePtr box(T value, const std::string& name) {
+    bool fits = std::is_unsigned<T>::value ?
+        static_cast<unsigned long long>(value) <=
+            static_cast<unsigned long long>(std::numeric_limits<int>::max()) :
+        static_cast<long long>(value) >=
+            static_cast<long long>(std::numeric_limits<int>::min()) &&
+        static_cast<long long>(value) <=
+            static_cast<long long>(std::numeric_limits<int>::max());
+    if (!fits) {
+      throw InvalidInputException(10065,
+                                  name + ": result does not fit an integer");
+    }
+    return make_number(static_cast<int>(value));
+  }
+};
+
+template <typename T>
+struct ResultTraits<T, typename std::enable_if<
+    std::is_floating_point<T>::value>::type> {
+  static NodePtr box(T value, const std::string&) {
+    return make_number(static_cast<double>(value));
+  }
+};
+
+template <>
+struct ResultTraits<std::string> {
+  static NodePtr box(const std::string& value, const std::string&) {
+    return make_node(String(value));
+  }
+};
+
+/**
+ * @brief Deduces the result and parameter types of a function pointer or a
+ * function object with one operator().
+ */
+template <typename F>
+struct FunctionTraits :
+    FunctionTraits<decltype(&F::operator())> {};
+
+template <typename R, typename... A>
+struct FunctionTraits<R (*)(A...)> {
+  using Result = R;
+  static const std::size_t arity = sizeof...(A);
+  template <std::size_t I>
+  using Parameter = typename std::decay<
+      typename std::tuple_element<I, std::tuple<A...>>::type>::type;
+};
+
+template <typename R, typename... A>
+struct FunctionTraits<R (&)(A...)> : FunctionTraits<R (*)(A...)> {};
+
+template <typename R, typename... A>
+struct FunctionTraits<R (A...)> : FunctionTraits<R (*)(A...)> {};
+
+template <typename C, typename R, typename... A>
+struct FunctionTraits<R (C::*)(A...)> : FunctionTraits<R (*)(A...)> {};
+
+template <typename C, typename R, typename... A>
+struct FunctionTraits<R (C::*)(A...) const> : FunctionTraits<R (*)(A...)> {};
+
+template <std::size_t... I>
+struct Indices {};
+
+template <std::size_t N, std::size_t... I>
+struct MakeIndices : MakeIndices<N - 1, N - 1, I...> {};
+
+template <std::size_t... I>
+struct MakeIndices<0, I...> {
+  using type = Indices<I...>;
+};
+
+/**
+ * @brief Checks one argument, naming it in the error.
+ */
+template <typename T>
+bool check_argument(NodePtr node, std::size_t index,
+                    const std::string& name) {
+  if (!ArgumentTraits<T>::check(node)) {
+    throw TypeException(10064, name + ": argument " +
+        std::to_string(index + 1) + " is not " + ArgumentTraits<T>::name());
+  }
+  return true;
+}
+
+/**
+ * @brief Calls the function and boxes its result.
+ */
+template <typename R>
+struct Invoke {
+  template <typename F, typename... A>
+  static NodePtr call(F& function, const std::string& name, A&&... args) {
+    return ResultTraits<typename std::decay<R>::type>::box(
+        function(std::forward<A>(args)...), name);
+  }
+};
+
+template <>
+struct Invoke<void> {
+  template <typename F, typename... A>
+  static NodePtr call(F& function, const std::string&, A&&... args) {
+    function(std::forward<A>(args)...);
+    return create_unspecified();
+  }
+};
+
+/**
+ * @brief The Callable that wraps a typed native procedure: it checks the
+ * number and the types of the arguments, unboxes them straight out of their
+ * nodes, and boxes the result.
+ */
+template <typename F>
+class TypedNative {
+public:
+  using Traits = FunctionTraits<F>;
+
+  TypedNative(const std::string& name, F function) :
+      name(name),
+      function(function) {}
+
+  std::deque<NodePtr> operator()(std::deque<NodePtr> args) {
+    if (args.size() != Traits::arity) {
+      throw InvalidInputException(10063, name + ": expected " +
+          std::to_string(Traits::arity) + " arguments, got " +
+          std::to_string(args.size()));
+    }
+    return {apply(args, typename MakeIndices<Traits::arity>::type())};
+  }
+
+private:
+  template <std::size_t... I>
+  NodePtr apply(const std::deque<NodePtr>& args, Indices<I...>) {
+    // A braced list is evaluated in order, so the first bad argument is
+    // the one reported
+    bool checked[] = {true, check_argument<
+        typename Traits::template Parameter<I>>(args[I], I, name)...};
+    (void) checked;
+    return Invoke<typename Traits::Result>::call(
+        function, name,
+        ArgumentTraits<typename Traits::template Parameter<I>>::unbox(
+            args[I])...);
+  }
+
+  std::string name;
+  F function;
+};
+
+/**
+ * @brief Wraps a C++ function in a native Closure with a fixed arity. The
+ * types of the parameters and of the result are deduced from the
+ * function, so the argument checks and conversions are resolved at compile
+ * time.
+ * @param name The name used in error messages
+ * @param function A function pointer, or a function object such as a
+ * lambda with a single, non-template operator()
+ * @return The new Closure node
+ */
+template <typename F>
+NodePtr make_native(const std::string& name, F function) {
+  return make_node(Closure(TypedNative<F>(name, function), false));
+}
+
+/**
+ * @brief Binds name to a typed native procedure in env.
+ * @see make_native
+ */
+template <typename F>
+void define_native(EnvPtr env, const std::string& name, F function) {
+  env->set_value(Symbol(name), make_native(name, function));
+}
+
+} // namespace native
+} // namespace shaka
+
+#endif //SHAKA_SCHEME_NATIVE_HPP
@@ -32,9 +32,191 @@ std::deque<NodePtr> str_append(std::deque<NodePtr> args) {
   return results;
 }
 
+/**
+ * @brief (make-string-builder) creates an empty mutable string to append
+ * to in place.
+ */
+std::deque<NodePtr> make_str_builder(std::deque<NodePtr> args) {
+  if (args.size() != 0) {
+    throw TypeException(10001, "make-string-builder: expected no arguments");
+  }
+  return {create_node(String(""))};
+}
+
+/**
+ * @brief (string-builder-append! builder str ...) appends strings to the
+ * builder without copying the characters already in it.
+ */
+std::deque<NodePtr> str_builder_append(std::deque<NodePtr> args) {
+  for (std::size_t i = 0; i < args.size(); i++) {
+    if (args[i]->get_type() != Data::Type::STRING) {
+      throw TypeException(10001, "string-builder-append!: expected strings");
+    }
+  }
+  if (args.size() == 0) {
+    throw TypeException(10001, "string-builder-append!: expected a builder");
+  }
+
+  String& builder = args[0]->get<String>();
+  for (std::size_t i = 1; i < args.size(); i++) {
+    builder.append(args[i]->get<String>());
+  }
+  return {create_unspecified()};
+}
+
+/**
+ * @brief (string-builder->string builder) returns a new string with the
+ * contents of the builder. The characters are shared until either string
+ * is modified.
+ */
+std::deque<NodePtr> str_builder_to_string(std::deque<NodePtr> args) {
+  if (args.size() != 1 || args[0]->get_type() != Data::Type::STRING) {
+    throw TypeException(10001, "string-builder->string: expected a builder");
+  }
+  return {create_node(String(args[0]->get<String>()))};
+}
+
+void check_strings(const std::deque<NodePtr>& args, std::size_t min_count,
+                   const std::string& name) {
+  if (args.size() < min_count) {
+    throw TypeException(10001, name + ": too few arguments");
+  }
+  for (std::size_t i = 0; i < args.size(); i++) {
+    if (args[i]->get_type() != Data::Type::STRING) {
+      throw TypeException(10001, name + ": expected strings");
+    }
+  }
+}
+
+/**
+ * @brief (string-upcase str) returns a copy of str in upper case.
+ */
+std::deque<NodePtr> str_upcase(std::deque<NodePtr> args) {
+  check_strings(args, 1, "string-upcase");
+  String result(args[0]->get<String>());
+  result.upcase();
+  return {create_node(result)};
+}
+
+/**
+ * @brief (string-downcase str) returns a copy of str in lower case.
+ */
+std::deque<NodePtr> str_downcase(std::deque<NodePtr> args) {
+  check_strings(args, 1, "string-downcase");
+  String result(args[0]->get<String>());
+  result.downcase();
+  return {create_node(result)};
+}
+
+/**
+ * @brief (string-index str char) returns the index of the first occurrence
+ * of char in str, or #f. char is given as a string of length 1.
+ */
+std::deque<NodePtr> str_index(std::deque<NodePtr> args) {
+  check_strings(args, 2, "string-index");
+  String& c = args[1]->get<String>();
+  if (c.length() != 1) {
+    throw TypeException(10001, "string-index: expected a string of length 1");
+  }
+  std::size_t k = args[0]->get<String>().index_of(c.ref(0));
+  if (k == string_kernels::npos) {
+    return {create_node(Boolean(false))};
+  }
+  return {create_node(Number(static_cast<int>(k)))};
+}
+
+/**
+ * @brief (string-contains str pattern) returns the index at which pattern
+ * first occurs in str, or #f.
+ */
+std::deque<NodePtr> str_contains(std::deque<NodePtr> args) {
+  check_strings(args, 2, "string-contains");
+  std::size_t k = args[0]->get<String>().find(args[1]->get<String>());
+  if (k == string_kernels::npos) {
+    return {create_node(Boolean(false))};
+  }
+  return {create_node(Number(static_cast<int>(k)))};
+}
+
+/**
+ * @brief (string-length str) returns the number of characters in str.
+ */
+std::deque<NodePtr> str_length(std::deque<NodePtr> args) {
+  check_strings(args, 1, "string-length");
+  return {create_node(Number(static_cast<int>(
+      args[0]->get<String>().length())))};
+}
+
+/**
+ * @brief (string-ref str k) returns the character at index k of str as a
+ * string of length 1.
+ */
+std::deque<NodePtr> str_ref(std::deque<NodePtr> args) {
+  if (args.size() != 2 || args[0]->get_type() != Data::Type::STRING ||
+      args[1]->get_type() != Data::Type::NUMBER ||
+      args[1]->get<Number>().get_type() != Number::NumberType::INTEGER) {
+    throw TypeException(10001, "string-ref: expected a string and an index");
+  }
+  String& str = args[0]->get<String>();
+  int k = args[1]->get<Number>().get<Integer>().get_value();
+  if (k < 0 || static_cast<std::size_t>(k) >= str.length()) {
+    throw TypeException(10001, "string-ref: index out of range");
+  }
+  return {create_node(String(1, str.ref(k)))};
+}
+
+/**
+ * @brief Applies a string comparison to each adjacent pair of arguments.
+ */
+std::deque<NodePtr> str_compare_all(
+    const std::deque<NodePtr>& args,
+    const std::string& name,
+    std::function<bool(const String&, const String&)> holds) {
+  check_strings(args, 1, name);
+  for (std::size_t i = 0; i + 1 < args.size(); i++) {
+    if (!holds(args[i]->get<String>(), args[i + 1]->get<String>())) {
+      return {create_node(Boolean(false))};
+    }
+  }
+  return {create_node(Boolean(true))};
+}
+
+std::deque<NodePtr> str_equal(std::deque<NodePtr> args) {
+  return str_compare_all(args, "string=?",
+                         [](const String& a, const String& b) {
+    return a == b;
+  });
+}
+
+std::deque<NodePtr> str_less(std::deque<NodePtr> args) {
+  return str_compare_all(args, "string<?",
+                         [](const String& a, const String& b) {
+    return a < b;
+  });
+}
+
+std::deque<NodePtr> str_ci_equal(std::deque<NodePtr> args) {
+  return str_compare_all(args, "string-ci=?",
+                         [](const String& a, const String& b) {
+    return a.byte_length() == b.byte_length() && a.compare_ci(b) == 0;
+  });
+}
+
 }
 
 Callable string_append = core::str_append;
+Callable string_length = core::str_length;
+Callable string_ref = core::str_ref;
+Callable string_upcase = core::str_upcase;
+Callable string_downcase = core::str_downcase;
+Callable string_index = core::str_index;
+Callable string_contains = core::str_contains;
+Callable string_equal = core::str_equal;
+Callable string_less = core::str_less;
+Callable string_ci_equal = core::str_ci_equal;
+Callable make_string_builder = core::make_str_builder;
+Callable string_builder_append = core::str_builder_append;
+Callable string_builder_to_string = core::str_builder_to_string;
 
 }
 #endif //SHAKA_SCHEME_STRINGS_HPP
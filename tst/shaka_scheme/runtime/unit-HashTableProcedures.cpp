@@ -0,0 +1,66 @@
+#include <gmock/gmock.h>
+#include "shaka_scheme/runtime/stdproc/hash_tables.hpp"
+#include "shaka_scheme/runtime/stdproc/equivalence_predicates.hpp"
+#include "shaka_scheme/system/core/lists.hpp"
+#include "shaka_scheme/system/gc/GC.hpp"
+#include "shaka_scheme/system/gc/init_gc.hpp"
+
+using namespace shaka;
+
+/**
+ * @brief Test: the hash table procedures on an equal? table
+ */
+TEST(HashTableProceduresUnitTest, equal_table) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+
+  // Given: an equal? table created without arguments
+  NodePtr table = stdproc::make_hash_table({})[0];
+  ASSERT_TRUE(stdproc::is_hash_table({table})[0]->get<Boolean>()
+                  .get_value());
+  ASSERT_EQ(table->get<HashTable>().get_equivalence(),
+            HashTable::Equivalence::EQUAL);
+
+  // When: a list key is set
+  NodePtr key = core::list(create_node(Number(1)), create_node(Number(2)));
+  stdproc::hash_table_set({table, key, create_node(String("value"))});
+
+  // Then: an equal list finds the value
+  NodePtr same = core::list(create_node(Number(1)), create_node(Number(2)));
+  ASSERT_EQ(stdproc::hash_table_ref({table, same})[0]->get<String>(),
+            String("value"));
+  ASSERT_TRUE(stdproc::hash_table_contains({table, same})[0]
+                  ->get<Boolean>().get_value());
+  ASSERT_EQ(stdproc::hash_table_size({table})[0]->get<Number>(), Number(1));
+  ASSERT_EQ(core::length(stdproc::hash_table_to_alist({table})[0]), 1u);
+
+  // When: the key is deleted
+  stdproc::hash_table_delete({table, same});
+
+  // Then: lookups fall back to the default or fail
+  ASSERT_EQ(stdproc::hash_table_ref_default(
+      {table, key, create_node(Number(0))})[0]->get<Number>(), Number(0));
+  ASSERT_THROW(stdproc::hash_table_ref({table, key}), InvalidInputException);
+  ASSERT_EQ(stdproc::hash({key})[0]->get<Number>(),
+            stdproc::hash({same})[0]->get<Number>());
+}
+
+/**
+ * @brief Test: make-hash-table takes eq?, eqv? or equal? as its predicate
+ */
+TEST(HashTableProceduresUnitTest, equivalence_argument) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+
+  // Given: the equivalence predicates as procedures
+  NodePtr eq = create_node(Closure(stdproc::eq, false));
+  NodePtr eqv = create_node(Closure(stdproc::eqv, false));
+  NodePtr not_a_predicate = create_node(Closure(stdproc::hash, true));
+
+  // Then: the table uses the matching equivalence
+  ASSERT_EQ(stdproc::make_hash_table({eq})[0]->get<HashTable>()
+                .get_equivalence(), HashTable::Equivalence::EQ);
+  ASSERT_EQ(stdproc::make_hash_table({eqv})[0]->get<HashTable>()
+                .get_equivalence(), HashTable::Equivalence::EQV);
+  ASSERT_THROW(stdproc::make_hash_table({not_a_predicate}), TypeException);
+}
@@ -0,0 +1,237 @@
+#include <gmock/gmock.h>
+#include "shaka_scheme/runtime/stdproc/list_library.hpp"
+#include "shaka_scheme/runtime/stdproc/numbers_arithmetic.hpp"
+#include "shaka_scheme/runtime/stdproc/pairs_and_lists.hpp"
+#include "shaka_scheme/system/vm/compiler/Compiler.hpp"
+#include "shaka_scheme/system/vm/HeapVirtualMachine.hpp"
+#include "shaka_scheme/system/lexer/rules/init.hpp"
+#include "shaka_scheme/system/parser/parser_definitions.hpp"
+#include "shaka_scheme/system/core/lists.hpp"
+#include "shaka_scheme/system/gc/GC.hpp"
+#include "shaka_scheme/system/gc/init_gc.hpp"
+
+#include <sstream>
+
+using namespace shaka;
+
+namespace {
+
+/**
+ * @brief Compiles and evaluates str in env, returning the accumulator
+ */
+NodePtr evaluate(const std::string& str, EnvPtr env) {
+  parser::ParserInput input(str);
+  Compiler compiler;
+  HeapVirtualMachine hvm(nullptr, nullptr, env, ValueRib(), nullptr);
+  return hvm.run(compiler.compile(parser::parse_datum(input).it));
+}
+
+std::string to_string(NodePtr node) {
+  std::stringstream ss;
+  ss << *node;
+  return ss.str();
+}
+
+void define_stepping(EnvPtr env, const std::string& name,
+                     SteppingCallable callable) {
+  env->set_value(Symbol(name), create_node(Closure(
+      std::make_shared<SteppingCallable>(callable), true)));
+}
+
+EnvPtr make_environment() {
+  EnvPtr env = std::make_shared<Environment>(nullptr);
+  env->set_value(Symbol("+"), create_node(Closure(stdproc::add, true)));
+  env->set_value(Symbol("*"), create_node(Closure(stdproc::mul, true)));
+  env->set_value(Symbol("car"), create_node(Closure(stdproc::car, false)));
+  env->set_value(Symbol("cdr"), create_node(Closure(stdproc::cdr, false)));
+  env->set_value(Symbol("cons"), create_node(Closure(stdproc::cons, false)));
+  env->set_value(Symbol("<"), create_node(Closure([](stdproc::Args args) {
+    return stdproc::Args{create_node(Boolean(
+        args[0]->get<Number>() < args[1]->get<Number>()))};
+  }, false)));
+  define_stepping(env, "map", stdproc::map);
+  define_stepping(env, "for-each", stdproc::for_each);
+  define_stepping(env, "filter", stdproc::filter);
+  define_stepping(env, "fold", stdproc::fold);
+  define_stepping(env, "fold-right", stdproc::fold_right);
+  define_stepping(env, "sort", stdproc::sort);
+  return env;
+}
+
+} // namespace
+
+/**
+ * @brief Test: map and for-each apply Scheme and native procedures
+ */
+TEST(ListLibraryUnitTest, map_and_for_each) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+  EnvPtr env = make_environment();
+
+  // When: You map a Scheme procedure and a native procedure over lists
+  // Then: The results are in order, up to the end of the shortest list
+  ASSERT_EQ(to_string(evaluate("(map (lambda (x) (* x x)) '(1 2 3))", env)),
+            "(1 4 9)");
+  ASSERT_EQ(to_string(evaluate("(map + '(1 2 3) '(10 20))", env)),
+            "(11 22)");
+  ASSERT_EQ(to_string(evaluate("(map car '())", env)), "()");
+
+  // When: A mapped procedure calls map itself
+  // Then: Both maps return into the right frames
+  ASSERT_EQ(to_string(evaluate(
+      "(map (lambda (l) (map (lambda (x) (+ x 1)) l)) '((1 2) (3)))", env)),
+            "((2 3) (4))");
+
+  // When: You use for-each to sum a list
+  env->set_value(Symbol("total"), create_node(Number(0)));
+  evaluate("(for-each (lambda (x) (set! total (+ total x))) '(1 2 3 4))",
+           env);
+
+  // Then: The procedure was applied to every element
+  ASSERT_EQ(env->get_value(Symbol("total"))->get<Number>(), Number(10));
+}
+
+/**
+ * @brief Test: filter, fold and fold-right
+ */
+TEST(ListLibraryUnitTest, filter_and_fold) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+  EnvPtr env = make_environment();
+
+  // Then: filter keeps the elements that satisfy the predicate, in order
+  ASSERT_EQ(to_string(evaluate("(filter (lambda (x) (< x 3)) '(1 5 2 4))",
+                               env)),
+            "(1 2)");
+  // Then: fold goes from left to right, and fold-right from right to left
+  ASSERT_EQ(to_string(evaluate("(fold cons '() '(1 2 3))", env)),
+            "(3 2 1)");
+  ASSERT_EQ(to_string(evaluate("(fold-right cons '() '(1 2 3))", env)),
+            "(1 2 3)");
+  ASSERT_EQ(evaluate("(fold (lambda (x acc) (+ x acc)) 0 '(1 2 3))", env)
+                ->get<Number>(), Number(6));
+
+  // Then: fold-right takes several lists, up to the end of the shortest
+  ASSERT_EQ(to_string(evaluate(
+      "(fold-right (lambda (a b acc) (cons (+ a b) acc)) '()"
+      "            '(1 2 3) '(10 20))", env)),
+            "(11 22)");
+}
+
+/**
+ * @brief Test: re-entering a mapped procedure through a continuation
+ * leaves the lists that map already returned alone
+ */
+TEST(ListLibraryUnitTest, map_reentered_through_continuation) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+  EnvPtr env = make_environment();
+  env->set_value(Symbol("k"), create_node(Boolean(false)));
+
+  // Given: A map that captures the continuation of its first application
+  NodePtr first = evaluate(
+      "(map (lambda (x)"
+      "       (call/cc (lambda (c) (if k x ((lambda () (set! k c) x))))))"
+      "     '(1 2 3))", env);
+  ASSERT_EQ(to_string(first), "(1 2 3)");
+
+  // When: You return into that application again, twice
+  NodePtr second = evaluate("(k 10)", env);
+  NodePtr third = evaluate("(k 20)", env);
+
+  // Then: Each re-entry continues from the rest of the list, and builds a
+  // fresh result
+  ASSERT_EQ(to_string(second), "(10 2 3)");
+  ASSERT_EQ(to_string(third), "(20 2 3)");
+  ASSERT_EQ(to_string(first), "(1 2 3)");
+  ASSERT_EQ(to_string(second), "(10 2 3)");
+}
+
+/**
+ * @brief Test: sort is stable, and sorts lists and vectors
+ */
+TEST(ListLibraryUnitTest, sort) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+  EnvPtr env = make_environment();
+
+  // Then: Lists and vectors are sorted with a native procedure
+  ASSERT_EQ(to_string(evaluate("(sort < '(3 1 2 5 4))", env)),
+            "(1 2 3 4 5)");
+  NodePtr vector = evaluate("(sort < #(3 1 2))", env);
+  ASSERT_EQ(vector->get_type(), Data::Type::VECTOR);
+  ASSERT_EQ(vector->get<Vector>()[0]->get<Number>(), Number(1));
+  ASSERT_EQ(vector->get<Vector>()[2]->get<Number>(), Number(3));
+  ASSERT_EQ(to_string(evaluate("(sort < '())", env)), "()");
+
+  // Then: Equal keys keep their order with a Scheme procedure
+  ASSERT_EQ(to_string(evaluate(
+      "(sort (lambda (a b) (< (car a) (car b)))"
+      "      '((2 . a) (1 . b) (2 . c) (1 . d) (0 . e)))", env)),
+            "((0 . e) (1 . b) (1 . d) (2 . a) (2 . c))");
+}
+
+/**
+ * @brief Test: sort on a long list compares at most n log n times
+ */
+TEST(ListLibraryUnitTest, sort_long_list) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+  EnvPtr env = make_environment();
+
+  // Given: A list of 4096 numbers in a scrambled order
+  const int n = 4096;
+  NodePtr list = core::list();
+  for (int i = 0; i < n; ++i) {
+    list = core::cons(create_node(Number((i * 1237) % n)), list);
+  }
+  env->set_value(Symbol("xs"), list);
+  env->set_value(Symbol("count"), create_node(Number(0)));
+
+  // When: You sort it with a Scheme procedure that counts its calls
+  NodePtr result = evaluate(
+      "(sort (lambda (a b) (set! count (+ count 1)) (< a b)) xs)", env);
+
+  // Then: The list is sorted, with at most n log n comparisons
+  int i = 0;
+  for (NodePtr it = result; core::is_pair(it); it = core::cdr(it), ++i) {
+    ASSERT_EQ(core::car(it)->get<Number>(), Number(i));
+  }
+  ASSERT_EQ(i, n);
+  ASSERT_LE(env->get_value(Symbol("count"))->get<Number>(),
+            Number(n * 12));
+}
+
+/**
+ * @brief Test: map still works on a VM whose earlier runs used a freed heap
+ */
+TEST(ListLibraryUnitTest, map_after_heap_is_freed) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+  EnvPtr env = make_environment();
+  env->set_value(Symbol("pair?"), create_node(Closure(stdproc::is_pair,
+                                                      false)));
+  HeapVirtualMachine hvm(nullptr, nullptr, env, ValueRib(), nullptr);
+  Compiler compiler;
+
+  // Given: A procedure that maps itself over the rest of a list
+  parser::ParserInput definition(
+      "(define f (lambda (l) (if (pair? l) (map f (cdr l)) 1)))");
+  hvm.run(compiler.compile(parser::parse_datum(definition).it));
+  parser::ParserInput call("(f '(1 2 3))");
+  Expression compiled = compiler.compile(parser::parse_datum(call).it);
+
+  // When: It runs again and again, each time in a heap that is freed after
+  // Then: Each run gets the same result
+  for (int i = 0; i < 20; ++i) {
+    gc::GC scratch;
+    gc::HeapScope scope(scratch);
+    ASSERT_EQ(to_string(hvm.run(compiled)), "(1 1)");
+  }
+}
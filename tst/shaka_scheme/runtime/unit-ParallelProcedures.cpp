@@ -0,0 +1,226 @@
+#include <gmock/gmock.h>
+#include "shaka_scheme/runtime/stdproc/parallel.hpp"
+#include "shaka_scheme/runtime/stdproc/numbers_arithmetic.hpp"
+#include "shaka_scheme/system/vm/compiler/Compiler.hpp"
+#include "shaka_scheme/system/vm/HeapVirtualMachine.hpp"
+#include "shaka_scheme/system/lexer/rules/init.hpp"
+#include "shaka_scheme/system/parser/parser_definitions.hpp"
+#include "shaka_scheme/system/core/lists.hpp"
+#include "shaka_scheme/system/gc/GC.hpp"
+#include "shaka_scheme/system/gc/init_gc.hpp"
+
+using namespace shaka;
+
+namespace {
+
+/**
+ * @brief Compiles and evaluates str in env, returning the accumulator
+ */
+NodePtr evaluate(const std::string& str, EnvPtr env) {
+  parser::ParserInput input(str);
+  Compiler compiler;
+  HeapVirtualMachine hvm(nullptr, nullptr, env, ValueRib(), nullptr);
+  hvm.set_expression(compiler.compile(parser::parse_datum(input).it));
+  do {
+    hvm.evaluate_assembly_instruction();
+  } while (core::car(hvm.get_expression())->get<Symbol>() != Symbol("halt"));
+  return hvm.get_accumulator();
+}
+
+EnvPtr make_environment() {
+  EnvPtr env = std::make_shared<Environment>(nullptr);
+  env->set_value(Symbol("+"), create_node(Closure(stdproc::add, true)));
+  env->set_value(Symbol("*"), create_node(Closure(stdproc::mul, true)));
+  env->set_value(Symbol("parallel-map"),
+                 create_node(Closure(stdproc::parallel_map, false)));
+  env->set_value(Symbol("parallel-for-each"),
+                 create_node(Closure(stdproc::parallel_for_each, false)));
+  env->set_value(Symbol("parallel-reduce"),
+                 create_node(Closure(stdproc::parallel_reduce, false)));
+  env->set_value(Symbol("future"),
+                 create_node(Closure(stdproc::future, false)));
+  env->set_value(Symbol("touch"),
+                 create_node(Closure(stdproc::touch, false)));
+  return env;
+}
+
+} // namespace
+
+/**
+ * @brief Test: parallel-map applies a Scheme procedure to every element of a
+ * list and keeps the order
+ */
+TEST(ParallelProceduresUnitTest, parallel_map_list) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+  EnvPtr env = make_environment();
+
+  // Given: A list of 100 numbers
+  std::deque<NodePtr> numbers;
+  for (int i = 0; i < 100; ++i) {
+    numbers.push_back(create_node(Number(i)));
+  }
+  NodePtr list = core::list();
+  for (auto it = numbers.rbegin(); it != numbers.rend(); ++it) {
+    list = core::cons(*it, list);
+  }
+  env->set_value(Symbol("xs"), list);
+
+  // When: You square every element in parallel
+  NodePtr result = evaluate("(parallel-map (lambda (x) (* x x)) xs)", env);
+
+  // Then: The result is the list of squares, in order
+  ASSERT_EQ(core::length(result), 100);
+  int i = 0;
+  for (NodePtr it = result; core::is_pair(it); it = core::cdr(it), ++i) {
+    ASSERT_EQ(core::car(it)->get<Number>(), Number(i * i));
+  }
+
+  // Then: The heaps of the workers now belong to the calling GC
+  ASSERT_GT(garbage_collector.get_size(), 100);
+}
+
+/**
+ * @brief Test: parallel-map over a vector returns a vector
+ */
+TEST(ParallelProceduresUnitTest, parallel_map_vector) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+  EnvPtr env = make_environment();
+
+  // Given: A vector of three numbers
+  NodePtr vector = create_node(Vector({create_node(Number(1)),
+                                       create_node(Number(2)),
+                                       create_node(Number(3))}));
+  env->set_value(Symbol("v"), vector);
+
+  // When: You add 10 to each element in parallel
+  NodePtr result = evaluate("(parallel-map (lambda (x) (+ x 10)) v)", env);
+
+  // Then: The result is a vector of the sums
+  ASSERT_EQ(result->get_type(), Data::Type::VECTOR);
+  ASSERT_EQ(result->get<Vector>().length(), 3u);
+  ASSERT_EQ(result->get<Vector>()[0]->get<Number>(), Number(11));
+  ASSERT_EQ(result->get<Vector>()[2]->get<Number>(), Number(13));
+
+  // When: The input is empty
+  env->set_value(Symbol("empty"), create_node(Vector(0)));
+  result = evaluate("(parallel-map (lambda (x) x) empty)", env);
+
+  // Then: The result is an empty vector
+  ASSERT_EQ(result->get<Vector>().length(), 0u);
+}
+
+/**
+ * @brief Test: parallel-reduce folds chunks in order
+ */
+TEST(ParallelProceduresUnitTest, parallel_reduce) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+  EnvPtr env = make_environment();
+
+  // Given: A vector of 1000 numbers, 0 to 999
+  NodePtr vector = create_node(Vector(1000));
+  for (int i = 0; i < 1000; ++i) {
+    vector->get<Vector>()[i] = create_node(Number(i));
+  }
+  env->set_value(Symbol("v"), vector);
+
+  // When: You sum them in parallel starting from 5
+  NodePtr result = evaluate(
+      "(parallel-reduce (lambda (a b) (+ a b)) 5 v)", env);
+
+  // Then: The result is the sum plus the initial value
+  ASSERT_EQ(result->get<Number>(), Number(5 + 999 * 1000 / 2));
+
+  // When: The sequence is empty
+  env->set_value(Symbol("nil"), core::list());
+  result = evaluate("(parallel-reduce + 5 nil)", env);
+
+  // Then: The result is the initial value
+  ASSERT_EQ(result->get<Number>(), Number(5));
+}
+
+/**
+ * @brief Test: errors in workers reach the caller
+ */
+TEST(ParallelProceduresUnitTest, errors) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+  EnvPtr env = make_environment();
+
+  // Given: A list containing a symbol
+  env->set_value(Symbol("xs"), core::list(create_node(Number(1)),
+                                          create_node(Symbol("a"))));
+
+  // When: A worker applies + to the symbol
+  // Then: The exception is rethrown on the calling thread
+  ASSERT_ANY_THROW(evaluate("(parallel-for-each (lambda (x) (+ x 1)) xs)",
+                            env));
+
+  // When: The first argument is not a procedure
+  // Then: A TypeException is thrown
+  ASSERT_THROW(evaluate("(parallel-map 1 xs)", env), TypeException);
+}
+
+/**
+ * @brief Test: touch returns the value computed by a future
+ */
+TEST(ParallelProceduresUnitTest, future_touch) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+  EnvPtr env = make_environment();
+
+  // Given: A future that computes a product
+  env->set_value(Symbol("f"),
+                 evaluate("(future (lambda () (* 6 7)))", env));
+
+  // When: You touch it twice
+  NodePtr first = evaluate("(touch f)", env);
+  NodePtr second = evaluate("(touch f)", env);
+
+  // Then: Both touches give the same value
+  ASSERT_EQ(first->get<Number>(), Number(42));
+  ASSERT_EQ(first, second);
+
+  // When: A future touches other futures
+  NodePtr result = evaluate(
+      "(touch (future (lambda () "
+      "  (+ (touch (future (lambda () 1))) (touch (future (lambda () 2)))))))",
+      env);
+
+  // Then: The nested futures are run while the outer one waits
+  ASSERT_EQ(result->get<Number>(), Number(3));
+
+  // When: You touch a procedure that is not a future
+  // Then: A TypeException is thrown, not an error of the procedure
+  ASSERT_THROW(evaluate("(touch +)", env), TypeException);
+  ASSERT_THROW(evaluate("(touch (lambda () 1))", env), TypeException);
+}
+
+/**
+ * @brief Test: an exception in a future is rethrown by touch
+ */
+TEST(ParallelProceduresUnitTest, future_error) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+  EnvPtr env = make_environment();
+
+  // Given: A future whose thunk adds a symbol to a number
+  env->set_value(Symbol("f"),
+                 evaluate("(future (lambda () (+ 1 'a)))", env));
+
+  // When: You touch it
+  // Then: The exception reaches the toucher
+  ASSERT_ANY_THROW(evaluate("(touch f)", env));
+
+  // When: You touch something that is not a future
+  // Then: A TypeException is thrown
+  ASSERT_THROW(evaluate("(touch 1)", env), TypeException);
+}
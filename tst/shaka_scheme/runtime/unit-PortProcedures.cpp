@@ -0,0 +1,109 @@
+#include <gmock/gmock.h>
+#include "shaka_scheme/runtime/stdproc/ports.hpp"
+#include "shaka_scheme/runtime/stdproc/equivalence_predicates.hpp"
+#include "shaka_scheme/runtime/stdproc/numbers_arithmetic.hpp"
+#include "shaka_scheme/system/gc/GC.hpp"
+#include "shaka_scheme/system/gc/init_gc.hpp"
+
+#include <cstdio>
+
+using namespace shaka;
+
+namespace {
+
+bool is_true(const stdproc::Args& result) {
+  return result[0]->get<Boolean>().get_value();
+}
+
+NodePtr number(int value) {
+  return create_node(Number(value));
+}
+
+} // namespace
+
+/**
+ * @brief Test: string ports and the textual procedures
+ */
+TEST(PortProceduresUnitTest, string_ports) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+
+  // When: You write strings, a newline and a datum to a string port
+  NodePtr output = stdproc::open_output_string({})[0];
+  stdproc::write_string({create_node(String("log: ")), output});
+  stdproc::write_string({create_node(String("0123456789")), output,
+                         number(2), number(5)});
+  stdproc::newline({output});
+  stdproc::display({create_node(Number(42)), output});
+
+  // Then: get-output-string has all of it
+  ASSERT_EQ(stdproc::get_output_string({output})[0]->get<String>()
+                .get_string(), "log: 234\n42\n");
+  ASSERT_TRUE(is_true(stdproc::is_output_port({output})));
+  ASSERT_TRUE(is_true(stdproc::is_textual_port({output})));
+  ASSERT_FALSE(is_true(stdproc::is_port({number(1)})));
+
+  // When: You read lines from a string port
+  NodePtr input = stdproc::open_input_string(
+      {create_node(String("one\ntwo three\n"))})[0];
+
+  // Then: Each line is returned, then the end-of-file object
+  ASSERT_EQ(stdproc::read_line({input})[0]->get<String>().get_string(),
+            "one");
+  ASSERT_EQ(stdproc::read_string({number(3), input})[0]->get<String>()
+                .get_string(), "two");
+  ASSERT_EQ(stdproc::read_line({input})[0]->get<String>().get_string(),
+            " three");
+  NodePtr eof = stdproc::read_line({input})[0];
+  ASSERT_TRUE(is_true(stdproc::is_eof_object({eof})));
+  ASSERT_TRUE(is_true(stdproc::eqv({eof, stdproc::eof_object({})[0]})));
+
+  // Then: A textual port is not accepted by the binary procedures
+  ASSERT_THROW(stdproc::read_u8({input}), TypeException);
+  stdproc::close_input_port({input});
+  ASSERT_FALSE(is_true(stdproc::is_input_port_open({input})));
+}
+
+/**
+ * @brief Test: bytevector and file ports and the binary procedures
+ */
+TEST(PortProceduresUnitTest, binary_ports) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  const std::string path = "unit-PortProcedures.bin";
+
+  // When: You write bytes to a binary file, and close it
+  NodePtr file = stdproc::open_binary_output_file(
+      {create_node(String(path))})[0];
+  stdproc::write_u8({number(1), file});
+  stdproc::write_bytevector({create_node(Bytevector{2, 3, 4, 5}), file,
+                             number(1)});
+  stdproc::close_port({file});
+
+  // Then: read-bytevector! reads them into an existing bytevector
+  NodePtr input = stdproc::open_binary_input_file(
+      {create_node(String(path))})[0];
+  NodePtr storage = create_node(Bytevector(6, 0));
+  ASSERT_EQ(stdproc::peek_u8({input})[0]->get<Number>(), Number(1));
+  ASSERT_EQ(stdproc::read_bytevector_into({storage, input, number(2)})[0]
+                ->get<Number>(), Number(4));
+  Bytevector& bytes = storage->get<Bytevector>();
+  ASSERT_EQ(bytes[0], 0);
+  ASSERT_EQ(bytes[2], 1);
+  ASSERT_EQ(bytes[5], 5);
+  ASSERT_TRUE(is_true(stdproc::is_eof_object(
+      stdproc::read_bytevector_into({storage, input}))));
+  stdproc::close_port({input});
+  std::remove(path.c_str());
+
+  // Then: Bytevector ports work the same way
+  NodePtr output = stdproc::open_output_bytevector({})[0];
+  stdproc::write_u8({number(255), output});
+  NodePtr written = stdproc::get_output_bytevector({output})[0];
+  NodePtr reader = stdproc::open_input_bytevector({written})[0];
+  ASSERT_EQ(stdproc::read_bytevector({number(10), reader})[0]
+                ->get<Bytevector>()[0], 255);
+  ASSERT_TRUE(is_true(stdproc::is_eof_object(stdproc::read_u8({reader}))));
+  ASSERT_THROW(stdproc::write_string({create_node(String("x")), output}),
+               TypeException);
+}
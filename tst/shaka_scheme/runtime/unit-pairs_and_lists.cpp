@@ -605,3 +605,39 @@ TEST(PairsAndListsUnitTest, list_copy) {
   ASSERT_EQ(list3[0]->get<shaka::DataPair>().car()->get<shaka::Number>(),
             copy3[0]->get<shaka::DataPair>().car()->get<shaka::Number>());
 }
+
+/**
+ * @brief Tests that (append) and (list-copy) make one pair per element
+ */
+TEST(PairsAndListsUnitTest, append_list_copy_linear) {
+  using Args = std::deque<shaka::NodePtr>;
+  shaka::gc::GC garbage_collector;
+  shaka::gc::init_create_node(garbage_collector);
+
+  // Given: a list of 50000 numbers and 50000 more numbers to append
+  Args list_args;
+  for (int i = 0; i < 50000; ++i) {
+    list_args.push_back(shaka::create_node(shaka::Number(i)));
+  }
+  Args list {shaka::stdproc::impl::list(list_args)};
+  Args append_args {list_args};
+  append_args.push_front(list[0]);
+  int size = garbage_collector.get_size();
+
+  // When: (append) is called with the list and the numbers
+  Args appended {shaka::stdproc::impl::append(append_args)};
+
+  // Then: one pair is made for each element of the result, and one empty
+  // list to end it
+  ASSERT_EQ(garbage_collector.get_size(), size + 100001);
+  Args length {shaka::stdproc::impl::length(appended)};
+  ASSERT_EQ(length[0]->get<shaka::Number>(), shaka::Number(100000));
+
+  // When: (list-copy) is called on the result
+  size = garbage_collector.get_size();
+  Args copy {shaka::stdproc::impl::list_copy(appended)};
+
+  // Then: one pair is made for each element, and the elements are shared
+  ASSERT_EQ(garbage_collector.get_size(), size + 100001);
+  ASSERT_EQ(copy[0]->get<shaka::DataPair>().car(), list_args[0]);
+}
@@ -0,0 +1,111 @@
+#include <gmock/gmock.h>
+
+#include <shaka_scheme/system/base/HashTable.hpp>
+#include <shaka_scheme/system/base/Data.hpp>
+#include <shaka_scheme/system/core/lists.hpp>
+#include "shaka_scheme/system/gc/GC.hpp"
+#include "shaka_scheme/system/gc/init_gc.hpp"
+
+using namespace shaka;
+
+/**
+ * @brief Test: set, get and remove keep every entry reachable while the
+ * table grows and shrinks
+ */
+TEST(HashTableUnitTest, set_get_remove) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+
+  // Given: a table holding 1000 numbers mapped to their squares
+  HashTable table(HashTable::Equivalence::EQV);
+  for (int i = 0; i < 1000; ++i) {
+    table.set(create_node(Number(i)), create_node(Number(i * i)));
+  }
+
+  // Then: every key is found through an equivalent key
+  ASSERT_EQ(table.size(), 1000u);
+  for (int i = 0; i < 1000; ++i) {
+    NodePtr value = table.get(create_node(Number(i)));
+    ASSERT_TRUE(value);
+    ASSERT_EQ(value->get<Number>(), Number(i * i));
+  }
+  ASSERT_FALSE(table.get(create_node(Number(1000))));
+  ASSERT_FALSE(table.contains(create_node(Number(1.0))));
+
+  // When: every even key is removed and one key is overwritten
+  for (int i = 0; i < 1000; i += 2) {
+    ASSERT_TRUE(table.remove(create_node(Number(i))));
+  }
+  ASSERT_FALSE(table.remove(create_node(Number(0))));
+  table.set(create_node(Number(1)), create_node(String("one")));
+
+  // Then: only the odd keys are left
+  ASSERT_EQ(table.size(), 500u);
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_EQ(table.contains(create_node(Number(i))), i % 2 == 1);
+  }
+  ASSERT_EQ(table.get(create_node(Number(1)))->get<String>(),
+            String("one"));
+  ASSERT_EQ(table.entries().size(), 500u);
+
+  // When: the table is cleared
+  table.clear();
+
+  // Then: it is empty
+  ASSERT_EQ(table.size(), 0u);
+  ASSERT_FALSE(table.contains(create_node(Number(3))));
+}
+
+/**
+ * @brief Test: eqv? tables compare pairs by identity, equal? tables by
+ * content
+ */
+TEST(HashTableUnitTest, equivalence) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+
+  // Given: two distinct but equal lists
+  NodePtr a = core::list(create_node(Symbol("x")), create_node(Number(1)),
+                         create_node(String("s")));
+  NodePtr b = core::list(create_node(Symbol("x")), create_node(Number(1)),
+                         create_node(String("s")));
+
+  // When: the first list is a key in an eqv? and an equal? table
+  HashTable eqv_table(HashTable::Equivalence::EQV);
+  HashTable equal_table(HashTable::Equivalence::EQUAL);
+  eqv_table.set(a, create_node(Boolean(true)));
+  equal_table.set(a, create_node(Boolean(true)));
+
+  // Then: the eqv? table finds only the same list
+  ASSERT_TRUE(eqv_table.contains(a));
+  ASSERT_FALSE(eqv_table.contains(b));
+
+  // Then: the equal? table finds the equal list too
+  ASSERT_TRUE(equal_table.contains(b));
+  ASSERT_EQ(HashTable::hash(a, HashTable::Equivalence::EQUAL),
+            HashTable::hash(b, HashTable::Equivalence::EQUAL));
+  ASSERT_FALSE(equal_table.contains(
+      core::list(create_node(Symbol("x")), create_node(Number(2)))));
+
+  // Then: symbols and strings are compared by value in every table
+  eqv_table.set(create_node(Symbol("key")), create_node(Number(7)));
+  ASSERT_TRUE(eqv_table.contains(create_node(Symbol("key"))));
+}
+
+/**
+ * @brief Test: hashing a cyclic list terminates
+ */
+TEST(HashTableUnitTest, cyclic_equal_hash) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+
+  // Given: a circular list
+  NodePtr cycle = core::list(create_node(Number(1)), create_node(Number(2)));
+  core::set_cdr(core::cdr(cycle), cycle);
+
+  // Then: it hashes and can be used as a key by identity
+  HashTable::hash(cycle, HashTable::Equivalence::EQUAL);
+  HashTable table(HashTable::Equivalence::EQUAL);
+  table.set(cycle, create_node(Boolean(true)));
+  ASSERT_TRUE(table.contains(cycle));
+}
@@ -0,0 +1,118 @@
+#include <gmock/gmock.h>
+#include "shaka_scheme/system/base/Port.hpp"
+#include "shaka_scheme/system/exceptions/InvalidInputException.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+using namespace shaka;
+
+/**
+ * @brief Test: memory ports read lines and bytes, and collect output
+ */
+TEST(PortUnitTest, memory_ports) {
+  // Given: An input port over three lines, the last without a line feed
+  Port input = Port::open_input_memory("first\r\n\nlast", false);
+  std::string line;
+
+  // Then: Lines are read without their endings, then the end is reported
+  ASSERT_TRUE(input.read_line(line));
+  ASSERT_EQ(line, "first");
+  ASSERT_TRUE(input.read_line(line));
+  ASSERT_EQ(line, "");
+  ASSERT_EQ(input.peek_byte(), 'l');
+  ASSERT_TRUE(input.read_line(line));
+  ASSERT_EQ(line, "last");
+  ASSERT_FALSE(input.read_line(line));
+  ASSERT_EQ(input.read_byte(), -1);
+
+  // When: You write to an output port, through a copy of it
+  Port output = Port::open_output_memory(true);
+  Port copy = output;
+  copy.write("ab");
+  copy.write_byte(0);
+  output.write(std::string(3, 'c'));
+
+  // Then: Both handles see the same output
+  ASSERT_EQ(output.get_output(), std::string("ab\0ccc", 6));
+  ASSERT_TRUE(output == copy);
+  ASSERT_TRUE(output.is_binary());
+
+  // Then: A closed port cannot be used, and an input port cannot be written
+  input.close();
+  ASSERT_FALSE(input.is_open());
+  ASSERT_THROW(input.read_byte(), InvalidInputException);
+  ASSERT_THROW(copy.read_byte(), InvalidInputException);
+}
+
+/**
+ * @brief Test: file ports buffer their output until flushed or closed
+ */
+TEST(PortUnitTest, file_ports) {
+  const std::string path = "unit-Port.txt";
+  std::string block(Port::buffer_size * 3 + 7, 'x');
+  for (std::size_t i = 0; i < block.size(); i += 101) {
+    block[i] = '\n';
+  }
+
+  // When: You write less than a buffer to a file
+  Port output = Port::open_file(path, Port::Direction::OUTPUT, false);
+  output.write("header\n");
+
+  // Then: Nothing reaches the file until the port is flushed
+  std::ifstream before(path);
+  ASSERT_EQ(before.peek(), std::ifstream::traits_type::eof());
+  output.flush();
+  std::ifstream after(path);
+  std::string first;
+  std::getline(after, first);
+  ASSERT_EQ(first, "header");
+
+  // When: You write more than a buffer, and close the port
+  output.write(block);
+  output.write("\ntrailer");
+  output.close();
+
+  // Then: Reading it back gives the same lines and bytes
+  Port input = Port::open_file(path, Port::Direction::INPUT, false);
+  std::string line;
+  ASSERT_TRUE(input.read_line(line));
+  ASSERT_EQ(line, "header");
+  std::string bytes(block.size(), '\0');
+  ASSERT_EQ(input.read(&bytes[0], bytes.size()), block.size());
+  ASSERT_EQ(bytes, block);
+  ASSERT_TRUE(input.is_ready());
+  ASSERT_TRUE(input.read_line(line));
+  ASSERT_EQ(line, "");
+  ASSERT_TRUE(input.read_line(line));
+  ASSERT_EQ(line, "trailer");
+  ASSERT_EQ(input.read(&bytes[0], 10), 0u);
+  std::remove(path.c_str());
+
+  // Then: A file that does not exist cannot be opened
+  ASSERT_THROW(Port::open_file(path, Port::Direction::INPUT, true),
+               InvalidInputException);
+}
+
+/**
+ * @brief Test: console ports pass output on to their stream buffer
+ */
+TEST(PortUnitTest, console_ports) {
+  std::istringstream typed("typed line\nrest");
+  std::ostringstream shown;
+  Port input = Port::open_console(typed.rdbuf(), Port::Direction::INPUT);
+  Port output = Port::open_console(shown.rdbuf(), Port::Direction::OUTPUT);
+
+  std::string line;
+  ASSERT_TRUE(input.read_line(line));
+  ASSERT_EQ(line, "typed line");
+  ASSERT_TRUE(input.read_line(line));
+  ASSERT_EQ(line, "rest");
+  ASSERT_FALSE(input.read_line(line));
+
+  shown << "before ";
+  output.write("more");
+  shown << " after";
+  ASSERT_EQ(shown.str(), "before more after");
+}
@@ -0,0 +1,407 @@
+#include <gmock/gmock.h>
+#include <shaka_scheme/system/base/Data.hpp>
+#include <shaka_scheme/system/vm/strings.hpp>
+#include <shaka_scheme/system/gc/GC.hpp>
+#include <shaka_scheme/system/gc/init_gc.hpp>
+
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+/**
+ * @brief Test: short appends stay flat
+ */
+TEST(StringUnitTest, short_append) {
+  // Given: two short strings
+  shaka::String hello("hello ");
+  shaka::String world("world");
+
+  // When: you append them
+  hello.append(world);
+
+  // Then: the result is flat and has the characters of both
+  ASSERT_FALSE(hello.is_rope());
+  ASSERT_EQ(hello, shaka::String("hello world"));
+  ASSERT_EQ(hello.length(), 11u);
+}
+
+/**
+ * @brief Test: many appends build a rope that flattens to the same text
+ */
+TEST(StringUnitTest, rope_append) {
+  // Given: an empty string and the equivalent std::string
+  shaka::String result("");
+  std::string expected;
+
+  // When: you append 100000 short pieces to it
+  for (int i = 0; i < 100000; ++i) {
+    shaka::String piece(std::to_string(i % 10) + ",");
+    result.append(piece);
+    expected += std::to_string(i % 10) + ",";
+  }
+
+  // Then: the result is a rope of the right length
+  ASSERT_TRUE(result.is_rope());
+  ASSERT_EQ(result.length(), expected.size());
+
+  // Then: reading it gives the same characters
+  ASSERT_EQ(result.get_string(), expected);
+  ASSERT_EQ(result.ref(2), '1');
+
+  // When: you copy it and modify the copy
+  shaka::String copy(result);
+  copy.set(0, 'x');
+
+  // Then: the original is unchanged
+  ASSERT_FALSE(copy.is_rope());
+  ASSERT_EQ(copy.ref(0), 'x');
+  ASSERT_EQ(result.ref(0), '0');
+}
+
+/**
+ * @brief Test: appending a string to itself
+ */
+TEST(StringUnitTest, self_append) {
+  // Given: a string at the rope threshold
+  shaka::String s(std::string(shaka::String::rope_threshold, 'a'));
+
+  // When: you append it to itself twice
+  s.append(s);
+  s.append(s);
+
+  // Then: it has four times the characters
+  ASSERT_EQ(s.get_string(),
+            std::string(4 * shaka::String::rope_threshold, 'a'));
+}
+
+/**
+ * @brief Test: small appends to a shared rope leave the other copies alone
+ */
+TEST(StringUnitTest, shared_rope_append) {
+  // Given: a rope and a copy of it
+  shaka::String base(std::string(shaka::String::rope_threshold, 'a'));
+  base.append(shaka::String("b"));
+  shaka::String copy(base);
+  std::string expected = std::string(shaka::String::rope_threshold, 'a') + "b";
+
+  // When: you append single characters to the copy
+  for (int i = 0; i < 1000; ++i) {
+    copy.append(shaka::String("c"));
+  }
+
+  // Then: the copy has them and the original does not
+  ASSERT_EQ(copy.get_string(), expected + std::string(1000, 'c'));
+  ASSERT_EQ(copy.length(), expected.size() + 1000);
+  ASSERT_EQ(base.get_string(), expected);
+
+  // When: a rope containing the flattened original is flattened, and more
+  // characters are appended to the original
+  shaka::String outer(base);
+  outer.append(copy);
+  base.append(shaka::String("\xCE\xBB"));
+
+  // Then: every string still reads back its own characters
+  ASSERT_EQ(outer.get_string(),
+            expected + expected + std::string(1000, 'c'));
+  ASSERT_EQ(base.get_string(), expected + "\xCE\xBB");
+  ASSERT_EQ(base.length(), expected.size() + 1);
+  ASSERT_EQ(base.ref(expected.size()), U'\u03BB');
+}
+
+/**
+ * @brief Test: a shared rope can be flattened from several threads at once
+ */
+TEST(StringUnitTest, concurrent_flatten) {
+  // Given: a rope
+  shaka::String result("");
+  for (int i = 0; i < 1000; ++i) {
+    result.append(shaka::String(std::string(10, 'a' + i % 26)));
+  }
+
+  // When: several threads read copies of it
+  std::vector<std::thread> readers;
+  std::vector<std::string> texts(4);
+  for (int i = 0; i < 4; ++i) {
+    readers.push_back(std::thread([&result, &texts, i]() {
+      shaka::String copy(result);
+      texts[i] = copy.get_string();
+    }));
+  }
+  for (auto& reader : readers) {
+    reader.join();
+  }
+
+  // Then: they all see the same text
+  for (auto& text : texts) {
+    ASSERT_EQ(text, result.get_string());
+  }
+}
+
+/**
+ * @brief Test: the string-builder procedures
+ */
+TEST(StringUnitTest, string_builder) {
+  shaka::gc::GC garbage_collector;
+  shaka::gc::init_create_node(garbage_collector);
+
+  // Given: a string builder
+  shaka::NodePtr builder = shaka::make_string_builder({})[0];
+
+  // When: you append to it and take a snapshot
+  shaka::string_builder_append({builder,
+                                shaka::create_node(shaka::String("abc")),
+                                shaka::create_node(shaka::String("def"))});
+  shaka::NodePtr snapshot = shaka::string_builder_to_string({builder})[0];
+
+  // When: you keep appending after the snapshot
+  shaka::string_builder_append({builder,
+                                shaka::create_node(shaka::String("ghi"))});
+
+  // Then: the builder has everything, and the snapshot is unchanged
+  ASSERT_EQ(builder->get<shaka::String>(), shaka::String("abcdefghi"));
+  ASSERT_EQ(snapshot->get<shaka::String>(), shaka::String("abcdef"));
+
+  // Then: non-strings are rejected
+  ASSERT_THROW(shaka::string_builder_append(
+      {builder, shaka::create_node(shaka::Number(1))}),
+               shaka::TypeException);
+}
+
+/**
+ * @brief Test: upcase and downcase change only ASCII letters, at every
+ * length around the vector widths
+ */
+TEST(StringUnitTest, upcase_downcase) {
+  for (std::size_t n = 0; n < 100; ++n) {
+    // Given: a string of letters, digits and non-ASCII characters
+    std::string text;
+    for (std::size_t i = 0; i < n; ++i) {
+      const char* alphabet[] = {"a", "Z", "9", "\u00e9", "m", "Q", " ", "~"};
+      text += alphabet[i % 8];
+    }
+    std::string upper = text;
+    std::string lower = text;
+    for (char& c : upper) {
+      if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 32);
+    }
+    for (char& c : lower) {
+      if (c >= 'A' && c <= 'Z') c = static_cast<char>(c + 32);
+    }
+
+    // When: you convert the case
+    shaka::String up(text);
+    shaka::String down(text);
+    up.upcase();
+    down.downcase();
+
+    // Then: the results match a byte by byte conversion
+    ASSERT_EQ(up.get_string(), upper);
+    ASSERT_EQ(down.get_string(), lower);
+  }
+}
+
+/**
+ * @brief Test: searching for characters and substrings
+ */
+TEST(StringUnitTest, index_and_find) {
+  // Given: a long string with a marker near the end
+  std::string text(100, 'a');
+  text += "needle";
+  text += std::string(40, 'a');
+  shaka::String haystack(text);
+
+  // Then: the character and substring are found where std::string finds them
+  ASSERT_EQ(haystack.index_of('n'), text.find('n'));
+  ASSERT_EQ(haystack.find(shaka::String("needle")), text.find("needle"));
+  ASSERT_EQ(haystack.find(shaka::String("")), 0u);
+
+  // Then: missing characters and substrings are reported as npos
+  ASSERT_EQ(haystack.index_of('z'), shaka::string_kernels::npos);
+  ASSERT_EQ(haystack.find(shaka::String("needles")),
+            shaka::string_kernels::npos);
+  ASSERT_EQ(shaka::String("ab").find(shaka::String("abc")),
+            shaka::string_kernels::npos);
+}
+
+/**
+ * @brief Test: ordering agrees with unsigned byte comparison
+ */
+TEST(StringUnitTest, compare) {
+  // Given: strings that differ at every position up to 70
+  std::string base(70, 'm');
+  for (std::size_t i = 0; i < base.size(); ++i) {
+    std::string other = base;
+    other[i] = 'n';
+
+    // Then: the order is decided at the first difference
+    ASSERT_LT(shaka::String(base), shaka::String(other));
+    ASSERT_GT(shaka::String(other), shaka::String(base));
+    ASSERT_NE(shaka::String(base), shaka::String(other));
+  }
+
+  // Then: a prefix orders first, and bytes above 0x7f order last
+  ASSERT_LT(shaka::String("abc"), shaka::String("abcd"));
+  ASSERT_LT(shaka::String("abc"), shaka::String("ab\xe9"));
+  ASSERT_EQ(shaka::String(base), shaka::String(base));
+
+  // Then: case-insensitive comparison folds ASCII letters only
+  ASSERT_EQ(shaka::String(std::string(50, 'x') + "Hello")
+                .compare_ci(shaka::String(std::string(50, 'X') + "hELLO")),
+            0);
+  ASSERT_LT(shaka::String("apple").compare_ci(shaka::String("BANANA")), 0);
+  ASSERT_NE(shaka::String("[").compare_ci(shaka::String("{")), 0);
+}
+
+/**
+ * @brief Test: indexing by character over UTF-8 text
+ */
+TEST(StringUnitTest, utf8_indexing) {
+  // Given: a long string mixing one, two, three and four byte characters
+  const std::u32string chars = U"a\u00e9\u4e2d\U0001F600";
+  std::u32string expected;
+  std::string text;
+  for (std::size_t i = 0; i < 300; ++i) {
+    char32_t c = chars[i % chars.size()];
+    expected += c;
+    shaka::string_kernels::encode_utf8(c, text);
+  }
+  shaka::String str(text);
+
+  // Then: the length counts characters, not bytes
+  ASSERT_EQ(str.length(), expected.size());
+  ASSERT_EQ(str.byte_length(), text.size());
+  ASSERT_FALSE(str.is_ascii());
+
+  // Then: every character can be read by index and by iteration
+  std::u32string iterated;
+  for (char32_t c : str) {
+    iterated += c;
+  }
+  ASSERT_EQ(iterated, expected);
+  for (std::size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_EQ(str.ref(i), expected[i]);
+  }
+  ASSERT_THROW(str.ref(expected.size()), std::out_of_range);
+
+  // Then: searches and substrings use character indices
+  ASSERT_EQ(str.index_of(U'\U0001F600'), 3u);
+  ASSERT_EQ(str.find(shaka::String("\u4e2d\U0001F600a")), 2u);
+  shaka::String part;
+  part.substring(str, 1, 3);
+  ASSERT_EQ(part, shaka::String("\u00e9\u4e2d"));
+}
+
+/**
+ * @brief Test: mutation and append of multi-byte characters
+ */
+TEST(StringUnitTest, utf8_mutation) {
+  // Given: an ASCII string
+  shaka::String str("hello");
+  ASSERT_TRUE(str.is_ascii());
+
+  // When: characters are replaced by wider ones
+  str.set(1, U'\u00e9');
+  str.fill(U'\u4e2d', 3);
+
+  // Then: the indices still refer to characters
+  ASSERT_EQ(str, shaka::String("h\u00e9l\u4e2d\u4e2d"));
+  ASSERT_EQ(str.length(), 5u);
+  ASSERT_EQ(str.ref(4), U'\u4e2d');
+
+  // When: enough multi-byte text is appended to build a rope
+  shaka::String long_str;
+  for (std::size_t i = 0; i < 100; ++i) {
+    long_str.append(shaka::String("\u00e9\u4e2d"));
+  }
+
+  // Then: the rope reports the character count and indexes correctly
+  ASSERT_TRUE(long_str.is_rope());
+  ASSERT_EQ(long_str.length(), 200u);
+  ASSERT_EQ(long_str.ref(199), U'\u4e2d');
+
+  // Then: invalid UTF-8 is replaced with U+FFFD
+  shaka::String invalid("a\xff" "b\xe4\xb8");
+  ASSERT_EQ(invalid.length(), 5u);
+  ASSERT_EQ(invalid.ref(1), U'\ufffd');
+  ASSERT_EQ(invalid.ref(4), U'\ufffd');
+}
+
+/**
+ * @brief Test: set and fill keep every index entry in step with the bytes
+ */
+TEST(StringUnitTest, utf8_splice) {
+  // Given: a long ASCII string and the characters it should hold
+  std::u32string expected(300, U'a');
+  shaka::String str(std::string(300, 'a'));
+
+  // When: characters of every width are set and filled across strides
+  const std::u32string chars = U"b\u00e9\u4e2d\U0001F600";
+  for (std::size_t i = 0; i < 40; ++i) {
+    char32_t c = chars[i % chars.size()];
+    std::size_t position = (i * 97) % expected.size();
+    if (i % 3 == 0) {
+      std::size_t end = std::min(expected.size(), position + i * 5);
+      str.fill(c, position, end);
+      std::fill(expected.begin() + position, expected.begin() + end, c);
+    } else {
+      str.set(position, c);
+      expected[position] = c;
+    }
+
+    // Then: every character reads back by index
+    ASSERT_EQ(str.length(), expected.size());
+    for (std::size_t j = 0; j < expected.size(); ++j) {
+      ASSERT_EQ(str.ref(j), expected[j]);
+    }
+  }
+
+  // Then: a character with no UTF-8 encoding is stored as U+FFFD
+  str.set(5, 0xD800);
+  ASSERT_EQ(str.ref(5), U'\ufffd');
+  ASSERT_EQ(str.ref(6), expected[6]);
+}
+
+/**
+ * @brief Test: the string builtins
+ */
+TEST(StringUnitTest, builtins) {
+  shaka::gc::GC garbage_collector;
+  shaka::gc::init_create_node(garbage_collector);
+  using shaka::create_node;
+  using shaka::String;
+
+  // Given: some strings
+  shaka::NodePtr hello = create_node(String("Hello"));
+  shaka::NodePtr hello_upper = create_node(String("HELLO"));
+
+  // Then: the case conversions return new strings
+  ASSERT_EQ(shaka::string_upcase({hello})[0]->get<String>(), String("HELLO"));
+  ASSERT_EQ(shaka::string_downcase({hello})[0]->get<String>(),
+            String("hello"));
+  ASSERT_EQ(hello->get<String>(), String("Hello"));
+
+  // Then: the searches return an index or #f
+  ASSERT_EQ(shaka::string_index({hello, create_node(String("l"))})[0]
+                ->get<shaka::Number>(), shaka::Number(2));
+  ASSERT_EQ(shaka::string_index({hello, create_node(String("z"))})[0]
+                ->get<shaka::Boolean>(), shaka::Boolean(false));
+  ASSERT_EQ(shaka::string_contains({hello, create_node(String("llo"))})[0]
+                ->get<shaka::Number>(), shaka::Number(2));
+
+  // Then: the comparisons accept any number of strings
+  ASSERT_EQ(shaka::string_equal({hello, hello, hello})[0]
+                ->get<shaka::Boolean>(), shaka::Boolean(true));
+  ASSERT_EQ(shaka::string_equal({hello, hello_upper})[0]
+                ->get<shaka::Boolean>(), shaka::Boolean(false));
+  ASSERT_EQ(shaka::string_ci_equal({hello, hello_upper})[0]
+                ->get<shaka::Boolean>(), shaka::Boolean(true));
+  ASSERT_EQ(shaka::string_less({hello_upper, hello})[0]
+                ->get<shaka::Boolean>(), shaka::Boolean(true));
+
+  // Then: string-length and string-ref count characters
+  shaka::NodePtr unicode = create_node(String("h\u00e9llo"));
+  ASSERT_EQ(shaka::string_length({unicode})[0]->get<shaka::Number>(),
+            shaka::Number(5));
+  ASSERT_EQ(shaka::string_ref({unicode, create_node(shaka::Number(1))})[0]
+                ->get<String>(), String("\u00e9"));
+}
@@ -335,3 +335,34 @@ TEST(ListsUnitTest, append_3_args_success) {
   // Then: the string output is as follows
   ASSERT_EQ(std::string("(a b c #f \"x\" \"y\" . \"z\")"), ss.str());
 }
+
+/**
+ * @brief Test: (append list second) on long lists makes one pair per element
+ */
+TEST(ListsUnitTest, append_long_list_linear) {
+  shaka::gc::GC garbage_collector;
+  shaka::gc::init_create_node(garbage_collector);
+  using namespace shaka;
+
+  // Given: two lists of 100000 numbers each, built with (cons)
+  NodePtr first = core::list();
+  NodePtr second = core::list();
+  for (int i = 0; i < 100000; ++i) {
+    first = core::cons(create_node(Data(Number(i))), first);
+    second = core::cons(create_node(Data(Number(i))), second);
+  }
+  int size = garbage_collector.get_size();
+
+  // When: you call (append) with the two lists
+  NodePtr node = core::append(first, second);
+
+  // Then: only the pairs of the first list are copied, and the elements
+  // and the second list are shared.
+  ASSERT_EQ(garbage_collector.get_size(), size + 100000);
+  ASSERT_EQ(core::car(node), core::car(first));
+  ASSERT_EQ(core::length(node), 200000u);
+  for (int i = 0; i < 100000; ++i) {
+    node = core::cdr(node);
+  }
+  ASSERT_EQ(node, second);
+}
@@ -3,6 +3,7 @@
 //
 #include <gmock/gmock.h>
 #include <shaka_scheme/system/core/types.hpp>
+#include <shaka_scheme/system/core/lists.hpp>
 #include "shaka_scheme/system/gc/GC.hpp"
 #include "shaka_scheme/system/gc/init_gc.hpp"
 
@@ -110,3 +111,132 @@ TEST(TypesUnitTest, is_eqv) {
   ASSERT_FALSE(core::is_eqv(node1, node2));
   ASSERT_FALSE(core::is_eqv(node2, node1));
 }
+
+/**
+ * @brief Test: Testing (equal?)
+ */
+TEST(TypesUnitTest, equal) {
+  shaka::gc::GC garbage_collector;
+  shaka::gc::init_create_node(garbage_collector);
+  using namespace shaka;
+
+  // Given: two distinct lists holding a string, a number and a vector
+  NodePtr vector1 = create_node(Data(Vector(2, create_node(Number(1)))));
+  NodePtr vector2 = create_node(Data(Vector(2, create_node(Number(1)))));
+  NodePtr list1 = core::list(create_node(String("hi")),
+                             create_node(Number(2)), vector1);
+  NodePtr list2 = core::list(create_node(String("hi")),
+                             create_node(Number(2)), vector2);
+  // Given: a list that differs only in its last element
+  NodePtr list3 = core::list(create_node(String("hi")),
+                             create_node(Number(2)), create_node(Number(1)));
+
+  // When: you apply the equivalence
+
+  // Then: it should be true for lists with equal contents.
+  ASSERT_TRUE(core::equal(list1, list2));
+  ASSERT_TRUE(core::equal(vector1, vector2));
+  // Then: it should be false for lists with different contents.
+  ASSERT_FALSE(core::equal(list1, list3));
+  ASSERT_FALSE(core::equal(list1, core::cdr(list2)));
+}
+
+/**
+ * @brief Test: (equal?) on long lists does not allocate
+ */
+TEST(TypesUnitTest, equal_long_list) {
+  shaka::gc::GC garbage_collector;
+  shaka::gc::init_create_node(garbage_collector);
+  using namespace shaka;
+
+  // Given: two distinct lists of 200000 numbers
+  NodePtr list1 = core::list(create_node(Number(0)));
+  NodePtr list2 = core::list(create_node(Number(0)));
+  NodePtr last1 = list1;
+  NodePtr last2 = list2;
+  for (int i = 1; i < 200000; ++i) {
+    core::set_cdr(last1, core::list(create_node(Number(i))));
+    core::set_cdr(last2, core::list(create_node(Number(i))));
+    last1 = core::cdr(last1);
+    last2 = core::cdr(last2);
+  }
+  int size = garbage_collector.get_size();
+
+  // When: you apply the equivalence
+
+  // Then: it should be true, without creating any nodes.
+  ASSERT_TRUE(core::equal(list1, list2));
+  ASSERT_EQ(garbage_collector.get_size(), size);
+  // Then: it should be false once the last element differs.
+  core::set_car(last2, create_node(Number(-1)));
+  ASSERT_FALSE(core::equal(list1, list2));
+}
+
+/**
+ * @brief Test: (equal?) terminates on cyclic structure
+ */
+TEST(TypesUnitTest, equal_cyclic) {
+  shaka::gc::GC garbage_collector;
+  shaka::gc::init_create_node(garbage_collector);
+  using namespace shaka;
+
+  // Given: a cycle of (1 2) and a cycle of (1 2 1 2), which unfold to the
+  // same infinite list
+  NodePtr cycle1 = core::list(create_node(Number(1)), create_node(Number(2)));
+  core::set_cdr(core::cdr(cycle1), cycle1);
+  NodePtr cycle2 = core::list(create_node(Number(1)), create_node(Number(2)),
+                              create_node(Number(1)), create_node(Number(2)));
+  core::set_cdr(core::cdr(core::cdr(core::cdr(cycle2))), cycle2);
+  // Given: a cycle of (1 3)
+  NodePtr cycle3 = core::list(create_node(Number(1)), create_node(Number(3)));
+  core::set_cdr(core::cdr(cycle3), cycle3);
+
+  // When: you apply the equivalence
+
+  // Then: it should be true for the cycles that unfold alike.
+  ASSERT_TRUE(core::equal(cycle1, cycle2));
+  // Then: it should be false for the cycles that do not.
+  ASSERT_FALSE(core::equal(cycle1, cycle3));
+}
+
+/**
+ * @brief Test: (equal?) on long cycles and self-referential vectors, which
+ * take several fast walks and union-find stretches to settle
+ */
+TEST(TypesUnitTest, equal_long_cyclic) {
+  shaka::gc::GC garbage_collector;
+  shaka::gc::init_create_node(garbage_collector);
+  using namespace shaka;
+
+  // Given: cycles of 5000 and 10000 numbers that unfold to the same list
+  auto make_cycle = [](int length, int last) {
+    NodePtr first = core::list(create_node(Number(0)));
+    NodePtr end = first;
+    for (int i = 1; i < length; ++i) {
+      int value = i == length - 1 ? last : i % 5000;
+      core::set_cdr(end, core::list(create_node(Number(value))));
+      end = core::cdr(end);
+    }
+    core::set_cdr(end, first);
+    return first;
+  };
+  NodePtr cycle1 = make_cycle(5000, 4999);
+  NodePtr cycle2 = make_cycle(10000, 4999);
+  // Given: a cycle of 10000 numbers whose last element differs
+  NodePtr cycle3 = make_cycle(10000, -1);
+
+  // Then: the cycles that unfold alike are equal, and the other is not.
+  ASSERT_TRUE(core::equal(cycle1, cycle2));
+  ASSERT_FALSE(core::equal(cycle1, cycle3));
+
+  // Given: two vectors that each hold themselves twice, #0=#(#0# #0#)
+  NodePtr vector1 = create_node(Vector(2));
+  vector1->get<Vector>()[0] = vector1;
+  vector1->get<Vector>()[1] = vector1;
+  NodePtr vector2 = create_node(Vector(2));
+  vector2->get<Vector>()[0] = vector2;
+  vector2->get<Vector>()[1] = vector2;
+
+  // Then: they are equal, although unfolding them doubles at every level.
+  ASSERT_TRUE(core::equal(vector1, vector2));
+}
@@ -8,6 +8,7 @@
 #include "shaka_scheme/system/gc/init_gc.hpp"
 #include "shaka_scheme/system/base/Data.hpp"
 #include "shaka_scheme/system/gc/GCNode.hpp"
+#include "shaka_scheme/system/gc/make_node.hpp"
 
 TEST(GCInitUnitTest, test_initialize_create_node) {
   // Given: You have created a GC object
@@ -30,4 +31,56 @@ TEST(GCInitUnitTest, test_initialize_create_node) {
   // before
 
   ASSERT_EQ(number->get<shaka::Number>(), shaka::Number(5));
-}
\ No newline at end of file
+}
+TEST(GCInitUnitTest, test_make_node) {
+  // Given: You have bound a GC object to the calling thread
+
+  shaka::gc::GC garbage_collector;
+  shaka::gc::HeapScope scope(garbage_collector);
+
+  // When: You use the typed allocators
+
+  shaka::NodePtr number = shaka::make_number(shaka::Number(5));
+  shaka::NodePtr symbol = shaka::make_symbol("a");
+  shaka::NodePtr boolean = shaka::make_boolean(true);
+  shaka::NodePtr null = shaka::make_null();
+  shaka::NodePtr pair = shaka::make_pair(number, null);
+  shaka::NodePtr string = shaka::make_node(shaka::String("abc"));
+
+  // Then: Every one of them was allocated from the bound GC
+
+  ASSERT_EQ(garbage_collector.get_size(), 6);
+
+  // Then: They hold what create_node would have made from the same values
+
+  ASSERT_EQ(number->get<shaka::Number>(), shaka::Number(5));
+  ASSERT_EQ(symbol->get<shaka::Symbol>(), shaka::Symbol("a"));
+  ASSERT_EQ(boolean->get<shaka::Boolean>(), shaka::Boolean(true));
+  ASSERT_EQ(null->get_type(), shaka::Data::Type::NULL_LIST);
+  ASSERT_EQ(pair->get<shaka::DataPair>().car(), number);
+  ASSERT_EQ(pair->get<shaka::DataPair>().cdr(), null);
+  ASSERT_EQ(string->get<shaka::String>(), shaka::String("abc"));
+}
+
+TEST(GCInitUnitTest, test_make_node_heap_scope) {
+  // Given: You have bound a GC object to the calling thread
+
+  shaka::gc::GC outer;
+  shaka::gc::init_create_node(outer);
+
+  // When: You allocate inside and after a HeapScope of another GC
+
+  shaka::gc::GC inner;
+  {
+    shaka::gc::HeapScope scope(inner);
+    shaka::make_number(shaka::Number(1));
+    ASSERT_EQ(shaka::gc::get_current_gc(), &inner);
+  }
+  shaka::make_number(shaka::Number(2));
+
+  // Then: Each allocation went to the GC bound at the time
+
+  ASSERT_EQ(inner.get_size(), 1);
+  ASSERT_EQ(outer.get_size(), 1);
+  ASSERT_EQ(shaka::gc::get_current_gc(), &outer);
+}
@@ -0,0 +1,82 @@
+#include <gmock/gmock.h>
+#include "shaka_scheme/system/gc/GC.hpp"
+#include "shaka_scheme/system/gc/init_gc.hpp"
+#include "shaka_scheme/system/vm/CallFrame.hpp"
+
+/**
+ * @Test: mark_call_frame() marks every frame below the one given
+ */
+
+TEST(GCMarkCallFrameTest, mark_call_frame_chain) {
+
+    // Given: You have constructed a GC and bound it to create_node
+
+    shaka::gc::GC garbage_collector;
+    shaka::gc::init_create_node(garbage_collector);
+
+    // Given: A frame below another, whose expression, environment, value
+    // rib and procedure each hold a node
+
+    shaka::NodePtr expression = shaka::create_node(shaka::Symbol("halt"));
+    shaka::NodePtr bound = shaka::create_node(shaka::String("bound"));
+    shaka::NodePtr argument = shaka::create_node(shaka::String("argument"));
+    shaka::NodePtr procedure = shaka::create_node(shaka::String("procedure"));
+    shaka::EnvPtr parent = std::make_shared<shaka::Environment>(nullptr);
+    parent->set_value(shaka::Symbol("x"), bound);
+    shaka::EnvPtr env = std::make_shared<shaka::Environment>(parent);
+    shaka::FramePtr bottom = std::make_shared<shaka::CallFrame>(
+        expression, env, shaka::ValueRib{argument}, nullptr);
+    bottom->set_procedure(procedure, 1);
+    shaka::FramePtr top = std::make_shared<shaka::CallFrame>(
+        shaka::create_node(shaka::Symbol("return")), nullptr,
+        shaka::ValueRib(), bottom);
+
+    // Given: A node that nothing refers to
+
+    shaka::create_node(shaka::String("garbage"));
+    ASSERT_EQ(garbage_collector.get_size(), 6);
+
+    // When: You invoke mark_call_frame on the top frame, and then run a
+    // sweep
+
+    shaka::gc::mark_call_frame(*top);
+    garbage_collector.sweep();
+
+    // Then: Only the unreferenced node was freed
+
+    ASSERT_EQ(garbage_collector.get_size(), 5);
+}
+
+/**
+ * @Test: marking a stepping native procedure marks what it holds between
+ * steps
+ */
+
+TEST(GCMarkCallFrameTest, mark_stepping_roots) {
+
+    // Given: You have constructed a GC and bound it to create_node
+
+    shaka::gc::GC garbage_collector;
+    shaka::gc::init_create_node(garbage_collector);
+
+    // Given: A stepping closure that holds on to a node
+
+    shaka::NodePtr held = shaka::create_node(shaka::String("held"));
+    shaka::NodePtr closure = shaka::create_node(shaka::Closure(
+        std::make_shared<shaka::SteppingCallable>([](shaka::ValueRib) {
+          return shaka::NativeStep();
+        }), false,
+        std::make_shared<shaka::SteppingRoots>([held]() {
+          return shaka::ValueRib{held};
+        })));
+    ASSERT_EQ(garbage_collector.get_size(), 2);
+
+    // When: You mark the closure, and then run a sweep
+
+    shaka::gc::mark_node(closure);
+    garbage_collector.sweep();
+
+    // Then: The held node is still there
+
+    ASSERT_EQ(garbage_collector.get_size(), 2);
+}
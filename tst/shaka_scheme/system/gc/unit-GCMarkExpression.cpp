@@ -25,9 +25,9 @@ TEST(GCMarkExpressionTest, mark_expression) {
     shaka::DataPair instruction_pair(instruction_data);
     shaka::NodePtr exp = shaka::create_node(instruction_pair);
 
-    // Then: The number of objects in the GC's managed memory is 9
+    // Then: The number of objects in the GC's managed memory is 3
 
-    ASSERT_EQ(garbage_collector.get_size(), 9);
+    ASSERT_EQ(garbage_collector.get_size(), 3);
 
     // When: You invoke mark_expression, and then run a sweep
 
@@ -0,0 +1,100 @@
+#include <gmock/gmock.h>
+#include "shaka_scheme/system/gc/GC.hpp"
+#include "shaka_scheme/system/gc/init_gc.hpp"
+
+/**
+ * @Test: sweep() removes the entries of a weak hash table whose keys are
+ * only reachable through the table
+ */
+TEST(GCMarkWeakUnitTest, weak_hash_table) {
+
+  // Given: You have constructed a GC and bound it to create_node
+  shaka::gc::GC garbage_collector;
+  shaka::gc::init_create_node(garbage_collector);
+
+  // Given: A weak table with a live key, a key that is held by a strong
+  // table, and a key that is only held by the weak table
+  shaka::NodePtr table = shaka::create_node(shaka::HashTable(
+      shaka::HashTable::Equivalence::EQ, 0, true));
+  shaka::NodePtr strong = shaka::create_node(shaka::HashTable(
+      shaka::HashTable::Equivalence::EQ));
+  shaka::NodePtr live_key = shaka::create_node(shaka::DataPair(
+      shaka::create_node(shaka::Number(1))));
+  shaka::NodePtr held_key = shaka::create_node(shaka::DataPair(
+      shaka::create_node(shaka::Number(2))));
+  shaka::NodePtr dead_key = shaka::create_node(shaka::DataPair(
+      shaka::create_node(shaka::Number(3))));
+  shaka::HashTable& weak = table->get<shaka::HashTable>();
+  weak.set(live_key, shaka::create_node(shaka::String("a")));
+  weak.set(held_key, shaka::create_node(shaka::String("b")));
+  weak.set(dead_key, shaka::create_node(shaka::String("c")));
+  strong->get<shaka::HashTable>().set(live_key, held_key);
+
+  // When: You mark both tables and the live key, then run a sweep
+  shaka::gc::mark_node(table);
+  shaka::gc::mark_node(strong);
+  shaka::gc::mark_node(live_key);
+  garbage_collector.sweep();
+
+  // Then: Only the entries of the reachable keys are left, and their
+  // values survived
+  ASSERT_EQ(weak.size(), 2u);
+  ASSERT_EQ(weak.get(live_key)->get<shaka::String>(), shaka::String("a"));
+  ASSERT_EQ(weak.get(held_key)->get<shaka::String>(), shaka::String("b"));
+}
+
+/**
+ * @Test: An ephemeron whose datum refers back to its key does not keep the
+ * key alive
+ */
+TEST(GCMarkWeakUnitTest, ephemeron_cycle) {
+
+  // Given: You have constructed a GC and bound it to create_node
+  shaka::gc::GC garbage_collector;
+  shaka::gc::init_create_node(garbage_collector);
+
+  // Given: An ephemeron whose datum is a pair holding the key
+  shaka::NodePtr key = shaka::create_node(shaka::Symbol("key"));
+  shaka::NodePtr datum = shaka::create_node(shaka::DataPair(key));
+  shaka::NodePtr ephemeron = shaka::create_node(
+      shaka::Ephemeron(key, datum));
+
+  // When: You mark only the ephemeron, then run a sweep
+  shaka::gc::mark_node(ephemeron);
+  garbage_collector.sweep();
+
+  // Then: The ephemeron is broken
+  ASSERT_TRUE(ephemeron->get<shaka::Ephemeron>().is_broken());
+  ASSERT_FALSE(ephemeron->get<shaka::Ephemeron>().get_key());
+}
+
+/**
+ * @Test: Marking the datum of one ephemeron can make the key of another
+ * reachable
+ */
+TEST(GCMarkWeakUnitTest, ephemeron_chain) {
+
+  // Given: You have constructed a GC and bound it to create_node
+  shaka::gc::GC garbage_collector;
+  shaka::gc::init_create_node(garbage_collector);
+
+  // Given: Two ephemerons, where the datum of the second is the key of the
+  // first, and only the key of the second is a root
+  shaka::NodePtr k1 = shaka::create_node(shaka::Symbol("k1"));
+  shaka::NodePtr k2 = shaka::create_node(shaka::Symbol("k2"));
+  shaka::NodePtr value = shaka::create_node(shaka::Number(42));
+  shaka::NodePtr e1 = shaka::create_node(shaka::Ephemeron(k1, value));
+  shaka::NodePtr e2 = shaka::create_node(shaka::Ephemeron(k2, k1));
+
+  // When: You mark both ephemerons and the second key, then run a sweep
+  shaka::gc::mark_node(e1);
+  shaka::gc::mark_node(e2);
+  shaka::gc::mark_node(k2);
+  garbage_collector.sweep();
+
+  // Then: Neither ephemeron is broken, and the value survived
+  ASSERT_FALSE(e1->get<shaka::Ephemeron>().is_broken());
+  ASSERT_FALSE(e2->get<shaka::Ephemeron>().is_broken());
+  ASSERT_EQ(e1->get<shaka::Ephemeron>().get_datum()->get<shaka::Number>(),
+            shaka::Number(42));
+}
@@ -0,0 +1,155 @@
+#include <gmock/gmock.h>
+#include "shaka_scheme/system/base/Data.hpp"
+#include "shaka_scheme/system/core/lists.hpp"
+#include "shaka_scheme/system/gc/GC.hpp"
+#include "shaka_scheme/system/gc/init_gc.hpp"
+#include "shaka_scheme/system/gc/Message.hpp"
+
+using namespace shaka;
+
+/**
+ * @Test: deep_copy preserves shared structure and cycles
+ */
+TEST(GCMessageUnitTest, deep_copy_shared_structure) {
+
+    // Given: A GC bound to create_node
+
+    gc::GC garbage_collector;
+    gc::init_create_node(garbage_collector);
+
+    // Given: A circular list #0=(a . #0#) and a vector holding it twice
+
+    NodePtr cycle = core::list(create_node(Symbol("a")));
+    core::set_cdr(cycle, cycle);
+    NodePtr vector = create_node(Vector(2));
+    vector->get<Vector>()[0] = cycle;
+    vector->get<Vector>()[1] = cycle;
+
+    // When: You deep copy the vector
+
+    NodePtr copy = gc::deep_copy(vector);
+
+    // Then: The copy is a different vector whose elements are one shared pair
+
+    ASSERT_NE(copy, vector);
+    NodePtr first = copy->get<Vector>()[0];
+    ASSERT_NE(first, cycle);
+    ASSERT_EQ(first, copy->get<Vector>()[1]);
+
+    // Then: The pair still points back to itself
+
+    ASSERT_EQ(core::cdr(first), first);
+    ASSERT_EQ(core::car(first)->get<Symbol>(), Symbol("a"));
+}
+
+/**
+ * @Test: deep_copy refuses to copy procedures
+ */
+TEST(GCMessageUnitTest, deep_copy_closure) {
+    gc::GC garbage_collector;
+    gc::init_create_node(garbage_collector);
+
+    // Given: A list that holds a closure
+
+    NodePtr list = core::list(create_node(Closure()));
+
+    // When: You deep copy the list
+    // Then: A TypeException is thrown
+
+    ASSERT_THROW(gc::deep_copy(list), TypeException);
+}
+
+/**
+ * @Test: A Message transfers its private heap to the receiving GC
+ */
+TEST(GCMessageUnitTest, adopt) {
+
+    // Given: A sender heap and a receiver heap
+
+    gc::GC sender;
+    gc::GC receiver;
+    gc::init_create_node(sender);
+
+    // Given: The list (1 2 3) in the sender heap
+
+    NodePtr list = core::list(create_node(Number(1)),
+                              create_node(Number(2)),
+                              create_node(Number(3)));
+    int sender_size = sender.get_size();
+
+    // When: You construct a Message from the list
+
+    gc::Message message(list);
+
+    // Then: The copy was not allocated in the sender heap
+
+    ASSERT_EQ(sender.get_size(), sender_size);
+
+    // When: The receiver adopts the message
+
+    NodePtr received = message.adopt(receiver);
+
+    // Then: The receiver owns a copy of the list
+
+    ASSERT_GT(receiver.get_size(), 0);
+    ASSERT_NE(received, list);
+    ASSERT_EQ(core::length(received), 3);
+    ASSERT_EQ(core::car(core::cdr(received))->get<Number>(), Number(2));
+}
+
+/**
+ * @Test: deep_copy copies the entries of hash tables and ephemerons
+ */
+TEST(GCMessageUnitTest, deep_copy_table_and_ephemeron) {
+    gc::GC garbage_collector;
+    gc::init_create_node(garbage_collector);
+
+    // Given: An equal? table from the list (1 2) to an ephemeron whose key
+    // is that same list
+
+    NodePtr key = core::list(create_node(Number(1)), create_node(Number(2)));
+    NodePtr ephemeron = create_node(Ephemeron(key, create_node(Symbol("v"))));
+    NodePtr table = create_node(HashTable(HashTable::Equivalence::EQUAL));
+    table->get<HashTable>().set(key, ephemeron);
+
+    // When: You deep copy the table
+
+    NodePtr copy = gc::deep_copy(table);
+
+    // Then: The copy has its own entry, found by an equal key
+
+    ASSERT_NE(copy, table);
+    HashTable& copied = copy->get<HashTable>();
+    ASSERT_EQ(copied.size(), 1u);
+    ASSERT_EQ(copied.get_equivalence(), HashTable::Equivalence::EQUAL);
+    NodePtr lookup = core::list(create_node(Number(1)),
+                                create_node(Number(2)));
+    NodePtr value = copied.get(lookup);
+    ASSERT_TRUE(value);
+
+    // Then: The ephemeron was copied too, and its key is the copied key
+
+    ASSERT_NE(value, ephemeron);
+    NodePtr copied_key = copied.entries()[0].first;
+    ASSERT_NE(copied_key, key);
+    ASSERT_EQ(value->get<Ephemeron>().get_key(), copied_key);
+    ASSERT_EQ(value->get<Ephemeron>().get_datum()->get<Symbol>(),
+              Symbol("v"));
+}
+
+/**
+ * @Test: deep_copy refuses to copy ports
+ */
+TEST(GCMessageUnitTest, deep_copy_port) {
+    gc::GC garbage_collector;
+    gc::init_create_node(garbage_collector);
+
+    // Given: A list that holds a port
+
+    NodePtr list = core::list(create_node(Port::open_output_memory(false)));
+
+    // When: You deep copy the list
+    // Then: A TypeException is thrown
+
+    ASSERT_THROW(gc::deep_copy(list), TypeException);
+}
@@ -0,0 +1,178 @@
+#include <gmock/gmock.h>
+#include "shaka_scheme/system/serialization/fasl.hpp"
+#include "shaka_scheme/system/core/lists.hpp"
+#include "shaka_scheme/system/core/types.hpp"
+#include "shaka_scheme/system/lexer/rules/init.hpp"
+#include "shaka_scheme/system/parser/parser_definitions.hpp"
+#include "shaka_scheme/system/gc/GC.hpp"
+#include "shaka_scheme/system/gc/init_gc.hpp"
+
+#include <limits>
+#include <sstream>
+
+using namespace shaka;
+
+namespace {
+
+NodePtr parse(const std::string& str) {
+  parser::ParserInput input(str);
+  return parser::parse_datum(input).it;
+}
+
+std::string to_string(NodePtr node) {
+  std::stringstream ss;
+  ss << *node;
+  return ss.str();
+}
+
+} // namespace
+
+/**
+ * @brief Test: data round-trips through encode and decode
+ */
+TEST(FaslUnitTest, round_trip) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+
+  // Given: Data of every supported type
+  NodePtr datum = parse(
+      "(0 -1 1000000 3/4 -2.5 \"str\" #t #f () sym sym"
+      " #(1 (2 . 3) #()) (a b . c))");
+  datum = core::cons(create_node(Number(std::numeric_limits<int>::max())),
+                     core::cons(create_node(Number(
+                         std::numeric_limits<int>::min())), datum));
+  Bytevector bytes{0, 127, 255};
+  NodePtr bytevector = create_node(bytes);
+
+  // When: You encode and decode them
+  NodePtr decoded = fasl::decode(fasl::encode(datum));
+  NodePtr decoded_bytes = fasl::decode(fasl::encode(bytevector));
+
+  // Then: The results are equal to the originals
+  ASSERT_TRUE(core::equal(decoded, datum));
+  ASSERT_EQ(to_string(decoded), to_string(datum));
+  ASSERT_TRUE(core::equal(decoded_bytes, bytevector));
+  ASSERT_EQ(fasl::decode(fasl::encode(create_unspecified()))->get_type(),
+            Data::Type::UNSPECIFIED);
+}
+
+/**
+ * @brief Test: shared structure and cycles are kept
+ */
+TEST(FaslUnitTest, sharing_and_cycles) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+
+  // Given: A cyclic list, a vector holding itself, and a shared string
+  NodePtr cycle = core::list(create_node(Number(1)), create_node(Number(2)));
+  core::set_cdr(core::cdr(cycle), cycle);
+  NodePtr vector = create_node(Vector(2));
+  vector->get<Vector>()[0] = vector;
+  NodePtr text = create_node(String("shared"));
+  vector->get<Vector>()[1] = text;
+  NodePtr datum = core::list(cycle, vector, text, cycle);
+
+  // When: You encode and decode them
+  NodePtr decoded = fasl::decode(fasl::encode(datum));
+
+  // Then: The decoded objects are shared in the same way
+  NodePtr decoded_cycle = core::car(decoded);
+  ASSERT_EQ(core::cdr(core::cdr(decoded_cycle)), decoded_cycle);
+  ASSERT_EQ(core::car(core::cdr(core::cdr(core::cdr(decoded)))),
+            decoded_cycle);
+  NodePtr decoded_vector = core::car(core::cdr(decoded));
+  ASSERT_EQ(decoded_vector->get<Vector>()[0], decoded_vector);
+  ASSERT_EQ(decoded_vector->get<Vector>()[1],
+            core::car(core::cdr(core::cdr(decoded))));
+  ASSERT_TRUE(core::equal(decoded, datum));
+
+  // Given: A pair in the middle of a list that is shared
+  NodePtr middle = core::list(create_node(Number(2)), create_node(Number(3)));
+  NodePtr list = core::cons(create_node(Number(1)), middle);
+  NodePtr pair = core::cons(list, middle);
+  NodePtr decoded_pair = fasl::decode(fasl::encode(pair));
+
+  // Then: It is still shared
+  ASSERT_EQ(core::cdr(core::car(decoded_pair)), core::cdr(decoded_pair));
+  ASSERT_EQ(to_string(decoded_pair), "((1 2 3) 2 3)");
+}
+
+/**
+ * @brief Test: long lists are written as one record, without recursion
+ */
+TEST(FaslUnitTest, long_list) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+
+  // Given: A list of 200000 small integers
+  NodePtr list = core::list();
+  for (int i = 0; i < 200000; ++i) {
+    list = core::cons(create_node(Number(i % 64)), list);
+  }
+
+  // When: You encode it
+  std::string bytes = fasl::encode(list);
+
+  // Then: It takes about a byte per element, and decodes to an equal list
+  ASSERT_LT(bytes.size(), 200000u * 2 + 32);
+  ASSERT_TRUE(core::equal(fasl::decode(bytes), list));
+}
+
+/**
+ * @brief Test: a stream holds several data, read one at a time
+ */
+TEST(FaslUnitTest, streaming) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+
+  // When: You write three data to one stream
+  std::stringstream stream;
+  fasl::Writer writer(stream);
+  writer.write(parse("(a b)"));
+  writer.write(create_node(Number(42)));
+  writer.write(parse("(a c)"));
+
+  // Then: They are read back in order, followed by the end of the stream
+  fasl::Reader reader(stream);
+  NodePtr datum;
+  ASSERT_TRUE(reader.read(datum));
+  ASSERT_EQ(to_string(datum), "(a b)");
+  ASSERT_TRUE(reader.read(datum));
+  ASSERT_EQ(datum->get<Number>(), Number(42));
+  ASSERT_TRUE(reader.read(datum));
+  ASSERT_EQ(to_string(datum), "(a c)");
+  ASSERT_FALSE(reader.read(datum));
+}
+
+/**
+ * @brief Test: unsupported objects and malformed input throw
+ */
+TEST(FaslUnitTest, errors) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+
+  // Then: Procedures cannot be written
+  NodePtr closure = create_node(Closure([](std::deque<NodePtr> args) {
+    return args;
+  }, true));
+  ASSERT_THROW(fasl::encode(core::list(closure)), InvalidInputException);
+
+  // Then: Every truncation of an encoding throws
+  std::string bytes = fasl::encode(parse("(1 \"two\" #(3 x) x 4.5)"));
+  for (std::size_t size = 0; size < bytes.size(); ++size) {
+    ASSERT_THROW(fasl::decode(bytes.substr(0, size)), InvalidInputException);
+  }
+
+  // Then: A vector claiming more elements than the stream holds throws
+  std::string empty_vector = fasl::encode(parse("#()"));
+  ASSERT_EQ(empty_vector.back(), '\0');
+  empty_vector.pop_back();
+  ASSERT_THROW(fasl::decode(empty_vector + "\xff\xff\xff\xff\x0f"),
+               InvalidInputException);
+
+  // Then: A stream without the header throws
+  ASSERT_THROW(fasl::decode("not fasl"), InvalidInputException);
+}
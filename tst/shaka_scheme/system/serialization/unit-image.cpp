@@ -0,0 +1,131 @@
+#include <gmock/gmock.h>
+#include "shaka_scheme/system/serialization/image.hpp"
+#include "shaka_scheme/runtime/stdproc/numbers_arithmetic.hpp"
+#include "shaka_scheme/runtime/stdproc/pairs_and_lists.hpp"
+#include "shaka_scheme/system/vm/compiler/Compiler.hpp"
+#include "shaka_scheme/system/vm/HeapVirtualMachine.hpp"
+#include "shaka_scheme/system/lexer/rules/init.hpp"
+#include "shaka_scheme/system/parser/parser_definitions.hpp"
+#include "shaka_scheme/system/core/lists.hpp"
+#include "shaka_scheme/system/gc/GC.hpp"
+#include "shaka_scheme/system/gc/init_gc.hpp"
+
+#include <cstdio>
+#include <sstream>
+
+using namespace shaka;
+
+namespace {
+
+NodePtr evaluate(const std::string& str, EnvPtr env) {
+  parser::ParserInput input(str);
+  Compiler compiler;
+  HeapVirtualMachine hvm(nullptr, nullptr, env, ValueRib(), nullptr);
+  return hvm.run(compiler.compile(parser::parse_datum(input).it));
+}
+
+std::string to_string(NodePtr node) {
+  std::stringstream ss;
+  ss << *node;
+  return ss.str();
+}
+
+/**
+ * @brief Makes the natives the way a program would at startup, and gives
+ * them ids.
+ */
+EnvPtr make_natives(image::NativeTable& natives) {
+  EnvPtr env = std::make_shared<Environment>(nullptr);
+  env->set_value(Symbol("*"), create_node(Closure(stdproc::mul, true)));
+  env->set_value(Symbol("car"), create_node(Closure(stdproc::car, false)));
+  env->set_value(Symbol("define"), create_node(PrimitiveFormMarker("define")));
+  natives.add_environment(env);
+  return env;
+}
+
+} // namespace
+
+/**
+ * @brief Test: an image keeps compiled procedures, data and natives
+ */
+TEST(ImageUnitTest, save_and_load) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+
+  // Given: A top level with natives, compiled procedures and data
+  image::NativeTable natives;
+  EnvPtr env = make_natives(natives);
+  evaluate("(define square (lambda (x) (* x x)))", env);
+  evaluate("(define first (lambda (l) (car l)))", env);
+  evaluate("(define data '(1 2/3 4.5 \"five\" #t sym #(6 7) ()))", env);
+  NodePtr cycle = core::list(create_node(Number(1)), create_node(Number(2)));
+  core::set_cdr(core::cdr(cycle), cycle);
+  env->set_value(Symbol("cycle"), cycle);
+  env->set_value(Symbol("same"), core::list(cycle, cycle));
+
+  // When: You save it, and load it with natives made anew
+  const std::string path = "unit-image.img";
+  image::save_image(path, env, natives);
+  image::NativeTable fresh_natives;
+  EnvPtr fresh_env = make_natives(fresh_natives);
+  EnvPtr loaded = image::load_image(path, fresh_natives);
+  std::remove(path.c_str());
+
+  // Then: The procedures run, and call the natives of the new program
+  ASSERT_EQ(evaluate("(square 7)", loaded)->get<Number>(), Number(49));
+  ASSERT_EQ(evaluate("(first data)", loaded)->get<Number>(), Number(1));
+  ASSERT_EQ(loaded->get_value(Symbol("car")),
+            fresh_env->get_value(Symbol("car")));
+
+  // Then: The data is equal, and sharing and cycles are kept
+  ASSERT_EQ(to_string(loaded->get_value(Symbol("data"))),
+            to_string(env->get_value(Symbol("data"))));
+  NodePtr loaded_cycle = loaded->get_value(Symbol("cycle"));
+  ASSERT_EQ(core::cdr(core::cdr(loaded_cycle)), loaded_cycle);
+  NodePtr same = loaded->get_value(Symbol("same"));
+  ASSERT_EQ(core::car(same), loaded_cycle);
+  ASSERT_EQ(core::car(core::cdr(same)), loaded_cycle);
+
+  // When: You define more in the loaded top level
+  evaluate("(define cube (lambda (x) (* x (square x))))", loaded);
+
+  // Then: The original top level is unchanged
+  ASSERT_EQ(evaluate("(cube 2)", loaded)->get<Number>(), Number(8));
+  ASSERT_FALSE(env->is_defined(Symbol("cube")));
+}
+
+/**
+ * @brief Test: images that cannot be written or read are rejected
+ */
+TEST(ImageUnitTest, errors) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+
+  image::NativeTable natives;
+  EnvPtr env = make_natives(natives);
+  std::string image = image::write_image(env, natives);
+
+  // Then: A truncated or corrupted image throws
+  for (std::size_t size = 0; size < image.size(); ++size) {
+    ASSERT_THROW(image::read_image(image.data(), size, natives),
+                 InvalidInputException);
+  }
+  std::string corrupted = image;
+  corrupted[0] = 'X';
+  ASSERT_THROW(image::read_image(corrupted.data(), corrupted.size(), natives),
+               InvalidInputException);
+
+  // Then: Loading without the natives of the image throws
+  image::NativeTable empty;
+  ASSERT_THROW(image::read_image(image.data(), image.size(), empty),
+               InvalidInputException);
+
+  // Then: Saving a native procedure without an id throws
+  env->set_value(Symbol("cdr"), create_node(Closure(stdproc::cdr, false)));
+  ASSERT_THROW(image::write_image(env, natives), InvalidInputException);
+
+  // Then: A missing file throws
+  ASSERT_THROW(image::load_image("unit-image-missing.img", natives),
+               InvalidInputException);
+}
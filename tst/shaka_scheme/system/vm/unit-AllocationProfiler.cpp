@@ -0,0 +1,161 @@
+#include <gmock/gmock.h>
+#include "shaka_scheme/system/vm/AllocationProfiler.hpp"
+#include "shaka_scheme/system/vm/HeapVirtualMachine.hpp"
+#include "shaka_scheme/system/vm/Scheduler.hpp"
+#include "shaka_scheme/system/vm/compiler/Compiler.hpp"
+#include "shaka_scheme/system/lexer/rules/init.hpp"
+#include "shaka_scheme/system/parser/parser_definitions.hpp"
+#include "shaka_scheme/runtime/stdproc/pairs_and_lists.hpp"
+#include "shaka_scheme/system/exceptions/InvalidInputException.hpp"
+#include "shaka_scheme/system/gc/GC.hpp"
+#include "shaka_scheme/system/gc/init_gc.hpp"
+
+#include <sstream>
+
+using namespace shaka;
+
+namespace {
+
+Expression compile_string(const std::string& str) {
+  parser::ParserInput input(str);
+  Compiler compiler;
+  return compiler.compile(parser::parse_datum(input).it);
+}
+
+} // namespace
+
+/**
+ * @brief Test: allocations are attributed to the Scheme procedure and the
+ * C++ function that made them
+ */
+TEST(AllocationProfilerUnitTest, sites) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+
+  // Given: A procedure that allocates a pair with cons
+  EnvPtr env = std::make_shared<Environment>(nullptr);
+  env->set_value(Symbol("cons"), create_node(Closure(stdproc::cons, false)));
+  HeapVirtualMachine hvm(nullptr, nullptr, env, ValueRib(), nullptr);
+  Expression definition =
+      compile_string("(define make-pair (lambda (x) (cons x x)))");
+  Expression call = compile_string("(make-pair 1)");
+  hvm.run(definition);
+
+  // When: It is run three times while profiling
+  AllocationProfiler profiler;
+  profiler.start();
+  ASSERT_TRUE(profiler.is_running());
+  for (int i = 0; i < 3; ++i) {
+    hvm.run(call);
+  }
+  profiler.stop();
+
+  // Then: The pairs made by cons are attributed to make-pair and to the
+  // native procedure, and nothing to the GC
+  ASSERT_FALSE(profiler.is_running());
+  std::size_t pairs = 0;
+  for (const AllocationProfiler::Site& site : profiler.get_sites()) {
+    ASSERT_GT(site.count, 0u);
+    ASSERT_EQ(site.bytes % site.count, 0u);
+    ASSERT_NE(site.caller.find("shaka::gc::"), 0u);
+    if (site.procedure == "make-pair" &&
+        site.type == Data::Type::DATA_PAIR &&
+        site.caller.find("stdproc::impl::cons") != std::string::npos) {
+      pairs += site.count;
+    }
+  }
+  ASSERT_EQ(pairs, 3u);
+  ASSERT_GE(profiler.get_allocation_count(), 3u);
+  ASSERT_GE(profiler.get_allocated_bytes(),
+            profiler.get_allocation_count() * sizeof(gc::GCData));
+
+  // When: Allocating after the profiler is stopped
+  std::size_t count = profiler.get_allocation_count();
+  create_node(Data(Symbol("x")));
+
+  // Then: Nothing more is recorded
+  ASSERT_EQ(profiler.get_allocation_count(), count);
+
+  // Then: The report lists the site
+  std::ostringstream report;
+  profiler.write_report(report);
+  ASSERT_NE(report.str().find("Sites by count"), std::string::npos);
+  ASSERT_NE(report.str().find("Sites by bytes"), std::string::npos);
+  ASSERT_NE(report.str().find("pair"), std::string::npos);
+  ASSERT_NE(report.str().find("make-pair / "), std::string::npos);
+
+  // When: The allocations are discarded
+  profiler.reset();
+
+  // Then: There are none left
+  ASSERT_EQ(profiler.get_allocation_count(), 0u);
+  ASSERT_TRUE(profiler.get_sites().empty());
+}
+
+/**
+ * @brief Test: allocations outside of any VM, and the size of each
+ */
+TEST(AllocationProfilerUnitTest, outside_vm) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+
+  // Given: A running profiler, and a second one
+  AllocationProfiler profiler;
+  profiler.start();
+  AllocationProfiler other;
+
+  // Then: Only one may run at a time
+  ASSERT_THROW(other.start(), InvalidInputException);
+
+  // When: A string is allocated with no VM running
+  create_node(Data(String("hello")));
+  profiler.stop();
+
+  // Then: It is recorded with its contents
+  std::vector<AllocationProfiler::Site> sites = profiler.get_sites();
+  ASSERT_EQ(sites.size(), 1u);
+  ASSERT_EQ(sites[0].procedure, "(none)");
+  ASSERT_EQ(sites[0].type, Data::Type::STRING);
+  ASSERT_EQ(sites[0].bytes, sizeof(gc::GCData) + 5);
+  ASSERT_STREQ(AllocationProfiler::get_type_name(sites[0].type), "string");
+}
+
+/**
+ * @brief Test: allocations on green threads are attributed to the Scheme
+ * procedure the thread is applying
+ */
+TEST(AllocationProfilerUnitTest, scheduler) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+
+  // Given: A Scheduler and a procedure that allocates a pair with cons
+  EnvPtr env = std::make_shared<Environment>(nullptr);
+  env->set_value(Symbol("cons"), create_node(Closure(stdproc::cons, false)));
+  HeapVirtualMachine hvm(nullptr, nullptr, env, ValueRib(), nullptr);
+  Scheduler scheduler(hvm);
+  scheduler.define_procedures(env);
+  scheduler.run(compile_string("(define make-pair (lambda (x) (cons x x)))"));
+  Expression spawn = compile_string("(spawn (lambda () (make-pair 1)))");
+  Expression call = compile_string("(make-pair 2)");
+
+  // When: The main thread and a spawned thread call it while profiling
+  AllocationProfiler profiler;
+  profiler.start();
+  scheduler.run(spawn);
+  scheduler.run(call);
+  profiler.stop();
+
+  // Then: Both pairs are attributed to make-pair, and nothing to no VM
+  std::size_t pairs = 0;
+  for (const AllocationProfiler::Site& site : profiler.get_sites()) {
+    ASSERT_NE(site.procedure, "(none)");
+    if (site.procedure == "make-pair" &&
+        site.type == Data::Type::DATA_PAIR &&
+        site.caller.find("stdproc::impl::cons") != std::string::npos) {
+      pairs += site.count;
+    }
+  }
+  ASSERT_EQ(pairs, 2u);
+}
@@ -0,0 +1,129 @@
+#include <gmock/gmock.h>
+#include "shaka_scheme/system/vm/AsyncIO.hpp"
+#include "shaka_scheme/system/vm/Scheduler.hpp"
+#include "shaka_scheme/system/vm/compiler/Compiler.hpp"
+#include "shaka_scheme/system/lexer/rules/init.hpp"
+#include "shaka_scheme/system/parser/parser_definitions.hpp"
+#include "shaka_scheme/runtime/stdproc/ports.hpp"
+#include "shaka_scheme/system/gc/GC.hpp"
+#include "shaka_scheme/system/gc/init_gc.hpp"
+
+#include <cerrno>
+#include <cstdio>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace shaka;
+
+namespace {
+
+Expression compile_string(const std::string& str) {
+  parser::ParserInput input(str);
+  Compiler compiler;
+  return compiler.compile(parser::parse_datum(input).it);
+}
+
+std::vector<AsyncIO::Completion> wait_for(AsyncIO& io, std::size_t count) {
+  std::vector<AsyncIO::Completion> all;
+  while (all.size() < count) {
+    for (AsyncIO::Completion& completion : io.wait(-1)) {
+      all.push_back(completion);
+    }
+  }
+  return all;
+}
+
+} // namespace
+
+/**
+ * @brief Test: reads and writes at offsets, with both backends
+ */
+TEST(AsyncIOUnitTest, read_and_write) {
+  const std::string path = "unit-AsyncIO.bin";
+  for (bool use_io_uring : {true, false}) {
+    AsyncIO io(use_io_uring, 2);
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+    ASSERT_GE(fd, 0);
+
+    // When: You queue two writes, the second before the first in the file
+    io.write(fd, 5, "world", 2);
+    io.write(fd, 0, "hello", 1);
+    ASSERT_FALSE(io.is_empty());
+
+    // Then: Both complete, as one batch
+    std::vector<AsyncIO::Completion> written = wait_for(io, 2);
+    ASSERT_EQ(written[0].result + written[1].result, 10);
+    if (!use_io_uring) {
+      ASSERT_FALSE(io.is_using_io_uring());
+    }
+
+    // When: You read across the end of the file, and from a bad descriptor
+    io.read(fd, 3, 100, 7);
+    io.read(-1, 0, 10, 8);
+    std::vector<AsyncIO::Completion> read = wait_for(io, 2);
+
+    // Then: The read stops at the end, and the other one fails
+    for (const AsyncIO::Completion& completion : read) {
+      if (completion.thread_id == 7) {
+        ASSERT_EQ(completion.data, "loworld");
+        ASSERT_EQ(completion.result, 7);
+      } else {
+        ASSERT_EQ(completion.result, -EBADF);
+      }
+    }
+    ASSERT_TRUE(io.is_empty());
+    ASSERT_EQ(io.wait(0).size(), 0u);
+    ::close(fd);
+  }
+  std::remove(path.c_str());
+}
+
+/**
+ * @brief Test: green threads park on async-read and async-write
+ */
+TEST(AsyncIOUnitTest, scheduler_procedures) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+
+  for (bool use_io_uring : {true, false}) {
+    // Given: A Scheduler with the port procedures
+    EnvPtr env = std::make_shared<Environment>(nullptr);
+    env->set_value(Symbol("open-binary-output-file"), create_node(
+        Closure(stdproc::open_binary_output_file, false)));
+    env->set_value(Symbol("open-input-file"), create_node(
+        Closure(stdproc::open_input_file, false)));
+    env->set_value(Symbol("read-line"), create_node(
+        Closure(stdproc::read_line, true)));
+    env->set_value(Symbol("close-port"), create_node(
+        Closure(stdproc::close_port, false)));
+    HeapVirtualMachine hvm(nullptr, nullptr, env, ValueRib(), nullptr);
+    Scheduler scheduler(hvm, 1000, use_io_uring);
+    scheduler.define_procedures(env);
+
+    // When: The main thread writes a file asynchronously
+    scheduler.run(compile_string(
+        "(define out (open-binary-output-file \"unit-AsyncIO.txt\"))"));
+    scheduler.run(compile_string("(async-write \"first line\\n\" out)"));
+    scheduler.run(compile_string("(async-write #u8(50 110 100) out)"));
+    scheduler.run(compile_string("(close-port out)"));
+
+    // When: Another thread reads it back while the main thread waits
+    scheduler.run(compile_string("(define ch (make-channel))"));
+    scheduler.run(compile_string(
+        "(define in (open-input-file \"unit-AsyncIO.txt\"))"));
+    scheduler.run(compile_string(
+        "(spawn (lambda () (channel-send ch (async-read 100 in))))"));
+    NodePtr text = scheduler.run(compile_string("(channel-receive ch)"));
+
+    // Then: The reader gets everything that was written, then the end
+    ASSERT_EQ(text->get<String>().get_string(), "first line\n2nd");
+    ASSERT_EQ(scheduler.run(compile_string("(async-read 5 in)"))->get_type(),
+              Data::Type::EOF_OBJECT);
+    ASSERT_EQ(scheduler.run(compile_string("(read-line in)"))->get_type(),
+              Data::Type::EOF_OBJECT);
+    ASSERT_TRUE(scheduler.get_async_io().is_empty());
+  }
+  std::remove("unit-AsyncIO.txt");
+}
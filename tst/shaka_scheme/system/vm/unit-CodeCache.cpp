@@ -0,0 +1,110 @@
+#include <gmock/gmock.h>
+#include "shaka_scheme/system/vm/compiler/CodeCache.hpp"
+#include "shaka_scheme/system/serialization/files.hpp"
+#include "shaka_scheme/runtime/stdproc/numbers_arithmetic.hpp"
+#include "shaka_scheme/system/lexer/rules/init.hpp"
+#include "shaka_scheme/system/gc/GC.hpp"
+#include "shaka_scheme/system/gc/init_gc.hpp"
+
+#include <cstdio>
+
+#include <unistd.h>
+
+using namespace shaka;
+
+namespace {
+
+EnvPtr make_environment() {
+  EnvPtr env = std::make_shared<Environment>(nullptr);
+  env->set_value(Symbol("define"), create_node(PrimitiveFormMarker("define")));
+  env->set_value(Symbol("lambda"), create_node(PrimitiveFormMarker("lambda")));
+  env->set_value(Symbol("quote"), create_node(PrimitiveFormMarker("quote")));
+  env->set_value(Symbol("*"), create_node(Closure(stdproc::mul, true)));
+  return env;
+}
+
+NodePtr run_all(const std::vector<Expression>& compiled,
+                HeapVirtualMachine& hvm) {
+  NodePtr result;
+  for (const Expression& expression : compiled) {
+    result = hvm.run(expression);
+  }
+  return result;
+}
+
+} // namespace
+
+/**
+ * @brief Test: compiled code is stored, then reused while it is fresh
+ */
+TEST(CodeCacheUnitTest, hits_and_misses) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+  const std::string directory = "unit-CodeCache.cache";
+  const std::string source =
+      "(define square (lambda (x) (* x x)))\n"
+      "(define data '(1 \"two\" #(3)))\n"
+      "(square 6)\n";
+
+  // When: You compile a source text with an empty cache
+  HeapVirtualMachine hvm(nullptr, nullptr, make_environment(), ValueRib(),
+                         nullptr);
+  CodeCache cache(directory, "macros-1");
+  std::vector<Expression> compiled = cache.compile(source, hvm);
+
+  // Then: It is compiled, and runs
+  ASSERT_EQ(cache.get_misses(), 1u);
+  ASSERT_EQ(compiled.size(), 3u);
+  ASSERT_EQ(run_all(compiled, hvm)->get<Number>(), Number(36));
+
+  // When: Another cache on the same directory compiles the same text
+  HeapVirtualMachine other_hvm(nullptr, nullptr, make_environment(),
+                               ValueRib(), nullptr);
+  CodeCache other_cache(directory, "macros-1");
+  std::vector<Expression> cached = other_cache.compile(source, other_hvm);
+
+  // Then: The entry is used, and holds the same code
+  ASSERT_EQ(other_cache.get_hits(), 1u);
+  ASSERT_EQ(cached.size(), compiled.size());
+  for (std::size_t i = 0; i < cached.size(); ++i) {
+    ASSERT_TRUE(core::equal(cached[i], compiled[i]));
+  }
+  ASSERT_EQ(run_all(cached, other_hvm)->get<Number>(), Number(36));
+
+  // Then: Another macro version or another text does not use the entry
+  CodeCache new_macros(directory, "macros-2");
+  new_macros.compile(source, hvm);
+  ASSERT_EQ(new_macros.get_misses(), 1u);
+  ASSERT_NE(new_macros.get_entry_path(source), cache.get_entry_path(source));
+  ASSERT_NE(cache.get_entry_path(source + " "), cache.get_entry_path(source));
+
+  // When: An entry is corrupted
+  std::string path = cache.get_entry_path(source);
+  ASSERT_TRUE(serialization::write_file_atomically(path, "garbage"));
+
+  // Then: It is recompiled and rewritten
+  other_cache.compile(source, other_hvm);
+  ASSERT_EQ(other_cache.get_misses(), 1u);
+  other_cache.compile(source, other_hvm);
+  ASSERT_EQ(other_cache.get_hits(), 2u);
+
+  std::remove(path.c_str());
+  std::remove(new_macros.get_entry_path(source).c_str());
+  ::rmdir(directory.c_str());
+}
+
+/**
+ * @brief Test: compile_source compiles every datum, and rejects bad input
+ */
+TEST(CodeCacheUnitTest, compile_source) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+  HeapVirtualMachine hvm(nullptr, nullptr, make_environment(), ValueRib(),
+                         nullptr);
+
+  ASSERT_EQ(compile_source("", hvm).size(), 0u);
+  ASSERT_EQ(compile_source("1 2 ; comment\n 3", hvm).size(), 3u);
+  ASSERT_THROW(compile_source("(1 2", hvm), InvalidInputException);
+}
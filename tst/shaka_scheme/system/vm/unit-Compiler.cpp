@@ -234,6 +234,37 @@ TEST(CompilerUnitTest, call_cc_test) {
   ASSERT_EQ(output, ss_test.str());
 }
 
+/**
+ * @brief Test: compile() changing reset and shift expressions to 'reset' and
+ * 'shift' instructions
+ */
+TEST(CompilerUnitTest, reset_shift_test) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  Compiler compiler;
+
+  // Given: The expression (reset (shift k (k 'a)))
+  Data k_data(Symbol("k"));
+  Data a_data(Symbol("a"));
+  NodePtr k_a = list(create_node(k_data), create_node(a_data));
+  NodePtr shift = list(create_node(Data(Symbol("shift"))),
+                       create_node(k_data), k_a);
+  Expression input = list(create_node(Data(Symbol("reset"))), shift);
+
+  // When: You compile the expression.
+  Expression expression = compiler.compile(input);
+
+  std::stringstream ss;
+  ss << *expression;
+  std::string output = ss.str();
+
+  // Then: The shift is in tail position of the prompt, so it pushes no frame
+  std::stringstream ss_test;
+  ss_test << "(reset (halt) (shift (argument (close (k) (refer a (argument";
+  ss_test << " (refer k (apply)))) (apply)))))";
+  ASSERT_EQ(output, ss_test.str());
+}
+
 /**
  * @brief Test: compile() changing applications to 'frame' instructions
  */
@@ -9,6 +9,10 @@
 #include "shaka_scheme/system/vm/strings.hpp"
 #include "shaka_scheme/system/gc/GC.hpp"
 #include "shaka_scheme/system/gc/init_gc.hpp"
+#include "shaka_scheme/system/vm/compiler/Compiler.hpp"
+#include "shaka_scheme/system/lexer/rules/init.hpp"
+#include "shaka_scheme/system/parser/parser_definitions.hpp"
+#include "shaka_scheme/runtime/stdproc/numbers_arithmetic.hpp"
 
 using namespace shaka;
 
@@ -1439,3 +1443,141 @@ TEST(HeapVirtualMachineUnitTest, closure_vs_continuation) {
       Symbol("b")
   );
 }
+
+/**
+ * @brief Test: (reset ret x) and (shift x) with a multi-shot delimited
+ * continuation
+ */
+TEST(HeapVirtualMachineUnitTest, reset_shift) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+
+  // Given: An environment with a binding for +
+  EnvPtr env = std::make_shared<Environment>(nullptr);
+  env->set_value(Symbol("+"), create_node(Closure(stdproc::add, true)));
+
+  // Given: The compiled expression (+ 1 (reset (+ 10 (shift k (k (k 100))))))
+  parser::ParserInput input("(+ 1 (reset (+ 10 (shift k (k (k 100))))))");
+  Compiler compiler;
+  Expression compiled = compiler.compile(parser::parse_datum(input).it);
+
+  // Given: A HeapVirtualMachine instance loaded with the expression
+  ValueRib vr;
+  HeapVirtualMachine hvm(nullptr, compiled, env, vr, nullptr);
+
+  // When: You evaluate the expression until (halt)
+  do {
+    hvm.evaluate_assembly_instruction();
+  } while (core::car(hvm.get_expression())->get<Symbol>() != Symbol("halt"));
+
+  // Then: k was resumed twice and only captured the frames inside reset
+  ASSERT_EQ(hvm.get_accumulator()->get<Number>(), Number(121));
+
+  // Then: The stack has been unwound back past the prompt
+  ASSERT_EQ(hvm.get_call_frame(), nullptr);
+}
+
+/**
+ * @brief Test: (conti1 x) creates a continuation that can only be resumed once
+ */
+TEST(HeapVirtualMachineUnitTest, one_shot_continuation) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+
+  // Given: A CallFrame that returns to (halt)
+  EnvPtr env = std::make_shared<Environment>(nullptr);
+  ValueRib vr;
+  FramePtr frame = std::make_shared<CallFrame>(
+      core::list(create_node(Symbol("halt"))), env, vr, nullptr);
+
+  // Given: An assembly instruction of the form (conti1 (halt))
+  NodePtr expression = core::list(
+      create_node(Symbol("conti1")),
+      core::list(create_node(Symbol("halt")))
+  );
+  HeapVirtualMachine hvm(nullptr, expression, env, vr, frame);
+
+  // When: You invoke the evaluate_assembly_instruction() method
+  hvm.evaluate_assembly_instruction();
+
+  // Then: The continuation shares the CallFrame instead of copying it
+  Closure& k = hvm.get_accumulator()->get<Closure>();
+  ASSERT_TRUE(k.is_continuation_closure());
+  ASSERT_TRUE(k.is_one_shot());
+  ASSERT_EQ(k.get_call_frame(), frame);
+
+  // When: You apply the continuation to 'a
+  NodePtr kont = hvm.get_accumulator();
+  hvm.set_value_rib({create_node(Symbol("a"))});
+  hvm.set_expression(core::list(create_node(Symbol("apply"))));
+  hvm.evaluate_assembly_instruction(); // apply
+  hvm.evaluate_assembly_instruction(); // return
+
+  // Then: The value is delivered to the captured frame
+  ASSERT_EQ(hvm.get_accumulator()->get<Symbol>(), Symbol("a"));
+  ASSERT_EQ(core::car(hvm.get_expression())->get<Symbol>(), Symbol("halt"));
+
+  // When: You apply the continuation a second time
+  hvm.set_accumulator(kont);
+  hvm.set_expression(core::list(create_node(Symbol("apply"))));
+
+  // Then: The resumption is rejected
+  ASSERT_THROW(hvm.evaluate_assembly_instruction(), InvalidInputException);
+}
+
+/**
+ * @brief Test: run() evaluates a compiled expression, and a native procedure
+ * can call back into Scheme with apply_procedure()
+ */
+TEST(HeapVirtualMachineUnitTest, run_and_apply_procedure) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+
+  // Given: An environment with + and a native (call-twice f x) that applies
+  // f to the result of applying f to x, on the VM that is running it
+  EnvPtr env = std::make_shared<Environment>(nullptr);
+  env->set_value(Symbol("+"), create_node(Closure(stdproc::add, true)));
+  env->set_value(Symbol("call-twice"), create_node(Closure(
+      [](std::deque<NodePtr> args) {
+        HeapVirtualMachine* hvm = HeapVirtualMachine::get_current();
+        NodePtr once = hvm->apply_procedure(args[0], {args[1]});
+        return std::deque<NodePtr>{hvm->apply_procedure(args[0], {once})};
+      }, false)));
+
+  // Given: A HeapVirtualMachine with the environment
+  HeapVirtualMachine hvm(nullptr, nullptr, env, ValueRib(), nullptr);
+  Compiler compiler;
+  parser::ParserInput input(
+      "(+ 1 (call-twice (lambda (x)"
+      "                   (+ x (call-twice (lambda (y) (+ y 1)) 0)))"
+      "                 10))");
+
+  // When: You run the compiled expression
+  NodePtr result = hvm.run(compiler.compile(parser::parse_datum(input).it));
+
+  // Then: The nested calls return into the right frames
+  ASSERT_EQ(result->get<Number>(), Number(15));
+  ASSERT_EQ(HeapVirtualMachine::get_current(), nullptr);
+
+  // When: You apply a Scheme procedure from C++
+  parser::ParserInput lambda("(lambda (a b) (+ a b))");
+  NodePtr add = hvm.run(compiler.compile(parser::parse_datum(lambda).it));
+  result = hvm.apply_procedure(add, {create_node(Number(2)),
+                                     create_node(Number(3))});
+
+  // Then: The value of the application is returned
+  ASSERT_EQ(result->get<Number>(), Number(5));
+
+  // When: Evaluation throws
+  parser::ParserInput error("(+ 1 undefined-variable)");
+  Expression expression = compiler.compile(parser::parse_datum(error).it);
+  hvm.set_accumulator(result);
+
+  // Then: The registers are restored
+  ASSERT_ANY_THROW(hvm.run(expression));
+  ASSERT_EQ(hvm.get_accumulator(), result);
+  ASSERT_EQ(hvm.get_call_frame(), nullptr);
+  ASSERT_EQ(HeapVirtualMachine::get_current(), nullptr);
+}
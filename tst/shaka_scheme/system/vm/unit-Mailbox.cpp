@@ -0,0 +1,69 @@
+#include <gmock/gmock.h>
+#include "shaka_scheme/system/vm/Mailbox.hpp"
+#include "shaka_scheme/system/vm/HeapVirtualMachine.hpp"
+#include "shaka_scheme/system/vm/compiler/Compiler.hpp"
+#include "shaka_scheme/system/lexer/rules/init.hpp"
+#include "shaka_scheme/system/parser/parser_definitions.hpp"
+#include "shaka_scheme/runtime/stdproc/numbers_arithmetic.hpp"
+#include "shaka_scheme/system/gc/GC.hpp"
+#include "shaka_scheme/system/gc/init_gc.hpp"
+
+#include <thread>
+#include <vector>
+
+using namespace shaka;
+
+/**
+ * @brief Test: HeapVirtualMachine instances evaluate in parallel OS threads,
+ * each with its own heap, and report back through a Mailbox
+ */
+TEST(MailboxUnitTest, parallel_virtual_machines) {
+  // Given: The lexer rules are initialized once, before any thread starts
+  lexer::rules::init_lexer_rules();
+
+  Mailbox results;
+  std::vector<std::thread> workers;
+
+  // When: Four threads each evaluate a program in their own VM and heap
+  for (int k = 0; k < 4; ++k) {
+    workers.push_back(std::thread([k, &results]() {
+      gc::GC garbage_collector;
+      gc::init_create_node(garbage_collector);
+
+      EnvPtr env = std::make_shared<Environment>(nullptr);
+      env->set_value(Symbol("*"), create_node(Closure(stdproc::mul, true)));
+      HeapVirtualMachine hvm(nullptr, nullptr, env, ValueRib(), nullptr);
+
+      std::stringstream ss;
+      ss << "((lambda (x) (* x x)) " << k << ")";
+      parser::ParserInput input(ss.str());
+      Compiler compiler;
+      hvm.set_expression(compiler.compile(parser::parse_datum(input).it));
+      do {
+        hvm.evaluate_assembly_instruction();
+      } while (core::car(hvm.get_expression())->get<Symbol>() !=
+          Symbol("halt"));
+
+      // Then: Each result is copied out of the worker heap before it dies
+      results.send(core::list(create_node(Number(k)), hvm.get_accumulator()));
+    }));
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  // Then: The main thread receives every result into its own heap
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  int total = 0;
+  for (int i = 0; i < 4; ++i) {
+    NodePtr result = results.receive(garbage_collector);
+    int k = core::car(result)->get<Number>().get<Integer>().get_value();
+    ASSERT_EQ(core::car(core::cdr(result))->get<Number>(), Number(k * k));
+    total += k;
+  }
+  ASSERT_EQ(total, 0 + 1 + 2 + 3);
+
+  NodePtr value;
+  ASSERT_FALSE(results.try_receive(garbage_collector, value));
+}
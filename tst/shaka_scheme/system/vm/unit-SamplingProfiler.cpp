@@ -0,0 +1,167 @@
+#include <gmock/gmock.h>
+#include "shaka_scheme/system/vm/SamplingProfiler.hpp"
+#include "shaka_scheme/system/vm/HeapVirtualMachine.hpp"
+#include "shaka_scheme/system/vm/compiler/Compiler.hpp"
+#include "shaka_scheme/system/lexer/rules/init.hpp"
+#include "shaka_scheme/system/parser/parser_definitions.hpp"
+#include "shaka_scheme/runtime/stdproc/numbers_arithmetic.hpp"
+#include "shaka_scheme/system/exceptions/InvalidInputException.hpp"
+#include "shaka_scheme/system/gc/GC.hpp"
+#include "shaka_scheme/system/gc/init_gc.hpp"
+
+#include <sstream>
+
+using namespace shaka;
+
+namespace {
+
+Expression compile_string(const std::string& str) {
+  parser::ParserInput input(str);
+  Compiler compiler;
+  return compiler.compile(parser::parse_datum(input).it);
+}
+
+/**
+ * @brief Binds (probe), which returns 0 after passing the VM that applies
+ * it to a callback.
+ */
+void define_probe(EnvPtr env,
+                  std::function<void(const HeapVirtualMachine&)> callback) {
+  env->set_value(Symbol("probe"), create_node(Closure(
+      [callback](std::deque<NodePtr>) -> std::deque<NodePtr> {
+        callback(*HeapVirtualMachine::get_current());
+        return {create_node(Number(0))};
+      }, true)));
+}
+
+} // namespace
+
+/**
+ * @brief Test: the stack lists each procedure call once, from top level
+ */
+TEST(SamplingProfilerUnitTest, get_stack) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+
+  // Given: A probe that saves the stack of the VM that applies it
+  EnvPtr env = std::make_shared<Environment>(nullptr);
+  env->set_value(Symbol("+"), create_node(Closure(stdproc::add, true)));
+  std::vector<std::string> stack;
+  define_probe(env, [&stack](const HeapVirtualMachine& hvm) {
+    stack = SamplingProfiler::get_stack(hvm);
+  });
+  HeapVirtualMachine hvm(nullptr, nullptr, env, ValueRib(), nullptr);
+
+  // Given: Two procedures, where one calls the other while it is still
+  // evaluating arguments
+  hvm.run(compile_string("(define inner (lambda () (+ (probe) 1)))"));
+  hvm.run(compile_string("(define outer (lambda () (+ 1 (inner))))"));
+
+  // When: The probe is applied from inside both
+  NodePtr result = hvm.run(compile_string("(+ 1 (outer))"));
+
+  // Then: The stack lists both, once each
+  ASSERT_EQ(result->get<Number>(), Number(3));
+  ASSERT_EQ(stack, std::vector<std::string>({
+      "(top level)", "outer", "inner"}));
+
+  // When: The probe is applied from an anonymous procedure called in tail
+  // position
+  hvm.run(compile_string("((lambda (x y) (+ (probe) x)) 1 2)"));
+
+  // Then: The procedure is described by its lambda
+  ASSERT_EQ(stack, std::vector<std::string>({
+      "(top level)", "(lambda (x y))"}));
+
+  // When: The VM is back at top level
+  // Then: The stack is only top level
+  ASSERT_EQ(SamplingProfiler::get_stack(hvm),
+            std::vector<std::string>({"(top level)"}));
+}
+
+/**
+ * @brief Test: samples of the same stack are counted together
+ */
+TEST(SamplingProfilerUnitTest, write_collapsed) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+
+  // Given: A probe that samples the VM that applies it
+  SamplingProfiler profiler;
+  EnvPtr env = std::make_shared<Environment>(nullptr);
+  env->set_value(Symbol("+"), create_node(Closure(stdproc::add, true)));
+  define_probe(env, [&profiler](const HeapVirtualMachine& hvm) {
+    profiler.sample(hvm);
+  });
+  HeapVirtualMachine hvm(nullptr, nullptr, env, ValueRib(), nullptr);
+  hvm.run(compile_string("(define f (lambda () (+ (probe) (probe))))"));
+
+  // When: f samples twice, then the VM is sampled at top level
+  hvm.run(compile_string("(f)"));
+  profiler.sample(hvm);
+
+  // Then: There is one line for each stack
+  ASSERT_EQ(profiler.get_sample_count(), 3u);
+  std::ostringstream out;
+  profiler.write_collapsed(out);
+  ASSERT_EQ(out.str(), "(top level) 1\n(top level);f 2\n");
+
+  // When: The samples are discarded
+  profiler.reset();
+
+  // Then: There are none left
+  ASSERT_EQ(profiler.get_sample_count(), 0u);
+  ASSERT_TRUE(profiler.get_stacks().empty());
+}
+
+/**
+ * @brief Test: a running profiler samples the VM as it evaluates
+ */
+TEST(SamplingProfilerUnitTest, timer) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+
+  EnvPtr env = std::make_shared<Environment>(nullptr);
+  env->set_value(Symbol("+"), create_node(Closure(stdproc::add, true)));
+  env->set_value(Symbol("-"), create_node(Closure(stdproc::sub, true)));
+  native::define_native(env, "<", [](const Number& a, const Number& b) {
+    return a < b;
+  });
+  HeapVirtualMachine hvm(nullptr, nullptr, env, ValueRib(), nullptr);
+  hvm.run(compile_string(
+      "(define fib (lambda (n) "
+      "  (if (< n 2) n (+ (fib (- n 1)) (fib (- n 2))))))"));
+
+  // Given: A profiler that samples every millisecond of CPU time
+  SamplingProfiler profiler;
+  profiler.start(1000);
+  ASSERT_TRUE(profiler.is_running());
+
+  // Then: Only one profiler may run at a time
+  SamplingProfiler other;
+  ASSERT_THROW(other.start(1000), InvalidInputException);
+
+  // When: The VM computes until some samples are taken
+  for (int i = 0; i < 100 && profiler.get_sample_count() < 5; ++i) {
+    hvm.run(compile_string("(fib 15)"));
+  }
+  profiler.stop();
+
+  // Then: The samples are of fib, called from top level
+  ASSERT_FALSE(profiler.is_running());
+  ASSERT_GE(profiler.get_sample_count(), 5u);
+  for (const auto& stack : profiler.get_stacks()) {
+    ASSERT_EQ(stack.first.find("(top level)"), 0u);
+  }
+  std::ostringstream out;
+  profiler.write_collapsed(out);
+  ASSERT_NE(out.str().find("(top level);fib;fib"), std::string::npos);
+
+  // Then: No more samples are taken once stopped
+  std::size_t count = profiler.get_sample_count();
+  hvm.run(compile_string("(fib 15)"));
+  ASSERT_EQ(profiler.get_sample_count(), count);
+}
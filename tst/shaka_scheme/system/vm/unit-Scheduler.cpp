@@ -0,0 +1,353 @@
+#include <gmock/gmock.h>
+#include "shaka_scheme/system/vm/Scheduler.hpp"
+#include "shaka_scheme/system/vm/compiler/Compiler.hpp"
+#include "shaka_scheme/system/lexer/rules/init.hpp"
+#include "shaka_scheme/system/parser/parser_definitions.hpp"
+#include "shaka_scheme/runtime/stdproc/numbers_arithmetic.hpp"
+#include "shaka_scheme/runtime/stdproc/ports.hpp"
+#include "shaka_scheme/system/gc/GC.hpp"
+#include "shaka_scheme/system/gc/init_gc.hpp"
+#include "shaka_scheme/system/gc/mark_procedures.hpp"
+
+#include <unistd.h>
+
+using namespace shaka;
+
+namespace {
+
+Expression compile_string(const std::string& str) {
+  parser::ParserInput input(str);
+  Compiler compiler;
+  return compiler.compile(parser::parse_datum(input).it);
+}
+
+} // namespace
+
+/**
+ * @brief Test: a thread blocked on channel-receive is woken by channel-send
+ */
+TEST(SchedulerUnitTest, channel_send_receive) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+
+  // Given: A HeapVirtualMachine and a Scheduler with its procedures defined
+  EnvPtr env = std::make_shared<Environment>(nullptr);
+  env->set_value(Symbol("+"), create_node(Closure(stdproc::add, true)));
+  HeapVirtualMachine hvm(nullptr, nullptr, env, ValueRib(), nullptr);
+  Scheduler scheduler(hvm);
+  scheduler.define_procedures(env);
+
+  // Given: A channel and a spawned thread that sends 41 on it
+  scheduler.run(compile_string("(define ch (make-channel))"));
+  scheduler.run(compile_string("(spawn (lambda () (channel-send ch 41)))"));
+  ASSERT_EQ(scheduler.get_thread_count(), 1);
+
+  // When: The main thread receives from the empty channel
+  NodePtr result = scheduler.run(compile_string("(+ 1 (channel-receive ch))"));
+
+  // Then: It parks until the spawned thread delivers the value
+  ASSERT_EQ(result->get<Number>(), Number(42));
+  ASSERT_EQ(scheduler.get_thread_count(), 0);
+
+  // When: Receiving again with nobody left to send
+  // Then: The scheduler reports the deadlock
+  ASSERT_THROW(scheduler.run(compile_string("(channel-receive ch)")),
+               InvalidInputException);
+}
+
+/**
+ * @brief Test: a thread that never yields is preempted after a quantum
+ */
+TEST(SchedulerUnitTest, preemption) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+
+  // Given: A Scheduler with a quantum of 16 instructions
+  EnvPtr env = std::make_shared<Environment>(nullptr);
+  env->set_value(Symbol("+"), create_node(Closure(stdproc::add, true)));
+  HeapVirtualMachine hvm(nullptr, nullptr, env, ValueRib(), nullptr);
+  Scheduler scheduler(hvm, 16);
+  scheduler.define_procedures(env);
+
+  // Given: A spawned thread that loops forever
+  scheduler.run(compile_string("(define spin (lambda () (spin)))"));
+  scheduler.run(compile_string("(spawn (lambda () (spin)))"));
+
+  // When: The main thread runs after it
+  NodePtr result = scheduler.run(compile_string("(+ 1 2)"));
+
+  // Then: The main thread still gets to halt
+  ASSERT_EQ(result->get<Number>(), Number(3));
+  ASSERT_EQ(scheduler.get_thread_count(), 1);
+}
+
+/**
+ * @brief Test: sleeping threads wake up in order of their deadlines
+ */
+TEST(SchedulerUnitTest, sleep) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+
+  EnvPtr env = std::make_shared<Environment>(nullptr);
+  HeapVirtualMachine hvm(nullptr, nullptr, env, ValueRib(), nullptr);
+  Scheduler scheduler(hvm);
+  scheduler.define_procedures(env);
+
+  // Given: A thread that sleeps before sending, spawned before one that
+  // sends immediately
+  scheduler.run(compile_string("(define ch (make-channel))"));
+  scheduler.run(compile_string(
+      "(spawn (lambda () (sleep 20) (channel-send ch 'late)))"));
+  scheduler.run(compile_string(
+      "(spawn (lambda () (channel-send ch 'early)))"));
+
+  // When: The main thread receives twice
+  NodePtr first = scheduler.run(compile_string("(channel-receive ch)"));
+  NodePtr second = scheduler.run(compile_string("(channel-receive ch)"));
+
+  // Then: The sleeping thread sent last
+  ASSERT_EQ(first->get<Symbol>(), Symbol("early"));
+  ASSERT_EQ(second->get<Symbol>(), Symbol("late"));
+}
+
+/**
+ * @brief Test: a thread waiting on a file descriptor is parked in the poller
+ */
+TEST(SchedulerUnitTest, wait_readable) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+
+  // Given: A pipe with data waiting on its read end
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  ASSERT_EQ(write(fds[1], "x", 1), 1);
+
+  EnvPtr env = std::make_shared<Environment>(nullptr);
+  env->set_value(Symbol("fd"), create_node(Number(fds[0])));
+  HeapVirtualMachine hvm(nullptr, nullptr, env, ValueRib(), nullptr);
+  Scheduler scheduler(hvm);
+  scheduler.define_procedures(env);
+
+  // Given: A thread that waits for the pipe to be readable
+  scheduler.run(compile_string("(define ch (make-channel))"));
+  scheduler.run(compile_string(
+      "(spawn (lambda () (wait-readable fd) (channel-send ch 'ready)))"));
+
+  // When: The main thread waits for that thread
+  NodePtr result = scheduler.run(compile_string("(channel-receive ch)"));
+
+  // Then: The poller woke the thread up
+  ASSERT_EQ(result->get<Symbol>(), Symbol("ready"));
+
+  // Given: Two threads that wait for the pipe to be readable
+  scheduler.run(compile_string(
+      "(spawn (lambda () (wait-readable fd) (channel-send ch 'first)))"));
+  scheduler.run(compile_string(
+      "(spawn (lambda () (wait-readable fd) (channel-send ch 'second)))"));
+
+  // When: The main thread waits for both of them
+  scheduler.run(compile_string("(channel-receive ch)"));
+  scheduler.run(compile_string("(channel-receive ch)"));
+
+  // Then: Both were woken up
+  ASSERT_EQ(scheduler.get_thread_count(), 0);
+
+  close(fds[0]);
+  close(fds[1]);
+}
+
+/**
+ * @brief Test: read-line on a pipe waits in the poller instead of blocking
+ * the thread that writes the line
+ */
+TEST(SchedulerUnitTest, pipe_read_line) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+
+  // Given: An input port on an empty pipe
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  EnvPtr env = std::make_shared<Environment>(nullptr);
+  env->set_value(Symbol("port"), create_node(Port::open_file(
+      "/dev/fd/" + std::to_string(fds[0]), Port::Direction::INPUT, false)));
+  env->set_value(Symbol("read-line"),
+                 create_node(Closure(stdproc::read_line, true)));
+  env->set_value(Symbol("feed"), create_node(Closure(
+      [&fds](std::deque<NodePtr> args) {
+    const std::string& text = args[0]->get<String>().get_string();
+    EXPECT_EQ(write(fds[1], text.data(), text.size()),
+              static_cast<ssize_t>(text.size()));
+    return std::deque<NodePtr>{create_unspecified()};
+  }, false)));
+  HeapVirtualMachine hvm(nullptr, nullptr, env, ValueRib(), nullptr);
+  Scheduler scheduler(hvm);
+  scheduler.define_procedures(env);
+
+  // Given: A thread that reads a line from the pipe, and one that writes
+  // the line to it in two parts
+  scheduler.run(compile_string("(define ch (make-channel))"));
+  scheduler.run(compile_string(
+      "(spawn (lambda () (channel-send ch (read-line port))))"));
+  scheduler.run(compile_string(
+      "(spawn (lambda () (feed \"hel\") (sleep 5) (feed \"lo\\nrest\")))"));
+
+  // When: The main thread waits for the line
+  NodePtr result = scheduler.run(compile_string("(channel-receive ch)"));
+
+  // Then: The reader waited for the whole line while the writer ran
+  ASSERT_EQ(result->get<String>().get_string(), "hello");
+  ASSERT_EQ(scheduler.get_thread_count(), 0);
+
+  close(fds[0]);
+  close(fds[1]);
+}
+
+/**
+ * @brief Test: when a spawned thread throws, the main thread it interrupted
+ * is dropped too
+ */
+TEST(SchedulerUnitTest, spawned_thread_throws) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+
+  EnvPtr env = std::make_shared<Environment>(nullptr);
+  HeapVirtualMachine hvm(nullptr, nullptr, env, ValueRib(), nullptr);
+  Scheduler scheduler(hvm);
+  scheduler.define_procedures(env);
+
+  // Given: A thread that will receive from a channel that does not exist
+  scheduler.run(compile_string("(define ch (make-channel))"));
+  scheduler.run(compile_string(
+      "(spawn (lambda () (channel-receive 99)))"));
+
+  // When: The main thread waits on a channel while that thread throws
+  ASSERT_THROW(scheduler.run(compile_string("(channel-receive ch)")),
+               InvalidInputException);
+
+  // Then: No thread is left, and the main thread no longer receives
+  ASSERT_EQ(scheduler.get_thread_count(), 0);
+  scheduler.run(compile_string("(channel-send ch 5)"));
+  NodePtr result = scheduler.run(compile_string("(channel-receive ch)"));
+  ASSERT_EQ(result->get<Number>(), Number(5));
+}
+
+/**
+ * @brief Test: the registers and call frames of waiting threads and the
+ * values in reachable channels are in the root set
+ */
+TEST(SchedulerUnitTest, roots) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+
+  EnvPtr env = std::make_shared<Environment>(nullptr);
+  HeapVirtualMachine hvm(nullptr, nullptr, env, ValueRib(), nullptr);
+  Scheduler scheduler(hvm);
+  scheduler.define_procedures(env);
+  env->set_value(Symbol("+"), create_node(Closure(stdproc::add, true)));
+  env->set_value(Symbol("*"), create_node(Closure(stdproc::mul, true)));
+
+  // Given: A value sent on a channel that nobody receives from
+  scheduler.run(compile_string("(define ch (make-channel))"));
+  NodePtr value = create_node(String("buffered"));
+  env->set_value(Symbol("value"), value);
+  scheduler.run(compile_string("(channel-send ch value)"));
+
+  // Given: A thread parked in the middle of a call, whose pending
+  // arguments are only in its call frames, since arguments are evaluated
+  // from right to left
+  scheduler.run(compile_string("(define waiting (make-channel))"));
+  NodePtr argument = create_node(String("argument"));
+  env->set_value(Symbol("argument"), argument);
+  scheduler.run(compile_string(
+      "(spawn (lambda () (+ 0 (* (channel-receive waiting) argument))))"));
+  scheduler.run(compile_string("(yield)"));
+  env->set_value(Symbol("value"), create_node(Data()));
+  env->set_value(Symbol("argument"), create_node(Data()));
+
+  // Given: A thread that has not run yet
+  NodePtr thunk = create_node(Closure(nullptr, create_node(Data()),
+                                      VariableList(), nullptr, nullptr,
+                                      false));
+  scheduler.spawn(thunk);
+
+  // When: The VM and the root sets are marked
+  gc::mark(hvm);
+  gc::mark_weak_references();
+
+  // Then: All three were reached through the Scheduler
+  ASSERT_TRUE(gc::is_marked(thunk));
+  ASSERT_TRUE(gc::is_marked(argument));
+  ASSERT_TRUE(gc::is_marked(value));
+}
+
+/**
+ * @brief Test: a channel whose handle is collected is dropped together
+ * with the values buffered in it
+ */
+TEST(SchedulerUnitTest, channel_collected) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+
+  EnvPtr env = std::make_shared<Environment>(nullptr);
+  HeapVirtualMachine hvm(nullptr, nullptr, env, ValueRib(), nullptr);
+  Scheduler scheduler(hvm);
+  scheduler.define_procedures(env);
+
+  // Given: A channel bound to a variable and one that nothing refers to,
+  // each holding a value
+  scheduler.run(compile_string("(define ch (make-channel))"));
+  scheduler.run(compile_string("(channel-send ch 'kept)"));
+  scheduler.run(compile_string("(channel-send (make-channel) 'dropped)"));
+  ASSERT_EQ(scheduler.get_channel_count(), 2u);
+
+  // When: The heap is collected
+  gc::mark(hvm);
+  garbage_collector.sweep();
+
+  // Then: Only the bound channel is left, with its value
+  ASSERT_EQ(scheduler.get_channel_count(), 1u);
+  NodePtr result = scheduler.run(compile_string("(channel-receive ch)"));
+  ASSERT_EQ(result->get<Symbol>(), Symbol("kept"));
+}
+
+/**
+ * @brief Test: threads run with their VM as the current one, which gets its
+ * own registers back afterwards
+ */
+TEST(SchedulerUnitTest, current_vm) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+
+  // Given: A native procedure that reports whether a VM is current
+  EnvPtr env = std::make_shared<Environment>(nullptr);
+  env->set_value(Symbol("current?"), create_node(Closure(
+      [](std::deque<NodePtr>) {
+        return std::deque<NodePtr>{create_node(Boolean(
+            HeapVirtualMachine::get_current() != nullptr))};
+      }, false)));
+  Expression registers = compile_string("registers");
+  HeapVirtualMachine hvm(nullptr, registers, env, ValueRib(), nullptr);
+  Scheduler scheduler(hvm);
+  scheduler.define_procedures(env);
+
+  // When: The main thread and a spawned thread call it
+  scheduler.run(compile_string("(define ch (make-channel))"));
+  scheduler.run(compile_string(
+      "(spawn (lambda () (channel-send ch (current?))))"));
+  NodePtr result = scheduler.run(compile_string(
+      "(if (current?) (channel-receive ch) #f)"));
+
+  // Then: Both threads ran under the VM, which was not current afterwards
+  ASSERT_EQ(result->get<Boolean>(), Boolean(true));
+  ASSERT_EQ(HeapVirtualMachine::get_current(), nullptr);
+  ASSERT_EQ(hvm.get_expression(), registers);
+}
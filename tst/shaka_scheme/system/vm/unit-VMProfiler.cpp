@@ -0,0 +1,106 @@
+#include <gmock/gmock.h>
+#include "shaka_scheme/system/vm/VMProfiler.hpp"
+#include "shaka_scheme/system/vm/HeapVirtualMachine.hpp"
+#include "shaka_scheme/system/vm/compiler/Compiler.hpp"
+#include "shaka_scheme/system/lexer/rules/init.hpp"
+#include "shaka_scheme/system/parser/parser_definitions.hpp"
+#include "shaka_scheme/runtime/stdproc/numbers_arithmetic.hpp"
+#include "shaka_scheme/system/gc/GC.hpp"
+#include "shaka_scheme/system/gc/init_gc.hpp"
+
+#include <sstream>
+
+using namespace shaka;
+
+namespace {
+
+Expression compile_string(const std::string& str) {
+  parser::ParserInput input(str);
+  Compiler compiler;
+  return compiler.compile(parser::parse_datum(input).it);
+}
+
+} // namespace
+
+/**
+ * @brief Test: a profiled run counts each instruction it evaluates
+ */
+TEST(VMProfilerUnitTest, counts_instructions) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+
+  // Given: A HeapVirtualMachine with a profiler attached
+  EnvPtr env = std::make_shared<Environment>(nullptr);
+  env->set_value(Symbol("+"), create_node(Closure(stdproc::add, true)));
+  HeapVirtualMachine hvm(nullptr, nullptr, env, ValueRib(), nullptr);
+  VMProfiler profiler;
+  hvm.set_profiler(&profiler);
+  ASSERT_EQ(hvm.get_profiler(), &profiler);
+
+  // When: Applying a lambda to a constant
+  NodePtr result = hvm.run(compile_string("((lambda (x) (+ x 1)) 1)"));
+
+  // Then: The result is unchanged, and the run ended with one halt
+  ASSERT_EQ(result->get<Number>(), Number(2));
+  ASSERT_EQ(profiler.get_count(VMProfiler::HALT), 1u);
+  ASSERT_EQ(profiler.get_count(VMProfiler::APPLY), 2u);
+  ASSERT_EQ(profiler.get_count(VMProfiler::CLOSE), 1u);
+  ASSERT_EQ(profiler.get_count(VMProfiler::OTHER), 0u);
+
+  // Then: Each argument is pushed right after it is computed
+  ASSERT_GE(profiler.get_pair_count(VMProfiler::CONSTANT,
+                                    VMProfiler::ARGUMENT), 1u);
+  ASSERT_EQ(profiler.get_pair_count(VMProfiler::HALT, VMProfiler::HALT), 0u);
+
+  // When: The profiler is detached
+  hvm.set_profiler(nullptr);
+  hvm.run(compile_string("((lambda (x) x) 1)"));
+
+  // Then: Nothing more is counted
+  ASSERT_EQ(profiler.get_count(VMProfiler::HALT), 1u);
+}
+
+/**
+ * @brief Test: profilers merge and reset, and report every instruction
+ */
+TEST(VMProfilerUnitTest, merge_reset_and_report) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+
+  // Given: A profiler that has seen one run
+  EnvPtr env = std::make_shared<Environment>(nullptr);
+  HeapVirtualMachine hvm(nullptr, nullptr, env, ValueRib(), nullptr);
+  VMProfiler profiler;
+  hvm.set_profiler(&profiler);
+  hvm.run(compile_string("(define x 1)"));
+  std::uint64_t defines = profiler.get_count(VMProfiler::DEFINE);
+  ASSERT_EQ(defines, 1u);
+
+  // When: It is merged into another one twice
+  VMProfiler totals;
+  totals.merge(profiler);
+  totals.merge(profiler);
+
+  // Then: The counts add up
+  ASSERT_EQ(totals.get_count(VMProfiler::DEFINE), 2 * defines);
+  ASSERT_EQ(totals.get_count(VMProfiler::HALT), 2u);
+
+  // Then: The report names the instructions that were evaluated
+  std::ostringstream report;
+  totals.write_report(report);
+  ASSERT_NE(report.str().find("define"), std::string::npos);
+  ASSERT_NE(report.str().find("halt"), std::string::npos);
+  ASSERT_NE(report.str().find("constant -> define"), std::string::npos);
+  ASSERT_EQ(report.str().find("apply"), std::string::npos);
+
+  // When: It is reset
+  totals.reset();
+
+  // Then: Everything is back at 0
+  ASSERT_EQ(totals.get_count(VMProfiler::DEFINE), 0u);
+  ASSERT_EQ(totals.get_ticks(VMProfiler::DEFINE), 0u);
+  ASSERT_EQ(totals.get_pair_count(VMProfiler::CONSTANT,
+                                  VMProfiler::DEFINE), 0u);
+}
@@ -0,0 +1,111 @@
+#include <gmock/gmock.h>
+#include "shaka_scheme/system/vm/native.hpp"
+#include "shaka_scheme/system/vm/HeapVirtualMachine.hpp"
+#include "shaka_scheme/system/vm/compiler/Compiler.hpp"
+#include "shaka_scheme/system/lexer/rules/init.hpp"
+#include "shaka_scheme/system/parser/parser_definitions.hpp"
+#include "shaka_scheme/system/gc/GC.hpp"
+#include "shaka_scheme/system/gc/init_gc.hpp"
+
+using namespace shaka;
+
+namespace {
+
+int add_ints(int a, int b) {
+  return a + b;
+}
+
+NodePtr evaluate(HeapVirtualMachine& hvm, const std::string& str) {
+  parser::ParserInput input(str);
+  Compiler compiler;
+  return hvm.run(compiler.compile(parser::parse_datum(input).it));
+}
+
+} // namespace
+
+/**
+ * @brief Test: typed native procedures unbox their arguments and box their
+ * results
+ */
+TEST(NativeUnitTest, define_native) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+  lexer::rules::init_lexer_rules();
+
+  // Given: A VM with typed native procedures of several signatures
+  EnvPtr env = std::make_shared<Environment>(nullptr);
+  HeapVirtualMachine hvm(nullptr, nullptr, env, ValueRib(), nullptr);
+  hvm.define_native("add-ints", add_ints);
+  hvm.define_native("scale", [](long long a, double b) -> double {
+    return a * b;
+  });
+  hvm.define_native("string-size", [](const String& s) -> std::size_t {
+    return s.length();
+  });
+  hvm.define_native("greet", [](std::string name) {
+    return "hello " + name;
+  });
+  hvm.define_native("not-not", [](bool b) { return b; });
+  hvm.define_native("identity", [](NodePtr node) { return node; });
+  int calls = 0;
+  hvm.define_native("count!", [&calls]() { ++calls; });
+
+  // When: You call them from Scheme
+  // Then: The results come back as Scheme objects
+  ASSERT_EQ(evaluate(hvm, "(add-ints 2 3)")->get<Number>(), Number(5));
+  ASSERT_EQ(evaluate(hvm, "(scale 3 1/2)")->get<Number>(), Number(1.5));
+  ASSERT_EQ(evaluate(hvm, "(string-size \"abcd\")")->get<Number>(),
+            Number(4));
+  ASSERT_EQ(evaluate(hvm, "(greet \"you\")")->get<String>(),
+            String("hello you"));
+  ASSERT_EQ(evaluate(hvm, "(not-not #f)")->get<Boolean>(), Boolean(false));
+  ASSERT_EQ(evaluate(hvm, "(identity 'x)")->get<Symbol>(), Symbol("x"));
+  ASSERT_EQ(evaluate(hvm, "(count!)")->get_type(),
+            Data::Type::UNSPECIFIED);
+  ASSERT_EQ(calls, 1);
+}
+
+/**
+ * @brief Test: typed native procedures check their arity and argument types
+ */
+TEST(NativeUnitTest, checks_arguments) {
+  gc::GC garbage_collector;
+  gc::init_create_node(garbage_collector);
+
+  // Given: A typed native procedure of an int and a string
+  NodePtr proc = native::make_native("f", [](int, const String&) {
+    return 0;
+  });
+  Closure& closure = proc->get<Closure>();
+
+  // Then: A call with the wrong number of arguments throws
+  ASSERT_THROW(closure.call({create_node(Number(1))}), InvalidInputException);
+
+  // Then: A call with a wrong argument type throws, naming the argument
+  try {
+    closure.call({create_node(Number(1)), create_node(Number(2))});
+    FAIL();
+  } catch (const TypeException& e) {
+    ASSERT_EQ(std::string(e.what()), "f: argument 2 is not a string");
+  }
+  ASSERT_THROW(closure.call({create_node(Number(1.5)),
+                             create_node(String("s"))}),
+               TypeException);
+
+  // Then: Narrow integer types reject values out of their range
+  NodePtr narrow = native::make_native("g", [](unsigned char c) {
+    return c;
+  });
+  ASSERT_THROW(narrow->get<Closure>().call({create_node(Number(256))}),
+               TypeException);
+  ASSERT_THROW(narrow->get<Closure>().call({create_node(Number(-1))}),
+               TypeException);
+  ASSERT_EQ(narrow->get<Closure>().call({create_node(Number(255))})[0]
+                ->get<Number>(), Number(255));
+
+  // Then: Integer results that do not fit an Integer throw
+  NodePtr wide = native::make_native("h", []() -> long long {
+    return 1LL << 40;
+  });
+  ASSERT_THROW(wide->get<Closure>().call({}), InvalidInputException);
+}